@@ -136,6 +136,20 @@ struct oval_iterator *oval_collection_iterator(struct oval_collection *collectio
 	return iterator;
 }
 
+bool oval_collection_walk(struct oval_collection *collection, void **pos, void **item)
+{
+	__attribute__nonnull__(collection);
+
+	struct _oval_collection_item_frame *frame = (*pos == NULL) ?
+		collection->item_collection_frame : ((struct _oval_collection_item_frame *) *pos)->next;
+
+	if (frame == NULL)
+		return false;
+	*pos = frame;
+	*item = frame->item;
+	return true;
+}
+
 bool oval_collection_iterator_has_more(struct oval_iterator * iterator)
 {
 	__attribute__nonnull__(iterator);
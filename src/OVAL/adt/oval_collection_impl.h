@@ -47,6 +47,14 @@ bool oval_collection_iterator_has_more(struct oval_iterator *);
 int oval_collection_iterator_remaining(struct oval_iterator *);
 void *oval_collection_iterator_next(struct oval_iterator *);
 void oval_collection_iterator_free(struct oval_iterator *);
+/**
+ * Walk the collection without allocating an iterator. The items are visited
+ * in the reverse order of their addition.
+ * @param pos position in the collection, NULL to start at the last item
+ * @param item the next item is stored here
+ * @returns false when there are no more items
+ */
+bool oval_collection_walk(struct oval_collection *, void **pos, void **item);
 
 struct oval_string_iterator;
 
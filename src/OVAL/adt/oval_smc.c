@@ -101,6 +101,13 @@ void *oval_smc_get_last(struct oval_smc *map, const char *key)
 	return found;
 }
 
+void oval_smc_remove(struct oval_smc *map, const char *key, oscap_destruct_func destructor)
+{
+	struct oval_collection *list_col = (struct oval_collection *) oval_string_map_remove((struct oval_string_map *) map, key);
+	if (list_col != NULL)
+		oval_collection_free_items(list_col, destructor);
+}
+
 void oval_smc_free0(struct oval_smc *map)
 {
 	if (map == NULL)
@@ -42,6 +42,8 @@ struct oval_iterator *oval_smc_get_all_it(struct oval_smc *map, const char *key)
 
 void *oval_smc_get_last(struct oval_smc *map, const char *key);
 
+void oval_smc_remove(struct oval_smc *map, const char *key, oscap_destruct_func destructor);
+
 void oval_smc_free0(struct oval_smc *map);
 
 void oval_smc_free(struct oval_smc *map, oscap_destruct_func destructor);
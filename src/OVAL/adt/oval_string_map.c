@@ -166,6 +166,27 @@ void *oval_string_map_get_value(struct oval_string_map *map, const char *key)
 	return (entry == NULL) ? NULL : entry->item;
 }
 
+void *oval_string_map_remove(struct oval_string_map *map, const char *key)
+{
+	__attribute__nonnull__(map);
+
+	if (key == NULL)
+		return NULL;
+
+	struct _oval_string_map_entry **link = &map->entries;
+	while (*link != NULL && strcmp(key, (*link)->key) != 0)
+		link = &(*link)->next;
+	if (*link == NULL)
+		return NULL;
+
+	struct _oval_string_map_entry *entry = *link;
+	void *item = entry->item;
+	*link = entry->next;
+	free(entry->key);
+	free(entry);
+	return item;
+}
+
 void oval_string_map_free(struct oval_string_map *map, oscap_destruct_func free_func)
 {
 	__attribute__nonnull__(map);
@@ -243,6 +264,28 @@ void *oval_string_map_get_value(struct oval_string_map *map, const char *key)
 		return (val);
 }
 
+void *oval_string_map_remove(struct oval_string_map *map, const char *key)
+{
+	struct rbt_str_node *node = NULL;
+	char *key_copy;
+	void *val = NULL;
+
+	if (map == NULL || key == NULL) {
+		return NULL;
+	}
+
+	if (rbt_str_getnode((rbt_t *)map, key, &node) != 0)
+		return (NULL);
+
+	/* the tree doesn't own the keys, the copy made by put has to be freed here */
+	key_copy = node->key;
+	if (rbt_str_del((rbt_t *)map, key_copy, &val) != 0)
+		return (NULL);
+	free(key_copy);
+
+	return (val);
+}
+
 static void __oval_string_map_node_free(struct rbt_str_node *n, oscap_destruct_func destroy)
 {
 	if (destroy != NULL)
@@ -113,6 +113,61 @@ void oval_ste_collect_var_refs(struct oval_state *ste, struct oval_string_map *v
 	oval_state_content_iterator_free(cont_itr);
 }
 
+static void _comp_collect_var_deps(struct oval_component *comp, struct oval_string_map *vm)
+{
+	struct oval_variable *var;
+	struct oval_component_iterator *cmp_itr;
+
+	if (comp == NULL)
+		return;
+
+	if (oval_component_get_type(comp) == OVAL_COMPONENT_VARREF) {
+		var = oval_component_get_variable(comp);
+		if (var != NULL)
+			oval_string_map_put(vm, oval_variable_get_id(var), var);
+	} else if (oval_component_get_type(comp) > OVAL_FUNCTION) {
+		cmp_itr = oval_component_get_function_components(comp);
+		while (oval_component_iterator_has_more(cmp_itr)) {
+			struct oval_component *cmp;
+
+			cmp = oval_component_iterator_next(cmp_itr);
+			_comp_collect_var_deps(cmp, vm);
+		}
+		oval_component_iterator_free(cmp_itr);
+	}
+}
+
+void oval_var_collect_var_deps(struct oval_variable *var, struct oval_string_map *vm)
+{
+	if (oval_variable_get_type(var) == OVAL_VARIABLE_LOCAL)
+		_comp_collect_var_deps(oval_variable_get_component(var), vm);
+}
+
+void oval_ste_collect_var_deps(struct oval_state *ste, struct oval_string_map *vm)
+{
+	struct oval_state_content_iterator *cont_itr;
+
+	cont_itr = oval_state_get_contents(ste);
+	while (oval_state_content_iterator_has_more(cont_itr)) {
+		struct oval_state_content *cont;
+		struct oval_entity *ent;
+		oval_entity_varref_type_t vrt;
+
+		cont = oval_state_content_iterator_next(cont_itr);
+		ent = oval_state_content_get_entity(cont);
+		vrt = oval_entity_get_varref_type(ent);
+		if (vrt == OVAL_ENTITY_VARREF_ATTRIBUTE
+		    || vrt == OVAL_ENTITY_VARREF_ELEMENT) {
+			struct oval_variable *var;
+
+			var = oval_entity_get_variable(ent);
+			if (var != NULL)
+				oval_string_map_put(vm, oval_variable_get_id(var), var);
+		}
+	}
+	oval_state_content_iterator_free(cont_itr);
+}
+
 static void _set_collect_var_refs(struct oval_setobject *set, struct oval_string_map *vm)
 {
 	struct oval_setobject_iterator *subset_itr;
@@ -34,5 +34,13 @@
 void oval_obj_collect_var_refs(struct oval_object *obj, struct oval_string_map *vm);
 void oval_ste_collect_var_refs(struct oval_state *ste, struct oval_string_map *vm);
 
+/* Collect the variables a local variable depends on when it's computed
+ * from already collected objects, ie. the variables referenced through
+ * variable components of its component tree, not through objects. The
+ * state variant collects the variables referenced by the state entities.
+ */
+void oval_var_collect_var_deps(struct oval_variable *var, struct oval_string_map *vm);
+void oval_ste_collect_var_deps(struct oval_state *ste, struct oval_string_map *vm);
+
 
 #endif
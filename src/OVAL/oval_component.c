@@ -39,6 +39,7 @@
 #include <string.h>
 #include <time.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include <sys/types.h>
 
 #include "oval_definitions_impl.h"
@@ -56,6 +57,7 @@
 #include "common/_error.h"
 #include "common/oscap_string.h"
 #include "common/oscap_pcre.h"
+#include "common/list.h"
 #include "oval_glob_to_regex.h"
 
 #if !defined(OVAL_PROBES_ENABLED)
@@ -118,8 +120,29 @@ typedef struct {
 		oval_probe_session_t *sess;
 #endif
 	} u;
+	struct oval_component_cache *cache;
 } oval_argu_t;
 
+/*
+ * Results of the components evaluated while computing a batch of variables.
+ * They are keyed by the structure of the component, so the components which
+ * are the same in several variables are evaluated only once. Only the
+ * results of the components registered more than once are kept.
+ */
+struct oval_component_cache {
+	pthread_mutex_t lock;
+	struct oval_string_map *components;
+	struct oval_string_map *shared;
+	struct oval_string_map *results;
+	size_t lookups;
+	size_t hits;
+};
+
+struct oval_component_result {
+	oval_syschar_collection_flag_t flag;
+	struct oval_collection *values;
+};
+
 typedef struct oval_component {
 	struct oval_definition_model *model;
 	oval_component_type_t type;
@@ -200,6 +223,9 @@ typedef struct oval_component_REGEX_CAPTURE {
 	oval_component_type_t type;
 	struct oval_collection *function_components;	/*type==OVAL_COMPONENT_FUNCTION */
 	char *pattern;		/*type==OVAL_COMPONENT_REGEX_CAPTURE */
+	pthread_mutex_t lock;	/* guards the compilation of the pattern */
+	bool compiled;
+	oscap_pcre_t *re;	/* pattern compiled by the first evaluation, NULL if invalid */
 } oval_component_REGEX_CAPTURE_t;
 
 void oval_component_to_print(struct oval_component *component, char *indent, int index);
@@ -614,7 +640,12 @@ void oval_component_set_regex_pattern(struct oval_component *component, char *pa
 	/* type == OVAL_COMPONENT_REGEX_CAPTURE */
 	if (component->type == OVAL_FUNCTION_REGEX_CAPTURE) {
 		oval_component_REGEX_CAPTURE_t *regex = (oval_component_REGEX_CAPTURE_t *) component;
+		free(regex->pattern);
 		regex->pattern = oscap_strdup(pattern);
+		if (regex->re != NULL)
+			oscap_pcre_free(regex->re);
+		regex->re = NULL;
+		regex->compiled = false;
 	}
 }
 
@@ -729,6 +760,9 @@ struct oval_component *oval_component_new(struct oval_definition_model *model, o
 						return NULL;
 
 					regex->pattern = NULL;
+					pthread_mutex_init(&regex->lock, NULL);
+					regex->compiled = false;
+					regex->re = NULL;
 				};
 				break;
 			default:{
@@ -896,6 +930,10 @@ void oval_component_free(struct oval_component *component)
 			oval_component_REGEX_CAPTURE_t *regex = (oval_component_REGEX_CAPTURE_t *) component;
 			free(regex->pattern);
 			regex->pattern = NULL;
+			if (regex->re != NULL)
+				oscap_pcre_free(regex->re);
+			regex->re = NULL;
+			pthread_mutex_destroy(&regex->lock);
 		};
 		break;
 	case OVAL_FUNCTION_GLOB_TO_REGEX:
@@ -1455,9 +1493,12 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_OBJECTREF(oval_ar
 }
 
 #define _HAS_VALUES(flag) (flag==SYSCHAR_FLAG_COMPLETE || flag==SYSCHAR_FLAG_INCOMPLETE)
-static oval_syschar_collection_flag_t _oval_component_evaluate_VARREF(oval_argu_t *argu,
-								      struct oval_component *component,
-								      struct oval_collection *value_collection)
+/*
+ * Compute the variable referenced by the component, the values are left
+ * in the variable.
+ */
+static oval_syschar_collection_flag_t _oval_component_compute_VARREF(oval_argu_t *argu,
+								     struct oval_component *component)
 {
 	__attribute__nonnull__(component);
 
@@ -1492,7 +1533,19 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_VARREF(oval_argu_
 	}
 
 	flag = oval_variable_get_collection_flag(variable);
+
+	dIndent(-1);
+	return flag;
+}
+
+static oval_syschar_collection_flag_t _oval_component_evaluate_VARREF(oval_argu_t *argu,
+								      struct oval_component *component,
+								      struct oval_collection *value_collection)
+{
+	oval_syschar_collection_flag_t flag = _oval_component_compute_VARREF(argu, component);
+
 	if (_HAS_VALUES(flag)) {
+		struct oval_variable *variable = ((struct oval_component_VARREF *) component)->variable;
 		struct oval_value_iterator *values = oval_variable_get_values(variable);
 		while (oval_value_iterator_has_more(values)) {
 			struct oval_value *value = oval_value_iterator_next(values);
@@ -1500,11 +1553,138 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_VARREF(oval_argu_
 		}
 		oval_value_iterator_free(values);
 	}
+	return flag;
+}
 
-	dIndent(-1);
+#define OVAL_FUNCTION_MAX_VALUES_DEFAULT 10000000
+
+/*
+ * Values of a subcomponent in the order of their evaluation, stored in an
+ * array together with the lengths of their texts. The functions index the
+ * values directly instead of walking a copy of the collection for every
+ * combination of values. The values of a referenced variable are not
+ * copied, the collection is NULL then.
+ */
+struct oval_value_vector {
+	struct oval_collection *collection;
+	struct oval_value **values;
+	size_t *lengths;
+	size_t count;
+};
+
+static bool _oval_value_vector_walk(struct oval_value_vector *vector, struct oval_variable *variable,
+				    void **pos, struct oval_value **value)
+{
+	if (vector->collection != NULL)
+		return oval_collection_walk(vector->collection, pos, (void **) value);
+	return variable != NULL && oval_variable_walk_values(variable, pos, value);
+}
+
+static oval_syschar_collection_flag_t _oval_value_vector_eval(oval_argu_t *argu,
+							      struct oval_component *component,
+							      struct oval_value_vector *vector)
+{
+	oval_syschar_collection_flag_t flag;
+	struct oval_variable *variable = NULL;
+	struct oval_value *value;
+	void *pos = NULL;
+	size_t idx;
+
+	if (component->type == OVAL_COMPONENT_VARREF) {
+		vector->collection = NULL;
+		flag = _oval_component_compute_VARREF(argu, component);
+		if (_HAS_VALUES(flag))
+			variable = ((struct oval_component_VARREF *) component)->variable;
+	} else {
+		vector->collection = oval_collection_new();
+		flag = oval_component_eval_common(argu, component, vector->collection);
+	}
+
+	vector->count = 0;
+	while (_oval_value_vector_walk(vector, variable, &pos, &value))
+		vector->count++;
+	vector->values = malloc(vector->count * sizeof(struct oval_value *));
+	vector->lengths = malloc(vector->count * sizeof(size_t));
+
+	/* the walk starts at the last added value */
+	pos = NULL;
+	idx = vector->count;
+	while (_oval_value_vector_walk(vector, variable, &pos, &value)) {
+		char *text = oval_value_get_text(value);
+
+		idx--;
+		vector->values[idx] = value;
+		vector->lengths[idx] = text ? strlen(text) : 0;
+	}
 	return flag;
 }
 
+static void _oval_value_vector_clear(struct oval_value_vector *vector)
+{
+	oval_collection_free_items(vector->collection, (oscap_destruct_func) oval_value_free);
+	free(vector->values);
+	free(vector->lengths);
+}
+
+/*
+ * The texts of the values produced by a function are copied by
+ * oval_value_new(), so they are built in one buffer which only grows.
+ */
+struct oval_text_buffer {
+	char *text;
+	size_t size;
+};
+
+static char *_oval_text_buffer_reserve(struct oval_text_buffer *buffer, size_t size)
+{
+	if (size > buffer->size) {
+		size_t new_size = buffer->size ? buffer->size : 64;
+
+		while (new_size < size)
+			new_size *= 2;
+		buffer->text = realloc(buffer->text, new_size);
+		buffer->size = new_size;
+	}
+	return buffer->text;
+}
+
+/*
+ * Check the number of values produced by a function combining every value
+ * of a subcomponent with every value of the others. The number grows with
+ * the product of the numbers of values, so it is limited to report an
+ * error instead of exhausting the memory. The subcomponents without values
+ * are skipped if skip_empty is set, otherwise there is nothing to combine.
+ */
+static bool _oval_component_check_product(struct oval_component *component,
+					  const size_t *counts, size_t len, bool skip_empty)
+{
+	unsigned long limit = OVAL_FUNCTION_MAX_VALUES_DEFAULT;
+	char *limit_str = getenv("OSCAP_FUNCTION_MAX_VALUES");
+	size_t idx, product = 1;
+
+	if (limit_str != NULL)
+		if (sscanf(limit_str, "%lu", &limit) <= 0)
+			dW("Unable to parse OSCAP_FUNCTION_MAX_VALUES value");
+
+	if (!skip_empty) {
+		for (idx = 0; idx < len; idx++)
+			if (counts[idx] == 0)
+				return true;
+	}
+	for (idx = 0; idx < len; idx++) {
+		if (counts[idx] == 0)
+			continue;
+		if (product > limit / counts[idx]) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "The %s function would produce more than %lu values. "
+				     "The limit can be changed by the OSCAP_FUNCTION_MAX_VALUES environment variable.",
+				     oscap_enum_to_string(_OVAL_FUNCTION_MAP, component->type), limit);
+			return false;
+		}
+		product *= counts[idx];
+	}
+	return true;
+}
+
 static oval_syschar_collection_flag_t _oval_component_evaluate_BEGIN(oval_argu_t *argu,
 								     struct oval_component *component,
 								     struct oval_collection *value_collection)
@@ -1512,29 +1692,26 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_BEGIN(oval_argu_t
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_ERROR;
 	char *prefix = oval_component_get_prefix(component);
 	if (prefix) {
-		int len_prefix = strlen(prefix);
+		size_t len_prefix = strlen(prefix);
 		struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 		if (oval_component_iterator_has_more(subcomps)) {	/*only the first component is processed */
-			struct oval_collection *subcoll = oval_collection_new();
+			struct oval_value_vector vector;
+			struct oval_text_buffer buffer = { NULL, 0 };
 			struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-			flag = oval_component_eval_common(argu, subcomp, subcoll);
-			struct oval_value_iterator *values =
-			    (struct oval_value_iterator *)oval_collection_iterator(subcoll);
-			while (oval_value_iterator_has_more(values)) {
-				char *key = oval_value_get_text(oval_value_iterator_next(values));
-				const size_t concat_len = len_prefix + strlen(key) + 1;
-				char *concat = malloc(concat_len);
+			flag = _oval_value_vector_eval(argu, subcomp, &vector);
+			for (size_t idx = 0; idx < vector.count; idx++) {
+				char *key = oval_value_get_text(vector.values[idx]);
+				char *concat = key;
 				if (strncmp(prefix, key, len_prefix)) {
-					snprintf(concat, concat_len, "%s%s", prefix, key);
-				} else {
-					snprintf(concat, concat_len, "%s", key);
+					concat = _oval_text_buffer_reserve(&buffer, len_prefix + vector.lengths[idx] + 1);
+					memcpy(concat, prefix, len_prefix);
+					memcpy(concat + len_prefix, key, vector.lengths[idx] + 1);
 				}
 				struct oval_value *concat_value = oval_value_new(OVAL_DATATYPE_STRING, concat);
-				free(concat);
 				oval_collection_add(value_collection, concat_value);
 			}
-			oval_value_iterator_free(values);
-			oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+			free(buffer.text);
+			_oval_value_vector_clear(&vector);
 		}
 		oval_component_iterator_free(subcomps);
 	} else {
@@ -1549,30 +1726,27 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_END(oval_argu_t *
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_ERROR;
 	char *suffix = oval_component_get_suffix(component);
 	if (suffix) {
-		int len_suffix = strlen(suffix);
+		size_t len_suffix = strlen(suffix);
 		struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 		if (oval_component_iterator_has_more(subcomps)) {	/*only the first component is processed */
-			struct oval_collection *subcoll = oval_collection_new();
+			struct oval_value_vector vector;
+			struct oval_text_buffer buffer = { NULL, 0 };
 			struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-			flag = oval_component_eval_common(argu, subcomp, subcoll);
-			struct oval_value_iterator *values =
-			    (struct oval_value_iterator *)oval_collection_iterator(subcoll);
-			while (oval_value_iterator_has_more(values)) {
-				char *key = oval_value_get_text(oval_value_iterator_next(values));
-				int len_key = strlen(key);
-				const size_t concat_len = len_suffix + len_key + 1;
-				char *concat = malloc(concat_len);
+			flag = _oval_value_vector_eval(argu, subcomp, &vector);
+			for (size_t idx = 0; idx < vector.count; idx++) {
+				char *key = oval_value_get_text(vector.values[idx]);
+				size_t len_key = vector.lengths[idx];
+				char *concat = key;
 				if ((len_suffix > len_key) || strncmp(suffix, key + len_key - len_suffix, len_suffix)) {
-					snprintf(concat, concat_len, "%s%s", key, suffix);
-				} else {
-					snprintf(concat, concat_len, "%s", key);
+					concat = _oval_text_buffer_reserve(&buffer, len_key + len_suffix + 1);
+					memcpy(concat, key, len_key);
+					memcpy(concat + len_key, suffix, len_suffix + 1);
 				}
 				struct oval_value *concat_value = oval_value_new(OVAL_DATATYPE_STRING, concat);
-				free(concat);
 				oval_collection_add(value_collection, concat_value);
 			}
-			oval_value_iterator_free(values);
-			oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+			free(buffer.text);
+			_oval_value_vector_clear(&vector);
 		}
 		oval_component_iterator_free(subcomps);
 	} else {
@@ -1590,88 +1764,62 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_CONCAT(oval_argu_
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
 	struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 	int len_subcomps = oval_component_iterator_remaining(subcomps);
-	struct oval_collection **component_colls = malloc(len_subcomps * sizeof(struct oval_collection *));
+	struct oval_value_vector *vectors = malloc(len_subcomps * sizeof(struct oval_value_vector));
+	size_t *positions = malloc(len_subcomps * sizeof(size_t));
 	for (idx0 = 0; oval_component_iterator_has_more(subcomps); idx0++) {
-		struct oval_collection *subcoll = oval_collection_new();
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		oval_syschar_collection_flag_t subflag = oval_component_eval_common(argu, subcomp, subcoll);
+		oval_syschar_collection_flag_t subflag = _oval_value_vector_eval(argu, subcomp, &vectors[idx0]);
 		flag = _AGG_FLAG(flag, subflag);
-		component_colls[idx0] = subcoll;
+		positions[idx0] = vectors[idx0].count;
 	}
-	bool not_finished = (len_subcomps > 0) && _HAS_VALUES(flag);
-	if (not_finished) {
-		struct oval_value_iterator **values = malloc(len_subcomps * sizeof(struct oval_value_iterator *));
-		/* bool has_some[len_subcomps]; <-- unused variable */
-		not_finished = false;
-		char **texts = malloc(len_subcomps * sizeof(char *));
-		int *counts = malloc(len_subcomps * sizeof(int));
-		int catnum = 1;
-		for (idx0 = 0; idx0 < len_subcomps; idx0++) {
-			struct oval_value_iterator *comp_values =
-			    (struct oval_value_iterator *)oval_collection_iterator(component_colls[idx0]);
-			counts[idx0] = oval_value_iterator_remaining(comp_values);
-			if (counts[idx0]) {
-				/* int dbgnum = catnum; <-- unused variable */
-				catnum = catnum * counts[idx0];
-				values[idx0] = comp_values;
-				texts[idx0] = oval_value_get_text(oval_value_iterator_next(comp_values));
-				not_finished = true;
-			} else {
-				oval_value_iterator_free(comp_values);
-				oval_collection_free_items(component_colls[idx0],
-							   (oscap_destruct_func) oval_value_free);
-				component_colls[idx0] = NULL;
-				values[idx0] = NULL;
-				texts[idx0] = NULL;
-			}
-		}
-		for (int passnum = 1; passnum - 1 < catnum; passnum++) {
-			int len_cat = 1;
-			for (idx0 = 0; idx0 < len_subcomps; idx0++)
-				if (texts[idx0])
-					len_cat += strlen(texts[idx0]);
-			char *concat = malloc(len_cat);
-			*concat = '\0';
-			for (idx0 = 0; idx0 < len_subcomps; idx0++)
-				if (texts[idx0])
-					strcat(concat, texts[idx0]);
-			struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, concat);
-			free(concat);
-			oval_collection_add(value_collection, value);
-			bool rotate = true;
-			if (passnum < catnum) {
-				for (idx0 = 0; idx0 < len_subcomps && rotate; idx0++) {
-					if (texts[idx0]) {
-						if (oval_value_iterator_has_more(values[idx0])) {
-							rotate = false;
-						} else {
-							oval_value_iterator_free(values[idx0]);
-							values[idx0] =
-							    (struct oval_value_iterator *)
-							    oval_collection_iterator(component_colls[idx0]);
-						}
-						texts[idx0] =
-						    oval_value_get_text(oval_value_iterator_next(values[idx0]));
+	oval_component_iterator_free(subcomps);
+
+	if ((len_subcomps > 0) && _HAS_VALUES(flag)) {
+		if (_oval_component_check_product(component, positions, len_subcomps, true)) {
+			struct oval_text_buffer buffer = { NULL, 0 };
+
+			/*
+			 * The subcomponents without values are skipped, the values
+			 * of the first subcomponent are rotated first.
+			 */
+			memset(positions, 0, len_subcomps * sizeof(size_t));
+			do {
+				size_t len_cat = 0;
+				for (idx0 = 0; idx0 < len_subcomps; idx0++)
+					if (vectors[idx0].count)
+						len_cat += vectors[idx0].lengths[positions[idx0]];
+				char *concat = _oval_text_buffer_reserve(&buffer, len_cat + 1);
+				len_cat = 0;
+				for (idx0 = 0; idx0 < len_subcomps; idx0++) {
+					if (vectors[idx0].count) {
+						size_t pos = positions[idx0];
+						size_t len = vectors[idx0].lengths[pos];
+						if (len)
+							memcpy(concat + len_cat, oval_value_get_text(vectors[idx0].values[pos]), len);
+						len_cat += len;
 					}
 				}
-			}
-		}
-		for (idx0 = 0; idx0 < len_subcomps; idx0++) {
-			if (counts[idx0]) {
-				oval_value_iterator_free(values[idx0]);
-				oval_collection_free_items(component_colls[idx0],
-							   (oscap_destruct_func) oval_value_free);
-			}
+				concat[len_cat] = '\0';
+				struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, concat);
+				oval_collection_add(value_collection, value);
+
+				for (idx0 = 0; idx0 < len_subcomps; idx0++) {
+					if (vectors[idx0].count == 0)
+						continue;
+					if (++positions[idx0] < vectors[idx0].count)
+						break;
+					positions[idx0] = 0;
+				}
+			} while (idx0 < len_subcomps);
+			free(buffer.text);
+		} else {
+			flag = SYSCHAR_FLAG_ERROR;
 		}
-		free(counts);
-		free(texts);
-		free(values);
-	} else {
-		for (idx0 = 0; idx0 < len_subcomps; ++idx0)
-			oval_collection_free_items(component_colls[idx0], (oscap_destruct_func) oval_value_free);
 	}
-	free(component_colls);
-	oval_component_iterator_free(subcomps);
+	for (idx0 = 0; idx0 < len_subcomps; ++idx0)
+		_oval_value_vector_clear(&vectors[idx0]);
+	free(positions);
+	free(vectors);
 	return flag;
 }
 
@@ -1685,25 +1833,19 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_COUNT(oval_argu_t
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
 	struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 	int len_subcomps = oval_component_iterator_remaining(subcomps);
-	struct oval_collection **component_colls = malloc(len_subcomps * sizeof(struct oval_collection *));
+	struct oval_value_vector *vectors = malloc(len_subcomps * sizeof(struct oval_value_vector));
 	for (idx0 = 0; oval_component_iterator_has_more(subcomps); idx0++) {
-		struct oval_collection *subcoll = oval_collection_new();
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		oval_syschar_collection_flag_t subflag = oval_component_eval_common(argu, subcomp, subcoll);
+		oval_syschar_collection_flag_t subflag = _oval_value_vector_eval(argu, subcomp, &vectors[idx0]);
 		flag = _AGG_FLAG(flag, subflag);
-		component_colls[idx0] = subcoll;
 	}
 	bool not_finished = (len_subcomps > 0) && _HAS_VALUES(flag);
 	if (not_finished) {
 		for (idx0 = 0; idx0 < len_subcomps; idx0++) {
-			struct oval_value_iterator *comp_values =
-			    (struct oval_value_iterator *)oval_collection_iterator(component_colls[idx0]);
-			while (oval_value_iterator_has_more(comp_values)) {
-				if (oval_value_get_text(oval_value_iterator_next(comp_values)))
+			for (size_t idx = 0; idx < vectors[idx0].count; idx++) {
+				if (oval_value_get_text(vectors[idx0].values[idx]))
 					count++;
 			}
-			oval_value_iterator_free(comp_values);
-
 		}
 	}
 	char count_str[128];
@@ -1714,12 +1856,17 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_COUNT(oval_argu_t
 	oval_component_iterator_free(subcomps);
 
 	for (idx0 = 0; idx0 < len_subcomps; ++idx0)
-	  oval_collection_free_items(component_colls[idx0], (oscap_destruct_func) oval_value_free);
+		_oval_value_vector_clear(&vectors[idx0]);
 
-	free(component_colls);
+	free(vectors);
 	return flag;
 }
 
+static int _oval_component_text_cmp(const void *a, const void *b)
+{
+	return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
 static oval_syschar_collection_flag_t _oval_component_evaluate_UNIQUE(oval_argu_t *argu,
 								      struct oval_component *component,
 								      struct oval_collection *value_collection)
@@ -1728,46 +1875,46 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_UNIQUE(oval_argu_
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
 	struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 	int len_subcomps = oval_component_iterator_remaining(subcomps);
-	struct oval_collection **component_colls = malloc(len_subcomps * sizeof(struct oval_collection *));
+	struct oval_value_vector *vectors = malloc(len_subcomps * sizeof(struct oval_value_vector));
+	size_t len_values = 0;
 
 	for (idx0 = 0; oval_component_iterator_has_more(subcomps); idx0++) {
-		struct oval_collection *subcoll = oval_collection_new();
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		oval_syschar_collection_flag_t subflag = oval_component_eval_common(argu, subcomp, subcoll);
+		oval_syschar_collection_flag_t subflag = _oval_value_vector_eval(argu, subcomp, &vectors[idx0]);
 		flag = _AGG_FLAG(flag, subflag);
-		component_colls[idx0] = subcoll;
+		len_values += vectors[idx0].count;
 	}
 
 	oval_component_iterator_free(subcomps);
 
 	bool not_finished = (len_subcomps > 0) && _HAS_VALUES(flag);
-	struct oval_string_map *valmap = oval_string_map_new();
 
 	if (not_finished) {
+		struct oscap_htable *seen = oscap_htable_new1(strcmp, len_values + 1);
+		char **texts = malloc(len_values * sizeof(char *));
+		size_t len_texts = 0;
+
 		for (idx0 = 0; idx0 < len_subcomps; idx0++) {
-			struct oval_value_iterator *comp_values =
-			    (struct oval_value_iterator *)oval_collection_iterator(component_colls[idx0]);
-
-			while (oval_value_iterator_has_more(comp_values)) {
-				char *valtxt;
-				if ((valtxt = oval_value_get_text(oval_value_iterator_next(comp_values))) != NULL) {
-				  if (oval_string_map_get_value(valmap, valtxt) == NULL) {
-					struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, valtxt);
-					oval_string_map_put(valmap, valtxt, value);
-				  }
-				}
+			for (size_t idx = 0; idx < vectors[idx0].count; idx++) {
+				char *valtxt = oval_value_get_text(vectors[idx0].values[idx]);
+				if (valtxt != NULL && oscap_htable_add(seen, valtxt, valtxt))
+					texts[len_texts++] = valtxt;
 			}
-			oval_value_iterator_free(comp_values);
 		}
+		/* the unique values are sorted by their texts */
+		qsort(texts, len_texts, sizeof(char *), _oval_component_text_cmp);
+		for (size_t idx = 0; idx < len_texts; idx++) {
+			struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, texts[idx]);
+			oval_collection_add(value_collection, value);
+		}
+		free(texts);
+		oscap_htable_free0(seen);
 	}
 
-	oval_string_map_collect_values(valmap, value_collection);
-	oval_string_map_free(valmap, NULL);
-
 	for (idx0 = 0; idx0 < len_subcomps; ++idx0)
-	  oval_collection_free_items(component_colls[idx0], (oscap_destruct_func) oval_value_free);
+		_oval_value_vector_clear(&vectors[idx0]);
 
-	free(component_colls);
+	free(vectors);
 	return flag;
 }
 
@@ -1782,18 +1929,15 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_SPLIT(oval_argu_t
 	int len_delim = strlen(delimiter);
 	if (oval_component_iterator_has_more(subcomps)) {	/* Only first component is considered */
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		struct oval_collection *subcoll = oval_collection_new();
-		flag = oval_component_eval_common(argu, subcomp, subcoll);
-		struct oval_value_iterator *values = (struct oval_value_iterator *)oval_collection_iterator(subcoll);
+		struct oval_value_vector vector;
+		struct oval_text_buffer buffer = { NULL, 0 };
 		struct oval_value *value;
-		while (oval_value_iterator_has_more(values)) {
-			char *text = oval_value_get_text(oval_value_iterator_next(values));
+		flag = _oval_value_vector_eval(argu, subcomp, &vector);
+		for (size_t idx = 0; idx < vector.count; idx++) {
+			char *text = oval_value_get_text(vector.values[idx]);
 			if (len_delim) {
-				char *split = malloc(strlen(text) + 2);
-				char *split0 = split;
-				*split0 = '\0';
-				strcat(split0, text);
-				split0[strlen(text) + 1] = '\0';	/*last two characters are EOS */
+				char *split0 = _oval_text_buffer_reserve(&buffer, vector.lengths[idx] + 1);
+				memcpy(split0, text, vector.lengths[idx] + 1);
 				char *split1;
 				for (split1 = strstr(split0, delimiter); split1; split1 = strstr(split0, delimiter)) {
 					*split1 = '\0';	/*terminate the text at the delimeter */
@@ -1803,19 +1947,18 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_SPLIT(oval_argu_t
 				}
 				value = oval_value_new(OVAL_DATATYPE_STRING, split0);
 				oval_collection_add(value_collection, value);
-				free(split);
 			} else {	/*Empty delimiter, Split at every character */
 				char split[] = { '\0', '\0' };
-				int idx;
-				for (idx = 0; text[idx]; idx++) {
-					*split = text[idx];
+				int idx1;
+				for (idx1 = 0; text[idx1]; idx1++) {
+					*split = text[idx1];
 					value = oval_value_new(OVAL_DATATYPE_STRING, split);
 					oval_collection_add(value_collection, value);
 				}
 			}
 		}
-		oval_value_iterator_free(values);
-		oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+		free(buffer.text);
+		_oval_value_vector_clear(&vector);
 	}
 	oval_component_iterator_free(subcomps);
 	return flag;
@@ -1834,32 +1977,31 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_SUBSTRING(oval_ar
 
 	if (oval_component_iterator_has_more(subcomps)) {	/*Only first component is considered */
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		struct oval_collection *subcoll = oval_collection_new();
-		flag = oval_component_eval_common(argu, subcomp, subcoll);
-		struct oval_value_iterator *values = (struct oval_value_iterator *)oval_collection_iterator(subcoll);
+		struct oval_value_vector vector;
+		struct oval_text_buffer buffer = { NULL, 0 };
 		struct oval_value *value;
 
-		while (oval_value_iterator_has_more(values)) {
-			char *text = oval_value_get_text(oval_value_iterator_next(values));
+		flag = _oval_value_vector_eval(argu, subcomp, &vector);
+		for (size_t idx = 0; idx < vector.count; idx++) {
+			char *text = oval_value_get_text(vector.values[idx]);
 			size_t txtlen, sublen;
 
-			txtlen = strlen(text);
+			txtlen = vector.lengths[idx];
 			sublen = (len < 0 || (size_t) len > txtlen) ? txtlen : (size_t) len;
 			if ((size_t) beg < txtlen) {
-				char *substr = malloc(sublen + 1);
+				char *substr = _oval_text_buffer_reserve(&buffer, sublen + 1);
 
 				strncpy(substr, text + beg, sublen);
 				substr[sublen] = '\0';
 
 				value = oval_value_new(OVAL_DATATYPE_STRING, substr);
-				free(substr);
 				oval_collection_add(value_collection, value);
 			} else {
 				flag = SYSCHAR_FLAG_ERROR;
 			}
 		}
-		oval_value_iterator_free(values);
-		oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+		free(buffer.text);
+		_oval_value_vector_clear(&vector);
 	}
 	oval_component_iterator_free(subcomps);
 	return flag;
@@ -1868,10 +2010,10 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_SUBSTRING(oval_ar
 static long unsigned int _comp_sec(int year, int month, int day, int hour, int minute, int second)
 {
 	time_t t;
-	struct tm *ts;
+	struct tm tm, *ts;
 
 	t = time(NULL);
-	ts = localtime(&t);
+	ts = localtime_r(&t, &tm);
 
 	ts->tm_year = year - 1900;
 	ts->tm_mon = month - 1;
@@ -1881,7 +2023,7 @@ static long unsigned int _comp_sec(int year, int month, int day, int hour, int m
 	ts->tm_sec = second;
 	ts->tm_isdst = -1;
 	t = mktime(ts);
-	ts = localtime(&t);
+	ts = localtime_r(&t, &tm);
 
 	if (ts->tm_isdst == 1)
 		t -= 3600;
@@ -1968,10 +2110,10 @@ static long unsigned int _parse_fmt_win(char *dt)
 static long unsigned int _parse_fmt_sse(char *dt)
 {
 	time_t t;
-	struct tm *ts;
+	struct tm tm, *ts;
 
 	t = (time_t) atol(dt);
-	ts = localtime(&t);
+	ts = localtime_r(&t, &tm);
 	if (ts->tm_isdst == 1)
 		t -= 3600;
 
@@ -2058,9 +2200,10 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_TIMEDIF(oval_argu
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
 	struct oval_component_iterator *subcomps;
 	int subcomp_idx;
-	struct oval_collection *val_cols[2];
-	struct oval_value_iterator *v1_itr;
+	struct oval_value_vector vectors[2];
 	oval_datetime_format_t fmt1, fmt2;
+	long unsigned int *times[2];
+	size_t counts[2], idx1, idx2;
 
 	subcomps = oval_component_get_function_components(component);
 	subcomp_idx = 0;
@@ -2068,15 +2211,14 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_TIMEDIF(oval_argu
 		struct oval_component *subcomp;
 
 		subcomp = oval_component_iterator_next(subcomps);
-		val_cols[subcomp_idx] = oval_collection_new();
-		flag = oval_component_eval_common(argu, subcomp, val_cols[subcomp_idx]);
+		flag = _oval_value_vector_eval(argu, subcomp, &vectors[subcomp_idx]);
 		subcomp_idx++;
 	}
 
 	if (oval_component_iterator_has_more(subcomps)) {
 		oval_component_iterator_free(subcomps);
-		oval_collection_free_items(val_cols[0], (oscap_destruct_func) oval_value_free);
-		oval_collection_free_items(val_cols[1], (oscap_destruct_func) oval_value_free);
+		_oval_value_vector_clear(&vectors[0]);
+		_oval_value_vector_clear(&vectors[1]);
 		return SYSCHAR_FLAG_ERROR;
 	}
 	oval_component_iterator_free(subcomps);
@@ -2087,43 +2229,46 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_TIMEDIF(oval_argu
 	fmt1 = oval_component_get_timedif_format_1(component);
 	fmt2 = oval_component_get_timedif_format_2(component);
 
+	/* the times are parsed once for all the differences */
 	if (subcomp_idx == 1) {
-		struct oval_value *ov;
 		char ts[16];
 
-		val_cols[1] = val_cols[0];
-		val_cols[0] = oval_collection_new();
 		snprintf(ts, sizeof (ts), "%lu", (long unsigned int) time(NULL));
-		ov = oval_value_new(OVAL_DATATYPE_INTEGER, ts);
-		oval_collection_add(val_cols[0], ov);
-		fmt1 = OVAL_DATETIME_SECONDS_SINCE_EPOCH;
-	}
-
-	v1_itr = (struct oval_value_iterator *) oval_collection_iterator(val_cols[0]);
-	while (oval_value_iterator_has_more(v1_itr)) {
-		struct oval_value *ov1;
-		struct oval_value_iterator *v2_itr;
-
-		ov1 = oval_value_iterator_next(v1_itr);
-
-		v2_itr = (struct oval_value_iterator *) oval_collection_iterator(val_cols[1]);
-		while (oval_value_iterator_has_more(v2_itr)) {
-			long unsigned int v;
-			char ts[16];
-			struct oval_value *ov2, *ov;
-
-			ov2 = oval_value_iterator_next(v2_itr);
-			v = _parse_fmt(ov1, fmt1) - _parse_fmt(ov2, fmt2);
-			snprintf(ts, sizeof (ts), "%lu", v);
-			ov = oval_value_new(OVAL_DATATYPE_INTEGER, ts);
-			oval_collection_add(value_collection, ov);
+		counts[0] = 1;
+		times[0] = malloc(sizeof(long unsigned int));
+		times[0][0] = _parse_fmt_sse(ts);
+	} else {
+		counts[0] = vectors[0].count;
+		times[0] = malloc(counts[0] * sizeof(long unsigned int));
+		for (idx1 = 0; idx1 < counts[0]; idx1++)
+			times[0][idx1] = _parse_fmt(vectors[0].values[idx1], fmt1);
+	}
+	counts[1] = vectors[subcomp_idx - 1].count;
+	times[1] = malloc(counts[1] * sizeof(long unsigned int));
+	for (idx2 = 0; idx2 < counts[1]; idx2++)
+		times[1][idx2] = _parse_fmt(vectors[subcomp_idx - 1].values[idx2], fmt2);
+
+	if (_oval_component_check_product(component, counts, 2, false)) {
+		for (idx1 = 0; idx1 < counts[0]; idx1++) {
+			for (idx2 = 0; idx2 < counts[1]; idx2++) {
+				long unsigned int v;
+				char ts[16];
+				struct oval_value *ov;
+
+				v = times[0][idx1] - times[1][idx2];
+				snprintf(ts, sizeof (ts), "%lu", v);
+				ov = oval_value_new(OVAL_DATATYPE_INTEGER, ts);
+				oval_collection_add(value_collection, ov);
+			}
 		}
-		oval_value_iterator_free(v2_itr);
+	} else {
+		flag = SYSCHAR_FLAG_ERROR;
 	}
-	oval_value_iterator_free(v1_itr);
 
-	oval_collection_free_items(val_cols[0], (oscap_destruct_func) oval_value_free);
-	oval_collection_free_items(val_cols[1], (oscap_destruct_func) oval_value_free);
+	free(times[0]);
+	free(times[1]);
+	while (subcomp_idx > 0)
+		_oval_value_vector_clear(&vectors[--subcomp_idx]);
 
 	return flag;
 }
@@ -2144,14 +2289,12 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ESCAPE_REGEX(oval
 
 	if (oval_component_iterator_has_more(subcomps)) {	//Only first component is considered
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		struct oval_collection *subcoll = oval_collection_new();
-		flag = oval_component_eval_common(argu, subcomp, subcoll);
-		struct oval_value_iterator *values = (struct oval_value_iterator *)oval_collection_iterator(subcoll);
-		while (oval_value_iterator_has_more(values)) {
-			struct oval_value *value = oval_value_iterator_next(values);
-			char *text = oval_value_get_text(value);
-			int len = strlen(text);
-			char *string = malloc(2 * len + 1);
+		struct oval_value_vector vector;
+		struct oval_text_buffer buffer = { NULL, 0 };
+		flag = _oval_value_vector_eval(argu, subcomp, &vector);
+		for (size_t idx = 0; idx < vector.count; idx++) {
+			char *text = oval_value_get_text(vector.values[idx]);
+			char *string = _oval_text_buffer_reserve(&buffer, 2 * vector.lengths[idx] + 1);
 			char *insert = string;
 			while (*text) {
 				if (_isEscape(*text))
@@ -2159,12 +2302,11 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ESCAPE_REGEX(oval
 				*insert++ = *text++;
 			}
 			*insert = '\0';
-			value = oval_value_new(OVAL_DATATYPE_STRING, string);
-			free(string);
+			struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, string);
 			oval_collection_add(value_collection, value);
 		}
-		oval_value_iterator_free(values);
-		oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+		free(buffer.text);
+		_oval_value_vector_clear(&vector);
 	}
 	oval_component_iterator_free(subcomps);
 	return flag;
@@ -2183,23 +2325,20 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_GLOB_TO_REGEX(ova
 	struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 	if (oval_component_iterator_has_more(subcomps)) {	//Only first component is considered
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		struct oval_collection *subcoll = oval_collection_new();
-		flag = oval_component_eval_common(argu, subcomp, subcoll);
-		struct oval_value_iterator *values = (struct oval_value_iterator *)oval_collection_iterator(subcoll);
-		while (oval_value_iterator_has_more(values)) {
-			struct oval_value *value = oval_value_iterator_next(values);
-			char *text = oval_value_get_text(value);
+		struct oval_value_vector vector;
+		flag = _oval_value_vector_eval(argu, subcomp, &vector);
+		for (size_t idx = 0; idx < vector.count; idx++) {
+			char *text = oval_value_get_text(vector.values[idx]);
 			char *string = oval_glob_to_regex(text, glob_noescape);
 			if (string == NULL) {
 				flag = SYSCHAR_FLAG_ERROR;
 				break;
 			}
-			value = oval_value_new(OVAL_DATATYPE_STRING, string);
+			struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, string);
 			free(string);
 			oval_collection_add(value_collection, value);
 		}
-		oval_value_iterator_free(values);
-		oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+		_oval_value_vector_clear(&vector);
 	}
 	oval_component_iterator_free(subcomps);
 	return flag;
@@ -2210,36 +2349,41 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_REGEX_CAPTURE(ova
 									     struct oval_collection *value_collection)
 {
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
+	oval_component_REGEX_CAPTURE_t *regex = (oval_component_REGEX_CAPTURE_t *) component;
 	int rc;
-	char *pattern;
-	int erroffset = -1;
-	oscap_pcre_t *re = NULL;
-	char *error;
 
-	pattern = oval_component_get_regex_pattern(component);
-	re = oscap_pcre_compile(pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
-	if (re == NULL) {
-		dE("oscap_pcre_compile() failed: \"%s\".", error);
-		oscap_pcre_err_free(error);
-		return SYSCHAR_FLAG_ERROR;
+	/* the pattern is compiled once for all the evaluations of the component */
+	pthread_mutex_lock(&regex->lock);
+	if (!regex->compiled) {
+		char *error;
+		int erroffset = -1;
+
+		regex->re = oscap_pcre_compile(regex->pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
+		if (regex->re == NULL) {
+			dE("oscap_pcre_compile() failed: \"%s\".", error);
+			oscap_pcre_err_free(error);
+		}
+		regex->compiled = true;
 	}
+	pthread_mutex_unlock(&regex->lock);
+	if (regex->re == NULL)
+		return SYSCHAR_FLAG_ERROR;
 
 	struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
 	if (oval_component_iterator_has_more(subcomps)) {	//Only first component is considered
 		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
-		struct oval_collection *subcoll = oval_collection_new();
-		flag = oval_component_eval_common(argu, subcomp, subcoll);
-		struct oval_value_iterator *values = (struct oval_value_iterator *)oval_collection_iterator(subcoll);
-		while (oval_value_iterator_has_more(values)) {
-			struct oval_value *value = oval_value_iterator_next(values);
-			char *text = oval_value_get_text(value);
-			char *nval = NULL;
+		struct oval_value_vector vector;
+		struct oval_text_buffer buffer = { NULL, 0 };
+		flag = _oval_value_vector_eval(argu, subcomp, &vector);
+		for (size_t idx = 0; idx < vector.count; idx++) {
+			char *text = oval_value_get_text(vector.values[idx]);
+			char *nval = "";
 			int i, ovector[60], ovector_len = sizeof (ovector) / sizeof (ovector[0]);
 
 			for (i = 0; i < ovector_len; ++i)
 				ovector[i] = -1;
 
-			rc = oscap_pcre_exec(re, text, strlen(text), 0, 0, ovector, ovector_len);
+			rc = oscap_pcre_exec(regex->re, text, vector.lengths[idx], 0, 0, ovector, ovector_len);
 			if (rc < -1) {
 				dE("oscap_pcre_exec() failed: %d.", rc);
 				flag = SYSCHAR_FLAG_ERROR;
@@ -2249,42 +2393,71 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_REGEX_CAPTURE(ova
 			if (rc > 1 && ovector[2] != -1) {
 				int substr_len = ovector[3] - ovector[2];
 
-				nval = malloc(substr_len + 1);
+				nval = _oval_text_buffer_reserve(&buffer, substr_len + 1);
 				memcpy(nval, text + ovector[2], substr_len);
 				nval[substr_len] = '\0';
-			} else {
-				nval = NULL;
 			}
 			flag = SYSCHAR_FLAG_COMPLETE;
 
-			if (nval != NULL) {
-				value = oval_value_new(OVAL_DATATYPE_STRING, nval);
-				free(nval);
-			} else {
-				value = oval_value_new(OVAL_DATATYPE_STRING, "");
-			}
+			struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, nval);
 			oval_collection_add(value_collection, value);
 		}
-		oval_value_iterator_free(values);
-		oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
+		free(buffer.text);
+		_oval_value_vector_clear(&vector);
 	}
 	oval_component_iterator_free(subcomps);
-	oscap_pcre_free(re);
 	return flag;
 }
 
-struct val_col_lst_s {
-	void *val_col;
-	struct val_col_lst_s *next;
+/*
+ * Number of a value of a subcomponent of the arithmetic function, it is
+ * converted once for all the combinations with the values of the others.
+ */
+struct oval_arithmetic_operand {
+	struct oval_value *value;
+	oval_datatype_t datatype;
+	bool valid;
+	double number;
 };
 
-static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC_rec(struct val_col_lst_s *val_col_lst, double val,
+static void _oval_arithmetic_operand_init(struct oval_arithmetic_operand *operand, struct oval_value *ov)
+{
+	operand->value = ov;
+	operand->datatype = oval_value_get_datatype(ov);
+	operand->valid = true;
+	if (operand->datatype == OVAL_DATATYPE_STRING) {
+		errno = 0; // Setting errno to 0 as suggested by strtod() manpage, as 0 is used both on success and failure
+		operand->number = strtod(oval_value_get_text(ov), NULL);
+		if (errno)
+			operand->valid = false;
+	} else if (operand->datatype == OVAL_DATATYPE_INTEGER) {
+		operand->number = (double) oval_value_get_integer(ov);
+	} else if (operand->datatype == OVAL_DATATYPE_FLOAT) {
+		operand->number = (double) oval_value_get_float(ov);
+	} else {
+		operand->valid = false;
+	}
+}
+
+static void _oval_arithmetic_operand_seterr(struct oval_arithmetic_operand *operand)
+{
+	if (operand->datatype == OVAL_DATATYPE_STRING)
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected content: %s.", oval_value_get_text(operand->value));
+	else
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected value type: %s.", oval_datatype_get_text(operand->datatype));
+}
+
+/*
+ * Combine the value computed from the subcomponents after the given one
+ * with every value of the subcomponent, the values of the first
+ * subcomponent are rotated first.
+ */
+static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC_rec(struct oval_arithmetic_operand **operands,
+						    const size_t *counts, int subcomp_idx, double val,
 						    oval_datatype_t datatype, oval_arithmetic_operation_t op,
 						    struct oval_collection *res_val_col)
 {
-	struct oval_value_iterator *val_itr;
-
-	if (val_col_lst == NULL) {
+	if (subcomp_idx < 0) {
 		struct oval_value *ov;
 		char sv[32];
 
@@ -2301,47 +2474,28 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC_rec(st
 		return SYSCHAR_FLAG_COMPLETE;
 	}
 
-	val_itr = (struct oval_value_iterator *) oval_collection_iterator(val_col_lst->val_col);
-	while (oval_value_iterator_has_more(val_itr)) {
-		struct oval_value *ov;
+	for (size_t idx = 0; idx < counts[subcomp_idx]; idx++) {
+		struct oval_arithmetic_operand *operand = &operands[subcomp_idx][idx];
 		oval_datatype_t dt;
 		double new_val;
 
-		ov = oval_value_iterator_next(val_itr);
-		dt = oval_value_get_datatype(ov);
-		if (dt == OVAL_DATATYPE_STRING) {
-			errno = 0; // Setting errno to 0 as suggested by strtod() manpage, as 0 is used both on success and failure
-			new_val = strtod(oval_value_get_text(ov), NULL);
-			if (errno) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected content: %s.", oval_value_get_text(ov));
-				oval_value_iterator_free(val_itr);
-				return SYSCHAR_FLAG_ERROR;
-			}
-		} else if (dt == OVAL_DATATYPE_INTEGER) {
-			new_val = (double) oval_value_get_integer(ov);
-		} else if (dt == OVAL_DATATYPE_FLOAT) {
-			new_val = (double) oval_value_get_float(ov);
-		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected value type: %s.", oval_datatype_get_text(dt));
-			oval_value_iterator_free(val_itr);
+		if (!operand->valid) {
+			_oval_arithmetic_operand_seterr(operand);
 			return SYSCHAR_FLAG_ERROR;
 		}
 
+		new_val = operand->number;
 		if (op == OVAL_ARITHMETIC_ADD) {
 			new_val += val;
-		} else if (op == OVAL_ARITHMETIC_MULTIPLY) {
-			new_val *= val;
 		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected arithmetic operation: %s.", oval_arithmetic_operation_get_text(op));
-			oval_value_iterator_free(val_itr);
-			return SYSCHAR_FLAG_ERROR;
+			new_val *= val;
 		}
 
+		dt = operand->datatype;
 		if (datatype == OVAL_DATATYPE_FLOAT)
 			dt = OVAL_DATATYPE_FLOAT;
-		_oval_component_evaluate_ARITHMETIC_rec(val_col_lst->next, new_val, dt, op, res_val_col);
+		_oval_component_evaluate_ARITHMETIC_rec(operands, counts, subcomp_idx - 1, new_val, dt, op, res_val_col);
 	}
-	oval_value_iterator_free(val_itr);
 
 	return SYSCHAR_FLAG_COMPLETE;
 }
@@ -2352,9 +2506,11 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC(oval_a
 {
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
 	struct oval_component_iterator *subcomps;
-	struct val_col_lst_s *vcl_root, *vcl_elm;
 	oval_arithmetic_operation_t op;
-	struct oval_value_iterator *val_itr;
+	struct oval_value_vector *vectors;
+	struct oval_arithmetic_operand **operands;
+	size_t *counts;
+	int len_subcomps, idx0;
 
 	op = oval_component_get_arithmetic_operation(component);
 	if (op != OVAL_ARITHMETIC_ADD && op != OVAL_ARITHMETIC_MULTIPLY) {
@@ -2362,63 +2518,53 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC(oval_a
 		return SYSCHAR_FLAG_ERROR;
 	}
 
-	vcl_root = NULL;
 	subcomps = oval_component_get_function_components(component);
-	while (oval_component_iterator_has_more(subcomps)) {
-		struct oval_component *subcomp;
-		struct oval_collection *val_col;
-
-		subcomp = oval_component_iterator_next(subcomps);
-		val_col = oval_collection_new();
+	len_subcomps = oval_component_iterator_remaining(subcomps);
+	if (len_subcomps == 0) {
+		oval_component_iterator_free(subcomps);
+		return SYSCHAR_FLAG_ERROR;
+	}
+	vectors = malloc(len_subcomps * sizeof(struct oval_value_vector));
+	operands = malloc(len_subcomps * sizeof(struct oval_arithmetic_operand *));
+	counts = malloc(len_subcomps * sizeof(size_t));
+	for (idx0 = 0; oval_component_iterator_has_more(subcomps); idx0++) {
+		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
 		// todo: combine flags
-		flag = oval_component_eval_common(argu, subcomp, val_col);
-		vcl_elm = malloc(sizeof (struct val_col_lst_s));
-		vcl_elm->val_col = val_col;
-		vcl_elm->next = vcl_root;
-		vcl_root = vcl_elm;
+		flag = _oval_value_vector_eval(argu, subcomp, &vectors[idx0]);
+		counts[idx0] = vectors[idx0].count;
+		operands[idx0] = malloc(counts[idx0] * sizeof(struct oval_arithmetic_operand));
+		for (size_t idx = 0; idx < counts[idx0]; idx++)
+			_oval_arithmetic_operand_init(&operands[idx0][idx], vectors[idx0].values[idx]);
 	}
 	oval_component_iterator_free(subcomps);
 
-	if (vcl_root == NULL) {
-		return SYSCHAR_FLAG_ERROR;
+	if (!_oval_component_check_product(component, counts, len_subcomps, false)) {
+		flag = SYSCHAR_FLAG_ERROR;
+		goto cleanup;
 	}
-	val_itr = (struct oval_value_iterator *) oval_collection_iterator(vcl_root->val_col);
-	while (oval_value_iterator_has_more(val_itr)) {
-		struct oval_value *ov;
-		oval_datatype_t datatype;
-		double val;
-
-		ov = oval_value_iterator_next(val_itr);
-		datatype = oval_value_get_datatype(ov);
-		if (datatype == OVAL_DATATYPE_STRING) {
-			errno = 0; // Setting errno to 0 as suggested by strtod() manpage, as 0 is used both on success and failure
-			val = strtod(oval_value_get_text(ov), NULL);
-			if (errno) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected content: %s.", oval_value_get_text(ov));
-				flag = SYSCHAR_FLAG_ERROR;
-				goto cleanup;
-			}
-		} else if (datatype == OVAL_DATATYPE_INTEGER) {
-			val = (double) oval_value_get_integer(ov);
-		} else if (datatype == OVAL_DATATYPE_FLOAT) {
-			val = (double) oval_value_get_float(ov);
-		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected value type: %s.", oval_datatype_get_text(datatype));
+
+	/* the values of the last subcomponent are combined with all the others */
+	idx0 = len_subcomps - 1;
+	for (size_t idx = 0; idx < counts[idx0]; idx++) {
+		struct oval_arithmetic_operand *operand = &operands[idx0][idx];
+
+		if (!operand->valid) {
+			_oval_arithmetic_operand_seterr(operand);
 			flag = SYSCHAR_FLAG_ERROR;
 			goto cleanup;
 		}
-
-		flag = _oval_component_evaluate_ARITHMETIC_rec(vcl_root->next, val, datatype, op, value_collection);
+		flag = _oval_component_evaluate_ARITHMETIC_rec(operands, counts, idx0 - 1, operand->number,
+							       operand->datatype, op, value_collection);
 	}
 
  cleanup:
-	oval_value_iterator_free(val_itr);
-	while (vcl_root != NULL) {
-		oval_collection_free_items(vcl_root->val_col, (oscap_destruct_func) oval_value_free);
-		vcl_elm = vcl_root;
-		vcl_root = vcl_root->next;
-		free(vcl_elm);
+	for (idx0 = 0; idx0 < len_subcomps; idx0++) {
+		free(operands[idx0]);
+		_oval_value_vector_clear(&vectors[idx0]);
 	}
+	free(counts);
+	free(operands);
+	free(vectors);
 
 	return flag;
 }
@@ -2447,6 +2593,192 @@ static _oval_component_evaluator *_component_evaluators[] = {
 	NULL,
 };
 
+static void _oval_component_key_append(struct oscap_string *key, const char *str)
+{
+	char buf[32];
+
+	if (str == NULL) {
+		oscap_string_append_char(key, '-');
+		return;
+	}
+	snprintf(buf, sizeof(buf), "%zu:", strlen(str));
+	oscap_string_append_string(key, buf);
+	oscap_string_append_string(key, str);
+}
+
+static void _oval_component_key_append_int(struct oscap_string *key, int i)
+{
+	char buf[32];
+
+	snprintf(buf, sizeof(buf), "%d,", i);
+	oscap_string_append_string(key, buf);
+}
+
+/*
+ * Describe the component and all its subcomponents by a string, the
+ * components with the same key are evaluated to the same values.
+ */
+static bool _oval_component_key(struct oval_component *component, struct oscap_string *key)
+{
+	oval_component_type_t type = component->type;
+	bool ret = true;
+
+	_oval_component_key_append_int(key, type);
+	oscap_string_append_char(key, '(');
+
+	switch (type) {
+	case OVAL_COMPONENT_LITERAL: {
+		struct oval_value *value = ((struct oval_component_LITERAL *)component)->value;
+
+		if (value == NULL)
+			return false;
+		_oval_component_key_append_int(key, oval_value_get_datatype(value));
+		_oval_component_key_append(key, oval_value_get_text(value));
+		break;
+	}
+	case OVAL_COMPONENT_OBJECTREF: {
+		struct oval_component_OBJECTREF *objref = (struct oval_component_OBJECTREF *)component;
+
+		if (objref->object == NULL)
+			return false;
+		_oval_component_key_append(key, oval_object_get_id(objref->object));
+		_oval_component_key_append(key, objref->item_field);
+		_oval_component_key_append(key, objref->record_field);
+		break;
+	}
+	case OVAL_COMPONENT_VARREF: {
+		struct oval_variable *variable = ((struct oval_component_VARREF *)component)->variable;
+
+		if (variable == NULL)
+			return false;
+		_oval_component_key_append(key, oval_variable_get_id(variable));
+		break;
+	}
+	case OVAL_FUNCTION_ARITHMETIC:
+		_oval_component_key_append_int(key, ((struct oval_component_ARITHMETIC *)component)->operation);
+		break;
+	case OVAL_FUNCTION_BEGIN:
+	case OVAL_FUNCTION_END:
+		_oval_component_key_append(key, ((struct oval_component_BEGEND *)component)->character);
+		break;
+	case OVAL_FUNCTION_SPLIT:
+		_oval_component_key_append(key, ((struct oval_component_SPLIT *)component)->delimiter);
+		break;
+	case OVAL_FUNCTION_SUBSTRING:
+		_oval_component_key_append_int(key, ((struct oval_component_SUBSTRING *)component)->start);
+		_oval_component_key_append_int(key, ((struct oval_component_SUBSTRING *)component)->length);
+		break;
+	case OVAL_FUNCTION_TIMEDIF:
+		_oval_component_key_append_int(key, ((struct oval_component_TIMEDIF *)component)->format_1);
+		_oval_component_key_append_int(key, ((struct oval_component_TIMEDIF *)component)->format_2);
+		break;
+	case OVAL_FUNCTION_REGEX_CAPTURE:
+		_oval_component_key_append(key, ((struct oval_component_REGEX_CAPTURE *)component)->pattern);
+		break;
+	case OVAL_FUNCTION_GLOB_TO_REGEX:
+		_oval_component_key_append_int(key, ((struct oval_component_GLOB *)component)->glob_noescape);
+		break;
+	case OVAL_FUNCTION_CONCAT:
+	case OVAL_FUNCTION_ESCAPE_REGEX:
+	case OVAL_FUNCTION_COUNT:
+	case OVAL_FUNCTION_UNIQUE:
+		break;
+	default:
+		return false;
+	}
+
+	if (type > OVAL_FUNCTION) {
+		struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
+
+		while (ret && oval_component_iterator_has_more(subcomps))
+			ret = _oval_component_key(oval_component_iterator_next(subcomps), key);
+		oval_component_iterator_free(subcomps);
+	}
+	oscap_string_append_char(key, ')');
+
+	return ret;
+}
+
+static void _oval_component_result_free(struct oval_component_result *result)
+{
+	oval_collection_free_items(result->values, (oscap_destruct_func) oval_value_free);
+	free(result);
+}
+
+static oval_syschar_collection_flag_t _oval_component_eval_cached(oval_argu_t *argu,
+								   _oval_component_evaluator *evaluator,
+								   struct oval_component *component,
+								   struct oval_collection *value_collection)
+{
+	struct oval_component_cache *cache = argu->cache;
+	struct oval_component_result *result;
+	struct oval_collection *values;
+	struct oval_iterator *val_itr;
+	struct oscap_string *key;
+	oval_syschar_collection_flag_t flag;
+
+	key = oscap_string_new();
+	if (!_oval_component_key(component, key) ||
+	    oval_string_map_get_value(cache->shared, oscap_string_get_cstr(key)) == NULL) {
+		oscap_string_free(key);
+		return (*evaluator) (argu, component, value_collection);
+	}
+
+	pthread_mutex_lock(&cache->lock);
+	++cache->lookups;
+	result = oval_string_map_get_value(cache->results, oscap_string_get_cstr(key));
+	if (result != NULL)
+		++cache->hits;
+	pthread_mutex_unlock(&cache->lock);
+
+	/* the results are left untouched until the cache is freed */
+	if (result != NULL) {
+		dI("Reusing the values of a component evaluated for another variable.");
+		val_itr = oval_collection_iterator(result->values);
+		while (oval_collection_iterator_has_more(val_itr))
+			oval_collection_add(value_collection, oval_value_clone(oval_collection_iterator_next(val_itr)));
+		oval_collection_iterator_free(val_itr);
+		oscap_string_free(key);
+		return result->flag;
+	}
+
+	values = oval_collection_new();
+	flag = (*evaluator) (argu, component, values);
+
+	/* errors are not cached so that they are reported by each variable */
+	result = NULL;
+	if (flag != SYSCHAR_FLAG_ERROR) {
+		result = malloc(sizeof(*result));
+		result->flag = flag;
+		result->values = oval_collection_new();
+	}
+	val_itr = oval_collection_iterator(values);
+	while (oval_collection_iterator_has_more(val_itr)) {
+		struct oval_value *value = oval_collection_iterator_next(val_itr);
+
+		if (result != NULL)
+			oval_collection_add(result->values, oval_value_clone(value));
+		oval_collection_add(value_collection, value);
+	}
+	oval_collection_iterator_free(val_itr);
+	oval_collection_free(values);
+
+	if (result != NULL) {
+		pthread_mutex_lock(&cache->lock);
+		if (oval_string_map_get_value(cache->results, oscap_string_get_cstr(key)) == NULL) {
+			oval_string_map_put(cache->results, oscap_string_get_cstr(key), result);
+			result = NULL;
+		}
+		pthread_mutex_unlock(&cache->lock);
+		/* evaluated by another thread meanwhile */
+		if (result != NULL)
+			_oval_component_result_free(result);
+	}
+
+	oscap_string_free(key);
+	return flag;
+}
+
 static oval_syschar_collection_flag_t oval_component_eval_common(oval_argu_t *argu,
 								 struct oval_component *component,
 								 struct oval_collection *value_collection)
@@ -2459,21 +2791,87 @@ static oval_syschar_collection_flag_t oval_component_eval_common(oval_argu_t *ar
 	    ? _component_evaluators[evidx] : NULL;
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_ERROR;
 	if (evaluator) {
-		flag = (*evaluator) (argu, component, value_collection);
+		if (argu->cache != NULL && (type == OVAL_COMPONENT_OBJECTREF || type > OVAL_FUNCTION))
+			flag = _oval_component_eval_cached(argu, evaluator, component, value_collection);
+		else
+			flag = (*evaluator) (argu, component, value_collection);
 	} else {
 		oscap_seterr(OSCAP_EFAMILY_OVAL, "Component type %d not supported.", type);
 	}
 	return flag;
 }
 
+struct oval_component_cache *oval_component_cache_new(void)
+{
+	struct oval_component_cache *cache = malloc(sizeof(*cache));
+
+	pthread_mutex_init(&cache->lock, NULL);
+	cache->components = oval_string_map_new();
+	cache->shared = oval_string_map_new();
+	cache->results = oval_string_map_new();
+	cache->lookups = 0;
+	cache->hits = 0;
+
+	return cache;
+}
+
+void oval_component_cache_free(struct oval_component_cache *cache)
+{
+	if (cache == NULL)
+		return;
+
+	if (cache->lookups > 0) {
+		dI("Component values reused by other variables: %zu of %zu (%.1f%%).",
+		   cache->hits, cache->lookups, 100.0 * cache->hits / cache->lookups);
+	}
+	oval_string_map_free(cache->components, NULL);
+	oval_string_map_free(cache->shared, NULL);
+	oval_string_map_free(cache->results, (oscap_destruct_func) _oval_component_result_free);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+}
+
+void oval_component_cache_add(struct oval_component_cache *cache, struct oval_component *component)
+{
+	oval_component_type_t type = component->type;
+
+	if (type == OVAL_COMPONENT_OBJECTREF || type > OVAL_FUNCTION) {
+		struct oscap_string *key = oscap_string_new();
+		bool seen = false;
+
+		if (_oval_component_key(component, key)) {
+			const char *str = oscap_string_get_cstr(key);
+
+			seen = (oval_string_map_get_value(cache->components, str) != NULL);
+			if (!seen)
+				oval_string_map_put(cache->components, str, component);
+			else if (oval_string_map_get_value(cache->shared, str) == NULL)
+				oval_string_map_put(cache->shared, str, component);
+		}
+		oscap_string_free(key);
+		/* the subcomponents of a shared component are evaluated only once */
+		if (seen)
+			return;
+	}
+	if (type > OVAL_FUNCTION) {
+		struct oval_component_iterator *subcomps = oval_component_get_function_components(component);
+
+		while (oval_component_iterator_has_more(subcomps))
+			oval_component_cache_add(cache, oval_component_iterator_next(subcomps));
+		oval_component_iterator_free(subcomps);
+	}
+}
+
 oval_syschar_collection_flag_t oval_component_compute(struct oval_syschar_model *sysmod,
 						      struct oval_component *component,
-						      struct oval_collection *value_collection)
+						      struct oval_collection *value_collection,
+						      struct oval_component_cache *cache)
 {
 	oval_argu_t argu;
 
 	argu.mode = OVAL_MODE_COMPUTE;
 	argu.u.sysmod = sysmod;
+	argu.cache = cache;
 
 	return oval_component_eval_common(&argu, component, value_collection);
 }
@@ -2486,6 +2884,7 @@ oval_syschar_collection_flag_t oval_component_query(oval_probe_session_t *sess,
 
 	argu.mode = OVAL_MODE_QUERY;
 	argu.u.sess = sess;
+	argu.cache = NULL;
 
 	return oval_component_eval_common(&argu, component, value_collection);
 }
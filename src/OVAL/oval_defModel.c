@@ -44,6 +44,7 @@
 # include "oval_probe_impl.h"
 #endif
 #include "common/util.h"
+#include "common/list.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "common/elements.h"
@@ -188,6 +189,18 @@ void oval_definition_model_add_definition(struct oval_definition_model *model, s
 	oval_string_map_put(model->definition_map, key, (void *)definition);
 }
 
+/**
+ * Remove the definition from the model and free it. The definition must not be
+ * extended by any other definition of the model.
+ */
+void oval_definition_model_remove_definition(struct oval_definition_model *model, const char *id)
+{
+	__attribute__nonnull__(model);
+	struct oval_definition *definition = oval_string_map_remove(model->definition_map, id);
+	if (definition != NULL)
+		oval_definition_free(definition);
+}
+
 void oval_definition_model_set_schema(struct oval_definition_model *model, const char *version)
 {
 	__attribute__nonnull__(model);
@@ -252,6 +265,188 @@ struct oval_definition_model *oval_definition_model_import_source(struct oscap_s
 	return model;
 }
 
+struct oval_definition_stream {
+	struct oscap_source *source;
+	struct oval_parser_context context;	///< reader of the <definitions> element and the model
+	int depth;				///< depth of the <definitions> element
+	bool done;				///< all definitions have been read
+	struct oval_string_map *extended;	///< ids of definitions extended by other definitions
+	struct oval_string_map *parsed;		///< ids of extended definitions read so far
+	struct oscap_list *deferred;		///< ids of definitions read before the definitions they extend
+	struct oscap_iterator *deferred_it;
+};
+
+struct oval_definition_stream *oval_definition_stream_new(struct oval_definition_model *model, struct oscap_source *source)
+{
+	struct oval_parser_context context;
+	context.reader = oscap_source_get_streaming_xmlTextReader(source);
+	if (context.reader == NULL) {
+		return NULL;
+	}
+	context.definition_model = model;
+	context.user_data = NULL;
+
+	struct oval_definition_stream *stream = calloc(1, sizeof(struct oval_definition_stream));
+	stream->source = source;
+	stream->context = context;
+	stream->extended = oval_string_map_new();
+	stream->parsed = oval_string_map_new();
+	stream->deferred = oscap_list_new();
+
+	/* everything except the definitions, they are read one by one later */
+	while (xmlTextReaderRead(context.reader) == 1
+		&& xmlTextReaderNodeType(context.reader) != XML_READER_TYPE_ELEMENT) ;
+	int ret = oval_definition_model_parse_without_definitions(context.reader, &context, stream->extended);
+	xmlFreeTextReader(context.reader);
+	stream->context.reader = NULL;
+	if (ret == -1) {
+		oval_definition_stream_free(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+bool oval_definition_stream_is_extended(struct oval_definition_stream *stream, const char *id)
+{
+	return oval_string_map_get_value(stream->extended, id) != NULL;
+}
+
+static bool _oval_definition_stream_extends_unread(struct oval_definition_stream *stream,
+		struct oval_criteria_node *node, struct oval_string_map *visited)
+{
+	if (node == NULL)
+		return false;
+
+	bool unread = false;
+	switch (oval_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERIA: {
+		struct oval_criteria_node_iterator *subnodes = oval_criteria_node_get_subnodes(node);
+		while (!unread && oval_criteria_node_iterator_has_more(subnodes))
+			unread = _oval_definition_stream_extends_unread(stream, oval_criteria_node_iterator_next(subnodes), visited);
+		oval_criteria_node_iterator_free(subnodes);
+		break;
+	}
+	case OVAL_NODETYPE_EXTENDDEF: {
+		struct oval_definition *extended = oval_criteria_node_get_definition(node);
+		const char *id = extended ? oval_definition_get_id(extended) : NULL;
+		if (id == NULL || oval_string_map_get_value(visited, id) != NULL)
+			break;
+		if (oval_string_map_get_value(stream->parsed, id) == NULL)
+			return true;
+		oval_string_map_put(visited, id, extended);
+		unread = _oval_definition_stream_extends_unread(stream, oval_definition_get_criteria(extended), visited);
+		break;
+	}
+	default:
+		break;
+	}
+	return unread;
+}
+
+/**
+ * Parse the next definition of the <definitions> element.
+ * -1 error; 0 no more definitions; 1 a definition ready to be evaluated
+ */
+static int _oval_definition_stream_read(struct oval_definition_stream *stream, struct oval_definition **definition)
+{
+	xmlTextReaderPtr reader = stream->context.reader;
+	int ret;
+
+	if (reader == NULL) {
+		reader = stream->context.reader = oscap_source_get_streaming_xmlTextReader(stream->source);
+		if (reader == NULL)
+			return -1;
+		/* find the <definitions> element */
+		while ((ret = xmlTextReaderRead(reader)) == 1) {
+			if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT && xmlTextReaderDepth(reader) == 1
+			    && oscap_streq((const char *) xmlTextReaderConstLocalName(reader), "definitions")
+			    && oscap_streq((const char *) xmlTextReaderConstNamespaceUri(reader), (const char *) OVAL_DEFINITIONS_NAMESPACE))
+				break;
+		}
+		if (ret != 1)
+			return (ret == 0) ? 0 : -1;
+		stream->depth = xmlTextReaderDepth(reader);
+		if (xmlTextReaderIsEmptyElement(reader))
+			return 0;
+	}
+
+	while ((ret = xmlTextReaderRead(reader)) == 1 && xmlTextReaderDepth(reader) > stream->depth) {
+		if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT)
+			continue;
+
+		char *id = (char *) xmlTextReaderGetAttribute(reader, BAD_CAST "id");
+		if (oval_definition_parse_tag(reader, &stream->context, NULL) == -1) {
+			free(id);
+			return -1;
+		}
+		*definition = oval_definition_model_get_definition(stream->context.definition_model, id);
+		if (*definition == NULL) {
+			free(id);
+			continue;
+		}
+		if (oval_definition_stream_is_extended(stream, id))
+			oval_string_map_put_string(stream->parsed, id, id);
+
+		/* the definitions it extends follow, wait for them */
+		struct oval_string_map *visited = oval_string_map_new();
+		bool unread = _oval_definition_stream_extends_unread(stream, oval_definition_get_criteria(*definition), visited);
+		oval_string_map_free(visited, NULL);
+		if (unread) {
+			oscap_list_add(stream->deferred, id);
+			*definition = NULL;
+			continue;
+		}
+		free(id);
+		return 1;
+	}
+	return (ret == -1) ? -1 : 0;
+}
+
+int oval_definition_stream_next(struct oval_definition_stream *stream, struct oval_definition **definition)
+{
+	*definition = NULL;
+	if (!stream->done) {
+		int ret = _oval_definition_stream_read(stream, definition);
+		if (ret != 0)
+			return ret;
+		stream->done = true;
+		xmlFreeTextReader(stream->context.reader);
+		stream->context.reader = NULL;
+		stream->deferred_it = oscap_iterator_new(stream->deferred);
+	}
+
+	while (oscap_iterator_has_more(stream->deferred_it)) {
+		const char *id = oscap_iterator_next(stream->deferred_it);
+		*definition = oval_definition_model_get_definition(stream->context.definition_model, id);
+		if (*definition != NULL)
+			return 1;
+	}
+	return 0;
+}
+
+int oval_definition_stream_read_all(struct oval_definition_stream *stream)
+{
+	struct oval_definition *definition;
+	int ret;
+
+	while ((ret = oval_definition_stream_next(stream, &definition)) == 1) ;
+	return ret;
+}
+
+void oval_definition_stream_free(struct oval_definition_stream *stream)
+{
+	if (stream == NULL)
+		return;
+	if (stream->context.reader != NULL)
+		xmlFreeTextReader(stream->context.reader);
+	if (stream->deferred_it != NULL)
+		oscap_iterator_free(stream->deferred_it);
+	oscap_list_free(stream->deferred, free);
+	oval_string_map_free_string(stream->extended);
+	oval_string_map_free_string(stream->parsed);
+	free(stream);
+}
+
 struct oval_definition *oval_definition_model_get_definition(struct oval_definition_model *model, const char *key)
 {
 	__attribute__nonnull__(model);
@@ -564,6 +759,18 @@ int oval_definition_model_export(struct oval_definition_model *model, const char
 	return oscap_xml_save_filename_free(file, doc);
 }
 
+static bool _fp_set_has_filters(struct oval_setobject *set)
+{
+	struct oval_filter_iterator *filter_itr;
+	bool ret;
+
+	filter_itr = oval_setobject_get_filters(set);
+	ret = oval_filter_iterator_has_more(filter_itr);
+	oval_filter_iterator_free(filter_itr);
+
+	return ret;
+}
+
 static void _fp_set_recurse(struct oval_definition_model *model, struct oval_setobject *set, char *set_id)
 {
 	struct oval_setobject_iterator *subset_itr;
@@ -573,10 +780,17 @@ static void _fp_set_recurse(struct oval_definition_model *model, struct oval_set
 		struct oval_setobject *subset;
 
 		subset = oval_setobject_iterator_next(subset_itr);
-		if (oval_setobject_get_type(subset) == OVAL_SET_COLLECTIVE)
-			oval_set_propagate_filters(model, subset, set_id);
-		else
+		if (oval_setobject_get_type(subset) == OVAL_SET_COLLECTIVE) {
+			/*
+			 * Without filters the internal objects would be just copies
+			 * of the referenced ones, keep the references so that the
+			 * results can be shared with other sets
+			 */
+			if (_fp_set_has_filters(subset))
+				oval_set_propagate_filters(model, subset, set_id);
+		} else {
 			_fp_set_recurse(model, subset, set_id);
+		}
 	}
 	oval_setobject_iterator_free(subset_itr);
 }
@@ -595,7 +809,6 @@ void oval_definition_model_optimize_by_filter_propagation(struct oval_definition
 		struct oval_object_content_iterator *cont_itr;
 		struct oval_object_content *cont;
 		struct oval_setobject *set;
-		struct oval_filter_iterator *filter_itr;
 
 		obj = oval_object_iterator_next(obj_itr);
 		obj_id = oval_object_get_id(obj);
@@ -621,12 +834,8 @@ void oval_definition_model_optimize_by_filter_propagation(struct oval_definition
 			continue;
 		}
 
-		filter_itr = oval_setobject_get_filters(set);
-		if (!oval_filter_iterator_has_more(filter_itr)) {
-			oval_filter_iterator_free(filter_itr);
+		if (!_fp_set_has_filters(set))
 			continue;
-		}
-		oval_filter_iterator_free(filter_itr);
 
 		oval_set_propagate_filters(model, set, obj_id);
 	}
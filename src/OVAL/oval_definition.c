@@ -238,6 +238,28 @@ void oval_definition_free(struct oval_definition *definition)
 	free(definition);
 }
 
+void oval_definition_strip(struct oval_definition *definition)
+{
+	__attribute__nonnull__(definition);
+
+	free(definition->title);
+	free(definition->description);
+	if (definition->criteria != NULL)
+		oval_criteria_node_free(definition->criteria);
+	oval_collection_free_items(definition->affected, (oscap_destruct_func) oval_affected_free);
+	oval_collection_free_items(definition->reference, (oscap_destruct_func) oval_reference_free);
+	oval_collection_free_items(definition->notes, (oscap_destruct_func) free);
+	free(definition->anyxml);
+
+	definition->title = NULL;
+	definition->description = NULL;
+	definition->criteria = NULL;
+	definition->affected = oval_collection_new();
+	definition->reference = oval_collection_new();
+	definition->notes = oval_collection_new();
+	definition->anyxml = NULL;
+}
+
 bool oval_definition_iterator_has_more(struct oval_definition_iterator
 				       *oc_definition)
 {
@@ -86,6 +86,10 @@ int oval_reference_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, ova
 
 int oval_definition_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_definition_to_dom(struct oval_definition *, xmlDoc *, xmlNode *);
+/**
+ * Free everything but the id, version, class and deprecation of a definition.
+ */
+void oval_definition_strip(struct oval_definition *);
 
 int oval_object_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_object_to_dom(struct oval_object *, xmlDoc *, xmlNode *);
@@ -137,9 +141,25 @@ typedef void (*oval_value_consumer) (struct oval_value *, void *);
 int oval_value_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_value_consumer, void *);
 xmlNode *oval_value_to_dom(struct oval_value *, xmlDoc *, xmlNode *);
 int oval_value_cast(struct oval_value *value, oval_datatype_t new_dt);
+/**
+ * Get the value parsed according to its data type, it's parsed by the first
+ * call and kept with the value for the next comparisons.
+ */
+struct oval_cmp_datum *oval_value_get_cmp_datum(struct oval_value *value);
+
+/**
+ * Cache of the values of components shared by several variables computed
+ * together. It can be used by several threads computing variables at once.
+ */
+struct oval_component_cache;
+struct oval_component_cache *oval_component_cache_new(void);
+void oval_component_cache_free(struct oval_component_cache *cache);
+/* register a component of a variable which is going to be computed with the cache */
+void oval_component_cache_add(struct oval_component_cache *cache, struct oval_component *component);
 
 oval_syschar_collection_flag_t oval_component_compute(struct oval_syschar_model *sysmod, struct oval_component *component,
-						      struct oval_collection *value_collection);
+						      struct oval_collection *value_collection,
+						      struct oval_component_cache *cache);
 #if defined(OVAL_PROBES_ENABLED)
 oval_syschar_collection_flag_t oval_component_query(oval_probe_session_t *sess, struct oval_component *component,
 						    struct oval_collection *value_collection);
@@ -170,6 +190,26 @@ struct oval_object     *oval_definition_model_get_new_object(struct oval_definit
 struct oval_state      *oval_definition_model_get_new_state(struct oval_definition_model *, const char *);
 struct oval_variable   *oval_definition_model_get_new_variable(struct oval_definition_model *, const char *, oval_variable_type_t type);
 void oval_definition_model_add_definition(struct oval_definition_model *, struct oval_definition *);
+void oval_definition_model_remove_definition(struct oval_definition_model *, const char *);
+
+/**
+ * Definitions of a model read one by one from an OVAL Definitions document.
+ * The other parts of the document are parsed into the model right away.
+ */
+struct oval_definition_stream;
+struct oval_definition_stream *oval_definition_stream_new(struct oval_definition_model *, struct oscap_source *);
+/**
+ * Parse the next definition into the model. Definitions read before the
+ * definitions they extend are returned after all the others.
+ * -1 error; 0 no more definitions; 1 definition returned
+ */
+int oval_definition_stream_next(struct oval_definition_stream *, struct oval_definition **);
+int oval_definition_stream_read_all(struct oval_definition_stream *);
+/**
+ * Whether the definition is extended by another definition of the document.
+ */
+bool oval_definition_stream_is_extended(struct oval_definition_stream *, const char *);
+void oval_definition_stream_free(struct oval_definition_stream *);
 void oval_definition_model_add_test(struct oval_definition_model *, struct oval_test *);
 void oval_definition_model_add_object(struct oval_definition_model *, struct oval_object *);
 void oval_definition_model_add_state(struct oval_definition_model *, struct oval_state *);
@@ -187,5 +227,17 @@ struct oval_string_iterator *oval_definition_model_get_definitions_dependent_on_
 struct oval_collection *oval_variable_model_get_values_ref(struct oval_variable_model *, char *);
 int oval_variable_bind_ext_var(struct oval_variable *, struct oval_variable_model *, char *);
 bool oval_variable_contains_value(struct oval_variable *variable, const char* o_value_text);
+/**
+ * Walk the values of the variable without allocating an iterator, in the
+ * reverse order of their addition. *pos is NULL at the start.
+ */
+bool oval_variable_walk_values(struct oval_variable *variable, void **pos, struct oval_value **value);
+/**
+ * Compute the local variables of the map which have not been computed yet
+ * from the collected objects of the system characteristics model, together
+ * with the variables they depend on. The variables whose dependencies are
+ * computed are computed in parallel, level by level of the dependency graph.
+ */
+void oval_syschar_model_compute_variables(struct oval_syschar_model *sysmod, struct oval_string_map *variables);
 
 #endif
@@ -136,7 +136,31 @@ char *oval_determine_document_schema_version_priv(xmlTextReader *reader, oscap_d
 /*
  * -1 error; 0 OK; 1 warning
  */
-int oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_context *context)
+/**
+ * Read through the <definitions> element and collect the ids of the
+ * definitions referred to by <extend_definition> without parsing anything.
+ * -1 error; 0 OK
+ */
+static int _oval_parser_scan_extended_definitions(xmlTextReaderPtr reader, struct oval_string_map *extended)
+{
+	int depth = xmlTextReaderDepth(reader);
+	int ret;
+
+	while ((ret = xmlTextReaderRead(reader)) == 1 && xmlTextReaderDepth(reader) > depth) {
+		if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT
+		    || !oscap_streq((const char *) xmlTextReaderConstLocalName(reader), "extend_definition"))
+			continue;
+
+		char *definition_ref = (char *) xmlTextReaderGetAttribute(reader, BAD_CAST "definition_ref");
+		if (definition_ref != NULL && oval_string_map_get_value(extended, definition_ref) == NULL)
+			oval_string_map_put_string(extended, definition_ref, definition_ref);
+		free(definition_ref);
+	}
+
+	return (ret == 1) ? 0 : -1;
+}
+
+static int _oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_context *context, struct oval_string_map *extended)
 {
 	const char *tagname_generator = "generator";
 	const char *tagname_definitions = "definitions";
@@ -156,7 +180,10 @@ int oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_cont
 
 			int is_oval = strcmp((const char *)OVAL_DEFINITIONS_NAMESPACE, namespace) == 0;
 			if (is_oval && (strcmp(tagname, tagname_definitions) == 0)) {
-				ret = oval_parser_parse_tag(reader, context, &oval_definition_parse_tag, NULL);
+				if (extended == NULL)
+					ret = oval_parser_parse_tag(reader, context, &oval_definition_parse_tag, NULL);
+				else
+					ret = _oval_parser_scan_extended_definitions(reader, extended);
 			} else if (is_oval && strcmp(tagname, tagname_tests) == 0) {
 				ret = oval_parser_parse_tag(reader, context, &oval_test_parse_tag, NULL);
 			} else if (is_oval && strcmp(tagname, tagname_objects) == 0) {
@@ -187,6 +214,16 @@ int oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_cont
 	return ret;
 }
 
+int oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_context *context)
+{
+	return _oval_definition_model_parse(reader, context, NULL);
+}
+
+int oval_definition_model_parse_without_definitions(xmlTextReaderPtr reader, struct oval_parser_context *context, struct oval_string_map *extended)
+{
+	return _oval_definition_model_parse(reader, context, extended);
+}
+
 /* -1 error; 0 OK */
 int oval_parser_skip_tag(xmlTextReaderPtr reader, struct oval_parser_context *context)
 {
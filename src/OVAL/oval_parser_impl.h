@@ -41,6 +41,8 @@
 #define OVAL_ROOT_ELM_SYSCHARS "oval_system_characteristics"
 #define OVAL_ROOT_ELM_VARIABLES "oval_variables"
 
+struct oval_string_map;
+
 struct oval_parser_context {
 	struct oval_definition_model *definition_model;
 	struct oval_syschar_model *syschar_model;
@@ -52,6 +54,11 @@ struct oval_parser_context {
 };
 
 int oval_definition_model_parse(xmlTextReaderPtr, struct oval_parser_context *);
+/**
+ * Parse the document like oval_definition_model_parse, but only collect ids
+ * of the extended definitions into the map instead of parsing the definitions.
+ */
+int oval_definition_model_parse_without_definitions(xmlTextReaderPtr, struct oval_parser_context *, struct oval_string_map *extended);
 int oval_syschar_model_parse(xmlTextReaderPtr, struct oval_parser_context *);
 int oval_results_model_parse(xmlTextReaderPtr , struct oval_parser_context *);
 
@@ -38,9 +38,12 @@
 #include "common/util.h"
 #include "common/_error.h"
 #include "common/oscapxml.h"
+#include "source/oscap_source_priv.h"
 #include "source/xslt_priv.h"
 #include "public/oval_agent_api.h"
 #include "public/oval_session.h"
+#include "oval_definitions_impl.h"
+#include "results/oval_results_impl.h"
 #include "../DS/public/ds_sds_session.h"
 #include "oscap_source.h"
 #include "oscap_helpers.h"
@@ -55,6 +58,10 @@ struct oval_session {
 	struct oval_definition_model *def_model;
 	struct oval_variable_model *var_model;
 	struct oval_results_model *res_model;
+	/* definitions not read yet when streaming */
+	struct oval_definition_stream *def_stream;
+	/* the definitions were stripped after their evaluation when streaming */
+	bool definitions_stripped;
 
 	oval_agent_session_t *sess;
 	struct ds_sds_session *sds_session;
@@ -80,6 +87,8 @@ struct oval_session {
 	} reporter;
 
 	bool validation;
+	bool streaming;
+	bool short_circuit;
 	bool export_sys_chars;
 	bool full_validation;
 	bool fetch_remote_resources;
@@ -184,6 +193,20 @@ void oval_session_set_xml_reporter(struct oval_session *session, xml_reporter fn
 	session->reporter.xml_fn = fn;
 }
 
+void oval_session_set_streaming(struct oval_session *session, bool streaming)
+{
+	__attribute__nonnull__(session);
+
+	session->streaming = streaming;
+}
+
+void oval_session_set_short_circuit(struct oval_session *session, bool short_circuit)
+{
+	__attribute__nonnull__(session);
+
+	session->short_circuit = short_circuit;
+}
+
 static bool oval_session_validate(struct oval_session *session, struct oscap_source *source, oscap_document_type_t type)
 {
 	if (oscap_source_get_scap_type(source) == type) {
@@ -216,6 +239,9 @@ static int oval_session_load_definitions(struct oval_session *session)
 		return 1;
 	}
 	else {
+		/* the definitions are read from the file one by one later */
+		if (session->streaming && type == OSCAP_DOCUMENT_OVAL_DEFINITIONS)
+			oscap_source_set_streaming(session->source, true);
 		if (session->validation && !oval_session_validate(session, session->source, type))
 			return 1;
 	}
@@ -244,7 +270,23 @@ static int oval_session_load_definitions(struct oval_session *session)
 
 	/* import OVAL Definitions */
 	if (session->def_model) oval_definition_model_free(session->def_model);
-	session->def_model = oval_definition_model_import_source(session->oval.definitions);
+	oval_definition_stream_free(session->def_stream);
+	session->def_stream = NULL;
+	session->definitions_stripped = false;
+	if (session->streaming) {
+		/* the DOM might have been built for validation before, read the file instead */
+		if (session->oval.definitions == session->source)
+			oscap_source_free_xmlDoc(session->source);
+		session->def_model = oval_definition_model_new();
+		session->def_stream = oval_definition_stream_new(session->def_model, session->oval.definitions);
+		if (session->def_stream == NULL) {
+			oval_definition_model_free(session->def_model);
+			session->def_model = NULL;
+		}
+	}
+	else {
+		session->def_model = oval_definition_model_import_source(session->oval.definitions);
+	}
 	if (session->def_model == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_OVAL, "Failed to import the OVAL Definitions from '%s'.",
 				oscap_source_readable_origin(session->oval.definitions));
@@ -333,6 +375,74 @@ static int oval_session_setup_agent(struct oval_session *session)
 	free(path_clone);
 
 	oval_agent_set_product_name(session->sess, (char *)oscap_productname);
+	struct oval_results_model *res_model = oval_agent_get_results_model(session->sess);
+	if (res_model != NULL)
+		oval_results_model_set_short_circuit(res_model, session->short_circuit);
+	return 0;
+}
+
+/* Read the definitions which haven't been read yet when streaming */
+static int oval_session_read_definitions(struct oval_session *session)
+{
+	if (session->def_stream == NULL)
+		return 0;
+
+	int ret = oval_definition_stream_read_all(session->def_stream);
+	oval_definition_stream_free(session->def_stream);
+	session->def_stream = NULL;
+	if (ret == -1) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Failed to import the OVAL Definitions from '%s'.",
+				oscap_source_readable_origin(session->oval.definitions));
+		return 1;
+	}
+	return 0;
+}
+
+static int oval_session_evaluate_stream(struct oval_session *session, agent_reporter fn, void *arg)
+{
+	struct oval_results_model *res_model = oval_agent_get_results_model(session->sess);
+	struct oval_result_system_iterator *rsystem_it = oval_results_model_get_systems(res_model);
+	struct oval_result_system *rsystem = oval_result_system_iterator_next(rsystem_it);
+	oval_result_system_iterator_free(rsystem_it);
+
+	struct oval_definition *definition;
+	int ret;
+
+	/* only the results are kept for the export, not the definitions */
+	bool keep_results = session->export.results || session->export.report;
+	session->definitions_stripped = keep_results;
+
+	dI("OVAL agent started to evaluate streamed OVAL definitions on your system.");
+	while ((ret = oval_definition_stream_next(session->def_stream, &definition)) == 1) {
+		char *id = oval_definition_get_id(definition);
+
+		if (oval_agent_eval_definition(session->sess, id) == -1)
+			return 1;
+
+		if (fn != NULL) {
+			struct oval_result_definition *res_def = oval_agent_get_result_definition(session->sess, id);
+			if (fn(res_def, arg) != 0)
+				break;
+		}
+
+		/* the collected objects stay, only definitions which are extended
+		 * by other definitions are needed later */
+		if (!oval_definition_stream_is_extended(session->def_stream, id)) {
+			if (keep_results) {
+				oval_definition_strip(definition);
+			} else {
+				oval_result_system_remove_definition(rsystem, id);
+				oval_definition_model_remove_definition(session->def_model, id);
+			}
+		}
+	}
+
+	if (ret == -1) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Failed to import the OVAL Definitions from '%s'.",
+				oscap_source_readable_origin(session->oval.definitions));
+		return 1;
+	}
+	dI("OVAL agent finished evaluation.");
 	return 0;
 }
 
@@ -345,6 +455,10 @@ int oval_session_evaluate_id(struct oval_session *session, const char *id, oval_
 		return 1;
 	}
 
+	if (oval_session_read_definitions(session) != 0) {
+		return 1;
+	}
+
 	if (oval_session_setup_agent(session) != 0) {
 		return 1;
 	}
@@ -369,7 +483,14 @@ int oval_session_evaluate(struct oval_session *session, agent_reporter fn, void
 		return 1;
 	}
 
-	oval_agent_eval_system(session->sess, fn, arg);
+	if (session->def_stream != NULL) {
+		if (oval_session_evaluate_stream(session, fn, arg) != 0) {
+			return 1;
+		}
+	}
+	else {
+		oval_agent_eval_system(session->sess, fn, arg);
+	}
 	if (oscap_err()) {
 		return 1;
 	}
@@ -402,6 +523,12 @@ int oval_session_export(struct oval_session *session)
 	/* Get OVAL Results if evaluation or analyse has been done and apply
 	 * directives to them */
 	if (session->res_model && (session->export.results || session->export.report)) {
+		/* the source definitions were stripped while streaming */
+		if (session->definitions_stripped) {
+			struct oval_directives_model *dirs = dir_model ? dir_model
+				: oval_results_model_get_directives_model(session->res_model);
+			oval_result_directives_set_included(oval_directives_model_get_defdirs(dirs), false);
+		}
 		oval_results_model_set_export_system_characteristics(session->res_model, session->export_sys_chars);
 		result = oval_results_model_export_source(session->res_model, dir_model, NULL);
 		filename = session->export.results;
@@ -480,6 +607,7 @@ void oval_session_free(struct oval_session *session)
 		oval_agent_destroy_session(session->sess);
 	if (session->def_model)
 		oval_definition_model_free(session->def_model);
+	oval_definition_stream_free(session->def_stream);
 	ds_sds_session_free(session->sds_session);
 	free(session);
 }
@@ -44,6 +44,7 @@
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
+#include "results/oval_cmp_impl.h"
 
 typedef struct oval_sysent {
 	struct oval_syschar_model *model;
@@ -53,6 +54,7 @@ typedef struct oval_sysent {
 	int mask;
 	oval_datatype_t datatype;
 	oval_syschar_status_t status;
+	struct oval_cmp_datum *cmp_datum;	///< the value parsed for the comparisons
 } oval_sysent_t;
 
 struct oval_sysent *oval_sysent_new(struct oval_syschar_model *model)
@@ -68,6 +70,7 @@ struct oval_sysent *oval_sysent_new(struct oval_syschar_model *model)
 	sysent->datatype = OVAL_DATATYPE_UNKNOWN;
 	sysent->mask = 0;
 	sysent->model = model;
+	sysent->cmp_datum = NULL;
 	return sysent;
 }
 
@@ -103,6 +106,7 @@ void oval_sysent_free(struct oval_sysent *sysent)
 		free(sysent->value);
 	if (sysent->record_fields)
 		oval_collection_free_items(sysent->record_fields, (oscap_destruct_func) oval_record_field_free);
+	oval_cmp_datum_free(sysent->cmp_datum);
 
 	sysent->name = NULL;
 	sysent->value = NULL;
@@ -203,6 +207,24 @@ void oval_sysent_set_value(struct oval_sysent *sysent, char *value)
 	if (sysent->value != NULL)
 		free(sysent->value);
 	sysent->value = oscap_strdup(value);
+	oval_cmp_datum_free(sysent->cmp_datum);
+	sysent->cmp_datum = NULL;
+}
+
+struct oval_cmp_datum *oval_sysent_get_cmp_datum(struct oval_sysent *sysent, oval_datatype_t datatype)
+{
+	__attribute__nonnull__(sysent);
+
+	if (!oval_cmp_datatype_is_parsed(datatype))
+		return NULL;
+	/* the entity is compared to states of different data types */
+	if (sysent->cmp_datum != NULL && sysent->cmp_datum->datatype != datatype) {
+		oval_cmp_datum_free(sysent->cmp_datum);
+		sysent->cmp_datum = NULL;
+	}
+	if (sysent->cmp_datum == NULL)
+		sysent->cmp_datum = oval_cmp_datum_new(sysent->value, datatype);
+	return sysent->cmp_datum;
 }
 
 void oval_sysent_add_record_field(struct oval_sysent *sysent, struct oval_record_field *rf)
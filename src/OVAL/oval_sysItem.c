@@ -170,6 +170,12 @@ struct oval_sysent_iterator *oval_sysitem_get_sysents(struct oval_sysitem *sysit
 	return (struct oval_sysent_iterator *)oval_collection_iterator(sysitem->sysents);
 }
 
+bool oval_sysitem_walk_sysents(struct oval_sysitem *sysitem, void **pos, struct oval_sysent **sysent)
+{
+	__attribute__nonnull__(sysitem);
+	return oval_collection_walk(sysitem->sysents, pos, (void **) sysent);
+}
+
 void oval_sysitem_add_sysent(struct oval_sysitem *sysitem, struct oval_sysent *sysent)
 {
 	__attribute__nonnull__(sysitem);
@@ -49,6 +49,11 @@ int oval_sysinfo_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *
 /* sysitem */
 void oval_sysitem_to_dom(struct oval_sysitem *, xmlDoc *, xmlNode *);
 int oval_sysitem_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, void *usr);
+/**
+ * Walk the entities of the item without allocating an iterator, in the
+ * reverse order of their addition. *pos is NULL at the start.
+ */
+bool oval_sysitem_walk_sysents(struct oval_sysitem *, void **pos, struct oval_sysent **sysent);
 
 /* syschar */
 void oval_syschar_to_dom(struct oval_syschar *, xmlDoc *, xmlNode *);
@@ -62,6 +67,13 @@ typedef void (*oval_sysent_consumer) (struct oval_sysent *, void *client);
 int oval_sysent_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_sysent_consumer, void *);
 void oval_sysent_to_dom(struct oval_sysent *sysent, xmlDoc * doc, xmlNode * tag_parent);
 void oval_sysent_to_print(struct oval_sysent *, char *, int);
+/**
+ * Get the value of the entity parsed as the given data type to be compared
+ * to a state, it's kept with the entity for the next comparisons.
+ * @returns NULL when the values of the data type aren't parsed, see
+ * oval_cmp_datatype_is_parsed()
+ */
+struct oval_cmp_datum *oval_sysent_get_cmp_datum(struct oval_sysent *sysent, oval_datatype_t datatype);
 
 /* syschar_model */
 typedef bool oval_syschar_resolver(struct oval_syschar *, void *);
@@ -41,10 +41,12 @@
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
+#include "results/oval_cmp_impl.h"
 
 typedef struct oval_value {
 	oval_datatype_t datatype;
 	char *text;
+	struct oval_cmp_datum *cmp_datum;	///< the text parsed for the comparisons
 } oval_value_t;
 
 bool oval_value_iterator_has_more(struct oval_value_iterator *oc_value)
@@ -124,6 +126,7 @@ struct oval_value *oval_value_new(oval_datatype_t datatype, char *text_value)
 
 	value->datatype = datatype;
 	value->text = oscap_strdup(text_value);
+	value->cmp_datum = NULL;
 	return value;
 }
 
@@ -141,6 +144,7 @@ void oval_value_free(struct oval_value *value)
     if (value == NULL)
         return;
 
+    oval_cmp_datum_free(value->cmp_datum);
     free(value->text);
     free(value);
 }
@@ -163,6 +167,20 @@ void oval_value_set_datatype(struct oval_value *value, oval_datatype_t datatype)
 	value->datatype = datatype;
 }
 
+struct oval_cmp_datum *oval_value_get_cmp_datum(struct oval_value *value)
+{
+	__attribute__nonnull__(value);
+
+	/* the data type may have been changed by a cast */
+	if (value->cmp_datum != NULL && value->cmp_datum->datatype != value->datatype) {
+		oval_cmp_datum_free(value->cmp_datum);
+		value->cmp_datum = NULL;
+	}
+	if (value->cmp_datum == NULL)
+		value->cmp_datum = oval_cmp_datum_new(value->text, value->datatype);
+	return value->cmp_datum;
+}
+
 /*
 void oval_value_set_text(struct oval_value *value, char *text)
 {
@@ -38,11 +38,13 @@
 #include "oval_definitions_impl.h"
 #include "adt/oval_collection_impl.h"
 #include "adt/oval_string_map_impl.h"
+#include "collectVarRefs_impl.h"
 #include "oval_agent_api_impl.h"
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "common/oscap_string.h"
+#include "common/oscap_parallel.h"
 #include "results/oval_cmp_impl.h"
 #include "results/oval_results_impl.h"
 #include "public/oval_probe.h"
@@ -339,12 +341,10 @@ oval_datatype_t oval_variable_get_datatype(struct oval_variable * variable)
 	return variable->datatype;
 }
 
-struct oval_value_iterator *oval_variable_get_values(struct oval_variable *variable)
+static struct oval_collection *_oval_variable_values(struct oval_variable *variable)
 {
 	struct oval_collection *values;
 
-	__attribute__nonnull__(variable);
-
 	switch (variable->type) {
 	case OVAL_VARIABLE_EXTERNAL: {
 		oval_variable_EXTERNAL_t *var = (oval_variable_EXTERNAL_t *) variable;
@@ -368,11 +368,30 @@ struct oval_value_iterator *oval_variable_get_values(struct oval_variable *varia
 		values = NULL;
 		break;
 	}
+	return values;
+}
+
+struct oval_value_iterator *oval_variable_get_values(struct oval_variable *variable)
+{
+	struct oval_collection *values;
 
+	__attribute__nonnull__(variable);
+
+	values = _oval_variable_values(variable);
 	return (values) ? (struct oval_value_iterator *) oval_collection_iterator(values) : 
 		(struct oval_value_iterator *) oval_collection_iterator_new();
 }
 
+bool oval_variable_walk_values(struct oval_variable *variable, void **pos, struct oval_value **value)
+{
+	struct oval_collection *values;
+
+	__attribute__nonnull__(variable);
+
+	values = _oval_variable_values(variable);
+	return (values) ? oval_collection_walk(values, pos, (void **) value) : false;
+}
+
 struct oval_variable_possible_value_iterator *oval_variable_get_possible_values2(struct oval_variable *variable)
 {
 	if (variable->type == OVAL_VARIABLE_EXTERNAL) {
@@ -414,13 +433,11 @@ oval_syschar_collection_flag_t oval_variable_get_collection_flag(struct oval_var
 	return variable->flag;
 }
 
-int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struct oval_variable *variable)
+static int _oval_variable_compute(struct oval_syschar_model *sysmod, struct oval_variable *variable,
+				  struct oval_component_cache *cache)
 {
 	oval_variable_LOCAL_t *var;
 	struct oval_component *component;
-	struct oval_value_iterator *val_itr;
-
-	__attribute__nonnull__(variable);
 
 	if (variable->type != OVAL_VARIABLE_LOCAL)
 		return 0;
@@ -433,7 +450,7 @@ int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struc
         if (component) {
 		if (!var->values)
 			var->values = oval_collection_new();
-		var->flag = oval_component_compute(sysmod, component, var->values);
+		var->flag = oval_component_compute(sysmod, component, var->values, cache);
 	} else {
 		dW("NULL component bound to a variable, id: %s.", var->id);
 		return -1;
@@ -447,14 +464,154 @@ int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struc
 		return 0;
 	}
 
-	val_itr = oval_variable_get_values(variable);
-	if (!oval_value_iterator_has_more(val_itr))
+	if (oval_collection_is_empty(var->values))
 		var->flag = SYSCHAR_FLAG_ERROR;
-	oval_value_iterator_free(val_itr);
 
         return 0;
 }
 
+int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struct oval_variable *variable)
+{
+	__attribute__nonnull__(variable);
+
+	return _oval_variable_compute(sysmod, variable, NULL);
+}
+
+/* levels of the variables which are not computed by the scheduler */
+#define OVAL_VARIABLE_LEVEL_DONE     -1
+#define OVAL_VARIABLE_LEVEL_VISITING -2
+#define OVAL_VARIABLE_LEVEL_CYCLE    -3
+
+struct oval_variable_node {
+	struct oval_variable *variable;
+	int level;
+};
+
+struct oval_variable_schedule {
+	struct oval_syschar_model *sysmod;
+	struct oval_component_cache *cache;
+	struct oval_variable **variables;
+};
+
+/*
+ * Get the level of the variable in the dependency graph, ie. the length of
+ * the longest chain of variables to be computed before it. The variables
+ * depending on a cycle are left to be computed on demand.
+ */
+static int _oval_variable_level(struct oval_variable *variable, struct oval_string_map *nodes, int *max_level)
+{
+	struct oval_variable_node *node;
+	struct oval_string_map *deps;
+	struct oval_iterator *dep_itr;
+	int level;
+
+	if (variable->type != OVAL_VARIABLE_LOCAL || variable->flag != SYSCHAR_FLAG_UNKNOWN)
+		return OVAL_VARIABLE_LEVEL_DONE;
+
+	node = oval_string_map_get_value(nodes, variable->id);
+	if (node != NULL)
+		return (node->level == OVAL_VARIABLE_LEVEL_VISITING) ? OVAL_VARIABLE_LEVEL_CYCLE : node->level;
+
+	node = malloc(sizeof(*node));
+	node->variable = variable;
+	node->level = OVAL_VARIABLE_LEVEL_VISITING;
+	oval_string_map_put(nodes, variable->id, node);
+
+	deps = oval_string_map_new();
+	oval_var_collect_var_deps(variable, deps);
+	level = 0;
+	dep_itr = oval_string_map_values(deps);
+	while (oval_collection_iterator_has_more(dep_itr)) {
+		int dep_level = _oval_variable_level(oval_collection_iterator_next(dep_itr), nodes, max_level);
+
+		if (dep_level == OVAL_VARIABLE_LEVEL_CYCLE)
+			level = OVAL_VARIABLE_LEVEL_CYCLE;
+		else if (level != OVAL_VARIABLE_LEVEL_CYCLE && dep_level >= level)
+			level = dep_level + 1;
+	}
+	oval_collection_iterator_free(dep_itr);
+	oval_string_map_free0(deps);
+
+	node->level = level;
+	if (level > *max_level)
+		*max_level = level;
+	return level;
+}
+
+static void _oval_variable_compute_job(size_t index, void *arg)
+{
+	struct oval_variable_schedule *schedule = arg;
+
+	_oval_variable_compute(schedule->sysmod, schedule->variables[index], schedule->cache);
+}
+
+void oval_syschar_model_compute_variables(struct oval_syschar_model *sysmod, struct oval_string_map *variables)
+{
+	struct oval_string_map *nodes;
+	struct oval_iterator *itr;
+	struct oval_variable_schedule schedule;
+	size_t count, *level_counts;
+	int level, max_level = -1;
+
+	nodes = oval_string_map_new();
+	itr = oval_string_map_values(variables);
+	while (oval_collection_iterator_has_more(itr))
+		_oval_variable_level(oval_collection_iterator_next(itr), nodes, &max_level);
+	oval_collection_iterator_free(itr);
+
+	if (max_level < 0) {
+		oval_string_map_free(nodes, free);
+		return;
+	}
+
+	level_counts = calloc(max_level + 1, sizeof(*level_counts));
+	count = 0;
+	schedule.cache = oval_component_cache_new();
+	itr = oval_string_map_values(nodes);
+	while (oval_collection_iterator_has_more(itr)) {
+		struct oval_variable_node *node = oval_collection_iterator_next(itr);
+
+		if (node->level >= 0) {
+			++level_counts[node->level];
+			++count;
+			if (node->variable->type == OVAL_VARIABLE_LOCAL) {
+				oval_variable_LOCAL_t *local = (oval_variable_LOCAL_t *) node->variable;
+
+				if (local->component != NULL)
+					oval_component_cache_add(schedule.cache, local->component);
+			}
+		}
+	}
+	oval_collection_iterator_free(itr);
+
+	dI("Computing %zu variables in %d levels of dependencies.", count, max_level + 1);
+
+	schedule.sysmod = sysmod;
+	schedule.variables = malloc(count * sizeof(*schedule.variables));
+	for (level = 0; level <= max_level; ++level) {
+		size_t n = 0;
+
+		itr = oval_string_map_values(nodes);
+		while (oval_collection_iterator_has_more(itr)) {
+			struct oval_variable_node *node = oval_collection_iterator_next(itr);
+
+			if (node->level == level)
+				schedule.variables[n++] = node->variable;
+		}
+		oval_collection_iterator_free(itr);
+
+		/* the variables of a level depend only on the lower levels */
+		if (oscap_parallel_run(level_counts[level], _oval_variable_compute_job, &schedule) != 0) {
+			for (size_t i = 0; i < level_counts[level]; ++i)
+				_oval_variable_compute_job(i, &schedule);
+		}
+	}
+	free(schedule.variables);
+	oval_component_cache_free(schedule.cache);
+	free(level_counts);
+	oval_string_map_free(nodes, free);
+}
+
 static int _dump_variable_values(struct oval_variable *variable)
 {
 	if (variable->flag != SYSCHAR_FLAG_COMPLETE && variable->flag != SYSCHAR_FLAG_INCOMPLETE) {
@@ -23,7 +23,7 @@
 #ifndef CRAPI_H
 #define CRAPI_H
 
-#define CRAPI_IO_BUFSZ 4096
+#define CRAPI_IO_BUFSZ (64 * 1024)
 
 #ifndef _FILE_OFFSET_BITS
 # define _FILE_OFFSET_BITS 32
@@ -30,6 +30,8 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
 #include <sys/types.h>
 
 #include "crapi.h"
@@ -39,6 +41,10 @@
 #include "sha2.h"
 #include "rmd160.h"
 
+#if defined(HAVE_GCRYPT)
+#include <gcrypt.h>
+#endif
+
 int crapi_digest_fd (int fd, crapi_alg_t alg, void *dst, size_t *size)
 {
 	if (dst == NULL) {
@@ -50,6 +56,19 @@ int crapi_digest_fd (int fd, crapi_alg_t alg, void *dst, size_t *size)
 		return -1;
 	}
 
+#if defined(HAVE_GCRYPT)
+        /*
+         * Reading the file into a buffer is cheaper than mapping it for small
+         * files and as fast for the large ones.
+         */
+        if (crapi_mdigest_fd (fd, 1, alg, dst, size) != 0)
+                return (-1);
+        if (*size == 0) {
+                errno = EINVAL;
+                return (-1);
+        }
+        return (0);
+#else
         switch (alg) {
 #ifdef OPENSCAP_ENABLE_MD5
         case CRAPI_DIGEST_MD5:
@@ -73,37 +92,119 @@ int crapi_digest_fd (int fd, crapi_alg_t alg, void *dst, size_t *size)
 
         errno = EINVAL;
         return (-1);
+#endif
 }
 
-int crapi_mdigest_fd (int fd, int num, ... /* crapi_alg_t alg, void *dst, size_t *size, ...*/)
-{
-        register int i;
-        va_list ap;
-        struct digest_ctbl_t *ctbl = malloc(num * sizeof(struct digest_ctbl_t));
-
+struct crapi_mdigest_req {
         crapi_alg_t alg;
         void       *dst;
         size_t     *size;
+};
+
+#if defined(HAVE_GCRYPT)
+static int crapi_gcry_alg (crapi_alg_t alg)
+{
+        switch (alg) {
+#ifdef OPENSCAP_ENABLE_MD5
+        case CRAPI_DIGEST_MD5:
+                return GCRY_MD_MD5;
+#endif
+#ifdef OPENSCAP_ENABLE_SHA1
+        case CRAPI_DIGEST_SHA1:
+                return GCRY_MD_SHA1;
+#endif
+        case CRAPI_DIGEST_SHA224:
+                return GCRY_MD_SHA224;
+        case CRAPI_DIGEST_SHA256:
+                return GCRY_MD_SHA256;
+        case CRAPI_DIGEST_SHA384:
+                return GCRY_MD_SHA384;
+        case CRAPI_DIGEST_SHA512:
+                return GCRY_MD_SHA512;
+        case CRAPI_DIGEST_RMD160:
+                return GCRY_MD_RMD160;
+        }
+
+        return GCRY_MD_NONE;
+}
+
+/*
+ * All the requested algorithms are enabled in a single gcrypt handle, so
+ * every block read from the file is hashed by all of them in one call.
+ * libgcrypt picks the implementation accelerated by the CPU (SHA-NI,
+ * ARMv8 crypto extensions, AVX2, ...) at runtime.
+ */
+static int crapi_mdigest_gcry_fd (int fd, int num, struct crapi_mdigest_req *req)
+{
+        gcry_md_hd_t hd;
+        uint8_t *fd_buf;
+        ssize_t  ret;
+        int i, enabled = 0;
+
+        for (i = 0; i < num; ++i) {
+                if (crapi_gcry_alg (req[i].alg) == GCRY_MD_NONE) {
+                        errno = EINVAL;
+                        return (-1);
+                }
+        }
+
+        if (gcry_md_open (&hd, 0, 0) != 0)
+                return (-1);
+
+        for (i = 0; i < num; ++i) {
+                int algo = crapi_gcry_alg (req[i].alg);
+
+                /* The algorithm may be disabled, eg. MD5 in FIPS mode */
+                if (*req[i].size < gcry_md_get_algo_dlen (algo)
+                    || gcry_md_enable (hd, algo) != 0)
+                        *req[i].size = 0;
+                else
+                        ++enabled;
+        }
+
+        fd_buf = malloc (CRAPI_IO_BUFSZ);
+
+        while ((ret = read (fd, fd_buf, CRAPI_IO_BUFSZ)) != 0) {
+                if (ret < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        free (fd_buf);
+                        gcry_md_close (hd);
+                        return (-1);
+                }
+                if (enabled > 0)
+                        gcry_md_write (hd, fd_buf, (size_t) ret);
+        }
+        free (fd_buf);
+
+        gcry_md_final (hd);
+
+        for (i = 0; i < num; ++i) {
+                int algo = crapi_gcry_alg (req[i].alg);
+
+                if (*req[i].size == 0)
+                        continue;
 
-        uint8_t fd_buf[CRAPI_IO_BUFSZ];
+                *req[i].size = gcry_md_get_algo_dlen (algo);
+                memcpy (req[i].dst, gcry_md_read (hd, algo), *req[i].size);
+        }
+
+        gcry_md_close (hd);
+        return (0);
+}
+#else
+static int crapi_mdigest_ctbl_fd (int fd, int num, struct crapi_mdigest_req *req)
+{
+        register int i;
+        struct digest_ctbl_t *ctbl = malloc(num * sizeof(struct digest_ctbl_t));
+        uint8_t *fd_buf = NULL;
         ssize_t ret;
 
-	if (num <= 0 || fd <= 0) {
-		errno = EINVAL;
-		free(ctbl);
-		return -1;
-	}
         for (i = 0; i < num; ++i)
                 ctbl[i].ctx = NULL;
 
-        va_start (ap, num);
-
         for (i = 0; i < num; ++i) {
-                alg  = va_arg (ap, crapi_alg_t);
-                dst  = va_arg (ap, void *);
-                size = va_arg (ap, size_t *);
-
-                switch (alg) {
+                switch (req[i].alg) {
 #ifdef OPENSCAP_ENABLE_MD5
                 case CRAPI_DIGEST_MD5:
                         ctbl[i].init   = &crapi_md5_init;
@@ -151,37 +252,21 @@ int crapi_mdigest_fd (int fd, int num, ... /* crapi_alg_t alg, void *dst, size_t
                         ctbl[i].free   = &crapi_rmd160_free;
                         break;
                 default:
-                        va_end (ap);
                         goto fail;
                 }
 
-                if ((ctbl[i].ctx = ctbl[i].init (dst, size)) == NULL)
-			*size = 0;
+                if ((ctbl[i].ctx = ctbl[i].init (req[i].dst, req[i].size)) == NULL)
+			*req[i].size = 0;
         }
 
-        va_end (ap);
+        fd_buf = malloc (CRAPI_IO_BUFSZ);
 
-        while ((ret = read (fd, fd_buf, sizeof fd_buf)) == sizeof fd_buf) {
-                for (i = 0; i < num; ++i) {
-			if (ctbl[i].ctx == NULL)
-				continue;
-                        if (ctbl[i].update (ctbl[i].ctx, fd_buf, sizeof fd_buf) != 0) {
-                                goto fail;
-                        }
+        while ((ret = read (fd, fd_buf, CRAPI_IO_BUFSZ)) != 0) {
+                if (ret < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        goto fail;
                 }
-        }
-
-        switch (ret) {
-        case 0:
-                break;
-        case -1:
-                goto fail;
-        default:
-		if (ret <= 0) {
-			free(ctbl);
-			return -1;
-		}
-
                 for (i = 0; i < num; ++i) {
 			if (ctbl[i].ctx == NULL)
 				continue;
@@ -196,6 +281,7 @@ int crapi_mdigest_fd (int fd, int num, ... /* crapi_alg_t alg, void *dst, size_t
 			continue;
                 ctbl[i].fini (ctbl[i].ctx);
 	}
+        free(fd_buf);
         free(ctbl);
         return (0);
 fail:
@@ -203,6 +289,45 @@ fail:
                 if (ctbl[i].ctx != NULL)
                         ctbl[i].free (ctbl[i].ctx);
 
+        free(fd_buf);
         free(ctbl);
         return (-1);
 }
+#endif
+
+int crapi_mdigest_fd (int fd, int num, ... /* crapi_alg_t alg, void *dst, size_t *size, ...*/)
+{
+        register int i;
+        va_list ap;
+        struct crapi_mdigest_req *req;
+        int ret;
+
+	if (num <= 0 || fd <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+        req = malloc(num * sizeof(struct crapi_mdigest_req));
+
+        va_start (ap, num);
+
+        for (i = 0; i < num; ++i) {
+                req[i].alg  = va_arg (ap, crapi_alg_t);
+                req[i].dst  = va_arg (ap, void *);
+                req[i].size = va_arg (ap, size_t *);
+        }
+
+        va_end (ap);
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#if defined(HAVE_GCRYPT)
+        ret = crapi_mdigest_gcry_fd (fd, num, req);
+#else
+        ret = crapi_mdigest_ctbl_fd (fd, num, req);
+#endif
+        free(req);
+
+        return (ret);
+}
@@ -25,6 +25,7 @@
 #endif
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
@@ -182,35 +183,45 @@ int crapi_md5_fd (int fd, void *dst, size_t *size)
 # else
                 buffer = mmap (NULL, buflen, PROT_READ, MAP_SHARED, fd, 0);        
 # endif
-                if (buffer == NULL) {
+                if (buffer == MAP_FAILED) {
 #endif
-                        uint8_t _buffer[CRAPI_IO_BUFSZ];
+                        uint8_t *_buffer;
                         void   *ctx;
                         ssize_t ret;
                 
+                        /* Probes run in threads, keep the large buffer off the stack */
+                        _buffer = malloc (CRAPI_IO_BUFSZ);
+                        if (_buffer == NULL)
+                                return (-1);
+
                         buffer = _buffer;
                         ctx    = crapi_md5_init (dst, size);
                         
-                        if (ctx == NULL)
+                        if (ctx == NULL) {
+                                free (_buffer);
                                 return (-1);
+                        }
                 
-                        while ((ret = read (fd, buffer, sizeof _buffer)) == sizeof _buffer)
-                                crapi_md5_update (ctx, buffer, sizeof _buffer);
+                        while ((ret = read (fd, buffer, CRAPI_IO_BUFSZ)) == CRAPI_IO_BUFSZ)
+                                crapi_md5_update (ctx, buffer, CRAPI_IO_BUFSZ);
                         
                         switch (ret) {
                         case 0:
                                 break;
                         case -1:
+                                free (_buffer);
                                 return (-1);
                         default:
 				if (ret <= 0) {
 					crapi_md5_free(ctx);
+					free(_buffer);
 					return -1;
 				}
                                 crapi_md5_update (ctx, buffer, (size_t) ret);
                         }
                         
                         crapi_md5_fini (ctx);
+                        free (_buffer);
 #if _FILE_OFFSET_BITS == 32
 # if defined(HAVE_NSS3)
                 } else {
@@ -25,6 +25,7 @@
 #endif
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
@@ -145,26 +146,33 @@ int crapi_rmd160_fd (int fd, void *dst, size_t *size)
 # else
                 buffer = mmap (NULL, buflen, PROT_READ, MAP_SHARED, fd, 0);        
 # endif        
-                if (buffer == NULL) {
+                if (buffer == MAP_FAILED) {
 #endif /* _FILE_OFFSET_BITS == 32 */
-                        uint8_t _buffer[CRAPI_IO_BUFSZ];
+                        uint8_t *_buffer;
                         gcry_md_hd_t hd;
                         ssize_t ret;
                 
+                        /* Probes run in threads, keep the large buffer off the stack */
+                        _buffer = malloc (CRAPI_IO_BUFSZ);
+                        if (_buffer == NULL)
+                                return (-1);
+
                         buffer = _buffer;
                         gcry_md_open (&hd, GCRY_MD_RMD160, 0);
                 
-                        while ((ret = read (fd, buffer, sizeof _buffer)) == sizeof _buffer)
-                                gcry_md_write (hd, (const void *)buffer, sizeof _buffer);
+                        while ((ret = read (fd, buffer, CRAPI_IO_BUFSZ)) == CRAPI_IO_BUFSZ)
+                                gcry_md_write (hd, (const void *)buffer, CRAPI_IO_BUFSZ);
                 
                         switch (ret) {
                         case 0:
                                 break;
                         case -1:
+                                free (_buffer);
                                 return (-1);
                         default:
 				if (ret <= 0) {
 					gcry_md_close(hd);
+					free(_buffer);
 					return -1;
 				}
                                 gcry_md_write (hd, (const void *)buffer, (size_t)ret);
@@ -175,6 +183,7 @@ int crapi_rmd160_fd (int fd, void *dst, size_t *size)
                         buffer = (void *)gcry_md_read (hd, GCRY_MD_RMD160);
                         memcpy (dst, buffer, gcry_md_get_algo_dlen (GCRY_MD_RMD160));
                         gcry_md_close (hd);
+                        free (_buffer);
 #if _FILE_OFFSET_BITS == 32
                 } else {
                         gcry_md_hash_buffer (GCRY_MD_RMD160, dst, (const void *)buffer, buflen);
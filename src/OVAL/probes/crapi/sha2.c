@@ -25,6 +25,7 @@
 #endif
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
@@ -62,29 +63,38 @@ static int crapi_sha2_fd (HASH_HashType algo, int fd, void *dst, size_t *size)
 # else
                 buffer = mmap (NULL, buflen, PROT_READ, MAP_SHARED, fd, 0);
 # endif
-                if (buffer == NULL) {
+                if (buffer == MAP_FAILED) {
 #endif /* _FILE_OFFSET_BITS == 32 */
-                        uint8_t _buffer[CRAPI_IO_BUFSZ];
+                        uint8_t *_buffer;
                         HASHContext *ctx;
                         ssize_t ret;
 
+                        /* Probes run in threads, keep the large buffer off the stack */
+                        _buffer = malloc (CRAPI_IO_BUFSZ);
+                        if (_buffer == NULL)
+                                return (-1);
+
                         buffer = _buffer;
                         ctx    = HASH_Create (algo);
 
-                        if (ctx == NULL)
+                        if (ctx == NULL) {
+                                free (_buffer);
                                 return (-1);
+                        }
 
-                        while ((ret = read (fd, buffer, sizeof _buffer)) == sizeof _buffer)
-                                HASH_Update (ctx, (const unsigned char *)buffer, (unsigned int) sizeof _buffer);
+                        while ((ret = read (fd, buffer, CRAPI_IO_BUFSZ)) == CRAPI_IO_BUFSZ)
+                                HASH_Update (ctx, (const unsigned char *)buffer, (unsigned int) CRAPI_IO_BUFSZ);
 
                         switch (ret) {
                         case 0:
                                 break;
                         case -1:
+                                free (_buffer);
                                 return (-1);
                         default:
 				if (ret <= 0) {
 					HASH_Destroy(ctx);
+					free(_buffer);
 					return -1;
 				}
                                 HASH_Update (ctx, (const unsigned char *)buffer, (unsigned int) ret);
@@ -92,6 +102,7 @@ static int crapi_sha2_fd (HASH_HashType algo, int fd, void *dst, size_t *size)
 
                         HASH_End (ctx, dst, (unsigned int *)size, *size);
                         HASH_Destroy (ctx);
+                        free (_buffer);
 #if _FILE_OFFSET_BITS == 32
                 } else {
                         HASH_HashBuf (algo, (unsigned char *)dst, (unsigned char *)buffer, (unsigned int)buflen);
@@ -230,26 +241,33 @@ static int crapi_sha2_fd (int algo, int fd, void *dst, size_t *size)
 # else
                 buffer = mmap (NULL, buflen, PROT_READ, MAP_SHARED, fd, 0);
 # endif
-                if (buffer == NULL) {
+                if (buffer == MAP_FAILED) {
 #endif /* _FILE_OFFSET_BITS == 32 */
-                        uint8_t _buffer[CRAPI_IO_BUFSZ];
+                        uint8_t *_buffer;
                         gcry_md_hd_t hd;
                         ssize_t ret;
 
+                        /* Probes run in threads, keep the large buffer off the stack */
+                        _buffer = malloc (CRAPI_IO_BUFSZ);
+                        if (_buffer == NULL)
+                                return (-1);
+
                         buffer = _buffer;
                         gcry_md_open (&hd, algo, 0);
 
-                        while ((ret = read (fd, buffer, sizeof _buffer)) == sizeof _buffer)
-                                gcry_md_write (hd, (const void *)buffer, sizeof _buffer);
+                        while ((ret = read (fd, buffer, CRAPI_IO_BUFSZ)) == CRAPI_IO_BUFSZ)
+                                gcry_md_write (hd, (const void *)buffer, CRAPI_IO_BUFSZ);
 
                         switch (ret) {
                         case 0:
                                 break;
                         case -1:
+                                free (_buffer);
                                 return (-1);
                         default:
 				if (ret <= 0) {
 					gcry_md_close(hd);
+					free(_buffer);
 					return -1;
 				}
                                 gcry_md_write (hd, (const void *)buffer, (size_t)ret);
@@ -260,6 +278,7 @@ static int crapi_sha2_fd (int algo, int fd, void *dst, size_t *size)
                         buffer = (void *)gcry_md_read (hd, algo);
                         memcpy (dst, buffer, gcry_md_get_algo_dlen (algo));
                         gcry_md_close (hd);
+                        free (_buffer);
 #if _FILE_OFFSET_BITS == 32
                 } else {
 			/* XXX: FIPS: Note that this function will abort the process if an unavailable algorithm is used. */
@@ -341,7 +360,7 @@ void crapi_sha224_free (void *ctxp)
 
 int crapi_sha224_fd (int fd, void *dst, size_t *size)
 {
-        return crapi_sha2_fd (GCRY_MD_SHA256, fd, dst, size);
+        return crapi_sha2_fd (GCRY_MD_SHA224, fd, dst, size);
 }
 
 void *crapi_sha256_init (void *dst, void *size)
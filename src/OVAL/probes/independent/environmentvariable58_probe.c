@@ -68,6 +68,9 @@
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
 #include "environmentvariable58_probe.h"
+#if !defined(OS_FREEBSD)
+#include "unix/proc-snapshot.h"
+#endif
 
 #if defined(OS_FREEBSD)
 static int read_environment(SEXP_t *pid_ent, SEXP_t *name_ent, probe_ctx *ctx)
@@ -232,8 +235,6 @@ static int read_environment(SEXP_t *pid_ent, SEXP_t *name_ent, probe_ctx *ctx)
 }
 
 #else
-#define BUFFER_SIZE 256
-
 extern char **environ;
 
 static int collect_variable(char *buffer, size_t env_name_size, int pid, SEXP_t *name_ent, probe_ctx *ctx)
@@ -261,14 +262,12 @@ static int collect_variable(char *buffer, size_t env_name_size, int pid, SEXP_t
 
 static int read_environment(SEXP_t *pid_ent, SEXP_t *name_ent, probe_ctx *ctx)
 {
-	int err = 1, pid, fd;
-	bool empty;
+	int err = 1, pid;
 	SEXP_t *item, *pid_sexp;
-	DIR *d;
-	struct dirent *d_entry;
-	char *buffer, *null_char, path[PATH_MAX] = {0};
-	ssize_t buffer_used;
-	size_t buffer_size;
+	struct proc_snapshot *snapshot;
+	const struct proc_entry **matches;
+	size_t count, match_count = 0;
+	char path[PATH_MAX] = {0};
 
 	const char *extra_vars = getenv("OSCAP_CONTAINER_VARS");
 	if (extra_vars && *extra_vars) {
@@ -290,104 +289,65 @@ static int read_environment(SEXP_t *pid_ent, SEXP_t *name_ent, probe_ctx *ctx)
 		return 0;
 	}
 
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(path, PATH_MAX, "%s/proc", prefix ? prefix : "");
-	d = opendir(path);
-	if (d == NULL) {
+	snapshot = proc_snapshot_get();
+	if (snapshot == NULL) {
+		const char *prefix = getenv("OSCAP_PROBE_ROOT");
 		dE("Can't read %s/proc: errno=%d, %s.", prefix ? prefix : "", errno, strerror(errno));
 		return PROBE_EACCESS;
 	}
 
-	if ((buffer = realloc(NULL, BUFFER_SIZE)) == NULL) {
-		dE("Can't re-allocate memory");
-		closedir(d);
-		return PROBE_EFAULT;
-	}
-	buffer_size = BUFFER_SIZE;
-
-	while ((d_entry = readdir(d))) {
-		if (strspn(d_entry->d_name, "0123456789") != strlen(d_entry->d_name))
-			continue;
+	count = proc_snapshot_count(snapshot);
+	matches = malloc((count > 0 ? count : 1) * sizeof(struct proc_entry *));
 
-		pid = atoi(d_entry->d_name);
-		pid_sexp = SEXP_number_newi_32(pid);
+	for (size_t i = 0; i < count; ++i) {
+		const struct proc_entry *entry = proc_snapshot_nth(snapshot, i);
 
-		if (probe_entobj_cmp(pid_ent, pid_sexp) != OVAL_RESULT_TRUE) {
-			SEXP_free(pid_sexp);
-			continue;
-		}
+		pid_sexp = SEXP_number_newi_32(entry->pid);
+		if (probe_entobj_cmp(pid_ent, pid_sexp) == OVAL_RESULT_TRUE)
+			matches[match_count++] = entry;
 		SEXP_free(pid_sexp);
+	}
+
+	proc_snapshot_load_entries(snapshot, matches, match_count, PROC_SNAPSHOT_ENVIRON);
 
-		snprintf(path, PATH_MAX, "%s/proc/%d/environ", prefix ? prefix : "", pid);
-		if ((fd = open(path, O_RDONLY)) == -1) {
-			dE("Can't open \"%s\": errno=%d, %s.", path, errno, strerror (errno));
+	for (size_t i = 0; i < match_count; ++i) {
+		const struct proc_entry *entry = matches[i];
+		char *var, *end;
+
+		if (entry->environment == NULL) {
+			snprintf(path, PATH_MAX, "%s/%d/environ", proc_snapshot_path(snapshot), entry->pid);
+			dE("Can't open \"%s\": errno=%d, %s.", path, entry->environment_errno, strerror(entry->environment_errno));
 			item = probe_item_create(
 					OVAL_INDEPENDENT_ENVIRONMENT_VARIABLE58, NULL,
-					"pid", OVAL_DATATYPE_INTEGER, (int64_t)pid,
+					"pid", OVAL_DATATYPE_INTEGER, (int64_t)entry->pid,
 					NULL
 			);
 
 			probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
 			probe_item_add_msg(item, OVAL_MESSAGE_LEVEL_ERROR,
-					   "Can't open \"%s\": errno=%d, %s.", path, errno, strerror (errno));
+					   "Can't open \"%s\": errno=%d, %s.", path, entry->environment_errno, strerror(entry->environment_errno));
 			probe_item_collect(ctx, item);
 			continue;
 		}
 
-		empty = true;
-
-		if ((buffer_used = read(fd, buffer, buffer_size - 1)) > 0) {
-			empty = false;
-		}
-
-		while (! empty) {
-			while (! (null_char = memchr(buffer, 0, buffer_used))) {
-				ssize_t s;
-				if ((size_t)buffer_used >= buffer_size) {
-					buffer_size += BUFFER_SIZE;
-					void *new_buffer = realloc(buffer, buffer_size);
-					if (new_buffer == NULL) {
-						dE("Can't re-allocate memory");
-						free(buffer);
-						closedir(d);
-						close(fd);
-						return PROBE_ENOMEM;
-					}
-					buffer = new_buffer;
-				}
-				s = read(fd, buffer + buffer_used, buffer_size - buffer_used);
-				if (s <= 0) {
-					empty = true;
-					buffer[buffer_used++] = 0;
-				}
-				else {
-					buffer_used += s;
-				}
+		/* The variables are separated by '\0', the last one is terminated by the snapshot */
+		end = entry->environment + entry->environment_len;
+		for (var = entry->environment; var < end; var += strlen(var) + 1) {
+			char *eq_char = strchr(var, '=');
+			if (eq_char == NULL) {
+				/* strange but possible:
+				 * $ strings /proc/1218/environ
+				/dev/input/event0 /dev/input/event1 /dev/input/event4 /dev/input/event3
+				*/
+				continue;
 			}
 
-			do {
-				char *eq_char = strchr(buffer, '=');
-				if (eq_char == NULL) {
-					/* strange but possible:
-					 * $ strings /proc/1218/environ
- 					/dev/input/event0 /dev/input/event1 /dev/input/event4 /dev/input/event3
-					*/
-					buffer_used -= null_char + 1 - buffer;
-					memmove(buffer, null_char + 1, buffer_used);
-					continue;
-				}
-
-				collect_variable(buffer, eq_char - buffer, pid, name_ent, ctx);
-
-				buffer_used -= null_char + 1 - buffer;
-				memmove(buffer, null_char + 1, buffer_used);
-			} while ((null_char = memchr(buffer, 0, buffer_used)));
+			collect_variable(var, eq_char - var, entry->pid, name_ent, ctx);
 		}
-
-		close(fd);
 	}
-	closedir(d);
-	free(buffer);
+	free(matches);
+	proc_snapshot_put(snapshot);
+
 	if (err) {
 		SEXP_t *msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
 				"Can't find process with requested PID.");
@@ -451,3 +411,10 @@ int environmentvariable58_probe_main(probe_ctx *ctx, void *arg)
 
 	return err;
 }
+
+void environmentvariable58_probe_fini(void *arg)
+{
+#if !defined(OS_FREEBSD)
+	proc_snapshot_drop();
+#endif
+}
@@ -50,6 +50,7 @@
 #include <probe/option.h>
 
 #include "common/debug_priv.h"
+#include "common/oscap_parallel.h"
 #include "oval_fts.h"
 #include "util.h"
 #include "probe/entcmp.h"
@@ -121,77 +122,96 @@ static int mem2hex (uint8_t *mem, size_t mlen, char *str, size_t slen)
 	return (0);
 }
 
-static int filehash58_cb(const char *prefix, const char *p, const char *f, const char *h, probe_ctx *ctx)
-{
-	SEXP_t *itm;
+/*
+ * The files found by oval_fts are hashed in batches, each batch by a run of
+ * a pool of worker threads, then the items are created and collected in the
+ * order in which oval_fts returned the files, so the results don't depend on
+ * the scheduling of the workers. The size of the batches bounds the memory
+ * needed for the walks of large trees.
+ */
+#define FILEHASH58_BATCH_SIZE 256
+
+struct filehash58_job {
+	char *path;
+	char *file;
+	const char *hash_type;
+	char *filepath;
+	int open_errno;            /* errno of open(), 0 if the file was opened */
+	crapi_alg_t alg;           /* 0 if the hash type isn't supported */
+	int result;                /* return value of crapi_mdigest_fd() */
+	uint8_t hash[64];
+	size_t hash_len;
+};
 
-	char   pbuf[PATH_MAX+1];
-	size_t plen, flen;
+struct filehash58_batch {
+	const char *prefix;
+	struct filehash58_job *jobs;
+	size_t count;
+	size_t size;
+};
 
+static void filehash58_hash_job(size_t index, void *arg)
+{
+	struct filehash58_batch *batch = (struct filehash58_batch *) arg;
+	struct filehash58_job *job = &batch->jobs[index];
 	int fd;
 
-	if (f == NULL)
-		return (0);
-
-	/*
-	 * Prepare path
-	 */
-	plen = strlen (p);
-	flen = strlen (f);
-
-	if (plen + flen + 1 > PATH_MAX)
-		return (-1);
-
-	memcpy (pbuf, p, sizeof (char) * plen);
-
-	if (p[plen - 1] != FILE_SEPARATOR) {
-		pbuf[plen] = FILE_SEPARATOR;
-		++plen;
-	}
-
-	memcpy (pbuf + plen, f, sizeof (char) * flen);
-	pbuf[plen+flen] = '\0';
-
 	/*
 	 * Open the file
 	 */
-	if (prefix == NULL) {
-		fd = open(pbuf, O_RDONLY);
+	if (batch->prefix == NULL) {
+		fd = open(job->filepath, O_RDONLY);
 	} else {
-		char *path_with_prefix = oscap_path_join(prefix, pbuf);
+		char *path_with_prefix = oscap_path_join(batch->prefix, job->filepath);
 		fd = open(path_with_prefix, O_RDONLY);
 		free(path_with_prefix);
 	}
 
 	if (fd < 0) {
-		strerror_r (errno, pbuf, PATH_MAX);
-		pbuf[PATH_MAX] = '\0';
+		job->open_errno = errno;
+		return;
+	}
+
+	job->alg = oscap_string_to_enum(CRAPI_ALG_MAP, job->hash_type);
+	if (job->alg == 0) {
+		close(fd);
+		return;
+	}
+
+	/*
+	 * Compute hash value
+	 */
+	job->hash_len = oscap_string_to_enum(CRAPI_ALG_MAP_SIZE, job->hash_type);
+	job->result = crapi_mdigest_fd(fd, 1, job->alg, job->hash, &job->hash_len);
 
+	close(fd);
+}
+
+static void filehash58_collect_job(struct filehash58_job *job, probe_ctx *ctx)
+{
+	SEXP_t *itm;
+	const char *p = job->path, *f = job->file, *h = job->hash_type;
+
+	if (job->open_errno != 0) {
 		itm = probe_item_create (OVAL_INDEPENDENT_FILE_HASH58, NULL,
-					"filepath", OVAL_DATATYPE_STRING, pbuf,
+					"filepath", OVAL_DATATYPE_STRING, job->filepath,
 					"path",     OVAL_DATATYPE_STRING, p,
 					"filename", OVAL_DATATYPE_STRING, f,
 					"hash_type",OVAL_DATATYPE_STRING, h,
 					NULL);
 		probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR,
-			"Can't open \"%s\": errno=%d, %s.", pbuf, errno, strerror (errno));
+			"Can't open \"%s\": errno=%d, %s.", job->filepath, job->open_errno, strerror (job->open_errno));
 		probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
 
 		probe_item_collect(ctx, itm);
-		return 0;
+		return;
 	}
 
-	uint8_t hash_dst[1025];
-	size_t hash_dstlen = sizeof(hash_dst);
-	char hash_str[2051];
-	crapi_alg_t hash_type;
-
-	hash_type = oscap_string_to_enum(CRAPI_ALG_MAP, h);
-	if (hash_type == 0) {
+	if (job->alg == 0) {
 		char *msg = oscap_sprintf("This version of OpenSCAP doesn't support the '%s' hash algorithm.", h);
 		dW(msg);
 		itm = probe_item_create (OVAL_INDEPENDENT_FILE_HASH58, NULL,
-			"filepath", OVAL_DATATYPE_STRING, pbuf,
+			"filepath", OVAL_DATATYPE_STRING, job->filepath,
 			"path", OVAL_DATATYPE_STRING, p,
 			"filename", OVAL_DATATYPE_STRING, f,
 			"hash_type", OVAL_DATATYPE_STRING, h,
@@ -200,45 +220,92 @@ static int filehash58_cb(const char *prefix, const char *p, const char *f, const
 		free(msg);
 		probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
 		probe_item_collect(ctx, itm);
-		close(fd);
-		return 0;
+		return;
 	}
 
-	hash_dstlen = oscap_string_to_enum(CRAPI_ALG_MAP_SIZE, h);
-
-	/*
-	 * Compute hash value
-	 */
-	if (crapi_mdigest_fd(fd, 1, hash_type, hash_dst, &hash_dstlen) != 0) {
-		close (fd);
-		return (-1);
-	}
-
-	close (fd);
+	if (job->result != 0)
+		return;
 
+	char hash_str[2051];
 	hash_str[0] = '\0';
-	mem2hex(hash_dst, hash_dstlen, hash_str, sizeof(hash_str));
+	mem2hex(job->hash, job->hash_len, hash_str, sizeof(hash_str));
 
 	/*
 	 * Create and add the item
 	 */
 	itm = probe_item_create(OVAL_INDEPENDENT_FILE_HASH58, NULL,
-		"filepath", OVAL_DATATYPE_STRING, pbuf,
+		"filepath", OVAL_DATATYPE_STRING, job->filepath,
 		"path", OVAL_DATATYPE_STRING, p,
 		"filename", OVAL_DATATYPE_STRING, f,
 		"hash_type",OVAL_DATATYPE_STRING, h,
 		"hash", OVAL_DATATYPE_STRING, hash_str,
 		NULL);
 
-	if (hash_dstlen == 0) {
+	if (job->hash_len == 0) {
 		probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR,
-			"Unable to compute %s hash value of \"%s\".", h, pbuf);
+			"Unable to compute %s hash value of \"%s\".", h, job->filepath);
 		probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
 	}
 
 	probe_item_collect(ctx, itm);
+}
 
-	return (0);
+static void filehash58_flush(struct filehash58_batch *batch, probe_ctx *ctx)
+{
+	if (oscap_parallel_run(batch->count, filehash58_hash_job, batch) != 0) {
+		for (size_t i = 0; i < batch->count; ++i)
+			filehash58_hash_job(i, batch);
+	}
+
+	for (size_t i = 0; i < batch->count; ++i) {
+		struct filehash58_job *job = &batch->jobs[i];
+		filehash58_collect_job(job, ctx);
+		free(job->path);
+		free(job->file);
+		free(job->filepath);
+	}
+	batch->count = 0;
+}
+
+static int filehash58_add(struct filehash58_batch *batch, const char *p, const char *f, const char *h)
+{
+	size_t plen, flen;
+
+	if (f == NULL)
+		return 0;
+
+	/*
+	 * Prepare path
+	 */
+	plen = strlen (p);
+	flen = strlen (f);
+
+	if (plen + flen + 1 > PATH_MAX)
+		return 0;
+
+	struct filehash58_job *job = &batch->jobs[batch->count];
+	memset(job, 0, sizeof(*job));
+	job->filepath = malloc(plen + flen + 2);
+	if (job->filepath == NULL)
+		return -1;
+
+	memcpy (job->filepath, p, sizeof (char) * plen);
+
+	if (p[plen - 1] != FILE_SEPARATOR) {
+		job->filepath[plen] = FILE_SEPARATOR;
+		++plen;
+	}
+
+	memcpy (job->filepath + plen, f, sizeof (char) * flen);
+	job->filepath[plen+flen] = '\0';
+
+	job->path = strdup(p);
+	job->file = strdup(f);
+	job->hash_type = h;
+	++batch->count;
+	if (job->path == NULL || job->file == NULL)
+		return -1;
+	return 0;
 }
 
 int filehash58_probe_offline_mode_supported()
@@ -246,6 +313,11 @@ int filehash58_probe_offline_mode_supported()
 	return PROBE_OFFLINE_OWN;
 }
 
+/* oval_fts handles all values of the path entities at once */
+const char * const filehash58_probe_multival_entities[] = {
+	"filepath", "path", "filename", "hash_type", NULL
+};
+
 void *filehash58_probe_init(void)
 {
 	/*
@@ -322,13 +394,30 @@ int filehash58_probe_main(probe_ctx *ctx, void *arg)
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 	if ((ofts = oval_fts_open_prefixed(prefix, path, filename, filepath, behaviors, probe_ctx_getresult(ctx))) != NULL) {
-		while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
+		struct filehash58_batch batch = {
+			.prefix = prefix,
+			.jobs = calloc(FILEHASH58_BATCH_SIZE, sizeof(struct filehash58_job)),
+			.count = 0,
+			.size = FILEHASH58_BATCH_SIZE
+		};
+
+		if (batch.jobs == NULL) {
+			dE("Can't allocate memory for hashing of files.");
+			err = PROBE_ENOMEM;
+		}
+
+		while (err == 0 && (ofts_ent = oval_fts_read(ofts)) != NULL) {
 			/* find hash types to compare with entity, think "not satisfy" */
-			for (int i = 0; OVAL_FILEHASH58_HASH_TYPES[i] != NULL; i++) {
+			for (int i = 0; err == 0 && OVAL_FILEHASH58_HASH_TYPES[i] != NULL; i++) {
 				const char *oval_filehash58_hash_type = OVAL_FILEHASH58_HASH_TYPES[i];
 				SEXP_t *oval_filehash58_hash_type_sexp = SEXP_string_new(oval_filehash58_hash_type, strlen(oval_filehash58_hash_type));
 				if (probe_entobj_cmp(hash_type, oval_filehash58_hash_type_sexp) == OVAL_RESULT_TRUE) {
-					filehash58_cb(prefix, ofts_ent->path, ofts_ent->file, oval_filehash58_hash_type, ctx);
+					if (filehash58_add(&batch, ofts_ent->path, ofts_ent->file, oval_filehash58_hash_type) != 0) {
+						dE("Can't allocate memory for hashing of \"%s/%s\".", ofts_ent->path, ofts_ent->file);
+						err = PROBE_ENOMEM;
+					} else if (batch.count == batch.size) {
+						filehash58_flush(&batch, ctx);
+					}
 				}
 
 				SEXP_free(oval_filehash58_hash_type_sexp);
@@ -336,6 +425,14 @@ int filehash58_probe_main(probe_ctx *ctx, void *arg)
 			oval_ftsent_free(ofts_ent);
 		}
 
+		if (err == 0)
+			filehash58_flush(&batch, ctx);
+		for (size_t i = 0; i < batch.count; ++i) {
+			free(batch.jobs[i].path);
+			free(batch.jobs[i].file);
+			free(batch.jobs[i].filepath);
+		}
+		free(batch.jobs);
 		oval_fts_close(ofts);
 	}
 
@@ -26,6 +26,7 @@
 #include "probe-api.h"
 
 int filehash58_probe_offline_mode_supported(void);
+extern const char * const filehash58_probe_multival_entities[];
 void *filehash58_probe_init(void);
 int filehash58_probe_main(probe_ctx *ctx, void *arg);
 void filehash58_probe_fini(void *arg);
@@ -111,18 +111,20 @@ static SEXP_t *create_item(const char *path, const char *filename, char *pattern
 }
 
 struct pfdata {
-	char *pattern;
+	char **patterns;
+	oscap_pcre_t **compiled_regexes;
+	size_t pattern_cnt;
 	oscap_pcre_options_t re_opts;
 	SEXP_t *instance_ent;
 	probe_ctx *ctx;
-	oscap_pcre_t *compiled_regex;
 };
 
 static int process_file(const char *prefix, const char *path, const char *file, void *arg, oval_schema_version_t over)
 {
 	struct pfdata *pfd = (struct pfdata *) arg;
-	int ret = 0, path_len, file_len, cur_inst = 0, fd = -1, substr_cnt,
-		buf_size = 0, buf_used = 0, ofs = 0, buf_inc = 4096;
+	int ret = 0, path_len, file_len, cur_inst, fd = -1, substr_cnt,
+		buf_size = 0, buf_used = 0, ofs, buf_inc = 4096;
+	size_t p;
 	char **substrs = NULL;
 	char *whole_path = NULL, *whole_path_with_prefix = NULL, *buf = NULL;
 	SEXP_t *next_inst = NULL;
@@ -205,49 +207,53 @@ static int process_file(const char *prefix, const char *path, const char *file,
 	}
 	buf[buf_used++] = '\0';
 
-	do {
-		int want_instance;
-
-		next_inst = SEXP_number_newi_32(cur_inst + 1);
-
-		if (probe_entobj_cmp(pfd->instance_ent, next_inst) == OVAL_RESULT_TRUE)
-			want_instance = 1;
-		else
-			want_instance = 0;
-
-		SEXP_free(next_inst);
-		substr_cnt = oscap_pcre_get_substrings(buf, &ofs, pfd->compiled_regex, want_instance, &substrs);
-
-		if (substr_cnt < 0) {
-			SEXP_t *msg;
-			msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
-				"Regular expression pattern match failed in file %s with error %d.",
-				whole_path, substr_cnt);
-			probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-			SEXP_free(msg);
-			probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
-			ret = -3;
-			goto cleanup;
-		}
+	/* the file is read once and matched against all patterns */
+	for (p = 0; p < pfd->pattern_cnt; ++p) {
+		cur_inst = 0;
+		ofs = 0;
+		do {
+			int want_instance;
+
+			next_inst = SEXP_number_newi_32(cur_inst + 1);
+
+			if (probe_entobj_cmp(pfd->instance_ent, next_inst) == OVAL_RESULT_TRUE)
+				want_instance = 1;
+			else
+				want_instance = 0;
+
+			SEXP_free(next_inst);
+			substr_cnt = oscap_pcre_get_substrings(buf, &ofs, pfd->compiled_regexes[p], want_instance, &substrs);
+
+			if (substr_cnt < 0) {
+				SEXP_t *msg;
+				msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
+					"Regular expression pattern match failed in file %s with error %d.",
+					whole_path, substr_cnt);
+				probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
+				SEXP_free(msg);
+				probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+				ret = -3;
+			}
 
-		if (substr_cnt > 0) {
-			++cur_inst;
+			if (substr_cnt > 0) {
+				++cur_inst;
 
-			if (want_instance) {
-				int k;
-				SEXP_t *item;
+				if (want_instance) {
+					int k;
+					SEXP_t *item;
 
-				item = create_item(path, file, pfd->pattern,
-						cur_inst, substrs, substr_cnt, over);
+					item = create_item(path, file, pfd->patterns[p],
+							cur_inst, substrs, substr_cnt, over);
 
-                                probe_item_collect(pfd->ctx, item);
+					probe_item_collect(pfd->ctx, item);
 
-				for (k = 0; k < substr_cnt; ++k)
-					free(substrs[k]);
-				free(substrs);
+					for (k = 0; k < substr_cnt; ++k)
+						free(substrs[k]);
+					free(substrs);
+				}
 			}
-		}
-	} while (substr_cnt > 0 && ofs < buf_used);
+		} while (substr_cnt > 0 && ofs < buf_used);
+	}
 
  cleanup:
 	if (fd != -1)
@@ -266,15 +272,22 @@ int textfilecontent54_probe_offline_mode_supported()
 	return PROBE_OFFLINE_OWN;
 }
 
+/* oval_fts handles all values of the path entities, each file is matched
+   against all values of the pattern */
+const char * const textfilecontent54_probe_multival_entities[] = {
+	"filepath", "path", "filename", "pattern", "instance", NULL
+};
+
 int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 {
 	SEXP_t *path_ent, *file_ent, *inst_ent, *bh_ent, *patt_ent, *filepath_ent, *probe_in;
-        SEXP_t *r0;
+        SEXP_t *r0, *patt_vals;
 	bool val;
 	struct pfdata pfd;
 	int ret = 0;
 	int errorffset = -1;
 	char *error;
+	size_t i, j;
 	OVAL_FTS    *ofts;
 	OVAL_FTSENT *ofts_ent;
 
@@ -301,13 +314,28 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 		goto cleanup;
         }
 
-	/* get pattern from SEXP */
-        SEXP_t *ent_val;
-        ent_val = probe_ent_getval(patt_ent);
-	pfd.pattern = SEXP_string_cstr(ent_val);
-        SEXP_free(patt_ent);
-        SEXP_free(ent_val);
-	if (pfd.pattern == NULL) {
+	/* get the patterns from SEXP, a variable can provide several of them */
+	probe_ent_getvals(patt_ent, &patt_vals);
+	SEXP_free(patt_ent);
+	pfd.patterns = calloc(SEXP_list_length(patt_vals) + 1, sizeof(char *));
+	pfd.compiled_regexes = calloc(SEXP_list_length(patt_vals) + 1, sizeof(oscap_pcre_t *));
+	SEXP_list_foreach(r0, patt_vals) {
+		char *pattern = SEXP_string_cstr(r0);
+
+		if (pattern == NULL) {
+			ret = -1;
+			break;
+		}
+		/* equal values are matched only once */
+		for (j = 0; j < pfd.pattern_cnt && strcmp(pfd.patterns[j], pattern) != 0; ++j);
+		if (j < pfd.pattern_cnt)
+			free(pattern);
+		else
+			pfd.patterns[pfd.pattern_cnt++] = pattern;
+	}
+	SEXP_free(r0);
+	SEXP_free(patt_vals);
+	if (ret != 0 || pfd.pattern_cnt == 0) {
 		ret = -1;
 		goto cleanup;
 	}
@@ -339,17 +367,27 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 			pfd.re_opts |= OSCAP_PCRE_OPTS_DOTALL;
 	}
 
-	pfd.compiled_regex = oscap_pcre_compile(pfd.pattern, pfd.re_opts, &error, &errorffset);
-	if (pfd.compiled_regex == NULL) {
-		SEXP_t *msg;
+	/* the patterns which fail to compile are reported and dropped */
+	for (i = 0, j = 0; i < pfd.pattern_cnt; ++i) {
+		oscap_pcre_t *regex = oscap_pcre_compile(pfd.patterns[i], pfd.re_opts, &error, &errorffset);
 
-		msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "oscap_pcre_compile() '%s' %s.", pfd.pattern, error);
-		probe_cobj_add_msg(probe_ctx_getresult(pfd.ctx), msg);
-		SEXP_free(msg);
-		probe_cobj_set_flag(probe_ctx_getresult(pfd.ctx), SYSCHAR_FLAG_ERROR);
-		oscap_pcre_err_free(error);
-		goto cleanup;
+		if (regex == NULL) {
+			SEXP_t *msg;
+
+			msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "oscap_pcre_compile() '%s' %s.", pfd.patterns[i], error);
+			probe_cobj_add_msg(probe_ctx_getresult(pfd.ctx), msg);
+			SEXP_free(msg);
+			probe_cobj_set_flag(probe_ctx_getresult(pfd.ctx), SYSCHAR_FLAG_ERROR);
+			oscap_pcre_err_free(error);
+			free(pfd.patterns[i]);
+			continue;
+		}
+		pfd.patterns[j] = pfd.patterns[i];
+		pfd.compiled_regexes[j++] = regex;
 	}
+	pfd.pattern_cnt = j;
+	if (pfd.pattern_cnt == 0)
+		goto cleanup;
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 
@@ -372,9 +410,12 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
         SEXP_free(inst_ent);
         SEXP_free(bh_ent);
         SEXP_free(filepath_ent);
-	if (pfd.pattern != NULL)
-		free(pfd.pattern);
-	if (pfd.compiled_regex != NULL)
-		oscap_pcre_free(pfd.compiled_regex);
+	for (i = 0; i < pfd.pattern_cnt; ++i) {
+		free(pfd.patterns[i]);
+		if (pfd.compiled_regexes[i] != NULL)
+			oscap_pcre_free(pfd.compiled_regexes[i]);
+	}
+	free(pfd.patterns);
+	free(pfd.compiled_regexes);
 	return ret;
 }
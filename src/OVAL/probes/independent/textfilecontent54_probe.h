@@ -26,6 +26,7 @@
 #include "probe-api.h"
 
 int textfilecontent54_probe_offline_mode_supported(void);
+extern const char * const textfilecontent54_probe_multival_entities[];
 int textfilecontent54_probe_main(probe_ctx *ctx, void *arg);
 
 #endif /* OPENSCAP_TEXTFILECONTENT54_PROBE_H */
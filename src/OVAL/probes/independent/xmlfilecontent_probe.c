@@ -53,9 +53,13 @@
 #include <config.h>
 #endif
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include <libxml/tree.h>
 #include <libxml/parser.h>
@@ -72,13 +76,48 @@
 #include <probe/option.h>
 #include <oval_fts.h>
 #include <common/debug_priv.h>
+#include "common/list.h"
 #include "xmlfilecontent_probe.h"
 
 #define FILE_SEPARATOR '/'
 
+/*
+ * Several objects often query the same file, so the documents are parsed
+ * and stripped of namespaces once per scan and the XPath expressions are
+ * compiled once. A document is parsed again if the file has changed.
+ *
+ * The cache holds at most XML_CACHE_MAX_DOCS files and keeps the documents
+ * of at most XML_CACHE_MAX_SIZE bytes of files, the documents beyond that
+ * are parsed for each object and freed right after use.
+ */
+#define XML_CACHE_MAX_DOCS 1024
+#define XML_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+struct xml_doc {
+	dev_t dev;
+	ino_t ino;
+	off_t size;             /* -1 if the file couldn't be stat'ed */
+	struct timespec mtime;
+	struct timespec ctime;
+	xmlDoc *doc;            /* namespace-stripped document, NULL if not parsed */
+	bool kept;              /* the document stays in the cache after use */
+	bool shared;            /* the entry is in the cache table */
+	pthread_mutex_t lock;   /* held while the document is used */
+};
+
+struct xml_cache {
+	pthread_mutex_t lock;           /* protects the tables and the size */
+	xsltStylesheetPtr strip_ns;     /* removes the namespaces */
+	struct oscap_htable *docs;      /* path -> struct xml_doc */
+	struct oscap_htable *xpaths;    /* expression -> xmlXPathCompExpr */
+	size_t size;                    /* size of the files of the kept documents */
+};
+
 struct pfdata {
 	SEXP_t *filename_ent;
 	char *xpath;
+	xmlXPathCompExpr *xpath_comp;
+	struct xml_cache *cache;
         probe_ctx *ctx;
 };
 
@@ -91,24 +130,7 @@ int xmlfilecontent_probe_offline_mode_supported()
 	return PROBE_OFFLINE_OWN;
 }
 
-void *xmlfilecontent_probe_init(void)
-{
-	/* init libxml */
-	//LIBXML_TEST_VERSION;
-	xmlInitParser();
-	xmlSetGenericErrorFunc(NULL, dummy_err_func);
-
-	return NULL;
-}
-
-void xmlfilecontent_probe_fini(void *arg)
-{
-        (void)arg;
-	/* deinit libxml */
-	xmlCleanupParser();
-}
-
-static xmlDocPtr strip_ns(xmlDocPtr doc)
+static xsltStylesheetPtr strip_ns_stylesheet(void)
 {
 	const char template[] = 
 	"<xsl:stylesheet version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\">"
@@ -134,21 +156,210 @@ static xmlDocPtr strip_ns(xmlDocPtr doc)
 		xmlFreeDoc(stylesheet_doc);
 		return NULL;
 	}
+	return stylesheet;
+}
+
+static void xml_doc_free(void *ptr)
+{
+	struct xml_doc *xd = ptr;
+
+	if (xd->doc != NULL)
+		xmlFreeDoc(xd->doc);
+	pthread_mutex_destroy(&xd->lock);
+	free(xd);
+}
+
+static void xpath_comp_free(void *ptr)
+{
+	xmlXPathFreeCompExpr(ptr);
+}
+
+void *xmlfilecontent_probe_init(void)
+{
+	struct xml_cache *cache;
+
+	/* init libxml */
+	//LIBXML_TEST_VERSION;
+	xmlInitParser();
+	xmlSetGenericErrorFunc(NULL, dummy_err_func);
+
+	cache = malloc(sizeof(struct xml_cache));
+	if (cache == NULL)
+		return NULL;
+	if (pthread_mutex_init(&cache->lock, NULL) != 0) {
+		dD("Can't initialize mutex: errno=%u, %s.", errno, strerror(errno));
+		free(cache);
+		return NULL;
+	}
+	cache->strip_ns = strip_ns_stylesheet();
+	cache->docs = oscap_htable_new();
+	cache->xpaths = oscap_htable_new();
+	cache->size = 0;
+
+	return cache;
+}
+
+void xmlfilecontent_probe_fini(void *arg)
+{
+	struct xml_cache *cache = arg;
+
+	if (cache != NULL) {
+		oscap_htable_free(cache->docs, xml_doc_free);
+		oscap_htable_free(cache->xpaths, xpath_comp_free);
+		if (cache->strip_ns != NULL)
+			xsltFreeStylesheet(cache->strip_ns);
+		pthread_mutex_destroy(&cache->lock);
+		free(cache);
+	}
+	/* deinit libxml */
+	xmlCleanupParser();
+}
+
+static xmlDocPtr strip_ns(xsltStylesheetPtr stylesheet, xmlDocPtr doc)
+{
+	if (stylesheet == NULL)
+		return NULL;
 	xmlDocPtr result = xsltApplyStylesheet(stylesheet, doc, NULL);
 	if (result == NULL) {
 		fprintf(stderr, "Can't apply XSLT on the document\n");
 	}
-	xsltFreeStylesheet(stylesheet);
 	return result;
 }
 
+/*
+ * Get the compiled XPath expression, NULL if it can't be compiled. The
+ * expression stays valid until the probe is finalized.
+ */
+static xmlXPathCompExpr *xml_cache_xpath(struct xml_cache *cache, const char *xpath)
+{
+	xmlXPathCompExpr *comp;
+
+	pthread_mutex_lock(&cache->lock);
+	comp = oscap_htable_get(cache->xpaths, xpath);
+	if (comp == NULL) {
+		comp = xmlXPathCompile(BAD_CAST xpath);
+		if (comp != NULL && !oscap_htable_add(cache->xpaths, xpath, comp)) {
+			xmlXPathFreeCompExpr(comp);
+			comp = NULL;
+		}
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	return comp;
+}
+
+/*
+ * Get the locked cache entry of the file, the caller releases it with
+ * xml_cache_doc_release() when it is done with the document. The entry
+ * isn't shared if the cache is full.
+ */
+static struct xml_doc *xml_cache_doc(struct xml_cache *cache, const char *path)
+{
+	struct xml_doc *xd;
+
+	pthread_mutex_lock(&cache->lock);
+	xd = oscap_htable_get(cache->docs, path);
+	if (xd == NULL) {
+		xd = calloc(1, sizeof(struct xml_doc));
+		if (xd != NULL) {
+			pthread_mutex_init(&xd->lock, NULL);
+			if (oscap_htable_itemcount(cache->docs) < XML_CACHE_MAX_DOCS) {
+				if (!oscap_htable_add(cache->docs, path, xd)) {
+					xml_doc_free(xd);
+					xd = NULL;
+				} else {
+					xd->shared = true;
+				}
+			}
+		}
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	if (xd != NULL)
+		pthread_mutex_lock(&xd->lock);
+	return xd;
+}
+
+static void xml_cache_doc_release(struct xml_doc *xd)
+{
+	if (!xd->kept && xd->doc != NULL) {
+		xmlFreeDoc(xd->doc);
+		xd->doc = NULL;
+	}
+	pthread_mutex_unlock(&xd->lock);
+	if (!xd->shared)
+		xml_doc_free(xd);
+}
+
+/*
+ * Parse the file into the locked entry unless the document parsed before is
+ * still up to date. Returns -1 if the file can't be parsed and -2 if the
+ * namespaces can't be removed.
+ */
+static int xml_doc_load(struct xml_cache *cache, struct xml_doc *xd, const char *path)
+{
+	struct stat st;
+
+	if (stat(path, &st) != 0) {
+		memset(&st, 0, sizeof(st));
+		st.st_size = -1;
+	}
+
+	if (xd->doc != NULL) {
+		if (st.st_size != -1 && xd->size == st.st_size &&
+		    xd->dev == st.st_dev && xd->ino == st.st_ino &&
+		    xd->mtime.tv_sec == st.st_mtim.tv_sec && xd->mtime.tv_nsec == st.st_mtim.tv_nsec &&
+		    xd->ctime.tv_sec == st.st_ctim.tv_sec && xd->ctime.tv_nsec == st.st_ctim.tv_nsec)
+			return 0;
+		xmlFreeDoc(xd->doc);
+		xd->doc = NULL;
+		if (xd->kept) {
+			pthread_mutex_lock(&cache->lock);
+			cache->size -= xd->size;
+			pthread_mutex_unlock(&cache->lock);
+			xd->kept = false;
+		}
+	}
+
+	xmlDoc *doc = xmlParseFile(path);
+	if (doc == NULL)
+		return -1;
+
+	/* Remove the namespace from the examined document. The XPath expressions
+	 * will be evaluated as if the namespace is ignored. Even though the
+	 * xmlfilecontent should use standardized XPath, existing content expects
+	 * this behavior.
+	 */
+	xmlDoc *doc_no_ns = strip_ns(cache->strip_ns, doc);
+	xmlFreeDoc(doc);
+	if (doc_no_ns == NULL)
+		return -2;
+
+	xd->doc = doc_no_ns;
+	xd->dev = st.st_dev;
+	xd->ino = st.st_ino;
+	xd->size = st.st_size;
+	xd->mtime = st.st_mtim;
+	xd->ctime = st.st_ctim;
+
+	/* Keep the document for the other objects if it fits into the cache */
+	if (xd->shared && st.st_size != -1) {
+		pthread_mutex_lock(&cache->lock);
+		if (cache->size + (size_t) st.st_size <= XML_CACHE_MAX_SIZE) {
+			cache->size += st.st_size;
+			xd->kept = true;
+		}
+		pthread_mutex_unlock(&cache->lock);
+	}
+	return 0;
+}
+
 static int process_file(const char *prefix, const char *path, const char *filename, void *arg)
 {
 	struct pfdata *pfd = (struct pfdata *) arg;
 	int ret = 0, path_len, filename_len;
 	char *whole_path = NULL;
-	xmlDoc *doc = NULL;
-	xmlDoc *doc_no_ns = NULL;
+	struct xml_doc *xd = NULL;
 	xmlXPathContext *xpath_ctx = NULL;
 	xmlXPathObject *xpath_obj = NULL;
 	SEXP_t *item = NULL;
@@ -172,31 +383,26 @@ static int process_file(const char *prefix, const char *path, const char *filena
 	memcpy(whole_path + path_len, filename, filename_len + 1);
 
 	if (prefix == NULL) {
-		doc = xmlParseFile(whole_path);
+		xd = xml_cache_doc(pfd->cache, whole_path);
+		ret = (xd == NULL) ? -1 : xml_doc_load(pfd->cache, xd, whole_path);
 	} else {
 		char *path_with_prefix = oscap_path_join(prefix, whole_path);
-		doc = xmlParseFile(path_with_prefix);
+		xd = xml_cache_doc(pfd->cache, path_with_prefix);
+		ret = (xd == NULL) ? -1 : xml_doc_load(pfd->cache, xd, path_with_prefix);
 		free(path_with_prefix);
 	}
 
-	if (doc == NULL) {
+	if (ret == -1) {
                 SEXP_t *msg;
                 msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "Can't parse '%s'.", whole_path);
                 probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
                 SEXP_free(msg);
                 probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
 
-		ret = -1;
 		goto cleanup;
 	}
 
-	/* Remove the namespace from the examined document. The XPath expressions
-	 * will be evaluated as if the namespace is ignored. Even though the
-	 * xmlfilecontent should use standardized XPath, existing content expects
-	 * this behavior.
-	 */
-	doc_no_ns = strip_ns(doc);
-	if (doc_no_ns == NULL) {
+	if (ret == -2) {
 		SEXP_t *msg;
 		msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
 			"Can't remove namespaces from '%s'.", whole_path);
@@ -208,7 +414,7 @@ static int process_file(const char *prefix, const char *path, const char *filena
 	}
 
 	/* evaluate xpath */
-	xpath_ctx = xmlXPathNewContext(doc_no_ns);
+	xpath_ctx = xmlXPathNewContext(xd->doc);
 	if (xpath_ctx == NULL) {
                 SEXP_t *msg;
                 msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "xmlXPathNewContext() error.");
@@ -220,7 +426,7 @@ static int process_file(const char *prefix, const char *path, const char *filena
 		goto cleanup;
 	}
 
-	xpath_obj = xmlXPathEvalExpression(BAD_CAST pfd->xpath, xpath_ctx);
+	xpath_obj = (pfd->xpath_comp == NULL) ? NULL : xmlXPathCompiledEval(pfd->xpath_comp, xpath_ctx);
 	if (xpath_obj == NULL) {
                 SEXP_t *msg;
                 msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "xmlXPathEvalExpression() error");
@@ -333,10 +539,8 @@ static int process_file(const char *prefix, const char *path, const char *filena
 		xmlXPathFreeObject(xpath_obj);
 	if (xpath_ctx != NULL)
 		xmlXPathFreeContext(xpath_ctx);
-	if (doc != NULL)
-		xmlFreeDoc(doc);
-	if (doc_no_ns != NULL)
-		xmlFreeDoc(doc_no_ns);
+	if (xd != NULL)
+		xml_cache_doc_release(xd);
 	if (whole_path != NULL)
 		free(whole_path);
 
@@ -350,8 +554,10 @@ int xmlfilecontent_probe_main(probe_ctx *ctx, void *arg)
 
 	OVAL_FTS    *ofts;
 	OVAL_FTSENT *ofts_ent;
+	struct xml_cache *cache = arg;
 
-        (void)arg;
+	if (cache == NULL)
+		return PROBE_EINIT;
 
         probe_in = probe_ctx_getobject(ctx);
 
@@ -386,6 +592,8 @@ int xmlfilecontent_probe_main(probe_ctx *ctx, void *arg)
 	pfd.xpath = SEXP_string_cstr(r0 = probe_ent_getval(xpath_ent));
         SEXP_free (r0);
 
+	pfd.xpath_comp = xml_cache_xpath(cache, pfd.xpath);
+	pfd.cache = cache;
 	pfd.filename_ent = filename_ent;
         pfd.ctx = ctx;
 
@@ -512,6 +512,35 @@ static int process_pattern_match(const char *path, oscap_pcre_t **regex_out)
 #undef TEST_PATH1
 #undef TEST_PATH2
 
+/*
+ * The values of the path or filepath entity. Probes which handle all values
+ * of a variable at once get the whole list, other probes are run once for
+ * each value which is then selected by the val_idx attribute.
+ */
+static SEXP_t *oval_fts_ent_getvals(SEXP_t *ent)
+{
+	SEXP_t *vals, *val;
+
+	if (probe_ent_attrexists(ent, "val_idx")) {
+		val = probe_ent_getval(ent);
+		vals = SEXP_list_new(val, NULL);
+		SEXP_free(val);
+	} else {
+		probe_ent_getvals(ent, &vals);
+	}
+
+	return vals;
+}
+
+static void oval_fts_free_regexes(oscap_pcre_t **regexes, size_t regex_cnt)
+{
+	size_t i;
+
+	for (i = 0; i < regex_cnt; ++i)
+		oscap_pcre_free(regexes[i]);
+	free(regexes);
+}
+
 OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t *behaviors, SEXP_t* result)
 {
 	return oval_fts_open_prefixed(NULL, path, filename, filepath, behaviors, result);
@@ -524,9 +553,10 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 	char cstr_path[PATH_MAX+1];
 	char cstr_file[PATH_MAX+1];
 	char cstr_buff[32];
-	const char *paths[2] = { NULL, NULL };
+	char **paths;
+	size_t i, path_cnt = 0;
 
-	SEXP_t *r0;
+	SEXP_t *r0, *path_vals, *path_val;
 
 	int mtc_fts_options = FTS_PHYSICAL | FTS_COMFOLLOW | FTS_NOCHDIR;
 	int rec_fts_options = FTS_PHYSICAL | FTS_COMFOLLOW | FTS_NOCHDIR;
@@ -537,7 +567,9 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 
 	uint32_t path_op;
 	bool nilfilename = false;
-	oscap_pcre_t *regex = NULL;
+	bool prune;
+	oscap_pcre_t **regexes;
+	size_t regex_cnt = 0;
 	struct stat st;
 
 	if ((path != NULL || filename != NULL || filepath == NULL)
@@ -563,8 +595,6 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 	dD("path_op: %u, '%s'.", path_op, oval_operation_get_text(path_op));
 #endif
 	if (path) { /* filepath == NULL */
-		PROBE_ENT_STRVAL(path, cstr_path, sizeof cstr_path,
-				 return NULL;, return NULL;);
 		if (probe_ent_getvals(filename, NULL) == 0) {
 			nilfilename = true;
 		} else {
@@ -572,10 +602,8 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 					 return NULL;, /* noop */;);
 		}
 #if defined(OSCAP_FTS_DEBUG)
-		dD("path: '%s', filename: '%s', filename: %d.", cstr_path, nilfilename ? "" : cstr_file, nilfilename);
+		dD("filename: '%s', filename: %d.", nilfilename ? "" : cstr_file, nilfilename);
 #endif
-	} else { /* filepath != NULL */
-		PROBE_ENT_STRVAL(filepath, cstr_path, sizeof cstr_path, return NULL;, return NULL;);
 	}
 
 	/* max_depth */
@@ -672,32 +700,70 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 	   information to the user.
 	*/
 
-	if (path_op == OVAL_OPERATION_EQUALS) {
-		paths[0] = strdup(cstr_path);
-	} else if (path_op == OVAL_OPERATION_PATTERN_MATCH) {
-		if (process_pattern_match(cstr_path, &regex) != 0)
-			return NULL;
-		paths[0] = extract_fixed_path_prefix(cstr_path);
-		dD("Extracted fixed path: '%s'.", paths[0]);
-	} else {
-		paths[0] = strdup("/");
-	}
+	/*
+	 * Each value of the path or filepath entity gives a starting point
+	 * of the traversal. The values may come from a variable, equal
+	 * starting points are opened only once.
+	 */
+	path_vals = oval_fts_ent_getvals(path != NULL ? path : filepath);
+	paths = calloc(SEXP_list_length(path_vals) + 1, sizeof(char *));
+	regexes = calloc(SEXP_list_length(path_vals) + 1, sizeof(oscap_pcre_t *));
+	prune = (path_op == OVAL_OPERATION_PATTERN_MATCH);
 
-	if (prefix != NULL) {
-		char *path_with_prefix = oscap_path_join(prefix, paths[0]);
-		free((void *) paths[0]);
-		paths[0] = path_with_prefix;
-	}
-	dI("Opening file '%s'.", paths[0]);
-	/* Fail if the provided path doensn't actually exist. Symlinks
-	   without targets are accepted. */
-	if (lstat(paths[0], &st) == -1) {
-		if (errno) {
-			dD("lstat() failed: errno: %d, '%s'.",
-			   errno, strerror(errno));
+	SEXP_list_foreach(path_val, path_vals) {
+		oscap_pcre_t *regex = NULL;
+		char *root;
+
+		if (!SEXP_stringp(path_val) || SEXP_string_length(path_val) == 0)
+			continue;
+		SEXP_string_cstr_r(path_val, cstr_path, sizeof cstr_path);
+
+		if (path_op == OVAL_OPERATION_EQUALS) {
+			root = strdup(cstr_path);
+		} else if (path_op == OVAL_OPERATION_PATTERN_MATCH) {
+			if (process_pattern_match(cstr_path, &regex) != 0)
+				continue;
+			root = extract_fixed_path_prefix(cstr_path);
+			dD("Extracted fixed path: '%s'.", root);
+		} else {
+			root = strdup("/");
 		}
-		free((void *) paths[0]);
-		oscap_pcre_free(regex);
+
+		if (prefix != NULL) {
+			char *path_with_prefix = oscap_path_join(prefix, root);
+			free(root);
+			root = path_with_prefix;
+		}
+		dI("Opening file '%s'.", root);
+		/* Skip the paths which don't actually exist. Symlinks
+		   without targets are accepted. */
+		if (lstat(root, &st) == -1) {
+			if (errno) {
+				dD("lstat() failed: errno: %d, '%s'.",
+				   errno, strerror(errno));
+			}
+			free(root);
+			oscap_pcre_free(regex);
+			continue;
+		}
+
+		/* the partial match optimization needs a regex for each path */
+		if (regex != NULL)
+			regexes[regex_cnt++] = regex;
+		else
+			prune = false;
+
+		for (i = 0; i < path_cnt && strcmp(paths[i], root) != 0; ++i);
+		if (i < path_cnt)
+			free(root);
+		else
+			paths[path_cnt++] = root;
+	}
+	SEXP_free(path_vals);
+
+	if (path_cnt == 0) {
+		free(paths);
+		oval_fts_free_regexes(regexes, regex_cnt);
 		return NULL;
 	}
 
@@ -707,22 +773,31 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 	/* reset errno as fts_open() doesn't do it itself. */
 	errno = 0;
 	ofts->ofts_match_path_fts = fts_open((char * const *) paths, mtc_fts_options, NULL);
-	free((void *) paths[0]);
+	for (i = 0; i < path_cnt; ++i)
+		free(paths[i]);
+	free(paths);
 	/* fts_open() doesn't return NULL for all errors (e.g. nonexistent paths),
 	   so check errno to detect it. Far from being perfect. */
 	if (ofts->ofts_match_path_fts == NULL || errno != 0) {
 		dE("fts_open() failed, errno: %d \"%s\".", errno, strerror(errno));
 		OVAL_FTS_free(ofts);
-		oscap_pcre_free(regex);
+		oval_fts_free_regexes(regexes, regex_cnt);
 		return (NULL);
 	}
 
 	ofts->ofts_recurse_path_fts_opts = rec_fts_options;
 	ofts->ofts_path_op = path_op;
-	if (regex != NULL) {
-		ofts->ofts_path_regex = regex;
-		oscap_pcre_optimize(regex);
+	if (prune && regex_cnt > 0) {
+		for (i = 0; i < regex_cnt; ++i)
+			oscap_pcre_optimize(regexes[i]);
+		ofts->ofts_path_regex = regexes;
+		ofts->ofts_path_regex_cnt = regex_cnt;
+	} else {
+		oval_fts_free_regexes(regexes, regex_cnt);
 	}
+	/* the same file can be reached from several starting points */
+	if (path_cnt > 1)
+		ofts->ofts_visited = oscap_htable_new();
 
 	if (filesystem == OVAL_RECURSE_FS_LOCAL) {
 #if defined(OS_SOLARIS)
@@ -829,6 +904,12 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_FOLLOW);
 			continue;
 		}
+		/* with 'equals', only the starting points themselves can match */
+		if (ofts->ofts_path_op == OVAL_OPERATION_EQUALS)
+			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
+		if (fts_ent->fts_level == FTS_ROOTLEVEL
+		    && ofts->filesystem == OVAL_RECURSE_FS_DEFINED)
+			ofts->ofts_recurse_path_devid = fts_ent->fts_statp->st_dev;
 		if (_oval_fts_is_local(ofts, fts_ent)) {
 			dI("Don't recurse into non-local filesystems, skipping '%s'.", fts_ent->fts_path);
 			fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
@@ -845,11 +926,21 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 		const size_t shift = ofts->prefix ? strlen(ofts->prefix) : 0;
 		/* partial match optimization for OVAL_OPERATION_PATTERN_MATCH operation on path and filepath */
 		if (ofts->ofts_path_regex != NULL && fts_ent->fts_info == FTS_D) {
-			int ret, svec[3];
-
-			ret = oscap_pcre_exec(ofts->ofts_path_regex,
-					fts_ent->fts_path+shift, fts_ent->fts_pathlen-shift, 0, OSCAP_PCRE_OPTS_PARTIAL,
-					svec, sizeof(svec) / sizeof(svec[0]));
+			int ret = OSCAP_PCRE_ERR_NOMATCH, svec[3];
+			size_t i;
+
+			/* the directory is skipped only if none of the patterns can match below it */
+			for (i = 0; i < ofts->ofts_path_regex_cnt; ++i) {
+				int r = oscap_pcre_exec(ofts->ofts_path_regex[i],
+						fts_ent->fts_path+shift, fts_ent->fts_pathlen-shift, 0, OSCAP_PCRE_OPTS_PARTIAL,
+						svec, sizeof(svec) / sizeof(svec[0]));
+				if (r >= 0 || (r != OSCAP_PCRE_ERR_NOMATCH && r != OSCAP_PCRE_ERR_PARTIAL)) {
+					ret = r;
+					break;
+				}
+				if (r == OSCAP_PCRE_ERR_PARTIAL)
+					ret = r;
+			}
 			if (ret < 0) {
 				switch (ret) {
 				case OSCAP_PCRE_ERR_NOMATCH:
@@ -882,7 +973,7 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 
 		if (ores == OVAL_RESULT_TRUE)
 			break;
-		if (ofts->ofts_path_op == OVAL_OPERATION_EQUALS) {
+		if (ofts->ofts_path_op == OVAL_OPERATION_EQUALS && ofts->ofts_visited == NULL) {
 			/* At this point the comparison result isn't OVAL_RESULT_TRUE. Since
 			we passed the exact path (from filepath or path elements) to
 			fts_open() we surely know that we can't find other items that would
@@ -1178,6 +1269,15 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 	return out_fts_ent;
 }
 
+/* Check whether an entry was returned already from another starting point */
+static bool oval_fts_visited(OVAL_FTS *ofts, FTSENT *fts_ent)
+{
+	if (ofts->ofts_visited == NULL)
+		return false;
+
+	return !oscap_htable_add(ofts->ofts_visited, fts_ent->fts_path, ofts);
+}
+
 OVAL_FTSENT *oval_fts_read(OVAL_FTS *ofts)
 {
 	FTSENT *fts_ent;
@@ -1205,17 +1305,21 @@ OVAL_FTSENT *oval_fts_read(OVAL_FTS *ofts)
 					&fts_ent->fts_statp->st_dev : NULL))) {
 				continue;
 			}
+			if (oval_fts_visited(ofts, fts_ent))
+				continue;
 			break;
 		} else {
 			fts_ent = oval_fts_read_recurse_path(ofts);
-			if (fts_ent != NULL)
+			if (fts_ent != NULL) {
+				if (oval_fts_visited(ofts, fts_ent))
+					continue;
 				break;
+			}
 
 			ofts->ofts_match_path_fts_ent = NULL;
 
-			// todo: is this true when variables are used?
-			/* with 'equals', there's only one potential target */
-			if (ofts->ofts_path_op == OVAL_OPERATION_EQUALS)
+			/* with 'equals' and a single value, there's only one potential target */
+			if (ofts->ofts_path_op == OVAL_OPERATION_EQUALS && ofts->ofts_visited == NULL)
 				return (NULL);
 		}
 	}
@@ -1234,7 +1338,9 @@ int oval_fts_close(OVAL_FTS *ofts)
 		free(ofts->ofts_recurse_path_pthcpy);
 
 	if (ofts->ofts_path_regex)
-		oscap_pcre_free(ofts->ofts_path_regex);
+		oval_fts_free_regexes(ofts->ofts_path_regex, ofts->ofts_path_regex_cnt);
+	if (ofts->ofts_visited)
+		oscap_htable_free0(ofts->ofts_visited);
 
 	if (ofts->ofts_spath != NULL)
 		SEXP_free(ofts->ofts_spath);
@@ -32,6 +32,7 @@
 #endif
 #include "fsdev.h"
 #include "common/oscap_pcre.h"
+#include "common/list.h"
 
 #define ENT_GET_AREF(ent, dst, attr_name, mandatory)			\
 	do {								\
@@ -78,8 +79,11 @@ typedef struct {
 	char *ofts_recurse_path_curpth;
 	dev_t ofts_recurse_path_devid;
 
-	oscap_pcre_t *ofts_path_regex;
+	oscap_pcre_t **ofts_path_regex;
+	size_t ofts_path_regex_cnt;
 	uint32_t ofts_path_op;
+	/* paths already returned when there are several starting points */
+	struct oscap_htable *ofts_visited;
 
 	SEXP_t *ofts_spath;
 	SEXP_t *ofts_sfilename;
@@ -230,7 +230,8 @@ bool probe_item_filtered(const SEXP_t *item, const SEXP_t *filters)
 	SEXP_t *filter, *ste;
 
 	SEXP_list_foreach(filter, filters) {
-		SEXP_t *felm, *ste_res, *r0;
+		SEXP_t *felm, *r0;
+		struct probe_ent_results ste_res;
 		oval_result_t ores;
 		oval_operator_t oopr;
 		oval_filter_action_t ofact;
@@ -239,31 +240,33 @@ bool probe_item_filtered(const SEXP_t *item, const SEXP_t *filters)
 		ofact = SEXP_number_getu(r0);
 		SEXP_free(r0);
 		ste = SEXP_list_nth(filter, 2);
-		ste_res = SEXP_list_new(NULL);
+		memset(&ste_res, 0, sizeof(ste_res));
 
+		/* the results are counted, the items are filtered without allocating result lists */
 		SEXP_sublist_foreach(felm, ste, 2, SEXP_LIST_END) {
-			SEXP_t *ielm, *elm_res;
-			char *elm_name;
+			SEXP_t *ielm;
+			struct probe_ent_results elm_res;
+			char elm_name[256], *elm_name_p = elm_name;
 			oval_check_t ochk;
+			size_t name_len;
 			int i;
 
-			elm_res = SEXP_list_new(NULL);
-			elm_name = probe_ent_getname(felm);
+			memset(&elm_res, 0, sizeof(elm_res));
+			name_len = probe_ent_getname_r(felm, elm_name, sizeof(elm_name));
+			if (name_len == 0 || name_len == (size_t) -1)
+				elm_name_p = probe_ent_getname(felm);
 
 			for (i = 1;; ++i) {
-				ielm = probe_obj_getent(item, elm_name, i);
+				ielm = probe_obj_getent(item, elm_name_p, i);
 
 				if (ielm == NULL)
 					break;
 
-				ores = probe_entste_cmp(felm, ielm);
-				SEXP_list_add(elm_res, r0 = SEXP_number_newi_32(ores));
-
+				probe_ent_results_add(&elm_res, probe_entste_cmp(felm, ielm));
 				SEXP_free(ielm);
-				SEXP_free(r0);
 			}
 
-			if (SEXP_list_length(elm_res) > 0) {
+			if (i > 1) {
 				r0 = probe_ent_getattrval(felm, "entity_check");
 
 				if (r0 == NULL)
@@ -273,14 +276,13 @@ bool probe_item_filtered(const SEXP_t *item, const SEXP_t *filters)
 
 				SEXP_free(r0);
 
-				ores = probe_ent_result_bychk(elm_res, ochk);
+				ores = probe_ent_results_bychk(&elm_res, ochk);
 			} else {
 				ores = OVAL_RESULT_FALSE;
 			}
-			SEXP_list_add(ste_res, r0 = SEXP_number_newi_32(ores));
-			SEXP_free(r0);
-			SEXP_free(elm_res);
-			free(elm_name);
+			probe_ent_results_add(&ste_res, ores);
+			if (elm_name_p != elm_name)
+				free(elm_name_p);
 		}
 
 		r0 = probe_ent_getattrval(ste, "operator");
@@ -288,9 +290,8 @@ bool probe_item_filtered(const SEXP_t *item, const SEXP_t *filters)
 			oopr = OVAL_OPERATOR_AND;
 		else
 			oopr = SEXP_number_geti_32(r0);
-		ores = probe_ent_result_byopr(ste_res, oopr);
+		ores = probe_ent_results_byopr(&ste_res, oopr);
 		SEXP_free(ste);
-		SEXP_free(ste_res);
 		SEXP_free(r0);
 
 		if ((ores == OVAL_RESULT_TRUE && ofact == OVAL_FILTER_ACTION_EXCLUDE)
@@ -221,7 +221,7 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_INDEPENDENT_ENVIRONMENT_VARIABLE, NULL, environmentvariable_probe_main, NULL, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_INDEPENDENT_ENVIRONMENTVARIABLE58
-	{OVAL_INDEPENDENT_ENVIRONMENT_VARIABLE58, NULL, environmentvariable58_probe_main, NULL, environmentvariable58_probe_offline_mode_supported},
+	{OVAL_INDEPENDENT_ENVIRONMENT_VARIABLE58, NULL, environmentvariable58_probe_main, environmentvariable58_probe_fini, environmentvariable58_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_INDEPENDENT_FAMILY
 	{OVAL_INDEPENDENT_FAMILY, NULL, family_probe_main, NULL, family_probe_offline_mode_supported},
@@ -257,13 +257,13 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_INDEPENDENT_YAML_FILE_CONTENT, NULL, yamlfilecontent_probe_main, NULL, yamlfilecontent_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_DPKGINFO
-	{OVAL_LINUX_DPKG_INFO, NULL, dpkginfo_probe_main, NULL, dpkginfo_probe_offline_mode_supported},
+	{OVAL_LINUX_DPKG_INFO, NULL, dpkginfo_probe_main, dpkginfo_probe_fini, dpkginfo_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_IFLISTENERS
 	{OVAL_LINUX_IFLISTENERS, NULL, iflisteners_probe_main, NULL, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_INETLISTENINGSERVERS
-	{OVAL_LINUX_INET_LISTENING_SERVERS, NULL, inetlisteningservers_probe_main, NULL, NULL},
+	{OVAL_LINUX_INET_LISTENING_SERVERS, NULL, inetlisteningservers_probe_main, inetlisteningservers_probe_fini, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_PARTITION
 	{OVAL_LINUX_PARTITION, NULL, partition_probe_main, NULL, patition_probe_offline_mode_supported},
@@ -287,10 +287,10 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_LINUX_SELINUXSECURITYCONTEXT, NULL, selinuxsecuritycontext_probe_main, NULL, selinuxsecuritycontext_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_SYSTEMDUNITDEPENDENCY
-	{OVAL_LINUX_SYSTEMDUNITDEPENDENCY, NULL, systemdunitdependency_probe_main, NULL, systemdunitdependency_probe_offline_mode_supported},
+	{OVAL_LINUX_SYSTEMDUNITDEPENDENCY, NULL, systemdunitdependency_probe_main, systemdunitdependency_probe_fini, systemdunitdependency_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_SYSTEMDUNITPROPERTY
-	{OVAL_LINUX_SYSTEMDUNITPROPERTY, NULL, systemdunitproperty_probe_main, NULL, systemdunitproperty_probe_offline_mode_supported},
+	{OVAL_LINUX_SYSTEMDUNITPROPERTY, NULL, systemdunitproperty_probe_main, systemdunitproperty_probe_fini, systemdunitproperty_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_FWUPDSECURITYATTR
 	{OVAL_LINUX_FWUPDSECATTR, NULL, fwupdsecattr_probe_main, NULL, NULL},
@@ -314,13 +314,13 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_UNIX_INTERFACE, NULL, interface_probe_main, NULL, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_PASSWORD
-	{OVAL_UNIX_PASSWORD, NULL, password_probe_main, NULL, password_probe_offline_mode_supported},
+	{OVAL_UNIX_PASSWORD, NULL, password_probe_main, password_probe_fini, password_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_PROCESS
 	{OVAL_UNIX_PROCESS, NULL, process_probe_main, NULL, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_PROCESS58
-	{OVAL_UNIX_PROCESS58, NULL, process58_probe_main, NULL, process58_probe_offline_mode_supported},
+	{OVAL_UNIX_PROCESS58, NULL, process58_probe_main, process58_probe_fini, process58_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_ROUTINGTABLE
 	{OVAL_UNIX_ROUTINGTABLE, NULL, routingtable_probe_main, NULL, NULL},
@@ -329,7 +329,7 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_UNIX_RUNLEVEL, NULL, runlevel_probe_main, NULL, runlevel_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_SHADOW
-	{OVAL_UNIX_SHADOW, NULL, shadow_probe_main, NULL, shadow_probe_offline_mode_supported},
+	{OVAL_UNIX_SHADOW, NULL, shadow_probe_main, shadow_probe_fini, shadow_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_SYMLINK
 	{OVAL_UNIX_SYMLINK, NULL, symlink_probe_main, NULL, symlink_probe_offline_mode_supported},
@@ -355,6 +355,36 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_SUBTYPE_UNKNOWN, NULL, NULL, NULL, NULL}
 };
 
+typedef struct probe_multival_entry {
+	oval_subtype_t type;
+	const char * const *entities;
+} probe_multival_entry_t;
+
+/*
+ * Probes which handle all values of a variable referenced by some of the
+ * object entities in a single run. The worker runs the other probes once
+ * for each combination of the values.
+ */
+static const probe_multival_entry_t probe_multival_table[] = {
+	/* {type, entities} */
+#ifdef OPENSCAP_PROBE_INDEPENDENT_FILEHASH58
+	{OVAL_INDEPENDENT_FILE_HASH58, filehash58_probe_multival_entities},
+#endif
+#ifdef OPENSCAP_PROBE_INDEPENDENT_TEXTFILECONTENT54
+	{OVAL_INDEPENDENT_TEXT_FILE_CONTENT_54, textfilecontent54_probe_multival_entities},
+#endif
+#ifdef OPENSCAP_PROBE_LINUX_RPMINFO
+	{OVAL_LINUX_RPM_INFO, rpminfo_probe_multival_entities},
+#endif
+#ifdef OPENSCAP_PROBE_UNIX_FILE
+	{OVAL_UNIX_FILE, file_probe_multival_entities},
+#endif
+#ifdef OPENSCAP_PROBE_UNIX_SYSCTL
+	{OVAL_UNIX_SYSCTL, sysctl_probe_multival_entities},
+#endif
+	{OVAL_SUBTYPE_UNKNOWN, NULL}
+};
+
 static const probe_table_entry_t *probe_table_get(oval_subtype_t type)
 {
 	const probe_table_entry_t *entry = probe_table;
@@ -389,6 +419,16 @@ probe_offline_mode_function_t probe_table_get_offline_mode_function(oval_subtype
 	return entry->probe_offline_mode_function;
 }
 
+const char * const *probe_table_get_multival_entities(oval_subtype_t type)
+{
+	const probe_multival_entry_t *entry = probe_multival_table;
+	while (entry->entities != NULL && entry->type != type)
+	{
+		entry++;
+	}
+	return entry->entities;
+}
+
 void probe_table_list(FILE *output)
 {
 	const probe_table_entry_t *entry = probe_table;
@@ -226,7 +226,8 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
 {
 	oval_operation_t op;
 	oval_datatype_t dtype;
-	SEXP_t *stmp, *val1, *vals, *res_lst, *r0;
+	SEXP_t *stmp, *val1, *vals;
+	struct probe_ent_results res_cnt;
 	int val_cnt, is_var;
 	oval_check_t ochk;
 	oval_result_t ores, result;
@@ -254,7 +255,7 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
 	else
 		op = SEXP_number_geti_32(stmp);
         SEXP_free(stmp);
-	res_lst = SEXP_list_new(NULL);
+	memset(&res_cnt, 0, sizeof(res_cnt));
 
 	SEXP_list_foreach(val1, vals) {
 		if (SEXP_typeof(val1) != SEXP_typeof(val2)) {
@@ -263,15 +264,13 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
 
                         SEXP_free(vals);
                         SEXP_free(val1);
-                        SEXP_free(res_lst);
 
 			return OVAL_RESULT_ERROR;
 		}
 
 		ores = probe_ent_cmp_single(val1, dtype, val2, op);
 
-		SEXP_list_add(res_lst, r0 = SEXP_number_newi_32(ores));
-                SEXP_free(r0);
+		probe_ent_results_add(&res_cnt, ores);
 	}
 
 	if (is_var) {
@@ -283,12 +282,11 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
 			SEXP_free(stmp);
 		}
 
-		result = probe_ent_result_bychk(res_lst, ochk);
+		result = probe_ent_results_bychk(&res_cnt, ochk);
 	} else {
 		result = ores;
 	}
 
-	SEXP_free(res_lst);
         SEXP_free(vals);
 
 	return result;
@@ -452,51 +450,57 @@ oval_result_t probe_entobj_cmp(SEXP_t * ent_obj, SEXP_t * val)
 	return ores;
 }
 
-struct _oresults {
-	int true_cnt, false_cnt, unknown_cnt, error_cnt, noteval_cnt, notappl_cnt;
-};
+void probe_ent_results_add(struct probe_ent_results *ores, oval_result_t r)
+{
+	switch (r) {
+	case OVAL_RESULT_TRUE:
+		++(ores->true_cnt);
+		break;
+	case OVAL_RESULT_FALSE:
+		++(ores->false_cnt);
+		break;
+	case OVAL_RESULT_UNKNOWN:
+		++(ores->unknown_cnt);
+		break;
+	case OVAL_RESULT_ERROR:
+		++(ores->error_cnt);
+		break;
+	case OVAL_RESULT_NOT_EVALUATED:
+		++(ores->noteval_cnt);
+		break;
+	case OVAL_RESULT_NOT_APPLICABLE:
+		++(ores->notappl_cnt);
+		break;
+	default:
+		++(ores->invalid_cnt);
+		break;
+	}
+}
 
-static int results_parser(SEXP_t * res_lst, struct _oresults *ores)
+static int results_parser(SEXP_t * res_lst, struct probe_ent_results *ores)
 {
-	oval_result_t r;
 	SEXP_t *res;
 
-	memset(ores, 0, sizeof(struct _oresults));
+	memset(ores, 0, sizeof(struct probe_ent_results));
 
 	SEXP_list_foreach(res, res_lst) {
-		r = SEXP_number_geti_32(res);
-		switch (r) {
-		case OVAL_RESULT_TRUE:
-			++(ores->true_cnt);
-			break;
-		case OVAL_RESULT_FALSE:
-			++(ores->false_cnt);
-			break;
-		case OVAL_RESULT_UNKNOWN:
-			++(ores->unknown_cnt);
-			break;
-		case OVAL_RESULT_ERROR:
-			++(ores->error_cnt);
-			break;
-		case OVAL_RESULT_NOT_EVALUATED:
-			++(ores->noteval_cnt);
-			break;
-		case OVAL_RESULT_NOT_APPLICABLE:
-			++(ores->notappl_cnt);
-			break;
-		default:
-			return -1;
-		}
+		probe_ent_results_add(ores, SEXP_number_geti_32(res));
 	}
 
-	return 0;
+	return ores->invalid_cnt == 0 ? 0 : -1;
+}
+
+static inline bool results_empty(const struct probe_ent_results *ores)
+{
+	return ores->true_cnt == 0 && ores->false_cnt == 0 && ores->unknown_cnt == 0 &&
+	       ores->error_cnt == 0 && ores->noteval_cnt == 0 && ores->notappl_cnt == 0 &&
+	       ores->invalid_cnt == 0;
 }
 
 // todo: already implemented elsewhere; consolidate
 oval_result_t probe_ent_result_bychk(SEXP_t * res_lst, oval_check_t check)
 {
-	oval_result_t result = OVAL_RESULT_UNKNOWN;
-	struct _oresults ores;
+	struct probe_ent_results ores;
 
 	if (SEXP_list_length(res_lst) == 0)
 		return OVAL_RESULT_UNKNOWN;
@@ -505,6 +509,19 @@ oval_result_t probe_ent_result_bychk(SEXP_t * res_lst, oval_check_t check)
 		return OVAL_RESULT_ERROR;
 	}
 
+	return probe_ent_results_bychk(&ores, check);
+}
+
+oval_result_t probe_ent_results_bychk(const struct probe_ent_results *res, oval_check_t check)
+{
+	oval_result_t result = OVAL_RESULT_UNKNOWN;
+	const struct probe_ent_results ores = *res;
+
+	if (results_empty(&ores))
+		return OVAL_RESULT_UNKNOWN;
+	if (ores.invalid_cnt > 0)
+		return OVAL_RESULT_ERROR;
+
 	if (ores.notappl_cnt > 0 &&
 	    ores.noteval_cnt == 0 &&
 	    ores.false_cnt == 0 && ores.error_cnt == 0 && ores.unknown_cnt == 0 && ores.true_cnt == 0)
@@ -584,8 +601,7 @@ oval_result_t probe_ent_result_bychk(SEXP_t * res_lst, oval_check_t check)
 // todo: already implemented elsewhere; consolidate
 oval_result_t probe_ent_result_byopr(SEXP_t * res_lst, oval_operator_t operator)
 {
-	oval_result_t result = OVAL_RESULT_UNKNOWN;
-	struct _oresults ores;
+	struct probe_ent_results ores;
 
 	if (SEXP_list_length(res_lst) == 0)
 		return OVAL_RESULT_UNKNOWN;
@@ -594,6 +610,19 @@ oval_result_t probe_ent_result_byopr(SEXP_t * res_lst, oval_operator_t operator)
 		return OVAL_RESULT_ERROR;
 	}
 
+	return probe_ent_results_byopr(&ores, operator);
+}
+
+oval_result_t probe_ent_results_byopr(const struct probe_ent_results *res, oval_operator_t operator)
+{
+	oval_result_t result = OVAL_RESULT_UNKNOWN;
+	const struct probe_ent_results ores = *res;
+
+	if (results_empty(&ores))
+		return OVAL_RESULT_UNKNOWN;
+	if (ores.invalid_cnt > 0)
+		return OVAL_RESULT_ERROR;
+
 	if (ores.notappl_cnt > 0 &&
 	    ores.noteval_cnt == 0 &&
 	    ores.false_cnt == 0 && ores.error_cnt == 0 && ores.unknown_cnt == 0 && ores.true_cnt == 0)
@@ -35,6 +35,29 @@
 #include "oval_definitions.h"
 #include "oval_results.h"
 
+/**
+ * Results counted without allocating a results vector.
+ * Initialize with zeroes and add the results with probe_ent_results_add().
+ */
+struct probe_ent_results {
+	int true_cnt, false_cnt, unknown_cnt, error_cnt, noteval_cnt, notappl_cnt;
+	int invalid_cnt;
+};
+
+void probe_ent_results_add(struct probe_ent_results *ores, oval_result_t res);
+
+/**
+ * Compute the overall result of the counted results, the same way as
+ * probe_ent_result_bychk() does for a results vector.
+ */
+oval_result_t probe_ent_results_bychk(const struct probe_ent_results *ores, oval_check_t check);
+
+/**
+ * Compute the overall result of the counted results, the same way as
+ * probe_ent_result_byopr() does for a results vector.
+ */
+oval_result_t probe_ent_results_byopr(const struct probe_ent_results *ores, oval_operator_t operator);
+
 /**
  * Compute the overall result.
  * Compute the overall result from a results vector and a check enumeration parameter.
@@ -25,6 +25,8 @@
 #endif
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sexp.h>
 
 #include "../SEAP/generic/rbt/rbt.h"
@@ -77,7 +79,23 @@ int probe_rcache_sexp_add(probe_rcache_t *cache, const SEXP_t *id, SEXP_t *item)
 
 int probe_rcache_cstr_add(probe_rcache_t *cache, const char *id, SEXP_t * item)
 {
-	return (-1);
+        SEXP_t *r;
+        char   *k;
+
+	if (cache == NULL || id == NULL || item == NULL) {
+		return -1;
+	}
+
+        k = strdup(id);
+        r = SEXP_ref(item);
+
+        if (rbt_str_add(cache->tree, k, (void *)r) != 0) {
+                SEXP_free(r);
+                free(k);
+                return (-1);
+        }
+
+	return (0);
 }
 
 int probe_rcache_sexp_del(probe_rcache_t *cache, const SEXP_t * id)
@@ -46,6 +46,8 @@ extern int chroot(const char *);
 
 #include "probe-api.h"
 #include "common/debug_priv.h"
+#include "common/list.h"
+#include "common/oscap_string.h"
 #include "entcmp.h"
 
 #include "worker.h"
@@ -114,18 +116,10 @@ void *probe_worker_runfn(void *arg)
 		dD("probe_worker_runfn has finished");
                 return (NULL);
 	} else {
-                SEXP_t *items;
-
 		dD("probe thread deleted");
 
 		obj = SEAP_msg_get(pair->pth->msg);
 		oid = probe_obj_getattrval(obj, "id");
-                items = probe_cobj_get_items(probe_res);
-
-                if (items != NULL) {
-                        SEXP_list_sort(items, SEXP_refcmp);
-                        SEXP_free(items);
-                }
 
 		if (probe_rcache_sexp_add(pair->probe->rcache, oid, probe_res) != 0) {
 			/* TODO */
@@ -202,18 +196,99 @@ struct probe_varref_ctx {
 
 struct probe_varref_ctx_ent {
 	SEXP_t *ent_name_sref;
-	unsigned int val_cnt;
+	unsigned int val_cnt;     /**< number of distinct values */
+	unsigned int *val_idx;    /**< indexes of the distinct values */
 	unsigned int next_val_idx;
 };
 
 static void probe_varref_destroy_ctx(struct probe_varref_ctx *ctx);
 
-static int probe_varref_create_ctx(const SEXP_t *probe_in, SEXP_t *varrefs, struct probe_varref_ctx **octx)
+/**
+ * Check whether the probe handles all values of the entity at once.
+ */
+static bool probe_varref_multival(const SEXP_t *ent, const char * const *multival_ents)
+{
+	char name[64];
+
+	if (multival_ents == NULL)
+		return false;
+	if (probe_ent_getname_r(ent, name, sizeof name) == 0)
+		return false;
+
+	for (; *multival_ents != NULL; ++multival_ents) {
+		if (strcmp(*multival_ents, name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Find the indexes of the distinct values in a list of variable values, so
+ * that the probe isn't run several times with the same combination of values.
+ * An empty list still gets one (invalid) index, the probe reports the missing value.
+ * @return the number of distinct values
+ */
+static unsigned int probe_varref_distinct(SEXP_t *val_lst, unsigned int val_cnt, unsigned int **val_idx)
+{
+	unsigned int i, j, cnt = 0;
+	unsigned int *idx;
+	SEXP_t **vals, *val;
+	struct oscap_htable *seen;
+
+	idx = malloc((val_cnt > 0 ? val_cnt : 1) * sizeof(unsigned int));
+	idx[0] = 0;
+	*val_idx = idx;
+	if (val_cnt <= 1)
+		return 1;
+
+	vals = malloc(val_cnt * sizeof(SEXP_t *));
+	seen = oscap_htable_new();
+	i = 0;
+	SEXP_list_foreach(val, val_lst) {
+		if (i == val_cnt) {
+			SEXP_free(val);
+			break;
+		}
+		vals[i] = SEXP_ref(val);
+
+		if (SEXP_stringp(val)) {
+			char *str = SEXP_string_cstr(val);
+
+			if (str != NULL && oscap_htable_add(seen, str, vals[i]))
+				idx[cnt++] = i;
+			free(str);
+		} else {
+			for (j = 0; j < cnt; ++j) {
+				if (SEXP_deepcmp(vals[idx[j]], val))
+					break;
+			}
+			if (j == cnt)
+				idx[cnt++] = i;
+		}
+		++i;
+	}
+	/* the value list is shorter than announced */
+	if (i < val_cnt) {
+		for (j = i; j < val_cnt; ++j)
+			idx[cnt++] = j;
+	}
+
+	for (j = 0; j < i; ++j)
+		SEXP_free(vals[j]);
+	free(vals);
+	oscap_htable_free0(seen);
+
+	return cnt;
+}
+
+static int probe_varref_create_ctx(const SEXP_t *probe_in, SEXP_t *varrefs, const char * const *multival_ents, struct probe_varref_ctx **octx)
 {
 	unsigned int i, ent_cnt, val_cnt;
 	SEXP_t *ent_name, *ent, *varref, *val_lst;
 	SEXP_t *r0, *r1, *r2, *r3;
 	SEXP_t *vid, *vidx_name, *vidx_val;
+	bool multival;
 
 	/* varref_cnt = SEXP_number_getu_32(r0 = SEXP_list_nth(varrefs, 2)); */
 	ent_cnt = SEXP_number_getu_32(r1 = SEXP_list_nth(varrefs, 3));
@@ -224,7 +299,8 @@ static int probe_varref_create_ctx(const SEXP_t *probe_in, SEXP_t *varrefs, stru
 
 	struct probe_varref_ctx *ctx = malloc(sizeof(struct probe_varref_ctx));
 	ctx->pi2 = SEXP_softref((SEXP_t *)probe_in);
-	ctx->ent_cnt = ent_cnt;
+	/* only the entities which the probe can't handle at once are iterated */
+	ctx->ent_cnt = 0;
 	ctx->ent_lst = malloc(ent_cnt * sizeof (ctx->ent_lst[0]));
 
 	vidx_name = SEXP_string_new(":val_idx", 8);
@@ -238,17 +314,22 @@ static int probe_varref_create_ctx(const SEXP_t *probe_in, SEXP_t *varrefs, stru
 		 */
 		r0 = SEXP_list_nth(ctx->pi2, i + 2);
 		vid = probe_ent_getattrval(r0, "var_ref");
+		multival = probe_varref_multival(r0, multival_ents);
 		r1 = SEXP_list_first(r0);
-		r2 = SEXP_list_first(r1);
-
-		r3 = SEXP_list_new(r2, vidx_name, vidx_val, NULL);
-		SEXP_free(r0);
-		r0 = SEXP_list_rest(r1);
-		ent_name = SEXP_list_join(r3, r0);
 		SEXP_free(r0);
+
+		if (multival) {
+			ent_name = SEXP_ref(r1);
+		} else {
+			r2 = SEXP_list_first(r1);
+			r3 = SEXP_list_new(r2, vidx_name, vidx_val, NULL);
+			r0 = SEXP_list_rest(r1);
+			ent_name = SEXP_list_join(r3, r0);
+			SEXP_free(r0);
+			SEXP_free(r2);
+			SEXP_free(r3);
+		}
 		SEXP_free(r1);
-		SEXP_free(r2);
-		SEXP_free(r3);
 
 		SEXP_sublist_foreach(varref, varrefs, 4, SEXP_LIST_END) {
 			r0 = SEXP_list_first(varref);
@@ -281,17 +362,21 @@ static int probe_varref_create_ctx(const SEXP_t *probe_in, SEXP_t *varrefs, stru
 
 		ent = SEXP_list_new(ent_name, val_lst, NULL);
 		SEXP_free(ent_name);
-		SEXP_free(val_lst);
 
 		r0 = SEXP_list_replace(ctx->pi2, i + 2, ent);
 		SEXP_free(r0);
 		SEXP_free(ent);
 
-		r0 = SEXP_listref_nth(ctx->pi2, i + 2);
-		ctx->ent_lst[i].ent_name_sref = SEXP_listref_first(r0);
-		SEXP_free(r0);
-		ctx->ent_lst[i].val_cnt = val_cnt;
-		ctx->ent_lst[i].next_val_idx = 0;
+		if (!multival) {
+			struct probe_varref_ctx_ent *ctx_ent = &ctx->ent_lst[ctx->ent_cnt++];
+
+			r0 = SEXP_listref_nth(ctx->pi2, i + 2);
+			ctx_ent->ent_name_sref = SEXP_listref_first(r0);
+			SEXP_free(r0);
+			ctx_ent->val_cnt = probe_varref_distinct(val_lst, val_cnt, &ctx_ent->val_idx);
+			ctx_ent->next_val_idx = 0;
+		}
+		SEXP_free(val_lst);
 	}
 
 	SEXP_free(vidx_name);
@@ -313,6 +398,7 @@ static void probe_varref_destroy_ctx(struct probe_varref_ctx *ctx)
 
 	while (ent != ent_end) {
 		SEXP_free(ent->ent_name_sref);
+		free(ent->val_idx);
 		++ent;
 	}
 
@@ -327,6 +413,10 @@ static int probe_varref_iterate_ctx(struct probe_varref_ctx *ctx)
 	SEXP_t *r0, *r1, *r2;
 	struct probe_varref_ctx_ent *ent, *ent_end;
 
+	/* the probe has got all values at once */
+	if (ctx->ent_cnt == 0)
+		return 0;
+
 	ent = ctx->ent_lst;
 	ent_end = ent + ctx->ent_cnt;
 	val_cnt = ent->val_cnt;
@@ -349,7 +439,7 @@ static int probe_varref_iterate_ctx(struct probe_varref_ctx *ctx)
 		next_val_idx = &ent->next_val_idx;
 		ent_name_sref = ent->ent_name_sref;
 	}
-	r1 = SEXP_list_replace(ent_name_sref, 3, r2 = SEXP_number_newu(*next_val_idx));
+	r1 = SEXP_list_replace(ent_name_sref, 3, r2 = SEXP_number_newu(ent->val_idx[*next_val_idx]));
 
 	SEXP_free(r0);
 	SEXP_free(r1);
@@ -488,7 +578,65 @@ static SEXP_t *probe_prepare_filters(probe_t *probe, SEXP_t *obj)
 }
 
 /**
- * Combine two collections of items using an operation.
+ * Get the ID assigned to an item by the item cache.
+ * @param item the item
+ * @param buffer storage for the ID
+ * @param buflen size of the buffer
+ * @return false if the item doesn't have an ID
+ */
+static bool probe_set_item_id(const SEXP_t *item, char *buffer, size_t buflen)
+{
+	SEXP_t *id;
+	size_t len;
+
+	if ((id = probe_ent_getattrval(item, "id")) == NULL)
+		return false;
+
+	len = SEXP_string_cstr_r(id, buffer, buflen);
+	SEXP_free(id);
+
+	return len != 0 && len != (size_t)-1;
+}
+
+/**
+ * Add the ID of an item to a hash set of item IDs. The values stored in
+ * the hash set only mark the presence of a key.
+ * @param index the hash set
+ * @param item the item
+ * @retval true if the ID wasn't in the set or the item doesn't have an ID
+ * @retval false if the ID was already in the set
+ */
+static bool probe_set_index_add(struct oscap_htable *index, const SEXP_t *item)
+{
+	char id[64];
+
+	if (!probe_set_item_id(item, id, sizeof id))
+		return true;
+
+	return oscap_htable_add(index, id, index);
+}
+
+/**
+ * Check whether the ID of an item is in a hash set of item IDs.
+ * @param index the hash set
+ * @param item the item
+ * @return false if the ID isn't in the set or the item doesn't have an ID
+ */
+static bool probe_set_index_has(struct oscap_htable *index, const SEXP_t *item)
+{
+	char id[64];
+
+	if (!probe_set_item_id(item, id, sizeof id))
+		return false;
+
+	return oscap_htable_get(index, id) != NULL;
+}
+
+/**
+ * Combine two collections of items using an operation. The items are
+ * identified by the IDs assigned by the item cache using hash sets, the
+ * result keeps the order of the input collections and doesn't contain an
+ * item more than once.
  * @param cobj1 item collection
  * @param cobj2 item collection
  * @param op operation
@@ -497,9 +645,9 @@ static SEXP_t *probe_prepare_filters(probe_t *probe, SEXP_t *obj)
 static SEXP_t *probe_set_combine(SEXP_t *cobj0, SEXP_t *cobj1, oval_setobject_operation_t op)
 {
         SEXP_t *set0, *set1, *res_cobj, *cobj0_mask, *cobj1_mask, *res_mask;
-        register int cmp;
-        register SEXP_t *item0, *item1, *res;
-        register SEXP_list_it *sit0, *sit1;
+        SEXP_t *item, *res;
+        SEXP_list_it *sit;
+        struct oscap_htable *seen, *index1;
 	oval_syschar_collection_flag_t res_flag;
 
 	if (cobj0 == NULL)
@@ -518,78 +666,53 @@ static SEXP_t *probe_set_combine(SEXP_t *cobj0, SEXP_t *cobj1, oval_setobject_op
                                             probe_cobj_get_flag(cobj1), op);
         res_mask = SEXP_list_join(cobj0_mask, cobj1_mask);
 
-        /* prepare iterators & first items */
-        sit0  = SEXP_list_it_new(set0);
-        sit1  = SEXP_list_it_new(set1);
-        item0 = SEXP_list_it_next(sit0);
-        item1 = SEXP_list_it_next(sit1);
+        /* IDs of the items in the result and in the second collection */
+        seen = oscap_htable_new1(strcmp, SEXP_list_length(set0) + SEXP_list_length(set1) + 1);
+        index1 = NULL;
+
+        if (op != OVAL_SET_OPERATION_UNION) {
+                index1 = oscap_htable_new1(strcmp, SEXP_list_length(set1) + 1);
+
+                sit = SEXP_list_it_new(set1);
+                while ((item = SEXP_list_it_next(sit)) != NULL)
+                        probe_set_index_add(index1, item);
+                SEXP_list_it_free(sit);
+        }
 
         /* perform the set operation */
         switch(op) {
         case OVAL_SET_OPERATION_UNION:
-                while (item0 != NULL && item1 != NULL) {
-                        cmp = SEXP_refcmp(item0, item1);
-
-                        if (cmp < 0) {
-                                SEXP_list_add(res, item0);
-                                item0 = SEXP_list_it_next(sit0);
-                        } else if (cmp > 0) {
-                                SEXP_list_add(res, item1);
-                                item1 = SEXP_list_it_next(sit1);
-                        } else {
-                                SEXP_list_add(res, item0);
-                                item0 = SEXP_list_it_next(sit0);
-                                item1 = SEXP_list_it_next(sit1);
-                        }
+                sit = SEXP_list_it_new(set0);
+                while ((item = SEXP_list_it_next(sit)) != NULL) {
+                        if (probe_set_index_add(seen, item))
+                                SEXP_list_add(res, item);
                 }
+                SEXP_list_it_free(sit);
 
-                if (item0 != NULL) {
-                        do {
-                                SEXP_list_add(res, item0);
-                        } while((item0 = SEXP_list_it_next(sit0)) != NULL);
-                } else if (item1 != NULL) {
-                        do {
-                                SEXP_list_add(res, item1);
-                        } while((item1 = SEXP_list_it_next(sit1)) != NULL);
+                sit = SEXP_list_it_new(set1);
+                while ((item = SEXP_list_it_next(sit)) != NULL) {
+                        if (probe_set_index_add(seen, item))
+                                SEXP_list_add(res, item);
                 }
+                SEXP_list_it_free(sit);
 
                 break;
         case OVAL_SET_OPERATION_INTERSECTION:
-                while (item0 != NULL && item1 != NULL) {
-                        cmp = SEXP_refcmp(item0, item1);
-
-                        if (cmp < 0)
-                                item0 = SEXP_list_it_next(sit0);
-                        else if (cmp > 0)
-                                item1 = SEXP_list_it_next(sit1);
-                        else {
-                                SEXP_list_add(res, item0);
-                                item0 = SEXP_list_it_next(sit0);
-                                item1 = SEXP_list_it_next(sit1);
-                        }
+                sit = SEXP_list_it_new(set0);
+                while ((item = SEXP_list_it_next(sit)) != NULL) {
+                        if (probe_set_index_has(index1, item) && probe_set_index_add(seen, item))
+                                SEXP_list_add(res, item);
                 }
+                SEXP_list_it_free(sit);
 
                 break;
         case OVAL_SET_OPERATION_COMPLEMENT:
-                while (item0 != NULL && item1 != NULL) {
-                        cmp = SEXP_refcmp(item0, item1);
-
-                        if (cmp < 0) {
-                                SEXP_list_add(res, item0);
-                                item0 = SEXP_list_it_next(sit0);
-                        } else if (cmp > 0) {
-                                item1 = SEXP_list_it_next(sit1);
-                        } else {
-                                item0 = SEXP_list_it_next(sit0);
-                                item1 = SEXP_list_it_next(sit1);
-                        }
-                }
-
-                if (item0 != NULL) {
-                        do {
-                                SEXP_list_add(res, item0);
-                        } while((item0 = SEXP_list_it_next(sit0)) != NULL);
+                sit = SEXP_list_it_new(set0);
+                while ((item = SEXP_list_it_next(sit)) != NULL) {
+                        if (!probe_set_index_has(index1, item) && probe_set_index_add(seen, item))
+                                SEXP_list_add(res, item);
                 }
+                SEXP_list_it_free(sit);
 
                 break;
         default:
@@ -597,8 +720,8 @@ static SEXP_t *probe_set_combine(SEXP_t *cobj0, SEXP_t *cobj1, oval_setobject_op
                 abort();
         }
 
-        SEXP_list_it_free(sit0);
-        SEXP_list_it_free(sit1);
+	oscap_htable_free0(seen);
+	oscap_htable_free0(index1);
 
 	/*
 	 * If the collected information is complete but all the items are
@@ -687,6 +810,66 @@ static SEXP_t *probe_set_apply_filters(SEXP_t *cobj, SEXP_t *filters)
 	return cobj;
 }
 
+/**
+ * Build a key identifying a set for the memoisation of set results. The
+ * key is derived from the set operation, the object references, the
+ * filters and the nested sets, so equal sets used by different set
+ * objects share the key.
+ * @param set the set
+ * @param key storage for the key
+ * @return false if the set contains an unexpected entity
+ */
+static bool probe_set_key(const SEXP_t *set, struct oscap_string *key)
+{
+	SEXP_t *member, *val, *action;
+	char member_name[24], buffer[32];
+	char *str;
+	bool ret = true;
+
+	val = probe_ent_getattrval(set, "operation");
+	snprintf(buffer, sizeof buffer, "(%d", val != NULL ? SEXP_number_geti_32(val) : OVAL_SET_OPERATION_UNION);
+	oscap_string_append_string(key, buffer);
+	SEXP_free(val);
+
+	SEXP_sublist_foreach(member, set, 2, 1000) {
+		if (!ret)
+			continue;
+
+		if (probe_ent_getname_r(member, member_name, sizeof member_name) == 0) {
+			ret = false;
+		} else if (strcmp("set", member_name) == 0) {
+			oscap_string_append_char(key, ' ');
+			ret = probe_set_key(member, key);
+		} else if (strcmp("obj_ref", member_name) == 0 || strcmp("filter", member_name) == 0) {
+			if ((val = probe_ent_getval(member)) == NULL
+			    || (str = SEXP_string_cstr(val)) == NULL) {
+				SEXP_free(val);
+				ret = false;
+				continue;
+			}
+
+			oscap_string_append_char(key, ' ');
+			oscap_string_append_char(key, member_name[0]);
+			if ((action = probe_ent_getattrval(member, "action")) != NULL) {
+				snprintf(buffer, sizeof buffer, "%u", SEXP_number_getu(action));
+				oscap_string_append_string(key, buffer);
+				SEXP_free(action);
+			}
+			oscap_string_append_char(key, ':');
+			oscap_string_append_string(key, str);
+
+			free(str);
+			SEXP_free(val);
+		} else {
+			ret = false;
+		}
+	}
+
+	oscap_string_append_char(key, ')');
+
+	return ret;
+}
+
 /**
  * Evaluate a set. This function takes care of evaluating a set of either two other sets
  * or an object and 0..n filters. Objects are evaluated using the probe_obj_eval function
@@ -711,6 +894,7 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 	int op_num;
 
 	SEXP_t *r0, *r1, *result, *Omsg = NULL;
+	struct oscap_string *key;
 
 	if (depth > MAX_EVAL_DEPTH) {
 		char *fmt = "probe_set_eval: Too many levels: max=%zu.";
@@ -726,6 +910,23 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 		return result;
 	}
 
+	/*
+	 * Sets (and nested sets) shared by several set objects are
+	 * evaluated only once
+	 */
+	key = oscap_string_new();
+
+	if (probe_set_key(set, key)) {
+		if ((result = probe_rcache_cstr_get(probe->rcache, oscap_string_get_cstr(key))) != NULL) {
+			dD("Using the memoised result of the set: %s", oscap_string_get_cstr(key));
+			oscap_string_free(key);
+			return result;
+		}
+	} else {
+		oscap_string_free(key);
+		key = NULL;
+	}
+
 	filters_u = SEXP_list_new(NULL);	/* unavailable filters */
 	filters_a = SEXP_list_new(NULL);	/* available filters (cached) */
 	filters_req = SEXP_list_new(NULL);	/* request list for probe_ste_fetch() */
@@ -954,8 +1155,16 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
         dD("=== RESULT ===");
         dO(OSCAP_DEBUGOBJ_SEXP, result);
 
+	if (key != NULL) {
+		/* the same set may have been memoised by another worker meanwhile */
+		if (probe_cobj_get_flag(result) != SYSCHAR_FLAG_ERROR)
+			probe_rcache_cstr_add(probe->rcache, oscap_string_get_cstr(key), result);
+		oscap_string_free(key);
+	}
+
 	return (result);
  eval_fail:
+	oscap_string_free(key);
 	SEXP_free(member);
 
 	for (; s_subset_i > 0; --s_subset_i)
@@ -1133,7 +1342,8 @@ SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret)
 
 			dD("handling varrefs in object");
 
-			if (probe_varref_create_ctx(probe_in, varrefs, &ctx) != 0) {
+			if (probe_varref_create_ctx(probe_in, varrefs,
+			                            probe_table_get_multival_entities(subtype), &ctx) != 0) {
 				SEXP_free(varrefs);
 				SEXP_free(pctx.filters);
 				SEXP_free(probe_in);
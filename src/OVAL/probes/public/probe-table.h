@@ -36,6 +36,12 @@ OSCAP_API probe_init_function_t probe_table_get_init_function(oval_subtype_t typ
 OSCAP_API probe_main_function_t probe_table_get_main_function(oval_subtype_t type);
 OSCAP_API probe_fini_function_t probe_table_get_fini_function(oval_subtype_t type);
 OSCAP_API probe_offline_mode_function_t probe_table_get_offline_mode_function(oval_subtype_t type);
+/**
+ * Get the names of the object entities for which the probe handles all
+ * values of a referenced variable at once.
+ * @return NULL terminated array of entity names or NULL
+ */
+OSCAP_API const char * const *probe_table_get_multival_entities(oval_subtype_t type);
 
 OSCAP_API void probe_table_list(FILE *output);
 OSCAP_API int probe_table_size(void);
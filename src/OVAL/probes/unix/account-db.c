@@ -0,0 +1,384 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pwd.h>
+#include <paths.h>
+#if defined(OS_APPLE)
+#include <utmp.h>
+#elif !defined(OS_FREEBSD)
+#include <lastlog.h>
+#endif
+#ifdef HAVE_SHADOW_H
+#include <shadow.h>
+#endif
+
+#include "_seap.h"
+#include "common/debug_priv.h"
+#include "common/util.h"
+#include "account-db.h"
+
+/*
+ * Entries of a table in enumeration order and pointers to them sorted by
+ * name. The name must be the first member of the entries.
+ */
+struct account_table {
+	bool loaded;
+	char *entries;
+	size_t entry_size;
+	size_t count;
+	const void **by_name;
+};
+
+#define ACCOUNT_TABLE_NAME(entry) (*(char *const *)(entry))
+
+struct account_db {
+	char *root;                 /* NULL if NSS is used */
+	unsigned int refcount;
+	pthread_mutex_t lock;       /* serializes loading of the tables */
+	struct account_table users;
+	struct account_table shadow;
+#if !defined(OS_FREEBSD)
+	bool lastlog_opened;
+	FILE *lastlog;
+	int64_t *last_logins;       /* indexed as users, INT64_MIN if not read yet */
+#endif
+};
+
+static pthread_mutex_t g_account_db_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct account_db *g_account_db = NULL;
+
+static char *account_strdup(const char *str)
+{
+	return str != NULL ? strdup(str) : NULL;
+}
+
+static void *account_table_append(struct account_table *table, size_t *capacity)
+{
+	if (table->count == *capacity) {
+		*capacity = *capacity ? *capacity * 2 : 256;
+		table->entries = realloc(table->entries, *capacity * table->entry_size);
+	}
+	return table->entries + table->count++ * table->entry_size;
+}
+
+static int account_table_cmp_name(const void *a, const void *b)
+{
+	const void *ea = *(const void *const *)a, *eb = *(const void *const *)b;
+	int ret = strcmp(ACCOUNT_TABLE_NAME(ea), ACCOUNT_TABLE_NAME(eb));
+
+	if (ret != 0)
+		return ret;
+	/* Entries of the same name stay in enumeration order */
+	return (ea > eb) - (ea < eb);
+}
+
+static void account_table_index(struct account_table *table)
+{
+	table->by_name = malloc((table->count + 1) * sizeof(void *));
+	for (size_t i = 0; i < table->count; ++i)
+		table->by_name[i] = table->entries + i * table->entry_size;
+	qsort(table->by_name, table->count, sizeof(void *), account_table_cmp_name);
+	table->loaded = true;
+}
+
+static int account_table_find(struct account_table *table, SEXP_t *name_ent, const void ***found)
+{
+	const void **res;
+	size_t count = 0;
+	char *name = NULL;
+
+	if (probe_ent_getoperation(name_ent, OVAL_OPERATION_EQUALS) == OVAL_OPERATION_EQUALS &&
+	    probe_ent_getdatatype(name_ent) == OVAL_DATATYPE_STRING &&
+	    !probe_ent_attrexists(name_ent, "var_ref")) {
+		SEXP_t *val = probe_ent_getval(name_ent);
+
+		if (val != NULL && SEXP_stringp(val))
+			name = SEXP_string_cstr(val);
+		SEXP_free(val);
+	}
+
+	if (name == NULL) {
+		res = malloc((table->count + 1) * sizeof(void *));
+		for (size_t i = 0; i < table->count; ++i)
+			res[i] = table->entries + i * table->entry_size;
+		*found = res;
+		return table->count;
+	}
+
+	/* Lower bound of the name */
+	size_t lo = 0, hi = table->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (strcmp(ACCOUNT_TABLE_NAME(table->by_name[mid]), name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	while (lo + count < table->count && strcmp(ACCOUNT_TABLE_NAME(table->by_name[lo + count]), name) == 0)
+		count++;
+
+	res = malloc((count + 1) * sizeof(void *));
+	memcpy(res, table->by_name + lo, count * sizeof(void *));
+	free(name);
+
+	*found = res;
+	return count;
+}
+
+static int account_db_load_users(struct account_db *db)
+{
+	struct account_table *table = &db->users;
+	struct passwd *pw;
+	FILE *fp = NULL;
+	size_t capacity = 0;
+
+	if (db->root != NULL) {
+		char *passwd_file_path = oscap_path_join(db->root, "/etc/passwd");
+		fp = fopen(passwd_file_path, "r");
+		if (fp == NULL) {
+			dD("Can't open %s: errno=%d, %s.", passwd_file_path, errno, strerror(errno));
+			free(passwd_file_path);
+			return -1;
+		}
+		free(passwd_file_path);
+	} else {
+		setpwent();
+	}
+
+	table->entry_size = sizeof(struct account_user);
+	while ((pw = (fp != NULL ? fgetpwent(fp) : getpwent())) != NULL) {
+		struct account_user *user = account_table_append(table, &capacity);
+
+		user->name = strdup(pw->pw_name);
+		user->password = account_strdup(pw->pw_passwd);
+		user->uid = pw->pw_uid;
+		user->gid = pw->pw_gid;
+		user->gecos = account_strdup(pw->pw_gecos);
+		user->home_dir = account_strdup(pw->pw_dir);
+		user->shell = account_strdup(pw->pw_shell);
+	}
+
+	if (fp != NULL)
+		fclose(fp);
+	else
+		endpwent();
+
+	account_table_index(table);
+	dD("Loaded %zu users.", table->count);
+	return 0;
+}
+
+#ifdef HAVE_SHADOW_H
+static int account_db_load_shadow(struct account_db *db)
+{
+	struct account_table *table = &db->shadow;
+	struct spwd *sp;
+	FILE *fp = NULL;
+	size_t capacity = 0;
+
+	if (db->root != NULL) {
+		char *shadow_file_path = oscap_path_join(db->root, "/etc/shadow");
+		fp = fopen(shadow_file_path, "r");
+		if (fp == NULL) {
+			dD("Can't open %s: errno=%d, %s.", shadow_file_path, errno, strerror(errno));
+			free(shadow_file_path);
+			return -1;
+		}
+		free(shadow_file_path);
+	} else {
+		setspent();
+	}
+
+	table->entry_size = sizeof(struct account_shadow);
+	while ((sp = (fp != NULL ? fgetspent(fp) : getspent())) != NULL) {
+		struct account_shadow *entry = account_table_append(table, &capacity);
+
+		entry->name = strdup(sp->sp_namp);
+		entry->password = account_strdup(sp->sp_pwdp);
+		entry->last_change = sp->sp_lstchg;
+		entry->min = sp->sp_min;
+		entry->max = sp->sp_max;
+		entry->warn = sp->sp_warn;
+		entry->inactive = sp->sp_inact;
+		entry->expire = sp->sp_expire;
+		entry->flag = sp->sp_flag;
+	}
+
+	if (fp != NULL)
+		fclose(fp);
+	else
+		endspent();
+
+	account_table_index(table);
+	dD("Loaded %zu shadow entries.", table->count);
+	return 0;
+}
+#endif
+
+static void account_db_free(struct account_db *db)
+{
+	if (db == NULL)
+		return;
+
+	for (size_t i = 0; i < db->users.count; ++i) {
+		struct account_user *user = (struct account_user *)(db->users.entries + i * db->users.entry_size);
+		free(user->name);
+		free(user->password);
+		free(user->gecos);
+		free(user->home_dir);
+		free(user->shell);
+	}
+	free(db->users.entries);
+	free(db->users.by_name);
+#ifdef HAVE_SHADOW_H
+	for (size_t i = 0; i < db->shadow.count; ++i) {
+		struct account_shadow *entry = (struct account_shadow *)(db->shadow.entries + i * db->shadow.entry_size);
+		free(entry->name);
+		free(entry->password);
+	}
+#endif
+	free(db->shadow.entries);
+	free(db->shadow.by_name);
+#if !defined(OS_FREEBSD)
+	if (db->lastlog != NULL)
+		fclose(db->lastlog);
+	free(db->last_logins);
+#endif
+	free(db->root);
+	pthread_mutex_destroy(&db->lock);
+	free(db);
+}
+
+static void account_db_unref(struct account_db *db)
+{
+	if (db != NULL && --db->refcount == 0)
+		account_db_free(db);
+}
+
+struct account_db *account_db_get(const char *root)
+{
+	struct account_db *db;
+
+	pthread_mutex_lock(&g_account_db_lock);
+
+	db = g_account_db;
+	if (db == NULL || (db->root == NULL) != (root == NULL) ||
+	    (root != NULL && strcmp(db->root, root) != 0)) {
+		account_db_unref(g_account_db);
+		g_account_db = db = calloc(1, sizeof(*db));
+		db->root = account_strdup(root);
+		pthread_mutex_init(&db->lock, NULL);
+		/* One reference is held by the cache */
+		db->refcount = 1;
+	}
+	db->refcount++;
+
+	pthread_mutex_unlock(&g_account_db_lock);
+	return db;
+}
+
+void account_db_put(struct account_db *db)
+{
+	pthread_mutex_lock(&g_account_db_lock);
+	account_db_unref(db);
+	pthread_mutex_unlock(&g_account_db_lock);
+}
+
+void account_db_drop(void)
+{
+	pthread_mutex_lock(&g_account_db_lock);
+	account_db_unref(g_account_db);
+	g_account_db = NULL;
+	pthread_mutex_unlock(&g_account_db_lock);
+}
+
+int account_db_find_users(struct account_db *db, SEXP_t *name_ent, const struct account_user ***users)
+{
+	pthread_mutex_lock(&db->lock);
+	if (!db->users.loaded && account_db_load_users(db) != 0) {
+		pthread_mutex_unlock(&db->lock);
+		return -1;
+	}
+	pthread_mutex_unlock(&db->lock);
+
+	return account_table_find(&db->users, name_ent, (const void ***)users);
+}
+
+#if !defined(OS_FREEBSD)
+int64_t account_db_last_login(struct account_db *db, const struct account_user *user)
+{
+	size_t n = ((const char *)user - db->users.entries) / db->users.entry_size;
+	int64_t last_login;
+
+	pthread_mutex_lock(&db->lock);
+
+	if (!db->lastlog_opened) {
+		if (db->root != NULL) {
+			char *lastlog_file_path = oscap_path_join(db->root, _PATH_LASTLOG);
+			db->lastlog = fopen(lastlog_file_path, "r");
+			free(lastlog_file_path);
+		} else {
+			db->lastlog = fopen(_PATH_LASTLOG, "r");
+		}
+		db->last_logins = malloc((db->users.count + 1) * sizeof(int64_t));
+		for (size_t i = 0; i < db->users.count; ++i)
+			db->last_logins[i] = INT64_MIN;
+		db->lastlog_opened = true;
+	}
+
+	if (db->last_logins[n] == INT64_MIN) {
+		struct lastlog ll;
+
+		db->last_logins[n] = -1;
+		if (db->lastlog != NULL &&
+		    fseeko(db->lastlog, (off_t)user->uid * sizeof(ll), SEEK_SET) == 0 &&
+		    fread((char *)&ll, sizeof(ll), 1, db->lastlog) == 1)
+			db->last_logins[n] = (int64_t)ll.ll_time;
+	}
+	last_login = db->last_logins[n];
+
+	pthread_mutex_unlock(&db->lock);
+	return last_login;
+}
+#endif
+
+#ifdef HAVE_SHADOW_H
+int account_db_find_shadow(struct account_db *db, SEXP_t *name_ent, const struct account_shadow ***entries)
+{
+	pthread_mutex_lock(&db->lock);
+	if (!db->shadow.loaded && account_db_load_shadow(db) != 0) {
+		pthread_mutex_unlock(&db->lock);
+		return -1;
+	}
+	pthread_mutex_unlock(&db->lock);
+
+	return account_table_find(&db->shadow, name_ent, (const void ***)entries);
+}
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef OPENSCAP_ACCOUNT_DB_H
+#define OPENSCAP_ACCOUNT_DB_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "probe-api.h"
+
+/*
+ * Account database shared by the password and shadow probes. The user and
+ * shadow tables are enumerated once per scan, either through NSS or from
+ * the files below $OSCAP_PROBE_ROOT in the offline mode, and indexed by
+ * user name. The entries are kept in the enumeration order until the
+ * database is dropped.
+ */
+
+struct account_user {
+	char *name;
+	char *password;
+	uid_t uid;
+	gid_t gid;
+	char *gecos;
+	char *home_dir;
+	char *shell;
+};
+
+struct account_shadow {
+	char *name;
+	char *password;
+	long last_change;
+	long min;
+	long max;
+	long warn;
+	long inactive;
+	long expire;
+	unsigned long flag;
+};
+
+struct account_db;
+
+/*
+ * Get a reference to the account database of the given root directory,
+ * the files of the root directory are read instead of NSS if it isn't NULL.
+ * The database is created by the first call, the following calls share it
+ * until account_db_drop() is called.
+ */
+struct account_db *account_db_get(const char *root);
+
+/*
+ * Release a reference obtained by account_db_get().
+ */
+void account_db_put(struct account_db *db);
+
+/*
+ * Drop the shared database, the next account_db_get() reads the accounts
+ * again. Called when the probes using the database are finalized.
+ */
+void account_db_drop(void);
+
+/*
+ * Find the users matching the name entity of an object. The users with the
+ * name are looked up in the index if the entity uses the equals operation
+ * and a single value, all the users are returned otherwise. The caller is
+ * expected to compare the names of the returned users with the entity.
+ * A newly allocated array of users in enumeration order is stored in
+ * *users. Returns the number of users or -1 if they can't be read.
+ */
+int account_db_find_users(struct account_db *db, SEXP_t *name_ent, const struct account_user ***users);
+
+#if !defined(OS_FREEBSD)
+/*
+ * Get the time of the last login of a user from lastlog, -1 if unknown.
+ */
+int64_t account_db_last_login(struct account_db *db, const struct account_user *user);
+#endif
+
+#ifdef HAVE_SHADOW_H
+/*
+ * Find the shadow entries matching the name entity of an object, see
+ * account_db_find_users().
+ */
+int account_db_find_shadow(struct account_db *db, SEXP_t *name_ent, const struct account_shadow ***entries);
+#endif
+
+#endif /* OPENSCAP_ACCOUNT_DB_H */
@@ -423,6 +423,11 @@ int file_probe_offline_mode_supported()
 	return PROBE_OFFLINE_OWN;
 }
 
+/* oval_fts handles all values of the path entities at once */
+const char * const file_probe_multival_entities[] = {
+	"filepath", "path", "filename", NULL
+};
+
 void *file_probe_init(void)
 {
         /*
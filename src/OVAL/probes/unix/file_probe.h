@@ -26,6 +26,7 @@
 #include "probe-api.h"
 
 int file_probe_offline_mode_supported(void);
+extern const char * const file_probe_multival_entities[];
 void *file_probe_init(void);
 int file_probe_main(probe_ctx *ctx, void *arg);
 void file_probe_fini(void *arg);
@@ -6,24 +6,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "debug_priv.h"
+#include "list.h"
 #include "dpkginfo-helper.h"
 
-#define DPKG_STATUS_BUFFER_SIZE 4096
-
-static char* trimleft(char *str)
-{
-	while (isspace((unsigned char)*str))
-		str++;
-
-	if (*str == 0)
-		return str;
-
-	return str;
-}
-
 static int version(struct dpkginfo_reply_t *reply)
 {
 	char *evr, *epoch, *version, *release;
@@ -65,104 +59,285 @@ err:
 	return -1;
 }
 
-struct dpkginfo_reply_t* dpkginfo_get_by_name(const char *name, int *err)
+struct dpkginfo_index {
+	char *path;              /**< path of the status file */
+	dev_t dev;               /**< device, inode, size and modification of the status file */
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+	unsigned int refcount;
+	struct oscap_htable *by_name;
+	struct dpkginfo_reply_t **pkgs; /**< installed packages in status file order */
+	size_t count;
+};
+
+static pthread_mutex_t g_dpkginfo_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct dpkginfo_index *g_dpkginfo_index = NULL;
+
+/* Fields of a package entry, pointing into the status file */
+struct dpkginfo_entry {
+	const char *name, *status, *arch, *evr;
+	size_t name_len, status_len, arch_len, evr_len;
+};
+
+static void dpkginfo_reply_free_cb(void *reply)
+{
+	dpkginfo_free_reply(reply);
+}
+
+static void dpkginfo_index_free(struct dpkginfo_index *index)
+{
+	if (index == NULL)
+		return;
+
+	oscap_htable_free(index->by_name, dpkginfo_reply_free_cb);
+	free(index->pkgs);
+	free(index->path);
+	free(index);
+}
+
+static void dpkginfo_index_unref(struct dpkginfo_index *index)
+{
+	if (index != NULL && --index->refcount == 0)
+		dpkginfo_index_free(index);
+}
+
+static int dpkginfo_index_add(struct dpkginfo_index *index, size_t *capacity, struct dpkginfo_entry *entry)
 {
-	FILE *f;
-	char buf[DPKG_STATUS_BUFFER_SIZE], path[PATH_MAX], *root, *key, *value;
 	struct dpkginfo_reply_t *reply;
+	char *name;
 
-	*err = 0;
-	reply = NULL;
+	if (entry->name == NULL)
+		return 0;
 
-	root = getenv("OSCAP_PROBE_ROOT");
-	if (root != NULL)
-		snprintf(path, PATH_MAX, "%s/var/lib/dpkg/status", root);
-	else
-		snprintf(path, PATH_MAX, "/var/lib/dpkg/status");
+	if (entry->status != NULL && (entry->status_len < 7 || strncmp(entry->status, "install", 7) != 0)) {
+		// Package deinstalled.
+		return 0;
+	}
 
-	f = fopen(path, "r");
-	if (f == NULL) {
-		dW("%s not found.", path);
-		*err = -1;
-		return NULL;
+	name = strndup(entry->name, entry->name_len);
+	if (name == NULL)
+		return -1;
+
+	// Only the first installed entry of a package is reported.
+	if (oscap_htable_get(index->by_name, name) != NULL) {
+		free(name);
+		return 0;
 	}
 
-	dD("Searching package \"%s\".", name);
+	reply = calloc(1, sizeof(*reply));
+	if (reply == NULL) {
+		free(name);
+		return -1;
+	}
+	reply->name = name;
+	if (entry->arch != NULL && (reply->arch = strndup(entry->arch, entry->arch_len)) == NULL)
+		goto err;
+	if (entry->evr != NULL) {
+		reply->evr = strndup(entry->evr, entry->evr_len);
+		if (reply->evr == NULL || version(reply) < 0)
+			goto err;
+	}
+
+	if (index->count == *capacity) {
+		*capacity = *capacity ? *capacity * 2 : 256;
+		index->pkgs = realloc(index->pkgs, *capacity * sizeof(struct dpkginfo_reply_t *));
+	}
+	index->pkgs[index->count++] = reply;
+	oscap_htable_add(index->by_name, reply->name, reply);
+
+	return 0;
+err:
+	dpkginfo_free_reply(reply);
+	return -1;
+}
+
+static int dpkginfo_index_parse(struct dpkginfo_index *index, const char *data, size_t size)
+{
+	struct dpkginfo_entry entry;
+	const char *line = data, *end = data + size;
+	size_t capacity = 0;
+
+	memset(&entry, 0, sizeof(entry));
+
+	while (line < end) {
+		const char *eol = memchr(line, '\n', end - line);
+		const char *key = line, *value;
+		size_t key_len;
 
-	while (fgets(buf, DPKG_STATUS_BUFFER_SIZE, f)) {
-		if (buf[0] == '\n') {
+		if (eol == NULL)
+			eol = end;
+
+		if (eol == line) {
 			// New package entry.
-			if (reply != NULL) {
-				// Package found.
-				goto out;
-			}
+			if (dpkginfo_index_add(index, &capacity, &entry) != 0)
+				return -1;
+			memset(&entry, 0, sizeof(entry));
+			line = eol + 1;
 			continue;
 		}
-		if (isspace(buf[0])) {
+		line = eol + 1;
+
+		if (isspace((unsigned char)key[0])) {
 			// Ignore line beginning by a space.
 			continue;
 		}
-		buf[strcspn(buf, "\n")] = 0;
-		key = buf;
-		value = strchr(buf, ':');
+		value = memchr(key, ':', eol - key);
 		if (value == NULL) {
 			// Ignore truncated line.
 			continue;
 		}
-		*value++ = '\0';
-		value = trimleft(value);
+		key_len = value - key;
+		value++;
+		while (value < eol && isspace((unsigned char)*value))
+			value++;
+
+#define DPKGINFO_FIELD(_key, _field) \
+		if (key_len == sizeof(_key) - 1 && memcmp(key, _key, key_len) == 0) { \
+			entry._field = value; \
+			entry._field ## _len = eol - value; \
+			continue; \
+		}
+
 		// Package should be the first line.
-		if (strcmp(key, "Package") == 0) {
-			if (strcmp(value, name) == 0) {
-				if (reply != NULL)
-					continue;
-				reply = calloc(1, sizeof(*reply));
-				if (reply == NULL)
-					goto err;
-				reply->name = strdup(value);
-				if (reply->name == NULL)
-					goto err;
-			}
-		} else if (reply != NULL) {
-			if (strcmp(key, "Status") == 0) {
-				if (strncmp(value, "install", 7) != 0) {
-					// Package deinstalled.
-					dD("Package \"%s\" has been deinstalled.", name);
-					dpkginfo_free_reply(reply);
-					reply = NULL;
-					continue;
-				}
-			} else if (strcmp(key, "Architecture") == 0) {
-				reply->arch = strdup(value);
-				if (reply->arch == NULL)
-					goto err;
-			} else if (strcmp(key, "Version") == 0) {
-				reply->evr = strdup(value);
-				if (reply->evr == NULL)
-					goto err;
-				if (version(reply) < 0)
-					goto err;
+		if (key_len == 7 && memcmp(key, "Package", 7) == 0) {
+			if (entry.name != NULL) {
+				// Package entries not separated by an empty line.
+				if (dpkginfo_index_add(index, &capacity, &entry) != 0)
+					return -1;
+				memset(&entry, 0, sizeof(entry));
 			}
+			entry.name = value;
+			entry.name_len = eol - value;
+			continue;
 		}
+		DPKGINFO_FIELD("Status", status);
+		DPKGINFO_FIELD("Architecture", arch);
+		DPKGINFO_FIELD("Version", evr);
+#undef DPKGINFO_FIELD
 	}
 
 	// Reached end of file.
+	return dpkginfo_index_add(index, &capacity, &entry);
+}
 
-out:
-	if (reply != NULL) {
-		// Package found.
-		dD("Package \"%s\" found (arch=%s evr=%s epoch=%s version=%s release=%s).",
-			name, reply->arch, reply->evr, reply->epoch, reply->version, reply->release);
-		*err = 1;
+static struct dpkginfo_index *dpkginfo_index_build(const char *path, const struct stat *st)
+{
+	struct dpkginfo_index *index;
+	void *data = NULL;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		dW("%s not found.", path);
+		return NULL;
 	}
-	fclose(f);
-	return reply;
-err:
-	dW("Insufficient memory available to allocate duplicate string.");
-	fclose(f);
-	dpkginfo_free_reply(reply);
-	*err = -1;
-	return NULL;
+
+	if (st->st_size > 0) {
+		data = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			dW("Can't map %s: %s", path, strerror(errno));
+			close(fd);
+			return NULL;
+		}
+	}
+	close(fd);
+
+	index = calloc(1, sizeof(*index));
+	/* The status file of a typical system has a few thousands of packages */
+	index->by_name = oscap_htable_new1((oscap_compare_func) strcmp, 4099);
+	if (dpkginfo_index_parse(index, data, st->st_size) != 0) {
+		dW("Insufficient memory available to allocate duplicate string.");
+		dpkginfo_index_free(index);
+		index = NULL;
+	} else {
+		dD("Indexed %zu installed packages of %s.", index->count, path);
+	}
+
+	if (data != NULL)
+		munmap(data, st->st_size);
+
+	return index;
+}
+
+struct dpkginfo_index *dpkginfo_index_get(void)
+{
+	struct dpkginfo_index *index;
+	char path[PATH_MAX];
+	const char *root;
+	struct stat st;
+
+	root = getenv("OSCAP_PROBE_ROOT");
+	if (root != NULL)
+		snprintf(path, PATH_MAX, "%s/var/lib/dpkg/status", root);
+	else
+		snprintf(path, PATH_MAX, "/var/lib/dpkg/status");
+
+	if (stat(path, &st) != 0) {
+		dW("%s not found.", path);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_dpkginfo_index_lock);
+
+	index = g_dpkginfo_index;
+	if (index != NULL && strcmp(index->path, path) == 0 &&
+	    index->dev == st.st_dev && index->ino == st.st_ino && index->size == st.st_size &&
+	    index->mtime.tv_sec == st.st_mtim.tv_sec && index->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+		index->refcount++;
+		pthread_mutex_unlock(&g_dpkginfo_index_lock);
+		return index;
+	}
+
+	if (index != NULL)
+		dD("The dpkg status index is outdated, rebuilding it.");
+	dpkginfo_index_unref(g_dpkginfo_index);
+	g_dpkginfo_index = NULL;
+
+	index = dpkginfo_index_build(path, &st);
+	if (index != NULL) {
+		index->path = strdup(path);
+		index->dev = st.st_dev;
+		index->ino = st.st_ino;
+		index->size = st.st_size;
+		index->mtime = st.st_mtim;
+		/* One reference is held by the cache */
+		index->refcount = 2;
+		g_dpkginfo_index = index;
+	}
+
+	pthread_mutex_unlock(&g_dpkginfo_index_lock);
+	return index;
+}
+
+void dpkginfo_index_put(struct dpkginfo_index *index)
+{
+	pthread_mutex_lock(&g_dpkginfo_index_lock);
+	dpkginfo_index_unref(index);
+	pthread_mutex_unlock(&g_dpkginfo_index_lock);
+}
+
+void dpkginfo_index_drop(void)
+{
+	pthread_mutex_lock(&g_dpkginfo_index_lock);
+	dpkginfo_index_unref(g_dpkginfo_index);
+	g_dpkginfo_index = NULL;
+	pthread_mutex_unlock(&g_dpkginfo_index_lock);
+}
+
+const struct dpkginfo_reply_t *dpkginfo_index_find(struct dpkginfo_index *index, const char *name)
+{
+	return oscap_htable_get(index->by_name, name);
+}
+
+size_t dpkginfo_index_count(struct dpkginfo_index *index)
+{
+	return index->count;
+}
+
+const struct dpkginfo_reply_t *dpkginfo_index_nth(struct dpkginfo_index *index, size_t n)
+{
+	return n < index->count ? index->pkgs[n] : NULL;
 }
 
 void dpkginfo_free_reply(struct dpkginfo_reply_t *reply)
@@ -22,6 +22,8 @@
 #ifndef __DPKGINFO_HELPER__
 #define __DPKGINFO_HELPER__
 
+#include <stddef.h>
+
 struct dpkginfo_reply_t {
         char *name;
         char *arch;
@@ -31,7 +33,45 @@ struct dpkginfo_reply_t {
         char *evr;
 };
 
-struct dpkginfo_reply_t * dpkginfo_get_by_name(const char *name, int *err);
+/**
+ * In-memory index of the installed packages of the dpkg status database.
+ * The status file is parsed once and the index is shared until the file
+ * is modified.
+ */
+struct dpkginfo_index;
+
+/**
+ * Get a reference to the index of the status file below OSCAP_PROBE_ROOT.
+ * The index is rebuilt if the status file has been modified since it was
+ * built. Returns NULL on error.
+ */
+struct dpkginfo_index *dpkginfo_index_get(void);
+
+/**
+ * Release a reference obtained by dpkginfo_index_get().
+ */
+void dpkginfo_index_put(struct dpkginfo_index *index);
+
+/**
+ * Drop the cached index, it is freed once all references are released.
+ * Called when the dpkginfo probe is finalized.
+ */
+void dpkginfo_index_drop(void);
+
+/**
+ * Find an installed package by name. Returns NULL if it isn't installed.
+ */
+const struct dpkginfo_reply_t *dpkginfo_index_find(struct dpkginfo_index *index, const char *name);
+
+/**
+ * Get the number of installed packages in the index.
+ */
+size_t dpkginfo_index_count(struct dpkginfo_index *index);
+
+/**
+ * Get an installed package by its position in the status file.
+ */
+const struct dpkginfo_reply_t *dpkginfo_index_nth(struct dpkginfo_index *index, size_t n);
 
 void dpkginfo_free_reply(struct dpkginfo_reply_t *reply);
 
@@ -60,6 +60,7 @@
 #include <probe/probe.h>
 
 #include "dpkginfo-helper.h"
+#include "probe/entcmp.h"
 
 #include "dpkginfo_probe.h"
 
@@ -67,12 +68,36 @@ int dpkginfo_probe_offline_mode_supported(void) {
         return PROBE_OFFLINE_OWN;
 }
 
+void dpkginfo_probe_fini(void *arg)
+{
+	dpkginfo_index_drop();
+}
+
+static void dpkginfo_additem(probe_ctx *ctx, const struct dpkginfo_reply_t *dpkginfo_reply, oval_datatype_t evr_string_type)
+{
+	SEXP_t *item;
+
+	dD("%s: element found version %s", dpkginfo_reply->name, dpkginfo_reply->evr);
+	item = probe_item_create (OVAL_LINUX_DPKG_INFO, NULL,
+			"name", OVAL_DATATYPE_STRING, dpkginfo_reply->name,
+			"arch", OVAL_DATATYPE_STRING, dpkginfo_reply->arch,
+			"epoch", OVAL_DATATYPE_STRING, dpkginfo_reply->epoch,
+			"release", OVAL_DATATYPE_STRING, dpkginfo_reply->release,
+			"version", OVAL_DATATYPE_STRING, dpkginfo_reply->version,
+			"evr", evr_string_type, dpkginfo_reply->evr,
+			NULL);
+
+	probe_item_collect(ctx, item);
+}
+
 int dpkginfo_probe_main (probe_ctx *ctx, void *arg)
 {
 	SEXP_t *val, *item, *ent, *obj;
         char *request_st = NULL;
-        struct dpkginfo_reply_t *dpkginfo_reply = NULL;
-        int errflag;
+        const struct dpkginfo_reply_t *dpkginfo_reply = NULL;
+        struct dpkginfo_index *index;
+	oval_operation_t op;
+	oval_datatype_t evr_string_type;
 
 	obj = probe_ctx_getobject(ctx);
 	ent = probe_obj_getent(obj, "name", 1);
@@ -110,55 +135,50 @@ int dpkginfo_probe_main (probe_ctx *ctx, void *arg)
                 }
         }
 
-        /* get info from debian apt cache */
-        dpkginfo_reply = dpkginfo_get_by_name(request_st, &errflag);
+	oval_schema_version_t oval_version = probe_obj_get_platform_schema_version(obj);
+	if (oval_schema_version_cmp(oval_version, OVAL_SCHEMA_VERSION(5.11.1)) >= 0) {
+		evr_string_type = OVAL_DATATYPE_DEBIAN_EVR_STRING;
+	} else {
+		evr_string_type = OVAL_DATATYPE_EVR_STRING;
+	}
+
+        /* get info from the index of the dpkg status database */
+        index = dpkginfo_index_get();
+
+        if (index == NULL) {
+		dD("dpkginfo_index_get failed.");
+		item = probe_item_create(OVAL_LINUX_DPKG_INFO, NULL,
+				"name", OVAL_DATATYPE_STRING, request_st,
+				NULL);
+		probe_item_setstatus (item, SYSCHAR_STATUS_ERROR);
+		probe_item_collect(ctx, item);
+		goto cleanup;
+        }
 
-        if (dpkginfo_reply == NULL) {
-                switch (errflag) {
-		case 0: /* Not found */
-		{
+	op = probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS);
+	if (op == OVAL_OPERATION_EQUALS) {
+		dpkginfo_reply = dpkginfo_index_find(index, request_st);
+		if (dpkginfo_reply == NULL)
 			dD("Package \"%s\" not found.", request_st);
-			break;
-		}
-		case -1: /* Error */
-		{
-			dD("dpkginfo_get_by_name failed.");
-			item = probe_item_create(OVAL_LINUX_DPKG_INFO, NULL,
-					"name", OVAL_DATATYPE_STRING, request_st,
-					NULL);
-			probe_item_setstatus (item, SYSCHAR_STATUS_ERROR);
-			probe_item_collect(ctx, item);
-			break;
+		else
+			dpkginfo_additem(ctx, dpkginfo_reply, evr_string_type);
+	} else {
+		/* pattern match, not equal, ... */
+		size_t count = dpkginfo_index_count(index);
+
+		for (size_t i = 0; i < count; ++i) {
+			SEXP_t *name;
+
+			dpkginfo_reply = dpkginfo_index_nth(index, i);
+			name = SEXP_string_newf("%s", dpkginfo_reply->name);
+			if (probe_entobj_cmp(ent, name) == OVAL_RESULT_TRUE)
+				dpkginfo_additem(ctx, dpkginfo_reply, evr_string_type);
+			SEXP_free(name);
 		}
-                }
-        } else { /* Ok */
-                int i;
-                int num_items = 1; /* FIXME */
-		oval_datatype_t evr_string_type;
-		oval_schema_version_t oval_version = probe_obj_get_platform_schema_version(obj);
-		if (oval_schema_version_cmp(oval_version, OVAL_SCHEMA_VERSION(5.11.1)) >= 0) {
-			evr_string_type = OVAL_DATATYPE_DEBIAN_EVR_STRING;
-		} else {
-			evr_string_type = OVAL_DATATYPE_EVR_STRING;
-		}
-
-                for (i = 0; i < num_items; ++i) {
-                        dD("%s: element found version %s", dpkginfo_reply->name, dpkginfo_reply->evr);
-                        item = probe_item_create (OVAL_LINUX_DPKG_INFO, NULL,
-                                        "name", OVAL_DATATYPE_STRING, dpkginfo_reply->name,
-                                        "arch", OVAL_DATATYPE_STRING, dpkginfo_reply->arch,
-                                        "epoch", OVAL_DATATYPE_STRING, dpkginfo_reply->epoch,
-                                        "release", OVAL_DATATYPE_STRING, dpkginfo_reply->release,
-                                        "version", OVAL_DATATYPE_STRING, dpkginfo_reply->version,
-					"evr", evr_string_type, dpkginfo_reply->evr,
-                                        NULL);
-
-			probe_item_collect(ctx, item);
-
-                        dpkginfo_free_reply(dpkginfo_reply);
-                }
-        }
+	}
 
+	dpkginfo_index_put(index);
+cleanup:
 	SEXP_free(ent);
         free(request_st);
 
@@ -54,17 +54,20 @@
 #include <stdio.h>
 #include <stdio_ext.h>
 #include <errno.h>
-#include <dirent.h>
-#include <fcntl.h>
+#include <limits.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <regex.h>
+#include <pthread.h>
+
+#include <probe/probe.h>
 
 #include "_seap.h"
 #include "probe-api.h"
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
 #include "inetlisteningservers_probe.h"
+#include "unix/proc-snapshot.h"
 
 /* This structure contains the information OVAL is asking or requesting */
 struct server_info {
@@ -73,234 +76,108 @@ struct server_info {
 	SEXP_t *local_port_ent;
 };
 
-/* Convenience structure for the results being reported */
-struct result_info {
+/* Socket read from the /proc/net tables */
+struct inet_socket {
 	const char *proto;
-	const char *laddr;
+	char *laddr;
 	unsigned lport;
-	const char *raddr;
+	char *raddr;
 	unsigned rport;
+	unsigned long inode;
 };
 
 /* This structure is used to store information from scanning all runnning
  * processes. It will be used later to augment server info */
-typedef struct _lnode {
-  pid_t pid;            // process ID
-  uid_t uid;            // effective user ID
-  char *cmd;            // command run by user
-  unsigned long inode;  // inode of socket
-  struct _lnode* next;  // Next node pointer
-} lnode;
-
-/* This is the linked list head. Only data elements go here. */
-typedef struct {
-  lnode *head;          // List head
-  lnode *cur;           // Pointer to current node
-} llist;
-
-/* Function prototypes */
-static inline lnode *list_get_cur(llist *l) { return l->cur; }
-static void list_create(llist *l);
-static void list_append(llist *l, lnode *node);
-static void list_clear(llist* l);
-static lnode *list_find_inode(llist *l, unsigned long i);
-
-
-static void list_create(llist *l)
-{
-	l->head = NULL;
-	l->cur = NULL;
-}
+struct inode_owner {
+	unsigned long inode;  // inode of socket
+	pid_t pid;            // process ID
+	uid_t uid;            // effective user ID
+	const char *cmd;      // command run by user, owned by the snapshot
+	size_t order;         // position in the process table
+};
 
-static void list_append(llist *l, lnode *node)
-{
-	lnode* newnode;
+/* Sockets and their owners, read once and shared by all objects of a scan */
+struct inet_scan {
+	struct proc_snapshot *snapshot;
+	struct inode_owner *owners;    // sorted by inode
+	size_t owner_count;
+	struct inet_socket *sockets;   // in /proc/net order
+	size_t socket_count;
+};
 
-	if (node == NULL || l == NULL)
-		return;
+static pthread_mutex_t g_inet_scan_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct inet_scan *g_inet_scan = NULL;
 
-	newnode = malloc(sizeof(lnode));
-	if (newnode == NULL)
-		return;
+static int inode_owner_cmp(const void *a, const void *b)
+{
+	const struct inode_owner *o1 = a, *o2 = b;
 
-	newnode->pid = node->pid;
-	newnode->uid = node->uid;
-	newnode->inode = node->inode;
-	// Take custody of the memory
-	newnode->cmd = node->cmd;
-	newnode->next = NULL;
-
-	// if we are at top, fix this up
-	if (l->head == NULL)
-		l->head = newnode;
-	else	// Otherwise add pointer to newnode
-		l->cur->next = newnode;
-
-	// make newnode current
-	l->cur = newnode;
+	if (o1->inode != o2->inode)
+		return o1->inode < o2->inode ? -1 : 1;
+	// The first process in the process table owns a shared socket
+	if (o1->order != o2->order)
+		return o1->order < o2->order ? -1 : 1;
+	return 0;
 }
 
-static void list_clear(llist* l)
+static const struct inode_owner *find_inode_owner(const struct inet_scan *scan, unsigned long inode)
 {
-	lnode* nextnode;
-	register lnode* cur;
-
-	cur = l->head;
-	while (cur) {
-		nextnode=cur->next;
-		free(cur->cmd);
-		free(cur);
-		cur=nextnode;
-	}
-	l->head = NULL;
-	l->cur = NULL;
-}
+	size_t lo = 0, hi = scan->owner_count;
 
-static lnode *list_find_inode(llist *l, unsigned long i)
-{
-        register lnode* cur;
-
-       	cur = l->head;	/* start at the beginning */
-	while (cur) {
-		if (cur->inode == i) {
-			l->cur = cur;
-			return cur;
-		} else
-			cur = cur->next;
+	// Find the first owner of the inode
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (scan->owners[mid].inode < inode)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+	if (lo < scan->owner_count && scan->owners[lo].inode == inode)
+		return &scan->owners[lo];
 	return NULL;
 }
 
-static int collect_process_info(llist *l)
+static int collect_process_info(struct inet_scan *scan)
 {
-	DIR *d, *f;
-	struct dirent *ent;
+	size_t count, capacity = 0;
 
-	d = opendir("/proc");
-	if (d == NULL)
+	scan->snapshot = proc_snapshot_get();
+	if (scan->snapshot == NULL)
 		return 1;
 
-	while (( ent = readdir(d) )) {
-		FILE *sf;
-		int pid, ppid;
-		char buf[100];
-		char *tmp, cmd[16], state, *text = NULL;
-		int fd, len, euid = 0;
+	proc_snapshot_load(scan->snapshot, PROC_SNAPSHOT_STAT | PROC_SNAPSHOT_STATUS | PROC_SNAPSHOT_SOCKETS);
+	count = proc_snapshot_count(scan->snapshot);
 
-		// Skip non-process dir entries
-		if(*ent->d_name<'0' || *ent->d_name>'9')
-			continue;
-		errno = 0;
-		pid = strtol(ent->d_name, NULL, 10);
-		if (errno)
-			continue;
+	for (size_t i = 0; i < count; ++i) {
+		const struct proc_entry *entry = proc_snapshot_nth(scan->snapshot, i);
 
-		// Parse up the stat file for the proc
-		snprintf(buf, 32, "/proc/%d/stat", pid);
-		fd = open(buf, O_RDONLY, 0);
-		if (fd < 0)
-			continue;
-		len = read(fd, buf, sizeof buf - 1);
-		close(fd);
-		if (len < 40)
-			continue;
-		buf[len] = 0;
-		tmp = strrchr(buf, ')');
-		if (tmp)
-			*tmp = 0;
-		else
+		// Skip kthreads and processes without a stat file
+		if (!entry->stat_valid || entry->pid == 2 || entry->ppid == 2)
 			continue;
-		memset(cmd, 0, sizeof(cmd));
-		sscanf(buf, "%d (%15c", &ppid, cmd);
-		sscanf(tmp+2, "%c %d", &state, &ppid);
 
-		// Skip kthreads
-		if (pid == 2 || ppid == 2)
+		// Process might have ended or we don't have access - ignore it
+		if (!entry->fd_valid)
 			continue;
 
-		// Get the effective uid
-		snprintf(buf, 32, "/proc/%d/status", pid);
-		sf = fopen(buf, "rt");
-		if (sf) {
-			int line = 0;
-			__fsetlocking(sf, FSETLOCKING_BYCALLER);
-			while (fgets(buf, sizeof(buf), sf)) {
-				if (line == 0) {
-					line++;
-					continue;
-				}
-				if (memcmp(buf, "Uid:", 4) == 0) {
-					int id;
-					sscanf(buf, "Uid: %d %d",
-						&id, &euid);
-					break;
-				}
-			}
-			fclose(sf);
-		}
+		// We make one entry for each socket inode
+		for (size_t j = 0; j < entry->socket_count; ++j) {
+			struct inode_owner *owner;
 
-		// Now lets get the inodes each process has open
-		snprintf(buf, 32, "/proc/%d/fd", pid);
-		f = opendir(buf);
-		if (f == NULL) {
-			// Process might have ended or we don;t have access - ignore it
-			free(text);
-			continue;
-		}
-		// For each file in the fd dir...
-		while (( ent = readdir(f) )) {
-			char line[256], *s, *e;
-			unsigned long inode;
-			lnode node;
-			int lnlen;
-
-			if (ent->d_name[0] == '.')
-				continue;
-			int pathname_len = snprintf(NULL, 0, "%s/%s", buf, ent->d_name);
-			if (pathname_len < 0) {
-				continue;
-			}
-			pathname_len++; // +1 for terminating '\0'
-			char *pathname = malloc(pathname_len);
-			snprintf(pathname, pathname_len, "%s/%s", buf, ent->d_name);
-			lnlen = readlink(pathname, line, sizeof(line) - 1);
-			free(pathname);
-			if (lnlen < 0) {
-				continue;
+			if (scan->owner_count == capacity) {
+				capacity = capacity ? capacity * 2 : 1024;
+				scan->owners = realloc(scan->owners, capacity * sizeof(struct inode_owner));
 			}
-			line[lnlen] = 0;
-
-			// Only look at the socket entries
-			if (memcmp(line, "socket:", 7) == 0) {
-				// Type 1 sockets
-				s = strchr(line+7, '[');
-				if (s == NULL)
-					continue;
-				s++;
-				e = strchr(s, ']');
-				if (e == NULL)
-					continue;
-				*e = 0;
-			} else if (memcmp(line, "[0000]:", 7) == 0) {
-				// Type 2 sockets
-				s = line + 8;
-			} else
-				continue;
-			errno = 0;
-			inode = strtoul(s, NULL, 10);
-			if (errno)
-				continue;
-			node.pid = pid;
-			node.uid = euid;
-			node.cmd = strdup(cmd);
-			node.inode = inode;
-			// We make one entry for each socket inode
-			list_append(l, &node);
+			owner = &scan->owners[scan->owner_count];
+			owner->inode = entry->sockets[j];
+			owner->pid = entry->pid;
+			// Use the effective uid, root if it can't be read
+			owner->uid = entry->euid != -1 ? entry->euid : 0;
+			owner->cmd = entry->comm;
+			owner->order = scan->owner_count++;
 		}
-		closedir(f);
-		free(text);
 	}
-	closedir(d);
+
+	qsort(scan->owners, scan->owner_count, sizeof(struct inode_owner), inode_owner_cmp);
 	return 0;
 }
 
@@ -333,42 +210,37 @@ static int eval_data(const char *type, const char *local_address,
 	return 1;
 }
 
-static void report_finding(struct result_info *res, llist *l, probe_ctx *ctx)
+static void report_finding(const struct inet_socket *s, const struct inode_owner *n, probe_ctx *ctx)
 {
         SEXP_t *item;
         SEXP_t se_lport_mem, se_rport_mem, se_lfull_mem, se_ffull_mem, *se_uid_mem = NULL;
-	lnode *n = NULL;
-
-	if (l) {
-		n = list_get_cur(l);
-	}
 
 	if (n) {
                 item = probe_item_create(OVAL_LINUX_INET_LISTENING_SERVER, NULL,
-                                 "protocol",             OVAL_DATATYPE_STRING,  res->proto,
-                                 "local_address",        OVAL_DATATYPE_STRING,  res->laddr,
-				 "local_port",           OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_lport_mem, res->lport),
+                                 "protocol",             OVAL_DATATYPE_STRING,  s->proto,
+                                 "local_address",        OVAL_DATATYPE_STRING,  s->laddr,
+				 "local_port",           OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_lport_mem, s->lport),
                                  "local_full_address",   OVAL_DATATYPE_SEXP,    SEXP_string_newf_r(&se_lfull_mem,
-                                                                                                   "%s:%u", res->laddr, res->lport),
+                                                                                                   "%s:%u", s->laddr, s->lport),
                                  "program_name",         OVAL_DATATYPE_STRING,  n->cmd,
-                                 "foreign_address",      OVAL_DATATYPE_STRING,  res->raddr,
-				 "foreign_port",         OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_rport_mem, res->rport),
+                                 "foreign_address",      OVAL_DATATYPE_STRING,  s->raddr,
+				 "foreign_port",         OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_rport_mem, s->rport),
                                  "foreign_full_address", OVAL_DATATYPE_SEXP,    SEXP_string_newf_r(&se_ffull_mem,
-                                                                                                   "%s:%u", res->raddr, res->rport),
+                                                                                                   "%s:%u", s->raddr, s->rport),
                                  "pid",                  OVAL_DATATYPE_INTEGER, (int64_t)n->pid,
 				 "user_id",              OVAL_DATATYPE_SEXP, se_uid_mem = SEXP_number_newu_64(n->uid),
                                  NULL);
 	} else {
                 item = probe_item_create(OVAL_LINUX_INET_LISTENING_SERVER, NULL,
-                                 "protocol",             OVAL_DATATYPE_STRING,  res->proto,
-                                 "local_address",        OVAL_DATATYPE_STRING,  res->laddr,
-				 "local_port",           OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_lport_mem, res->lport),
+                                 "protocol",             OVAL_DATATYPE_STRING,  s->proto,
+                                 "local_address",        OVAL_DATATYPE_STRING,  s->laddr,
+				 "local_port",           OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_lport_mem, s->lport),
                                  "local_full_address",   OVAL_DATATYPE_SEXP,    SEXP_string_newf_r(&se_lfull_mem,
-                                                                                                   "%s:%u", res->laddr, res->lport),
-                                 "foreign_address",      OVAL_DATATYPE_STRING,  res->raddr,
-				 "foreign_port",         OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_rport_mem, res->rport),
+                                                                                                   "%s:%u", s->laddr, s->lport),
+                                 "foreign_address",      OVAL_DATATYPE_STRING,  s->raddr,
+				 "foreign_port",         OVAL_DATATYPE_SEXP, SEXP_number_newu_64_r(&se_rport_mem, s->rport),
                                  "foreign_full_address", OVAL_DATATYPE_SEXP,    SEXP_string_newf_r(&se_ffull_mem,
-                                                                                                   "%s:%u", res->raddr, res->rport),
+                                                                                                   "%s:%u", s->raddr, s->rport),
                                  NULL);
 	}
 
@@ -397,17 +269,23 @@ static void addr_convert(const char *src, char *dest, int size)
 }
 
 
-static int read_tcp(const char *proc, const char *type, llist *l, probe_ctx *ctx, struct server_info *req)
+/*
+ * Read a tcp, udp or raw socket table of /proc/net, all of them have
+ * the same format.
+ */
+static int read_sockets(struct inet_scan *scan, const char *file, const char *type)
 {
 	int line = 0;
 	FILE *f;
-	char buf[256];
+	char buf[256], path[PATH_MAX];
 	unsigned long rxq, txq, time_len, retr, inode;
 	unsigned local_port, rem_port, uid;
 	int d, state, timer_run, timeout;
 	char rem_addr[128], local_addr[128], more[512];
+	size_t capacity = scan->socket_count;
 
-	f = fopen(proc, "rt");
+	snprintf(path, sizeof(path), "%s/net/%s", proc_snapshot_path(scan->snapshot), file);
+	f = fopen(path, "rt");
 	if (f == NULL) {
 		if (errno != ENOENT)
 			return 1;
@@ -430,132 +308,88 @@ static int read_tcp(const char *proc, const char *type, llist *l, probe_ctx *ctx
 		char src[NI_MAXHOST], dest[NI_MAXHOST];
 		addr_convert(local_addr, src, NI_MAXHOST);
 		addr_convert(rem_addr, dest, NI_MAXHOST);
-		dI("Have tcp port: %s:%u", src, local_port);
-		if (eval_data(type, src, local_port, req)) {
-			struct result_info r;
-			r.proto = type;
-			r.laddr = src;
-			r.lport = local_port;
-			r.raddr = dest;
-			r.rport = rem_port;
-			if (list_find_inode(l, inode)) {
-				report_finding(&r, l, ctx);
-			} else {
-				report_finding(&r, NULL, ctx);
-			}
+		dI("Have %s port: %s:%u", file, src, local_port);
+
+		if (scan->socket_count == capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			scan->sockets = realloc(scan->sockets, capacity * sizeof(struct inet_socket));
 		}
+		struct inet_socket *s = &scan->sockets[scan->socket_count++];
+		s->proto = type;
+		s->laddr = strdup(src);
+		s->lport = local_port;
+		s->raddr = strdup(dest);
+		s->rport = rem_port;
+		s->inode = inode;
 	}
 	fclose(f);
 	return 0;
 }
 
-static int read_udp(const char *proc, const char *type, llist *l, probe_ctx *ctx, struct server_info *req)
+static void inet_scan_free(struct inet_scan *scan)
 {
-	int line = 0;
-	FILE *f;
-	char buf[256];
-	unsigned long rxq, txq, time_len, retr, inode;
-	int local_port, rem_port, d, state, timer_run, uid, timeout;
-	char rem_addr[128], local_addr[128], more[512];
+	if (scan == NULL)
+		return;
 
-	f = fopen(proc, "rt");
-	if (f == NULL) {
-		if (errno != ENOENT)
-			return 1;
-		else
-			return 0;
+	for (size_t i = 0; i < scan->socket_count; ++i) {
+		free(scan->sockets[i].laddr);
+		free(scan->sockets[i].raddr);
 	}
-	__fsetlocking(f, FSETLOCKING_BYCALLER);
-	while (fgets(buf, sizeof(buf), f)) {
-		if (line == 0) {
-			line++;
-			continue;
-		}
-		more[0] = 0;
-		sscanf(buf, "%d: %64[0-9A-Fa-f]:%X %64[0-9A-Fa-f]:%X %X "
-			"%lX:%lX %X:%lX %lX %d %d %lu %511s\n",
-			&d, local_addr, &local_port, rem_addr, &rem_port,
-			&state, &txq, &rxq, &timer_run, &time_len, &retr,
-			&uid, &timeout, &inode, more);
+	free(scan->sockets);
+	free(scan->owners);
+	if (scan->snapshot != NULL)
+		proc_snapshot_put(scan->snapshot);
+	free(scan);
+}
 
-		char src[NI_MAXHOST], dest[NI_MAXHOST];
-		addr_convert(local_addr, src, NI_MAXHOST);
-		addr_convert(rem_addr, dest, NI_MAXHOST);
-		dI("Have udp port: %s:%u", src, local_port);
-		if (eval_data(type, src, local_port, req)) {
-			struct result_info r;
-			r.proto = type;
-			r.laddr = src;
-			r.lport = local_port;
-			r.raddr = dest;
-			r.rport = rem_port;
-			if (list_find_inode(l, inode)) {
-				report_finding(&r, l, ctx);
-			} else {
-				report_finding(&r, NULL, ctx);
-			}
-		}
+static struct inet_scan *inet_scan_new(void)
+{
+	struct inet_scan *scan = calloc(1, sizeof(struct inet_scan));
+
+	// Now start collecting the info
+	if (collect_process_info(scan)) {
+		inet_scan_free(scan);
+		return NULL;
 	}
-	fclose(f);
-	return 0;
+
+	// Now we check the tcp socket list...
+	read_sockets(scan, "tcp", "tcp");
+	read_sockets(scan, "tcp6", "tcp");
+
+	// Next udp sockets...
+	read_sockets(scan, "udp", "udp");
+	read_sockets(scan, "udp6", "udp");
+
+	// Next, raw sockets...not exactly part of standard yet. They
+	// can be used to send datagrams, so we will pretend they are udp
+	read_sockets(scan, "raw", "udp");
+	read_sockets(scan, "raw6", "udp");
+
+	dD("Found %zu sockets and %zu socket inodes of processes.", scan->socket_count, scan->owner_count);
+	return scan;
 }
 
-static int read_raw(const char *proc, const char *type, llist *l, probe_ctx *ctx, struct server_info *req)
+/*
+ * Get the sockets of the scan, they are read by the first object.
+ */
+static struct inet_scan *inet_scan_get(void)
 {
-	int line = 0;
-	FILE *f;
-	char buf[256];
-	unsigned long rxq, txq, time_len, retr, inode;
-	int local_port, rem_port, d, state, timer_run, uid, timeout;
-	char rem_addr[128], local_addr[128], more[512];
+	struct inet_scan *scan;
 
-	f = fopen(proc, "rt");
-	if (f == NULL) {
-		if (errno != ENOENT)
-			return 1;
-		else
-			return 0;
-	}
-	__fsetlocking(f, FSETLOCKING_BYCALLER);
-	while (fgets(buf, sizeof(buf), f)) {
-		if (line == 0) {
-			line++;
-			continue;
-		}
-		more[0] = 0;
-		sscanf(buf, "%d: %64[0-9A-Fa-f]:%X %64[0-9A-Fa-f]:%X %X "
-			"%lX:%lX %X:%lX %lX %d %d %lu %511s\n",
-			&d, local_addr, &local_port, rem_addr, &rem_port,
-			&state, &txq, &rxq, &timer_run, &time_len, &retr,
-			&uid, &timeout, &inode, more);
+	pthread_mutex_lock(&g_inet_scan_lock);
+	if (g_inet_scan == NULL)
+		g_inet_scan = inet_scan_new();
+	scan = g_inet_scan;
+	pthread_mutex_unlock(&g_inet_scan_lock);
 
-		char src[NI_MAXHOST], dest[NI_MAXHOST];
-		addr_convert(local_addr, src, NI_MAXHOST);
-		addr_convert(rem_addr, dest, NI_MAXHOST);
-		dI("Have raw port: %s:%u", src, local_port);
-		if (eval_data(type, src, local_port, req)) {
-			struct result_info r;
-			r.proto = type;
-			r.laddr = src;
-			r.lport = local_port;
-			r.raddr = dest;
-			r.rport = rem_port;
-			if (list_find_inode(l, inode)) {
-				report_finding(&r, l, ctx);
-			} else {
-				report_finding(&r, NULL, ctx);
-			}
-		}
-	}
-	fclose(f);
-	return 0;
+	return scan;
 }
 
 int inetlisteningservers_probe_main(probe_ctx *ctx, void *arg)
 {
         SEXP_t *object;
 	int err;
-	llist ll;
+	struct inet_scan *scan;
 
         object = probe_ctx_getobject(ctx);
 	struct server_info *req = malloc(sizeof(struct server_info));
@@ -581,9 +415,8 @@ int inetlisteningservers_probe_main(probe_ctx *ctx, void *arg)
 		goto cleanup;
 	}
 
-	// Now start collecting the info
-	list_create(&ll);
-	if (collect_process_info(&ll)) {
+	scan = inet_scan_get();
+	if (scan == NULL) {
 		SEXP_t *msg;
 
 		msg = probe_msg_creat(OVAL_MESSAGE_LEVEL_ERROR, "Permission error.");
@@ -595,20 +428,12 @@ int inetlisteningservers_probe_main(probe_ctx *ctx, void *arg)
 		goto cleanup;
 	}
 
-	// Now we check the tcp socket list...
-	read_tcp("/proc/net/tcp", "tcp", &ll, ctx, req);
-	read_tcp("/proc/net/tcp6", "tcp", &ll, ctx, req);
-
-	// Next udp sockets...
-	read_udp("/proc/net/udp", "udp", &ll, ctx, req);
-	read_udp("/proc/net/udp6", "udp", &ll, ctx, req);
-
-	// Next, raw sockets...not exactly part of standard yet. They
-	// can be used to send datagrams, so we will pretend they are udp
-	read_raw("/proc/net/raw", "udp", &ll, ctx, req);
-	read_raw("/proc/net/raw6", "udp", &ll, ctx, req);
+	for (size_t i = 0; i < scan->socket_count; ++i) {
+		const struct inet_socket *s = &scan->sockets[i];
 
-	list_clear(&ll);
+		if (eval_data(s->proto, s->laddr, s->lport, req))
+			report_finding(s, find_inode_owner(scan, s->inode), ctx);
+	}
 
 	err = 0;
  cleanup:
@@ -619,3 +444,12 @@ int inetlisteningservers_probe_main(probe_ctx *ctx, void *arg)
 
 	return err;
 }
+
+void inetlisteningservers_probe_fini(void *arg)
+{
+	pthread_mutex_lock(&g_inet_scan_lock);
+	inet_scan_free(g_inet_scan);
+	g_inet_scan = NULL;
+	pthread_mutex_unlock(&g_inet_scan_lock);
+	proc_snapshot_drop();
+}
@@ -27,4 +27,6 @@
 
 int inetlisteningservers_probe_main(probe_ctx *ctx, void *arg);
 
+void inetlisteningservers_probe_fini(void *arg);
+
 #endif /* OPENSCAP_INETLISTENINGSERVERS_PROBE_H */
@@ -24,6 +24,20 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <oscap_helpers.h>
+#include <crapi/crapi.h>
+
+#include "_seap.h"
+#include "common/oscap_parallel.h"
+
 #ifdef RPM46_FOUND
 int rpmErrorCb (rpmlogRec rec, rpmlogCallbackData data)
 {
@@ -51,3 +65,696 @@ void rpmLibsPreload()
 	const char* rcfiles = "";
 	rpmReadConfigFiles(rcfiles, NULL);
 }
+
+struct rpmdb_index {
+	char *root;              /**< root directory of the transaction set */
+	char *dbpath;            /**< expanded %{_dbpath} */
+	dev_t dev;               /**< device and inode of the rpmdb directory */
+	ino_t ino;
+	struct timespec mtime;   /**< the latest modification of the rpmdb */
+	unsigned int refcount;
+	pthread_mutex_t files_lock;
+	struct rpmdb_pkg *pkgs;  /**< packages in rpmdb order */
+	size_t count;
+	size_t *by_name;         /**< package indices sorted by name */
+};
+
+static pthread_mutex_t g_rpmdb_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rpmdb_index *g_rpmdb_index = NULL;
+
+static const char g_keyid_regex_string[] = "Key ID [a-fA-F0-9]{16}";
+
+/* Files of the rpmdb backends (bdb, ndb, sqlite) modified by transactions */
+static const char *g_rpmdb_files[] = {
+	"Packages", "Packages.db", "rpmdb.sqlite", "rpmdb.sqlite-wal", NULL
+};
+
+static int rpmdb_index_stat(const char *root, const char *dbpath, struct stat *dir_st, struct timespec *mtime)
+{
+	char path[PATH_MAX];
+	struct stat st;
+
+	if (root == NULL || strcmp(root, "/") == 0)
+		root = "";
+
+	snprintf(path, sizeof(path), "%s%s", root, dbpath);
+	if (stat(path, dir_st) != 0)
+		return -1;
+	*mtime = dir_st->st_mtim;
+
+	for (int i = 0; g_rpmdb_files[i] != NULL; ++i) {
+		snprintf(path, sizeof(path), "%s%s/%s", root, dbpath, g_rpmdb_files[i]);
+		if (stat(path, &st) != 0)
+			continue;
+		if (st.st_mtim.tv_sec > mtime->tv_sec ||
+		    (st.st_mtim.tv_sec == mtime->tv_sec && st.st_mtim.tv_nsec > mtime->tv_nsec))
+			*mtime = st.st_mtim;
+	}
+
+	return 0;
+}
+
+static void rpmdb_pkg_init(struct rpmdb_pkg *pkg, Header h, unsigned int offset, regex_t *keyid_regex)
+{
+	errmsg_t rpmerr;
+	const char *epoch;
+	char *str, *sid;
+	regmatch_t keyid_match[1];
+
+	memset(pkg, 0, sizeof(*pkg));
+	pkg->offset = offset;
+	pkg->name = headerFormat(h, "%{NAME}", &rpmerr);
+	pkg->arch = headerFormat(h, "%{ARCH}", &rpmerr);
+	pkg->epoch = headerFormat(h, "%{EPOCH}", &rpmerr);
+	pkg->release = headerFormat(h, "%{RELEASE}", &rpmerr);
+	pkg->version = headerFormat(h, "%{VERSION}", &rpmerr);
+
+	epoch = oscap_streq(pkg->epoch, "(none)") ? "0" : pkg->epoch;
+	pkg->evr = oscap_sprintf("%s:%s-%s", epoch, pkg->version, pkg->release);
+	pkg->extended_name = oscap_sprintf("%s-%s:%s-%s.%s", pkg->name, epoch, pkg->version, pkg->release, pkg->arch);
+
+	str = headerFormat(h, "%|SIGGPG?{%{SIGGPG:pgpsig}}:{%{SIGPGP:pgpsig}}|", &rpmerr);
+
+	if (str == NULL || regexec(keyid_regex, str, 1, keyid_match, 0) != 0) {
+		sid = NULL;
+		dD("Failed to extract the Key ID value: regex=\"%s\", string=\"%s\"",
+		   g_keyid_regex_string, str);
+	} else {
+		size_t keyid_start, keyid_length;
+
+		if (keyid_match[0].rm_so < 0 || keyid_match[0].rm_eo < 0)
+			sid = NULL;
+		else {
+			keyid_start = keyid_match[0].rm_so + strlen("Key ID ");
+			keyid_length = keyid_match[0].rm_eo - keyid_start;
+			sid = str + keyid_start;
+			sid[keyid_length] = '\0';
+		}
+	}
+
+	pkg->signature_keyid = strdup(sid != NULL ? sid : "0");
+	free(str);
+}
+
+static void rpmdb_pkg_free(struct rpmdb_pkg *pkg)
+{
+	free(pkg->name);
+	free(pkg->arch);
+	free(pkg->epoch);
+	free(pkg->release);
+	free(pkg->version);
+	free(pkg->evr);
+	free(pkg->signature_keyid);
+	free(pkg->extended_name);
+	for (size_t i = 0; i < pkg->file_count; ++i)
+		free(pkg->files[i]);
+	free(pkg->files);
+}
+
+static void rpmdb_index_free(struct rpmdb_index *index)
+{
+	if (index == NULL)
+		return;
+
+	for (size_t i = 0; i < index->count; ++i)
+		rpmdb_pkg_free(&index->pkgs[i]);
+	free(index->pkgs);
+	free(index->by_name);
+	free(index->root);
+	free(index->dbpath);
+	pthread_mutex_destroy(&index->files_lock);
+	free(index);
+}
+
+/* qsort_r isn't portable, indices are built under g_rpmdb_index_lock */
+static const struct rpmdb_pkg *g_sort_pkgs;
+
+static int rpmdb_index_cmp_name(const void *a, const void *b)
+{
+	size_t ia = *(const size_t *)a, ib = *(const size_t *)b;
+	int ret = strcmp(g_sort_pkgs[ia].name, g_sort_pkgs[ib].name);
+
+	if (ret != 0)
+		return ret;
+	/* Packages of the same name stay in rpmdb order */
+	return (ia > ib) - (ia < ib);
+}
+
+static struct rpmdb_index *rpmdb_index_build(rpmts ts)
+{
+	struct rpmdb_index *index;
+	rpmdbMatchIterator match;
+	regex_t keyid_regex;
+	size_t capacity = 0;
+	Header pkgh;
+
+	if (regcomp(&keyid_regex, g_keyid_regex_string, REG_EXTENDED) != 0) {
+		dE("regcomp(%s) failed.", g_keyid_regex_string);
+		return NULL;
+	}
+
+	index = calloc(1, sizeof(*index));
+	if (index == NULL) {
+		dE("Can't allocate memory for the rpmdb index.");
+		regfree(&keyid_regex);
+		return NULL;
+	}
+	pthread_mutex_init(&index->files_lock, NULL);
+
+	match = rpmtsInitIterator(ts, RPMDBI_PACKAGES, NULL, 0);
+	if (match != NULL) {
+		while ((pkgh = rpmdbNextIterator(match)) != NULL) {
+			if (index->count == capacity) {
+				size_t new_capacity = capacity ? capacity * 2 : 512;
+				struct rpmdb_pkg *pkgs = realloc(index->pkgs, new_capacity * sizeof(struct rpmdb_pkg));
+				if (pkgs == NULL) {
+					dE("Can't allocate memory for %zu packages of the rpmdb index.", new_capacity);
+					rpmdbFreeIterator(match);
+					regfree(&keyid_regex);
+					rpmdb_index_free(index);
+					return NULL;
+				}
+				index->pkgs = pkgs;
+				capacity = new_capacity;
+			}
+			rpmdb_pkg_init(&index->pkgs[index->count], pkgh,
+			               rpmdbGetIteratorOffset(match), &keyid_regex);
+			index->count++;
+		}
+		rpmdbFreeIterator(match);
+	}
+	regfree(&keyid_regex);
+
+	index->by_name = malloc((index->count + 1) * sizeof(size_t));
+	if (index->by_name == NULL) {
+		dE("Can't allocate memory for the rpmdb index.");
+		rpmdb_index_free(index);
+		return NULL;
+	}
+	for (size_t i = 0; i < index->count; ++i)
+		index->by_name[i] = i;
+	g_sort_pkgs = index->pkgs;
+	qsort(index->by_name, index->count, sizeof(size_t), rpmdb_index_cmp_name);
+	g_sort_pkgs = NULL;
+
+	dD("Indexed %zu packages of the rpmdb.", index->count);
+	return index;
+}
+
+static void rpmdb_index_unref(struct rpmdb_index *index)
+{
+	if (index != NULL && --index->refcount == 0)
+		rpmdb_index_free(index);
+}
+
+struct rpmdb_index *rpmdb_index_get(rpmts ts)
+{
+	struct rpmdb_index *index;
+	struct stat dir_st;
+	struct timespec mtime;
+	const char *root = rpmtsRootDir(ts);
+	char *dbpath = rpmExpand("%{_dbpath}", NULL);
+
+	if (root == NULL)
+		root = "/";
+
+	if (rpmdb_index_stat(root, dbpath, &dir_st, &mtime) != 0) {
+		/* Let librpm report the missing database */
+		memset(&dir_st, 0, sizeof(dir_st));
+		memset(&mtime, 0, sizeof(mtime));
+	}
+
+	pthread_mutex_lock(&g_rpmdb_index_lock);
+
+	index = g_rpmdb_index;
+	if (index != NULL && oscap_streq(index->root, root) && oscap_streq(index->dbpath, dbpath) &&
+	    index->dev == dir_st.st_dev && index->ino == dir_st.st_ino &&
+	    index->mtime.tv_sec == mtime.tv_sec && index->mtime.tv_nsec == mtime.tv_nsec) {
+		index->refcount++;
+		pthread_mutex_unlock(&g_rpmdb_index_lock);
+		free(dbpath);
+		return index;
+	}
+
+	if (index != NULL)
+		dD("The rpmdb index is outdated, rebuilding it.");
+	rpmdb_index_unref(g_rpmdb_index);
+	g_rpmdb_index = NULL;
+
+	index = rpmdb_index_build(ts);
+	if (index != NULL) {
+		index->root = strdup(root);
+		index->dbpath = dbpath;
+		index->dev = dir_st.st_dev;
+		index->ino = dir_st.st_ino;
+		index->mtime = mtime;
+		/* One reference is held by the cache */
+		index->refcount = 2;
+		g_rpmdb_index = index;
+	} else {
+		free(dbpath);
+	}
+
+	pthread_mutex_unlock(&g_rpmdb_index_lock);
+	return index;
+}
+
+void rpmdb_index_put(struct rpmdb_index *index)
+{
+	pthread_mutex_lock(&g_rpmdb_index_lock);
+	rpmdb_index_unref(index);
+	pthread_mutex_unlock(&g_rpmdb_index_lock);
+}
+
+void rpmdb_index_drop(void)
+{
+	pthread_mutex_lock(&g_rpmdb_index_lock);
+	rpmdb_index_unref(g_rpmdb_index);
+	g_rpmdb_index = NULL;
+	pthread_mutex_unlock(&g_rpmdb_index_lock);
+}
+
+int rpmdb_index_find(struct rpmdb_index *index, const char *name, oval_operation_t op, struct rpmdb_pkg ***pkgs)
+{
+	size_t count = 0;
+	regex_t re;
+
+	*pkgs = malloc((index->count + 1) * sizeof(struct rpmdb_pkg *));
+	if (*pkgs == NULL) {
+		dE("Can't allocate memory for the packages found.");
+		return -1;
+	}
+
+	switch (op) {
+	case OVAL_OPERATION_EQUALS: {
+		/* Find the first package of the name */
+		size_t lo = 0, hi = index->count;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (strcmp(index->pkgs[index->by_name[mid]].name, name) < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		for (; lo < index->count && strcmp(index->pkgs[index->by_name[lo]].name, name) == 0; ++lo)
+			(*pkgs)[count++] = &index->pkgs[index->by_name[lo]];
+		break;
+	}
+	case OVAL_OPERATION_NOT_EQUAL:
+		for (size_t i = 0; i < index->count; ++i)
+			(*pkgs)[count++] = &index->pkgs[i];
+		break;
+	case OVAL_OPERATION_PATTERN_MATCH:
+		/* The same flags as librpm uses for RPMMIRE_REGEX */
+		if (regcomp(&re, name, REG_EXTENDED | REG_NOSUB) != 0) {
+			dE("regcomp(%s) failed.", name);
+			free(*pkgs);
+			*pkgs = NULL;
+			return -1;
+		}
+		for (size_t i = 0; i < index->count; ++i) {
+			if (regexec(&re, index->pkgs[i].name, 0, NULL, 0) == 0)
+				(*pkgs)[count++] = &index->pkgs[i];
+		}
+		regfree(&re);
+		break;
+	default:
+		free(*pkgs);
+		*pkgs = NULL;
+		return -1;
+	}
+
+	return (int)count;
+}
+
+int rpmdb_index_find_ent(struct rpmdb_index *index, SEXP_t *name_ent, struct rpmdb_pkg ***pkgs)
+{
+	oval_operation_t op;
+	char name[1024];
+
+	if (name_ent == NULL)
+		return rpmdb_index_find(index, "", OVAL_OPERATION_NOT_EQUAL, pkgs);
+
+	op = probe_ent_getoperation(name_ent, OVAL_OPERATION_EQUALS);
+	PROBE_ENT_STRVAL(name_ent, name, sizeof name, op = OVAL_OPERATION_NOT_EQUAL;, strcpy(name, ""););
+
+	switch (op) {
+	case OVAL_OPERATION_EQUALS:
+	case OVAL_OPERATION_PATTERN_MATCH:
+		return rpmdb_index_find(index, name, op, pkgs);
+	default:
+		return rpmdb_index_find(index, name, OVAL_OPERATION_NOT_EQUAL, pkgs);
+	}
+}
+
+rpmdbMatchIterator rpmdb_index_pkg_iterator(rpmts ts, const struct rpmdb_pkg *pkg)
+{
+	unsigned int offset = pkg->offset;
+
+	return rpmtsInitIterator(ts, RPMDBI_PACKAGES, &offset, sizeof(offset));
+}
+
+int rpmdb_index_load_files(struct rpmdb_index *index, rpmts ts, struct rpmdb_pkg *pkg)
+{
+	rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
+	rpmdbMatchIterator match;
+	size_t capacity = 0;
+	Header pkgh;
+	int ret = 0;
+
+	pthread_mutex_lock(&index->files_lock);
+
+	if (pkg->files_loaded)
+		goto cleanup;
+
+	match = rpmdb_index_pkg_iterator(ts, pkg);
+	if (match == NULL || (pkgh = rpmdbNextIterator(match)) == NULL) {
+		if (match != NULL)
+			rpmdbFreeIterator(match);
+		ret = -1;
+		goto cleanup;
+	}
+
+	for (int i = 0; ret == 0 && i < 2; ++i) {
+		rpmfi fi = rpmfiNew(ts, pkgh, tag[i], 1);
+
+		while (ret == 0 && rpmfiNext(fi) != -1) {
+			if (pkg->file_count == capacity) {
+				size_t new_capacity = capacity ? capacity * 2 : 64;
+				char **files = realloc(pkg->files, new_capacity * sizeof(char *));
+				if (files == NULL) {
+					ret = -1;
+					break;
+				}
+				pkg->files = files;
+				capacity = new_capacity;
+			}
+			if ((pkg->files[pkg->file_count] = strdup(rpmfiFN(fi))) == NULL)
+				ret = -1;
+			else
+				pkg->file_count++;
+		}
+		rpmfiFree(fi);
+	}
+	rpmdbFreeIterator(match);
+
+	if (ret != 0) {
+		dE("Can't allocate memory for the files of the package %s.", pkg->name);
+		for (size_t i = 0; i < pkg->file_count; ++i)
+			free(pkg->files[i]);
+		free(pkg->files);
+		pkg->files = NULL;
+		pkg->file_count = 0;
+		goto cleanup;
+	}
+	pkg->files_loaded = true;
+
+cleanup:
+	pthread_mutex_unlock(&index->files_lock);
+	return ret;
+}
+
+#ifdef RPM47_FOUND
+static crapi_alg_t rpmverify_crapi_alg(int algo)
+{
+	switch (algo) {
+#ifdef OPENSCAP_ENABLE_MD5
+	case PGPHASHALGO_MD5:
+		return CRAPI_DIGEST_MD5;
+#endif
+#ifdef OPENSCAP_ENABLE_SHA1
+	case PGPHASHALGO_SHA1:
+		return CRAPI_DIGEST_SHA1;
+#endif
+	case PGPHASHALGO_SHA224:
+		return CRAPI_DIGEST_SHA224;
+	case PGPHASHALGO_SHA256:
+		return CRAPI_DIGEST_SHA256;
+	case PGPHASHALGO_SHA384:
+		return CRAPI_DIGEST_SHA384;
+	case PGPHASHALGO_SHA512:
+		return CRAPI_DIGEST_SHA512;
+	default:
+		return 0;
+	}
+}
+#endif
+
+/* The content of a file to be digested by crapi once the rpmdb is released */
+struct rpmverify_digest {
+	size_t file;                 /**< index of the file in the results */
+	char *path;                  /**< the file as installed */
+	crapi_alg_t alg;
+	size_t digest_len;
+	unsigned char digest[64];    /**< the digest recorded in the rpmdb */
+};
+
+/*
+ * Same as rpmVerifyFile(), except that the file digest is left to crapi if
+ * it supports the digest algorithm of the file. In that case dg->alg is set
+ * and the digest is verified by rpmverify_file_digest() later.
+ */
+static int rpmverify_file(const rpmts ts, const rpmfi fi, rpmVerifyAttrs *res, rpmVerifyAttrs omitMask,
+		struct rpmverify_digest *dg)
+{
+#ifdef RPM47_FOUND
+	const unsigned char *digest;
+	size_t digest_len;
+	crapi_alg_t alg;
+	int algo, ret;
+#endif
+
+	dg->alg = 0;
+#ifdef RPM47_FOUND
+	/*
+	 * Leave everything to librpm if it wouldn't compute the digest or if
+	 * crapi doesn't implement the algorithm. The conditions follow
+	 * rpmfiVerify().
+	 */
+	if ((omitMask & RPMVERIFY_FILEDIGEST) ||
+	    !(rpmfiVFlags(fi) & RPMVERIFY_FILEDIGEST) ||
+	    (rpmfiFFlags(fi) & RPMFILE_GHOST) ||
+	    rpmfiFState(fi) == RPMFILE_STATE_NETSHARED ||
+	    rpmfiFState(fi) == RPMFILE_STATE_NOTINSTALLED ||
+	    (digest = rpmfiFDigest(fi, &algo, &digest_len)) == NULL ||
+	    digest_len > sizeof(dg->digest) ||
+	    (alg = rpmverify_crapi_alg(algo)) == 0)
+		return rpmVerifyFile(ts, fi, res, omitMask);
+
+	ret = rpmVerifyFile(ts, fi, res, omitMask | RPMVERIFY_FILEDIGEST);
+	if (ret == 0) {
+		dg->alg = alg;
+		dg->digest_len = digest_len;
+		memcpy(dg->digest, digest, digest_len);
+	}
+	return ret;
+#else
+	return rpmVerifyFile(ts, fi, res, omitMask);
+#endif
+}
+
+#ifdef RPM47_FOUND
+static void rpmverify_file_digest(const struct rpmverify_digest *dg, rpmVerifyAttrs *res)
+{
+	unsigned char fdigest[64];
+	size_t fdigest_len = sizeof(fdigest);
+	struct stat st;
+	int fd;
+
+	/* Only the content of regular files is verified */
+	if (lstat(dg->path, &st) != 0 || !S_ISREG(st.st_mode))
+		return;
+
+	fd = open(dg->path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || crapi_digest_fd(fd, dg->alg, fdigest, &fdigest_len) != 0 || fdigest_len != dg->digest_len)
+		*res |= RPMVERIFY_READFAIL | RPMVERIFY_FILEDIGEST;
+	else if (memcmp(fdigest, dg->digest, dg->digest_len) != 0)
+		*res |= RPMVERIFY_FILEDIGEST;
+	if (fd >= 0)
+		close(fd);
+}
+#endif
+
+struct rpmverify_run {
+	rpmts ts;
+	struct rpmdb_pkg **pkgs;
+	rpmVerifyAttrs omit;
+	rpmverify_file_filter filter;
+	void *filter_arg;
+	struct rpmverify_pkg_res *results;
+	struct rpmverify_progress *progress;
+	pthread_mutex_t lock;    /**< guards the progress */
+	pthread_mutex_t db_lock; /**< guards every librpm call */
+};
+
+static void rpmverify_run_progress(struct rpmverify_run *run, size_t files)
+{
+	struct rpmverify_progress *progress = run->progress;
+
+	pthread_mutex_lock(&run->lock);
+	progress->packages_done++;
+	progress->files_verified += files;
+	if (progress->packages_done % 100 == 0 || progress->packages_done == progress->packages) {
+		dD("Verified %zu of %zu packages, %zu files.",
+		   progress->packages_done, progress->packages, progress->files_verified);
+	}
+	pthread_mutex_unlock(&run->lock);
+}
+
+/*
+ * Verify the files of a package against the header read from the rpmdb. The
+ * workers share the transaction set of the caller and neither rpmts, the
+ * rpmdb handle it opens with any of the backends (bdb, ndb, sqlite), nor the
+ * rpmfi iterators over its headers are thread safe, so everything librpm
+ * does for the package runs under db_lock. The file digests, which is where
+ * the time goes, are collected in *digests and computed by the caller after
+ * the lock is released.
+ */
+static void rpmverify_pkg_files(struct rpmverify_run *run, size_t i,
+		struct rpmverify_digest **digests, size_t *digest_count)
+{
+	struct rpmverify_pkg_res *res = &run->results[i];
+	rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
+	size_t capacity = 0, digest_capacity = 0;
+	rpmdbMatchIterator match;
+	Header pkgh;
+
+	match = rpmdb_index_pkg_iterator(run->ts, run->pkgs[i]);
+	if (match == NULL || (pkgh = rpmdbNextIterator(match)) == NULL) {
+		dE("Can't read the header of package %s from rpmdb.", run->pkgs[i]->name);
+		if (match != NULL)
+			rpmdbFreeIterator(match);
+		res->error = -1;
+		return;
+	}
+
+	for (int t = 0; t < 2 && res->error == 0; ++t) {
+		rpmfi fi = rpmfiNew(run->ts, pkgh, tag[t], 1);
+
+		while (rpmfiNext(fi) != -1) {
+			struct rpmverify_file_res *file_res;
+			struct rpmverify_digest dg;
+			rpmfileAttrs fflags = rpmfiFFlags(fi);
+			char *file = NULL;
+			int cmp = run->filter(rpmfiFN(fi), fflags, run->filter_arg, &file);
+
+			if (cmp == 1)
+				continue;
+			if (cmp == -1) {
+				res->error = -1;
+				break;
+			}
+
+			if (res->count == capacity) {
+				size_t new_capacity = capacity ? capacity * 2 : 16;
+				struct rpmverify_file_res *files = realloc(res->files, new_capacity * sizeof(struct rpmverify_file_res));
+
+				if (files == NULL) {
+					dE("Can't allocate results of package %s.", run->pkgs[i]->name);
+					free(file);
+					res->error = -1;
+					break;
+				}
+				res->files = files;
+				capacity = new_capacity;
+			}
+			file_res = &res->files[res->count++];
+			file_res->file = file != NULL ? file : strdup(rpmfiFN(fi));
+			file_res->fflags = fflags;
+			if (rpmverify_file(run->ts, fi, &file_res->vflags, run->omit, &dg) != 0) {
+				file_res->vflags = RPMVERIFY_FAILURES;
+				continue;
+			}
+			if (dg.alg == 0)
+				continue;
+
+			if (*digest_count == digest_capacity) {
+				size_t new_capacity = digest_capacity ? digest_capacity * 2 : 16;
+				struct rpmverify_digest *d = realloc(*digests, new_capacity * sizeof(struct rpmverify_digest));
+
+				if (d == NULL) {
+					dE("Can't allocate results of package %s.", run->pkgs[i]->name);
+					res->error = -1;
+					break;
+				}
+				*digests = d;
+				digest_capacity = new_capacity;
+			}
+			dg.file = res->count - 1;
+			if ((dg.path = strdup(rpmfiFN(fi))) == NULL) {
+				dE("Can't allocate results of package %s.", run->pkgs[i]->name);
+				res->error = -1;
+				break;
+			}
+			(*digests)[(*digest_count)++] = dg;
+		}
+		rpmfiFree(fi);
+	}
+	rpmdbFreeIterator(match);
+}
+
+static void rpmverify_pkg_job(size_t i, void *arg)
+{
+	struct rpmverify_run *run = arg;
+	struct rpmverify_pkg_res *res = &run->results[i];
+	struct rpmverify_digest *digests = NULL;
+	size_t digest_count = 0;
+
+	pthread_mutex_lock(&run->db_lock);
+	rpmverify_pkg_files(run, i, &digests, &digest_count);
+	pthread_mutex_unlock(&run->db_lock);
+
+	for (size_t d = 0; d < digest_count; ++d) {
+#ifdef RPM47_FOUND
+		if (res->error == 0)
+			rpmverify_file_digest(&digests[d], &res->files[digests[d].file].vflags);
+#endif
+		free(digests[d].path);
+	}
+	free(digests);
+
+	rpmverify_run_progress(run, res->count);
+}
+
+void rpmverify_pkgs(rpmts ts, struct rpmdb_pkg **pkgs, size_t count, rpmVerifyAttrs omit,
+		rpmverify_file_filter filter, void *filter_arg,
+		struct rpmverify_pkg_res *results, struct rpmverify_progress *progress)
+{
+	struct rpmverify_progress local_progress;
+	struct rpmverify_run run = {
+		.ts = ts,
+		.pkgs = pkgs,
+		.omit = omit,
+		.filter = filter,
+		.filter_arg = filter_arg,
+		.results = results,
+		.progress = progress != NULL ? progress : &local_progress
+	};
+
+	memset(results, 0, count * sizeof(struct rpmverify_pkg_res));
+	memset(run.progress, 0, sizeof(struct rpmverify_progress));
+	run.progress->packages = count;
+	pthread_mutex_init(&run.lock, NULL);
+	pthread_mutex_init(&run.db_lock, NULL);
+
+	if (oscap_parallel_run(count, rpmverify_pkg_job, &run) != 0) {
+		for (size_t i = 0; i < count; ++i)
+			rpmverify_pkg_job(i, &run);
+	}
+
+	pthread_mutex_destroy(&run.db_lock);
+	pthread_mutex_destroy(&run.lock);
+}
+
+void rpmverify_pkg_res_free(struct rpmverify_pkg_res *results, size_t count)
+{
+	if (results == NULL)
+		return;
+
+	for (size_t i = 0; i < count; ++i) {
+		for (size_t j = 0; j < results[i].count; ++j)
+			free(results[i].files[j].file);
+		free(results[i].files);
+	}
+	free(results);
+}
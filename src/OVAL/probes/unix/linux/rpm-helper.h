@@ -34,6 +34,10 @@
 #include <rpm/header.h>
 
 #include <pthread.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+#include <oval_definitions.h>
+#include <probe-api.h>
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "pthread.h"
@@ -93,6 +97,132 @@ int rpmVerifyFile(const rpmts ts, const rpmfi fi,
                 rpmVerifyAttrs * res, rpmVerifyAttrs omitMask);
 #endif
 
+/**
+ * Installed package cached by the rpmdb index. The strings are formatted
+ * the same way the rpm probes report them.
+ */
+struct rpmdb_pkg {
+	unsigned int offset;   /**< rpmdb record number of the package header */
+	char *name;
+	char *arch;
+	char *epoch;
+	char *release;
+	char *version;
+	char *evr;             /**< epoch:version-release, epoch defaults to 0 */
+	char *signature_keyid;
+	char *extended_name;   /**< name-epoch:version-release.arch */
+	char **files;          /**< files and directories, see rpmdb_index_load_files() */
+	size_t file_count;
+	bool files_loaded;
+};
+
+/**
+ * In-memory index of the installed packages shared by all rpm probes.
+ * The index is built on the first use and reused until the rpmdb
+ * is modified or the rpm probes are finalized.
+ */
+struct rpmdb_index;
+
+/**
+ * Get a reference to the index of the rpmdb used by the transaction set.
+ * The index is rebuilt if the rpmdb has been modified since it was built.
+ * Returns NULL on error.
+ */
+struct rpmdb_index *rpmdb_index_get(rpmts ts);
+
+/**
+ * Release a reference obtained by rpmdb_index_get().
+ */
+void rpmdb_index_put(struct rpmdb_index *index);
+
+/**
+ * Drop the cached index, it is freed once all references are released.
+ * Called when a rpm probe is finalized.
+ */
+void rpmdb_index_drop(void);
+
+/**
+ * Find packages by name. OVAL_OPERATION_EQUALS looks the name up in the
+ * index, OVAL_OPERATION_PATTERN_MATCH matches the names the same way as
+ * RPMMIRE_REGEX and OVAL_OPERATION_NOT_EQUAL selects all the packages.
+ * A newly allocated array of packages in rpmdb order is stored in *pkgs.
+ * Returns the number of packages or -1 on error.
+ */
+int rpmdb_index_find(struct rpmdb_index *index, const char *name, oval_operation_t op, struct rpmdb_pkg ***pkgs);
+
+/**
+ * Find packages by the name entity of an object, see rpmdb_index_find().
+ * All the packages are returned if the entity is NULL or if its operation
+ * can't be looked up in the index. The caller is expected to compare the
+ * names of the returned packages with the entity.
+ */
+int rpmdb_index_find_ent(struct rpmdb_index *index, SEXP_t *name_ent, struct rpmdb_pkg ***pkgs);
+
+/**
+ * Load the list of files and directories of a package, if it hasn't been
+ * loaded yet. Returns 0 on success and -1 on error.
+ */
+int rpmdb_index_load_files(struct rpmdb_index *index, rpmts ts, struct rpmdb_pkg *pkg);
+
+/**
+ * Create an iterator over the header of an indexed package.
+ */
+rpmdbMatchIterator rpmdb_index_pkg_iterator(rpmts ts, const struct rpmdb_pkg *pkg);
+
+/**
+ * Filter of the files verified by rpmverify_pkgs(). Returns 0 if the file
+ * is to be verified, 1 if it is skipped and -1 on error. The path reported
+ * for the file can be stored in *result_file, the path from the rpmdb is
+ * used otherwise. Called from the worker threads, one at a time.
+ */
+typedef int (*rpmverify_file_filter)(const char *file, rpmfileAttrs fflags, void *arg, char **result_file);
+
+/**
+ * Verification result of a single file.
+ */
+struct rpmverify_file_res {
+	char *file;            /**< filepath */
+	rpmVerifyAttrs vflags; /**< rpm verify flags */
+	rpmfileAttrs fflags;   /**< rpm file flags */
+};
+
+/**
+ * Verified files of a package in rpmdb order.
+ */
+struct rpmverify_pkg_res {
+	struct rpmverify_file_res *files;
+	size_t count;
+	int error;             /**< the filter failed, files are incomplete */
+};
+
+/**
+ * Progress of rpmverify_pkgs(), the counters are updated by the worker
+ * threads as the packages are verified.
+ */
+struct rpmverify_progress {
+	size_t packages;        /**< packages to verify */
+	size_t packages_done;   /**< packages verified so far */
+	size_t files_verified;  /**< files verified so far */
+};
+
+/**
+ * Verify the files of the packages in a pool of worker threads. The workers
+ * share ts, so every librpm call is made under a lock and only the digests
+ * of the file contents are computed in parallel.
+ * A package whose header can't be read or whose results can't be stored
+ * gets its error set. The files of pkgs[i] are stored to results[i], so that the callers can
+ * report them in a stable order regardless of the number of workers.
+ * The progress is optional.
+ */
+void rpmverify_pkgs(rpmts ts, struct rpmdb_pkg **pkgs, size_t count, rpmVerifyAttrs omit,
+		rpmverify_file_filter filter, void *filter_arg,
+		struct rpmverify_pkg_res *results, struct rpmverify_progress *progress);
+
+/**
+ * Free the results of rpmverify_pkgs().
+ */
+void rpmverify_pkg_res_free(struct rpmverify_pkg_res *results, size_t count);
+
 /**
  * Preload libraries required by rpm
  * It destroy error callback!
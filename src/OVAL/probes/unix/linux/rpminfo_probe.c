@@ -57,7 +57,6 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
-#include <regex.h>
 
 /* RPM headers */
 #include "rpm-helper.h"
@@ -69,6 +68,7 @@
 #include <probe/option.h>
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
+#include "common/list.h"
 #include "rpminfo_probe.h"
 
 
@@ -77,204 +77,35 @@ struct rpminfo_req {
         oval_operation_t op;
 };
 
-struct rpminfo_rep {
-        char *name;
-        char *arch;
-        char *epoch;
-        char *release;
-        char *version;
-        char *evr;
-        char *signature_keyid;
-	char extended_name[1024];
-};
-
 #define RPMINFO_LOCK	RPM_MUTEX_LOCK(&g_rpm->mutex)
 
 #define RPMINFO_UNLOCK	RPM_MUTEX_UNLOCK(&g_rpm->mutex)
 
-static const char g_keyid_regex_string[] = "Key ID [a-fA-F0-9]{16}";
-
-static void __rpminfo_rep_free (struct rpminfo_rep *ptr)
-{
-        free (ptr->name);
-        free (ptr->arch);
-        free (ptr->epoch);
-        free (ptr->release);
-        free (ptr->version);
-        free (ptr->evr);
-        free (ptr->signature_keyid);
-}
-
-static void pkgh2rep(Header h, struct rpminfo_rep *r, regex_t *keyid_regex)
-{
-        errmsg_t rpmerr;
-        char *str, *sid;
-	char *epoch_override = NULL;
-        size_t len;
-	regmatch_t keyid_match[1];
-
-	if (h == NULL || r == NULL) {
-		return;
-	}
-
-        r->name = headerFormat (h, "%{NAME}", &rpmerr);
-        r->arch = headerFormat (h, "%{ARCH}", &rpmerr);
-        r->epoch = headerFormat (h, "%{EPOCH}", &rpmerr);
-        r->release = headerFormat (h, "%{RELEASE}", &rpmerr);
-        r->version = headerFormat (h, "%{VERSION}", &rpmerr);
-	epoch_override = oscap_streq(r->epoch, "(none)") ? "0" : r->epoch;
-	snprintf(r->extended_name, 1024, "%s-%s:%s-%s.%s", r->name, epoch_override, r->version, r->release, r->arch);
-
-	len = (strlen(epoch_override) +
-               strlen (r->release) +
-               strlen (r->version) + 2);
-
-        str = malloc (sizeof (char) * (len + 1));
-        snprintf (str, len + 1, "%s:%s-%s",
-		epoch_override,
-                  r->version,
-                  r->release);
-
-        r->evr = str;
-
-        str = headerFormat (h, "%|SIGGPG?{%{SIGGPG:pgpsig}}:{%{SIGPGP:pgpsig}}|", &rpmerr);
-
-	if (regexec(keyid_regex, str, 1, keyid_match, 0) != 0) {
-		sid = NULL;
-		dD("Failed to extract the Key ID value: regex=\"%s\", string=\"%s\"",
-		   g_keyid_regex_string, str);
-	} else {
-		size_t keyid_start, keyid_length;
-
-		if (keyid_match[0].rm_so < 0 || keyid_match[0].rm_eo < 0)
-			sid = NULL;
-		else {
-			keyid_start = keyid_match[0].rm_so + strlen("Key ID ");
-			keyid_length = keyid_match[0].rm_eo - keyid_start;
-			sid = str + keyid_start;
-			sid[keyid_length] = '\0';
-		}
-	}
-
-        r->signature_keyid = strdup(sid != NULL ? sid : "0");
-        free (str);
-}
-
 /*
  * req - Structure containing the name of the package.
- * rep - Pointer to rpminfo_rep structure pointer. An
- *       array of rpminfo_rep structures will be allocated
- *       here.
+ * rep - Pointer to an array of package pointers. The array
+ *       is allocated here and the packages are owned by
+ *       the index returned in *index.
  *
  * The return value on error is -1. Otherwise the number of
- * rpminfo_rep structures allocated in *rep is returned.
+ * packages in *rep is returned.
  */
-static int get_rpminfo(struct rpminfo_req *req, struct rpminfo_rep **rep, struct rpm_probe_global *g_rpm)
+static int get_rpminfo(struct rpminfo_req *req, struct rpmdb_pkg ***rep, struct rpmdb_index **index, struct rpm_probe_global *g_rpm)
 {
-	rpmdbMatchIterator match;
-	Header pkgh;
-	int ret = 0, i;
-	regex_t keyid_regex;
-
-	if (regcomp(&keyid_regex, g_keyid_regex_string, REG_EXTENDED) != 0) {
-		dE("regcomp(%s) failed.", g_keyid_regex_string);
-		return -1;
-	}
-
-        RPMINFO_LOCK;
-
-        ret = -1;
-
-        switch (req->op) {
-        case OVAL_OPERATION_EQUALS:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMTAG_NAME, (const void *)req->name, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                ret = rpmdbGetIteratorCount (match);
-
-                break;
-	case OVAL_OPERATION_NOT_EQUAL:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                if (rpmdbSetIteratorRE (match, RPMTAG_NAME, RPMMIRE_GLOB, "*") != 0)
-                {
-                        ret = -1;
-                        goto ret;
-                }
-
-                break;
-        case OVAL_OPERATION_PATTERN_MATCH:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                if (rpmdbSetIteratorRE (match, RPMTAG_NAME, RPMMIRE_REGEX,
-                                        (const char *)req->name) != 0)
-                {
-                        ret = -1;
-                        goto ret;
-                }
+	int ret;
 
-                break;
-        default:
-                /* not supported */
-                ret = -1;
-                goto ret;
-        }
-
-        if (ret != -1) {
-                /*
-                 * We can allocate all memory needed now because we know the number
-                 * of results.
-                 */
-                void *new_rep = realloc (*rep, sizeof (struct rpminfo_rep) * ret);
-                if (new_rep == NULL) {
-                        ret = -2;
-                        goto ret;
-                }
-                (*rep) = new_rep;
-                for (i = 0; i < ret; ++i) {
-                        pkgh = rpmdbNextIterator (match);
-
-                        if (pkgh != NULL)
-			pkgh2rep(pkgh, (*rep) + i, &keyid_regex);
-                        else {
-                                /* XXX: emit warning */
-                                memset((*rep) + i, 0, sizeof(struct rpminfo_rep));
-                                break;
-                        }
-                }
-        } else {
-                ret = 0;
+	RPMINFO_LOCK;
 
-                while ((pkgh = rpmdbNextIterator (match)) != NULL) {
-                        void *new_rep = realloc (*rep, sizeof (struct rpminfo_rep) * ++ret);
-                        if (new_rep == NULL) {
-                                ret = -2;
-                                goto ret;
-                        }
-                        (*rep) = new_rep;
-                        pkgh2rep(pkgh, (*rep) + (ret - 1), &keyid_regex);
-                }
-        }
+	*index = rpmdb_index_get(g_rpm->rpmts);
+	if (*index == NULL) {
+		ret = -1;
+		goto ret;
+	}
 
-	match = rpmdbFreeIterator (match);
+	ret = rpmdb_index_find(*index, req->name, req->op, rep);
 ret:
-        RPMINFO_UNLOCK;
-
-	regfree(&keyid_regex);
-        return (ret);
+	RPMINFO_UNLOCK;
+	return (ret);
 }
 
 int rpminfo_probe_offline_mode_supported()
@@ -282,6 +113,11 @@ int rpminfo_probe_offline_mode_supported()
 	return PROBE_OFFLINE_CHROOT;
 }
 
+/* the packages are looked up for all values of the name at once */
+const char * const rpminfo_probe_multival_entities[] = {
+	"name", NULL
+};
+
 void *rpminfo_probe_init(void)
 {
 #ifdef RPM46_FOUND
@@ -315,6 +151,8 @@ void rpminfo_probe_fini (void *ptr)
 {
         struct rpm_probe_global *r = (struct rpm_probe_global *)ptr;
 
+	rpmdb_index_drop();
+
 	rpmFreeCrypto();
 	rpmFreeRpmrc();
 	rpmFreeMacros(NULL);
@@ -334,171 +172,59 @@ void rpminfo_probe_fini (void *ptr)
         return;
 }
 
-static int collect_rpm_files(SEXP_t *item, const struct rpminfo_rep *rep, struct rpm_probe_global *g_rpm)
+static int collect_rpm_files(SEXP_t *item, struct rpmdb_index *index, struct rpmdb_pkg *pkg, struct rpm_probe_global *g_rpm)
 {
 	SEXP_t *value;
-	rpmdbMatchIterator ts;
-	Header pkgh;
-	rpmfi fi;
-	rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
-	int i, ret = 0;
-
-	ts = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-	if (ts == NULL) {
-		return -1;
-	}
-
-	if (rpmdbSetIteratorRE(ts, RPMTAG_NAME, RPMMIRE_STRCMP, rep->name) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-	char *epoch_override = oscap_streq(rep->epoch, "(none)") ? "0" : rep->epoch;
-	if (rpmdbSetIteratorRE(ts, RPMTAG_EPOCH, RPMMIRE_STRCMP, epoch_override) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-	if (rpmdbSetIteratorRE(ts, RPMTAG_VERSION, RPMMIRE_STRCMP, rep->version) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-	if (rpmdbSetIteratorRE(ts, RPMTAG_RELEASE, RPMMIRE_STRCMP, rep->release) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-	if (rpmdbSetIteratorRE(ts, RPMTAG_ARCH, RPMMIRE_STRCMP, rep->arch) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-
-	while ((pkgh = rpmdbNextIterator(ts)) != NULL) {
-		/*
-		 * Inspect package files & directories
-		 */
-		for (i = 0; i < 2; ++i) {
-			fi = rpmfiNew(g_rpm->rpmts, pkgh, tag[i], 1);
-
-			while (rpmfiNext(fi) != -1) {
-				const char *filepath;
-				filepath = rpmfiFN(fi);
-				value = probe_entval_from_cstr(
-						OVAL_DATATYPE_STRING,
-						filepath,
-						strlen(filepath)
-						);
-				if (value != NULL) {
-					probe_item_ent_add(item, "filepath", NULL, value);
-					SEXP_free(value);
-				}
-			}
-			rpmfiFree(fi);
+	int ret;
+
+	RPMINFO_LOCK;
+	ret = rpmdb_index_load_files(index, g_rpm->rpmts, pkg);
+	RPMINFO_UNLOCK;
+
+	if (ret != 0)
+		return ret;
+
+	for (size_t i = 0; i < pkg->file_count; ++i) {
+		value = probe_entval_from_cstr(
+				OVAL_DATATYPE_STRING,
+				pkg->files[i],
+				strlen(pkg->files[i])
+				);
+		if (value != NULL) {
+			probe_item_ent_add(item, "filepath", NULL, value);
+			SEXP_free(value);
 		}
-
 	}
-cleanup:
-	ts = rpmdbFreeIterator(ts);
-	return ret;
+
+	return 0;
 }
 
-int rpminfo_probe_main(probe_ctx *ctx, void *arg)
+/*
+ * Look up the packages matching a single value of the name entity and collect
+ * them. The packages already collected for another value are skipped.
+ */
+static int rpminfo_collect(probe_ctx *ctx, SEXP_t *probe_in, SEXP_t *ent, oval_schema_version_t over,
+                           struct rpminfo_req *request_st, struct rpm_probe_global *g_rpm,
+                           struct oscap_htable *collected)
 {
-	SEXP_t *val, *item, *ent, *probe_in;
-	oval_schema_version_t over;
+	SEXP_t *item;
 	int rpmret, i;
-
-        struct rpminfo_req request_st;
-        struct rpminfo_rep *reply_st;
-
-	// arg is NULL if regex compilation failed
-	if (arg == NULL) {
-		return PROBE_EINIT;
-	}
-
-	struct rpm_probe_global *g_rpm = (struct rpm_probe_global *)arg;
-
-	// There was no rpm config files
-	if (g_rpm->rpmts == NULL) {
-		probe_cobj_set_flag(probe_ctx_getresult(ctx), SYSCHAR_FLAG_NOT_APPLICABLE);
-		return 0;
-	}
-
-	if (ctx->offline_mode & PROBE_OFFLINE_OWN) {
-		const char* root = getenv("OSCAP_PROBE_ROOT");
-		rpmtsSetRootDir(g_rpm->rpmts, root);
-	}
-
-	probe_in = probe_ctx_getobject(ctx);
-	if (probe_in == NULL)
-		return PROBE_ENOOBJ;
-
-	over = probe_obj_get_platform_schema_version(probe_in);
-
-        ent = probe_obj_getent (probe_in, "name", 1);
-
-        if (ent == NULL) {
-                return (PROBE_ENOENT);
-        }
-
-        val = probe_ent_getval (ent);
-
-        if (val == NULL) {
-                dD("%s: no value", "name");
-                SEXP_free (ent);
-                return (PROBE_ENOVAL);
-        }
-
-        request_st.name = SEXP_string_cstr (val);
-        SEXP_free (val);
-
-        val = probe_ent_getattrval (ent, "operation");
-
-        if (val == NULL) {
-                request_st.op = OVAL_OPERATION_EQUALS;
-        } else {
-                request_st.op = (oval_operation_t) SEXP_number_geti_32 (val);
-
-                switch (request_st.op) {
-                case OVAL_OPERATION_EQUALS:
-		case OVAL_OPERATION_NOT_EQUAL:
-                case OVAL_OPERATION_PATTERN_MATCH:
-                        break;
-                default:
-                        SEXP_free (val);
-                        SEXP_free (ent);
-                        free (request_st.name);
-                        return (PROBE_EOPNOTSUPP);
-                }
-
-                SEXP_free (val);
-        }
-
-        if (request_st.name == NULL) {
-		SEXP_free (ent);
-                switch (errno) {
-                case EINVAL:
-                        dD("%s: invalid value type", "name");
-			return PROBE_EINVAL;
-                        break;
-                case EFAULT:
-                        dD("%s: element not found", "name");
-			return PROBE_ENOELM;
-                        break;
-		default:
-			return PROBE_EUNKNOWN;
-                }
-        }
+	struct rpmdb_pkg **reply_st;
+	struct rpmdb_index *index = NULL;
 
         reply_st  = NULL;
 
         /* get info from RPM db */
-	switch (rpmret = get_rpminfo(&request_st, &reply_st, g_rpm)) {
+	switch (rpmret = get_rpminfo(request_st, &reply_st, &index, g_rpm)) {
         case 0: /* Not found */
-                dI("Package \"%s\" not found.", request_st.name);
+                dI("Package \"%s\" not found.", request_st->name);
+                free (reply_st);
                 break;
         case -1: /* Error */
                 dD("get_rpminfo failed");
 
                 item = probe_item_create(OVAL_LINUX_RPM_INFO, NULL,
-                                         "name", OVAL_DATATYPE_STRING, request_st.name,
+                                         "name", OVAL_DATATYPE_STRING, request_st->name,
                                          NULL);
 
                 probe_item_setstatus (item, SYSCHAR_STATUS_ERROR);
@@ -511,7 +237,13 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
                         SEXP_t *name;
 
                         for (i = 0; i < rpmret; ++i) {
-				name = SEXP_string_newf("%s", reply_st[i].name);
+				char key[16];
+
+				snprintf(key, sizeof key, "%u", reply_st[i]->offset);
+				if (collected != NULL && oscap_htable_get(collected, key) != NULL)
+					continue;
+
+				name = SEXP_string_newf("%s", reply_st[i]->name);
 
 				if (probe_entobj_cmp(ent, name) != OVAL_RESULT_TRUE) {
 					SEXP_free(name);
@@ -520,12 +252,12 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
 
                                 item = probe_item_create(OVAL_LINUX_RPM_INFO, NULL,
                                                          "name",    OVAL_DATATYPE_SEXP, name,
-                                                         "arch",    OVAL_DATATYPE_STRING, reply_st[i].arch,
-                                                         "epoch",   OVAL_DATATYPE_STRING, reply_st[i].epoch,
-                                                         "release", OVAL_DATATYPE_STRING, reply_st[i].release,
-                                                         "version", OVAL_DATATYPE_STRING, reply_st[i].version,
-                                                         "evr",     OVAL_DATATYPE_EVR_STRING, reply_st[i].evr,
-                                                         "signature_keyid", OVAL_DATATYPE_STRING, reply_st[i].signature_keyid,
+                                                         "arch",    OVAL_DATATYPE_STRING, reply_st[i]->arch,
+                                                         "epoch",   OVAL_DATATYPE_STRING, reply_st[i]->epoch,
+                                                         "release", OVAL_DATATYPE_STRING, reply_st[i]->release,
+                                                         "version", OVAL_DATATYPE_STRING, reply_st[i]->version,
+                                                         "evr",     OVAL_DATATYPE_EVR_STRING, reply_st[i]->evr,
+                                                         "signature_keyid", OVAL_DATATYPE_STRING, reply_st[i]->signature_keyid,
                                                          NULL);
 
 				/* OVAL 5.10 added extended_name and filepaths behavior */
@@ -533,8 +265,8 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
 					SEXP_t *value, *bh_value;
 					value = probe_entval_from_cstr(
 							OVAL_DATATYPE_STRING,
-							reply_st[i].extended_name,
-							strlen(reply_st[i].extended_name)
+							reply_st[i]->extended_name,
+							strlen(reply_st[i]->extended_name)
 					);
 					probe_item_ent_add(item, "extended_name", NULL, value);
 					SEXP_free(value);
@@ -548,7 +280,7 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
 						if (bh_value != NULL) {
 							if (SEXP_strcmp(bh_value, "true") == 0) {
 								/* collect package files */
-								collect_rpm_files(item, &reply_st[i], g_rpm);
+								collect_rpm_files(item, index, reply_st[i], g_rpm);
 
 							}
 							SEXP_free(bh_value);
@@ -560,10 +292,13 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
 
 
 				SEXP_free(name);
-                                __rpminfo_rep_free (&(reply_st[i]));
+
+				if (collected != NULL)
+					oscap_htable_add(collected, key, reply_st[i]);
 
 				if (probe_item_collect(ctx, item) < 0) {
-					SEXP_free(ent);
+					free(reply_st);
+					rpmdb_index_put(index);
 					return PROBE_EUNKNOWN;
 				}
                         }
@@ -572,8 +307,116 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
                 }
         }
 
-	SEXP_free(ent);
-        free(request_st.name);
+	if (index != NULL)
+		rpmdb_index_put(index);
+
+	return 0;
+}
+
+int rpminfo_probe_main(probe_ctx *ctx, void *arg)
+{
+	SEXP_t *val, *vals, *ent, *probe_in;
+	oval_schema_version_t over;
+	int ret = 0;
+
+        struct rpminfo_req request_st;
+        struct oscap_htable *collected = NULL;
+
+	// arg is NULL if regex compilation failed
+	if (arg == NULL) {
+		return PROBE_EINIT;
+	}
+
+	struct rpm_probe_global *g_rpm = (struct rpm_probe_global *)arg;
+
+	// There was no rpm config files
+	if (g_rpm->rpmts == NULL) {
+		probe_cobj_set_flag(probe_ctx_getresult(ctx), SYSCHAR_FLAG_NOT_APPLICABLE);
+		return 0;
+	}
+
+	if (ctx->offline_mode & PROBE_OFFLINE_OWN) {
+		const char* root = getenv("OSCAP_PROBE_ROOT");
+		rpmtsSetRootDir(g_rpm->rpmts, root);
+	}
+
+	probe_in = probe_ctx_getobject(ctx);
+	if (probe_in == NULL)
+		return PROBE_ENOOBJ;
+
+	over = probe_obj_get_platform_schema_version(probe_in);
+
+        ent = probe_obj_getent (probe_in, "name", 1);
+
+        if (ent == NULL) {
+                return (PROBE_ENOENT);
+        }
+
+        /* all values of a variable referenced by the name are looked up at once */
+        if (probe_ent_getvals (ent, &vals) == 0) {
+                dD("%s: no value", "name");
+                SEXP_free (vals);
+                SEXP_free (ent);
+                return (PROBE_ENOVAL);
+        }
+
+        val = probe_ent_getattrval (ent, "operation");
+
+        if (val == NULL) {
+                request_st.op = OVAL_OPERATION_EQUALS;
+        } else {
+                request_st.op = (oval_operation_t) SEXP_number_geti_32 (val);
+
+                switch (request_st.op) {
+                case OVAL_OPERATION_EQUALS:
+		case OVAL_OPERATION_NOT_EQUAL:
+                case OVAL_OPERATION_PATTERN_MATCH:
+                        break;
+                default:
+                        SEXP_free (val);
+                        SEXP_free (vals);
+                        SEXP_free (ent);
+                        return (PROBE_EOPNOTSUPP);
+                }
+
+                SEXP_free (val);
+        }
+
+        /* the same package can match several values */
+        if (SEXP_list_length (vals) > 1)
+                collected = oscap_htable_new();
+
+        SEXP_list_foreach (val, vals) {
+                request_st.name = SEXP_string_cstr (val);
+
+                if (request_st.name == NULL) {
+                        switch (errno) {
+                        case EINVAL:
+                                dD("%s: invalid value type", "name");
+                                ret = PROBE_EINVAL;
+                                break;
+                        case EFAULT:
+                                dD("%s: element not found", "name");
+                                ret = PROBE_ENOELM;
+                                break;
+                        default:
+                                ret = PROBE_EUNKNOWN;
+                        }
+                        break;
+                }
+
+                ret = rpminfo_collect(ctx, probe_in, ent, over, &request_st, g_rpm, collected);
+                free (request_st.name);
+
+                if (ret != 0)
+                        break;
+        }
+
+        SEXP_free (val);
+        SEXP_free (vals);
+        SEXP_free (ent);
+        if (collected != NULL)
+                oscap_htable_free0 (collected);
 
-        return 0;
+        return ret;
 }
@@ -26,6 +26,7 @@
 #include "probe-api.h"
 
 int rpminfo_probe_offline_mode_supported(void);
+extern const char * const rpminfo_probe_multival_entities[];
 void *rpminfo_probe_init(void);
 int rpminfo_probe_main(probe_ctx *ctx, void *arg);
 void rpminfo_probe_fini(void *arg);
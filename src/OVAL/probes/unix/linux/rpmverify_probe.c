@@ -53,7 +53,6 @@
 
 #include <probe/probe.h>
 #include <probe/option.h>
-#include "common/oscap_pcre.h"
 
 #include "rpmverify_probe.h"
 
@@ -72,149 +71,101 @@ struct rpmverify_res {
 #define RPMVERIFY_LOCK   RPM_MUTEX_LOCK(&g_rpm->mutex)
 #define RPMVERIFY_UNLOCK RPM_MUTEX_UNLOCK(&g_rpm->mutex)
 
+struct rpmverify_filter_arg {
+	SEXP_t *filepath_ent;
+	uint64_t flags;
+};
+
+static int rpmverify_filter_file(const char *file, rpmfileAttrs fflags, void *arg, char **result_file)
+{
+	struct rpmverify_filter_arg *filter = arg;
+	SEXP_t *filepath_sexp;
+	int ret;
+
+	if (((fflags & RPMFILE_CONFIG) && (filter->flags & RPMVERIFY_SKIP_CONFIG)) ||
+	    ((fflags & RPMFILE_GHOST)  && (filter->flags & RPMVERIFY_SKIP_GHOST)))
+		return 1;
+
+	filepath_sexp = SEXP_string_newf("%s", file);
+	ret = probe_entobj_cmp(filter->filepath_ent, filepath_sexp) == OVAL_RESULT_TRUE ? 0 : 1;
+	SEXP_free(filepath_sexp);
+
+	return ret;
+}
+
 static int rpmverify_collect(probe_ctx *ctx,
                              const char *name, oval_operation_t name_op,
-                             const char *file, oval_operation_t file_op,
 			     SEXP_t *name_ent, SEXP_t *filepath_ent,
                              uint64_t flags,
 		void (*callback)(probe_ctx *, struct rpmverify_res *),
 		struct rpm_probe_global *g_rpm)
 {
-	rpmdbMatchIterator match;
         rpmVerifyAttrs omit = (rpmVerifyAttrs)(flags & RPMVERIFY_RPMATTRMASK);
-	Header pkgh;
-	oscap_pcre_t *re = NULL;
-	int  ret = -1;
-
-        /* pre-compile regex if needed */
-        if (file_op == OVAL_OPERATION_PATTERN_MATCH) {
-                char *errmsg;
-                int erroff;
-
-                re = oscap_pcre_compile(file, OSCAP_PCRE_OPTS_UTF8, &errmsg,  &erroff);
-
-                if (re == NULL) {
-                        /* TODO */
-                        oscap_pcre_err_free(errmsg);
-                        return (-1);
-                }
-        }
+	struct rpmverify_filter_arg filter = { filepath_ent, flags };
+	struct rpmverify_pkg_res *results = NULL;
+	struct rpmverify_progress progress;
+	struct rpmdb_index *index = NULL;
+	struct rpmdb_pkg **pkgs = NULL;
+	int  ret = -1, count, selected = 0;
 
         RPMVERIFY_LOCK;
 
-        switch (name_op) {
-        case OVAL_OPERATION_EQUALS:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMTAG_NAME, (const void *)name, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                ret = rpmdbGetIteratorCount (match);
-
-                break;
-	case OVAL_OPERATION_NOT_EQUAL:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                if (rpmdbSetIteratorRE (match, RPMTAG_NAME, RPMMIRE_GLOB, "*") != 0)
-                {
-                        ret = -1;
-                        goto ret;
-                }
-
-                break;
-        case OVAL_OPERATION_PATTERN_MATCH:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                if (rpmdbSetIteratorRE (match, RPMTAG_NAME, RPMMIRE_REGEX,
-                                        (const char *)name) != 0)
-                {
-                        ret = -1;
-                        goto ret;
-                }
-
-                break;
-        default:
-                /* not supported */
-                dE("package name: operation not supported");
-                ret = -1;
-                goto ret;
-        }
-
 	if (RPMTAG_BASENAMES == 0 || RPMTAG_DIRNAMES == 0) {
-		return -1;
+		goto ret;
 	}
 
-        while ((pkgh = rpmdbNextIterator (match)) != NULL) {
-                rpmfi  fi;
-		rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
-                struct rpmverify_res res;
-                errmsg_t rpmerr;
-		int i;
-		SEXP_t *name_sexp;
-
-                res.name = headerFormat(pkgh, "%{NAME}", &rpmerr);
+	index = rpmdb_index_get(g_rpm->rpmts);
+	if (index == NULL)
+		goto ret;
 
-		name_sexp = SEXP_string_newf("%s", res.name);
-		if (probe_entobj_cmp(name_ent, name_sexp) != OVAL_RESULT_TRUE) {
-			SEXP_free(name_sexp);
-			continue;
-		}
-		SEXP_free(name_sexp);
-
-                /*
-                 * Inspect package files & directories
-                 */
-		for (i = 0; i < 2; ++i) {
-			fi = rpmfiNew(g_rpm->rpmts, pkgh, tag[i], 1);
-
-		  while (rpmfiNext(fi) != -1) {
-		    SEXP_t *filepath_sexp;
-
-		    res.fflags = rpmfiFFlags(fi);
-		    res.oflags = omit;
-
-		    if (((res.fflags & RPMFILE_CONFIG) && (flags & RPMVERIFY_SKIP_CONFIG)) ||
-			((res.fflags & RPMFILE_GHOST)  && (flags & RPMVERIFY_SKIP_GHOST)))
-		      continue;
-
-		    res.file   = strdup(rpmfiFN(fi));
-
-		    filepath_sexp = SEXP_string_newf("%s", res.file);
-		    if (probe_entobj_cmp(filepath_ent, filepath_sexp) != OVAL_RESULT_TRUE) {
-		      SEXP_free(filepath_sexp);
-		      free(res.file);
-		      continue;
-		    }
-		    SEXP_free(filepath_sexp);
+	count = rpmdb_index_find(index, name, name_op, &pkgs);
+	if (count < 0) {
+		dE("package name: operation not supported");
+		goto ret;
+	}
 
-		    if (rpmVerifyFile(g_rpm->rpmts, fi, &res.vflags, omit) != 0)
-		      res.vflags = RPMVERIFY_FAILURES;
+	for (int p = 0; p < count; ++p) {
+		SEXP_t *name_sexp = SEXP_string_newf("%s", pkgs[p]->name);
 
-		    callback(ctx, &res);
-		    free(res.file);
-		  }
+		if (probe_entobj_cmp(name_ent, name_sexp) == OVAL_RESULT_TRUE)
+			pkgs[selected++] = pkgs[p];
+		SEXP_free(name_sexp);
+	}
 
-		  rpmfiFree(fi);
+	/*
+	 * Verify the packages in parallel, the items are reported afterwards
+	 * in the rpmdb order.
+	 */
+	results = malloc(selected * sizeof(struct rpmverify_pkg_res));
+	if (results == NULL && selected > 0) {
+		dE("Can't allocate results of %d packages.", selected);
+		selected = 0;
+		goto ret;
+	}
+	rpmverify_pkgs(g_rpm->rpmts, pkgs, selected, omit, rpmverify_filter_file, &filter, results, &progress);
+	dI("Verified %zu files of %zu packages.", progress.files_verified, progress.packages);
+
+	ret = 0;
+	for (int p = 0; p < selected; ++p) {
+		struct rpmverify_res res;
+
+		res.name = pkgs[p]->name;
+		res.oflags = omit;
+		for (size_t i = 0; i < results[p].count; ++i) {
+			res.file = results[p].files[i].file;
+			res.vflags = results[p].files[i].vflags;
+			res.fflags = results[p].files[i].fflags;
+			callback(ctx, &res);
 		}
+		if (results[p].error != 0)
+			ret = -1;
 	}
 
-	match = rpmdbFreeIterator (match);
-        ret   = 0;
 ret:
-        if (re != NULL)
-                oscap_pcre_free(re);
+	rpmverify_pkg_res_free(results, selected);
+	free(pkgs);
+	if (index != NULL)
+		rpmdb_index_put(index);
 
         RPMVERIFY_UNLOCK;
         return (ret);
@@ -258,6 +209,7 @@ void rpmverify_probe_fini(void *ptr)
 {
         struct rpm_probe_global *r = (struct rpm_probe_global *)ptr;
 
+	rpmdb_index_drop();
 	rpmFreeCrypto();
 	rpmFreeRpmrc();
 	rpmFreeMacros(NULL);
@@ -412,7 +364,6 @@ int rpmverify_probe_main(probe_ctx *ctx, void *arg)
 
         if (rpmverify_collect(ctx,
                               name, name_op,
-                              file, file_op,
 			      name_ent, file_ent,
                               collect_flags,
                               rpmverify_additem, g_rpm) != 0)
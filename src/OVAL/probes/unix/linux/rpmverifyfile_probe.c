@@ -97,35 +97,6 @@ struct rpmverify_res {
 
 static int rpmverify_additem(probe_ctx *ctx, struct rpmverify_res *res);
 
-/* modify passed-in iterator to test also given entity */
-static int adjust_filter(rpmdbMatchIterator iterator, SEXP_t *ent, rpmTag rpm_tag) {
-	oval_operation_t ent_op;
-	char ent_str[1024];
-	int ret = 0;
-
-	if (ent) {
-		ent_op = probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS);
-		PROBE_ENT_STRVAL(ent, ent_str, sizeof ent_str, /* void */, strcpy(ent_str, ""););
-
-		switch (ent_op) {
-		case OVAL_OPERATION_EQUALS:
-			if (rpmdbSetIteratorRE (iterator, rpm_tag, RPMMIRE_STRCMP, ent_str) != 0)
-				ret = -1;
-
-			break;
-		case OVAL_OPERATION_PATTERN_MATCH:
-			if (rpmdbSetIteratorRE (iterator, rpm_tag, RPMMIRE_REGEX,
-						(const char *)ent_str) != 0)
-				ret = -1;
-
-			break;
-		default:
-			ret = 0;
-		}
-	}
-	return ret;
-}
-
 /*
  * Compare file with item iterated over.
  * Returns 0 when they match, 1 when don't match, -1 on error.
@@ -192,49 +163,59 @@ cleanup:
 	return ret;
 }
 
-static int rpmverify_collect_package_files_or_directories(
-		struct rpm_probe_global *g_rpm, probe_ctx *ctx, Header pkgh,
-		const char *file, oval_operation_t file_op, rpmTag tag,
-		struct rpmverify_res *res, uint64_t flags)
+struct rpmverify_filter_arg {
+	const char *file;
+	oval_operation_t file_op;
+	uint64_t flags;
+};
+
+static int rpmverify_filter_file(const char *current_file, rpmfileAttrs fflags, void *arg, char **result_file)
 {
-	int ret = 0;
-	rpmVerifyAttrs omit = (rpmVerifyAttrs)(flags & RPMVERIFY_RPMATTRMASK);
-	rpmfi fi = rpmfiNew(g_rpm->rpmts, pkgh, tag, 1);
+	struct rpmverify_filter_arg *filter = arg;
 
-	while (rpmfiNext(fi) != -1) {
-		const char *current_file = rpmfiFN(fi);
-		res->fflags = rpmfiFFlags(fi);
-		res->oflags = omit;
+	if (((fflags & RPMFILE_CONFIG) && (filter->flags & RPMVERIFY_SKIP_CONFIG)) ||
+			((fflags & RPMFILE_GHOST)  && (filter->flags & RPMVERIFY_SKIP_GHOST))) {
+		return 1;
+	}
 
-		if (((res->fflags & RPMFILE_CONFIG) && (flags & RPMVERIFY_SKIP_CONFIG)) ||
-				((res->fflags & RPMFILE_GHOST)  && (flags & RPMVERIFY_SKIP_GHOST))) {
-			continue;
-		}
-		int cmp_res = _compare_file_with_current_file(file_op, file, current_file, &res->file);
-		if (cmp_res == 1) {
-			/* no match */
-			continue;
-		}
-		if (cmp_res == -1) {
-			ret = -1;
-			goto cleanup;
-		}
+	return _compare_file_with_current_file(filter->file_op, filter->file, current_file, result_file);
+}
 
-		if (rpmVerifyFile(g_rpm->rpmts, fi, &res->vflags, omit) != 0) {
-			res->vflags = RPMVERIFY_FAILURES;
+/*
+ * Select the packages which provide the file from the index, similar
+ * to `rpm -q -f`.
+ */
+static int rpmverify_find_file_owners(struct rpm_probe_global *g_rpm, struct rpmdb_index *index,
+		const char *file, struct rpmdb_pkg ***pkgs)
+{
+	rpmdbMatchIterator match;
+	struct rpmdb_pkg **all = NULL;
+	unsigned int *offsets = NULL;
+	size_t offset_count = 0;
+	int count = 0, all_count;
+
+	match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_INSTFILENAMES, file, 0);
+	if (match != NULL) {
+		while (rpmdbNextIterator(match) != NULL) {
+			offsets = realloc(offsets, (offset_count + 1) * sizeof(unsigned int));
+			offsets[offset_count++] = rpmdbGetIteratorOffset(match);
 		}
+		match = rpmdbFreeIterator(match);
+	}
 
-		if (rpmverify_additem(ctx, res) != 0) {
-			ret = -1;
-			free(res->file);
-			goto cleanup;
+	all_count = rpmdb_index_find(index, "", OVAL_OPERATION_NOT_EQUAL, &all);
+	*pkgs = all;
+	for (int i = 0; i < all_count; ++i) {
+		for (size_t j = 0; j < offset_count; ++j) {
+			if (all[i]->offset == offsets[j]) {
+				(*pkgs)[count++] = all[i];
+				break;
+			}
 		}
-		free(res->file);
 	}
 
-cleanup:
-	rpmfiFree(fi);
-	return ret;
+	free(offsets);
+	return count;
 }
 
 static int rpmverify_collect(probe_ctx *ctx,
@@ -243,57 +224,43 @@ static int rpmverify_collect(probe_ctx *ctx,
 			     uint64_t flags,
 		struct rpm_probe_global *g_rpm)
 {
-	rpmdbMatchIterator match;
-	Header pkgh;
-	int  ret = -1;
+	rpmVerifyAttrs omit = (rpmVerifyAttrs)(flags & RPMVERIFY_RPMATTRMASK);
+	struct rpmverify_filter_arg filter = { file, file_op, flags };
+	struct rpmverify_pkg_res *results = NULL;
+	struct rpmverify_progress progress;
+	struct rpmdb_index *index;
+	struct rpmdb_pkg **pkgs = NULL;
+	int  ret = -1, count, selected = 0;
 
 	RPMVERIFY_LOCK;
 
+	index = rpmdb_index_get(g_rpm->rpmts);
+	if (index == NULL)
+		goto ret;
+
 	if (file != NULL && file_op == OVAL_OPERATION_EQUALS) {
 		/*
 		 * When we know the exact file path we look for, we don't need to
 		 * filter all RPM packages, but we can ask the rpmdb directly for
 		 * the package which provides this file, similar to `rpm -q -f`.
 		 */
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_INSTFILENAMES, file, 0);
+		count = rpmverify_find_file_owners(g_rpm, index, file, &pkgs);
 	} else {
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-	}
-	if (match == NULL) {
-		ret = 0;
-		goto ret;
-	}
-
-	if ((ret = adjust_filter(match, name_ent, RPMTAG_NAME)) == -1) {
-		dE("can't adjust filter with name");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, epoch_ent, RPMTAG_EPOCH)) == -1) {
-		dE("can't adjust filter with epoch");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, version_ent, RPMTAG_VERSION)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, release_ent, RPMTAG_RELEASE)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
+		count = rpmdb_index_find_ent(index, name_ent, &pkgs);
 	}
-	if ((ret = adjust_filter(match, arch_ent, RPMTAG_ARCH)) == -1) {
-		dE("can't adjust filter with version");
+	if (count < 0) {
+		dE("can't find packages by name");
 		goto ret;
 	}
 
-	while ((pkgh = rpmdbNextIterator (match)) != NULL) {
+	for (int p = 0; p < count; ++p) {
 		SEXP_t *ent;
-		struct rpmverify_res res;
-		errmsg_t rpmerr;
+		const struct rpmdb_pkg *pkg = pkgs[p];
 
 #define COMPARE_ENT(XXX) \
 		if (XXX ## _ent != NULL) { \
 			ent = probe_entval_from_cstr( \
-				probe_ent_getdatatype(XXX ## _ent), res.XXX, strlen(res.XXX) \
+				probe_ent_getdatatype(XXX ## _ent), pkg->XXX, strlen(pkg->XXX) \
 			); \
 			if (ent != NULL && probe_entobj_cmp(XXX ## _ent, ent) != OVAL_RESULT_TRUE) { \
 				SEXP_free(ent); \
@@ -302,40 +269,59 @@ static int rpmverify_collect(probe_ctx *ctx,
 			SEXP_free(ent); \
 		}
 
-		res.name = headerFormat(pkgh, "%{NAME}", &rpmerr);
 		COMPARE_ENT(name);
-
-		res.epoch = headerFormat(pkgh, "%{EPOCH}", &rpmerr);
 		COMPARE_ENT(epoch);
-
-		res.version = headerFormat(pkgh, "%{VERSION}", &rpmerr);
 		COMPARE_ENT(version);
-		res.release = headerFormat(pkgh, "%{RELEASE}", &rpmerr);
 		COMPARE_ENT(release);
-		res.arch = headerFormat(pkgh, "%{ARCH}", &rpmerr);
 		COMPARE_ENT(arch);
-		snprintf(res.extended_name, 1024, "%s-%s:%s-%s.%s", res.name,
-			oscap_streq(res.epoch, "(none)") ? "0" : res.epoch,
-			res.version, res.release, res.arch);
 
-		if (rpmverify_collect_package_files_or_directories(g_rpm, ctx, pkgh, file, file_op, RPMTAG_BASENAMES, &res, flags) != 0 ||
-				rpmverify_collect_package_files_or_directories(g_rpm, ctx, pkgh, file, file_op, RPMTAG_DIRNAMES, &res, flags) != 0) {
-			ret = -1;
-		}
+		pkgs[selected++] = pkgs[p];
+	}
+
+	/*
+	 * Verify the packages in parallel, the items are reported afterwards
+	 * in the rpmdb order.
+	 */
+	results = malloc(selected * sizeof(struct rpmverify_pkg_res));
+	if (results == NULL && selected > 0) {
+		dE("Can't allocate results of %d packages.", selected);
+		selected = 0;
+		goto ret;
+	}
+	rpmverify_pkgs(g_rpm->rpmts, pkgs, selected, omit, rpmverify_filter_file, &filter, results, &progress);
+	dI("Verified %zu files of %zu packages.", progress.files_verified, progress.packages);
 
-		free(res.name);
-		free(res.epoch);
-		free(res.version);
-		free(res.release);
-		free(res.arch);
-		if (ret == -1) {
-			goto ret;
+	ret = 0;
+	for (int p = 0; p < selected && ret == 0; ++p) {
+		struct rpmverify_res res;
+		const struct rpmdb_pkg *pkg = pkgs[p];
+
+		res.name = pkg->name;
+		res.epoch = pkg->epoch;
+		res.version = pkg->version;
+		res.release = pkg->release;
+		res.arch = pkg->arch;
+		snprintf(res.extended_name, sizeof(res.extended_name), "%s", pkg->extended_name);
+		res.oflags = omit;
+
+		for (size_t i = 0; i < results[p].count; ++i) {
+			res.file = results[p].files[i].file;
+			res.vflags = results[p].files[i].vflags;
+			res.fflags = results[p].files[i].fflags;
+			if (rpmverify_additem(ctx, &res) != 0) {
+				ret = -1;
+				break;
+			}
 		}
+		if (results[p].error != 0)
+			ret = -1;
 	}
 
-	ret   = 0;
 ret:
-	match = rpmdbFreeIterator(match);
+	rpmverify_pkg_res_free(results, selected);
+	free(pkgs);
+	if (index != NULL)
+		rpmdb_index_put(index);
 	RPMVERIFY_UNLOCK;
 	return (ret);
 }
@@ -380,6 +366,7 @@ void rpmverifyfile_probe_fini(void *ptr)
 {
 	struct rpm_probe_global *r = (struct rpm_probe_global *)ptr;
 
+	rpmdb_index_drop();
 	rpmFreeCrypto();
 	rpmFreeRpmrc();
 	rpmFreeMacros(NULL);
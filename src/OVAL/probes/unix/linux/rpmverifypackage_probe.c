@@ -113,47 +113,15 @@ static struct poptOption optionsTable[] = {
 
 #define CHROOT_PATH() probe_chroot_get_path(&g_rpm->chr)
 
-/* modify passed-in iterator to test also given entity */
-static int adjust_filter(rpmdbMatchIterator iterator, SEXP_t *ent, rpmTag rpm_tag) {
-	oval_operation_t ent_op;
-	char ent_str[1024] = "";
-	int ret = 0;
-
-	if (ent) {
-		ent_op = probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS);
-		PROBE_ENT_STRVAL(ent, ent_str, sizeof ent_str, /* void */, strcpy(ent_str, ""););
-		if (rpm_tag == RPMTAG_EPOCH && strcmp(ent_str, "(none)") == 0) {
-			return ret;
-		}
-
-		switch (ent_op) {
-		case OVAL_OPERATION_EQUALS:
-			if (rpmdbSetIteratorRE (iterator, rpm_tag, RPMMIRE_STRCMP, ent_str) != 0)
-				ret = -1;
-
-			break;
-		case OVAL_OPERATION_PATTERN_MATCH:
-			if (rpmdbSetIteratorRE (iterator, rpm_tag, RPMMIRE_REGEX,
-						(const char *)ent_str) != 0)
-				ret = -1;
-
-			break;
-		default:
-			ret = 0;
-		}
-	}
-	return ret;
-}
-
 static int rpmverify_collect(probe_ctx *ctx,
 			     SEXP_t *name_ent, SEXP_t *epoch_ent, SEXP_t *version_ent, SEXP_t *release_ent, SEXP_t *arch_ent,
 			     uint64_t flags,
 			int (*callback)(probe_ctx *, struct rpmverify_res *),
 			struct verifypackage_global *g_rpm)
 {
-	rpmdbMatchIterator match;
-	Header pkgh;
-	int  ret = -1;
+	struct rpmdb_index *index = NULL;
+	struct rpmdb_pkg **pkgs = NULL;
+	int  ret = -1, count;
 	unsigned int i, j, rpmcli_argc = 0;
 	const char * rpmcli_argv[10];
 	poptContext rpmcli_context;
@@ -161,50 +129,32 @@ static int rpmverify_collect(probe_ctx *ctx,
 
 	RPMVERIFY_LOCK;
 
-	match = rpmtsInitIterator (g_rpm->rpm.rpmts, RPMDBI_PACKAGES, NULL, 0);
-	if (match == NULL) {
-		ret = 0;
+	if (RPMTAG_BASENAMES == 0 || RPMTAG_DIRNAMES == 0) {
 		goto ret;
 	}
 
-	if ((ret = adjust_filter(match, name_ent, RPMTAG_NAME)) == -1) {
-		dE("can't adjust filter with name");
+	index = rpmdb_index_get(g_rpm->rpm.rpmts);
+	if (index == NULL)
 		goto ret;
-	}
-	if ((ret = adjust_filter(match, epoch_ent, RPMTAG_EPOCH)) == -1) {
-		dE("can't adjust filter with epoch");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, version_ent, RPMTAG_VERSION)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, release_ent, RPMTAG_RELEASE)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
-	if ((ret = adjust_filter(match, arch_ent, RPMTAG_ARCH)) == -1) {
-		dE("can't adjust filter with version");
-		goto ret;
-	}
 
-	if (RPMTAG_BASENAMES == 0 || RPMTAG_DIRNAMES == 0) {
-		return -1;
+	if ((count = rpmdb_index_find_ent(index, name_ent, &pkgs)) < 0) {
+		dE("can't find packages by name");
+		goto ret;
 	}
 
 	rpmcli_argv[0] = "probe_rpmverifypackage";
 	rpmcli_argv[1] = "--quiet";
 	rpmcli_argv[2] = "--nofiles";
 
-	while ((pkgh = rpmdbNextIterator (match)) != NULL) {
+	for (int p = 0; p < count; ++p) {
 		SEXP_t *ent;
 		struct rpmverify_res res;
-		errmsg_t rpmerr;
+		const struct rpmdb_pkg *pkg = pkgs[p];
 
 #define COMPARE_ENT(XXX) \
 		if (XXX ## _ent != NULL) { \
 			ent = probe_entval_from_cstr( \
-				probe_ent_getdatatype(XXX ## _ent), res.XXX, strlen(res.XXX) \
+				probe_ent_getdatatype(XXX ## _ent), pkg->XXX, strlen(pkg->XXX) \
 			); \
 			if (ent != NULL && probe_entobj_cmp(XXX ## _ent, ent) != OVAL_RESULT_TRUE) { \
 				SEXP_free(ent); \
@@ -213,21 +163,18 @@ static int rpmverify_collect(probe_ctx *ctx,
 			SEXP_free(ent); \
 		}
 
-		res.name = headerFormat(pkgh, "%{NAME}", &rpmerr);
 		COMPARE_ENT(name);
-
-		res.epoch = headerFormat(pkgh, "%{EPOCH}", &rpmerr);
 		COMPARE_ENT(epoch);
-
-		res.version = headerFormat(pkgh, "%{VERSION}", &rpmerr);
 		COMPARE_ENT(version);
-		res.release = headerFormat(pkgh, "%{RELEASE}", &rpmerr);
 		COMPARE_ENT(release);
-		res.arch = headerFormat(pkgh, "%{ARCH}", &rpmerr);
 		COMPARE_ENT(arch);
-		snprintf(res.extended_name, 1024, "%s-%s:%s-%s.%s", res.name,
-			oscap_streq(res.epoch, "(none)") ? "0" : res.epoch,
-			res.version, res.release, res.arch);
+
+		res.name = pkg->name;
+		res.epoch = pkg->epoch;
+		res.version = pkg->version;
+		res.release = pkg->release;
+		res.arch = pkg->arch;
+		snprintf(res.extended_name, sizeof(res.extended_name), "%s", pkg->extended_name);
 
 		/*
 		 * Verify package
@@ -306,16 +253,13 @@ static int rpmverify_collect(probe_ctx *ctx,
 			ret = 1;
 			goto ret;
 		}
-		free(res.name);
-		free(res.epoch);
-		free(res.version);
-		free(res.release);
-		free(res.arch);
 	}
 
-	match = rpmdbFreeIterator (match);
 	ret   = 0;
 ret:
+	free(pkgs);
+	if (index != NULL)
+		rpmdb_index_put(index);
 	RPMVERIFY_UNLOCK;
 	return (ret);
 }
@@ -385,6 +329,7 @@ void rpmverifypackage_probe_fini(void *ptr)
 {
 	struct verifypackage_global *r = (struct verifypackage_global *)ptr;
 
+	rpmdb_index_drop();
 	rpmFreeCrypto();
 	rpmFreeRpmrc();
 	rpmFreeMacros(NULL);
@@ -0,0 +1,518 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/list.h"
+#include "systemdshared.h"
+#include "systemd-unit-cache.h"
+
+/*
+ * Maximum number of calls waiting for a reply. The system bus limits the
+ * number of pending replies of a connection, 128 by default.
+ */
+#define SYSTEMD_PIPELINE_DEPTH 64
+
+struct systemd_unit_cache {
+	DBusConnection *conn;
+	unsigned int refcount;
+	pthread_mutex_t lock;       /* serializes the D-Bus calls and the updates */
+	bool listed;
+	char **names;               /* unit files */
+	size_t name_count;
+	struct oscap_htable *units; /* name -> struct systemd_unit */
+};
+
+static pthread_mutex_t g_systemd_unit_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct systemd_unit_cache *g_systemd_unit_cache = NULL;
+
+static bool is_unit_name_a_target(const char *unit)
+{
+	const char *suffix = ".target";
+	const size_t suffix_len = strlen(suffix);
+
+	if (!unit)
+		return false;
+
+	const size_t len = strlen(unit);
+	if (suffix_len >  len)
+		return false;
+
+	return strncmp(unit + len - suffix_len, suffix, suffix_len) == 0;
+}
+
+static void systemd_unit_free(void *ptr)
+{
+	struct systemd_unit *unit = ptr;
+
+	for (size_t i = 0; i < unit->property_count; ++i) {
+		for (size_t j = 0; j < unit->properties[i].value_count; ++j)
+			free(unit->properties[i].values[j]);
+		free(unit->properties[i].values);
+		free(unit->properties[i].name);
+	}
+	free(unit->properties);
+	for (size_t i = 0; i < unit->dependency_count; ++i)
+		free(unit->dependencies[i]);
+	free(unit->dependencies);
+	free(unit->path);
+	free(unit->name);
+	free(unit);
+}
+
+static struct systemd_unit *systemd_unit_cache_unit(struct systemd_unit_cache *cache, const char *name)
+{
+	struct systemd_unit *unit = oscap_htable_get(cache->units, name);
+
+	if (unit == NULL) {
+		unit = calloc(1, sizeof(*unit));
+		unit->name = strdup(name);
+		oscap_htable_add(cache->units, name, unit);
+	}
+	return unit;
+}
+
+static DBusPendingCall *systemd_send(DBusConnection *conn, const char *path, const char *interface, const char *method, const char *arg)
+{
+	DBusMessage *msg;
+	DBusPendingCall *pending = NULL;
+
+	msg = dbus_message_new_method_call("org.freedesktop.systemd1", path, interface, method);
+	if (msg == NULL) {
+		dD("Failed to create dbus_message via dbus_message_new_method_call!");
+		return NULL;
+	}
+
+	if (!dbus_message_append_args(msg, DBUS_TYPE_STRING, &arg, DBUS_TYPE_INVALID)) {
+		dD("Failed to append '%s' string parameter to dbus message!", arg);
+	} else if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
+		dD("Failed to send message via dbus!");
+	} else if (pending == NULL) {
+		dD("Invalid dbus pending call!");
+	}
+
+	dbus_message_unref(msg);
+	return pending;
+}
+
+static DBusMessage *systemd_reply(DBusPendingCall *pending)
+{
+	DBusMessage *msg;
+
+	if (pending == NULL)
+		return NULL;
+
+	dbus_pending_call_block(pending);
+	msg = dbus_pending_call_steal_reply(pending);
+	if (msg == NULL)
+		dD("Failed to steal dbus pending call reply.");
+	dbus_pending_call_unref(pending);
+
+	return msg;
+}
+
+static char *systemd_reply_path(DBusMessage *msg)
+{
+	DBusMessageIter args;
+	_DBusBasicValue path;
+
+	if (msg == NULL)
+		return NULL;
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dD("Failed to initialize iterator over received dbus message.");
+		dbus_message_unref(msg);
+		return NULL;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_OBJECT_PATH) {
+		dD("Expected object path argument in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		dbus_message_unref(msg);
+		return NULL;
+	}
+
+	dbus_message_iter_get_basic(&args, &path);
+	char *ret = oscap_strdup(path.str);
+	dbus_message_unref(msg);
+
+	return ret;
+}
+
+static void systemd_property_add_value(struct systemd_property *property, char *value)
+{
+	property->values = realloc(property->values, (property->value_count + 1) * sizeof(char *));
+	property->values[property->value_count++] = value;
+}
+
+static void systemd_reply_properties(DBusMessage *msg, struct systemd_unit *unit)
+{
+	DBusMessageIter args, property_iter;
+	size_t capacity = 0;
+
+	if (msg == NULL)
+		return;
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dD("Failed to initialize iterator over received dbus message.");
+		goto cleanup;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY || dbus_message_iter_get_element_type(&args) != DBUS_TYPE_DICT_ENTRY) {
+		dD("Expected array of dict_entry argument in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		goto cleanup;
+	}
+
+	dbus_message_iter_recurse(&args, &property_iter);
+	while (dbus_message_iter_get_arg_type(&property_iter) == DBUS_TYPE_DICT_ENTRY) {
+		DBusMessageIter dict_entry, value_variant;
+		dbus_message_iter_recurse(&property_iter, &dict_entry);
+
+		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_STRING) {
+			dD("Expected string as key in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
+			goto cleanup;
+		}
+
+		_DBusBasicValue value;
+		dbus_message_iter_get_basic(&dict_entry, &value);
+		const char *property_name = value.str;
+
+		if (dbus_message_iter_next(&dict_entry) == false) {
+			dW("Expected another field in dict_entry.");
+			goto cleanup;
+		}
+
+		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_VARIANT) {
+			dD("Expected variant as value in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
+			goto cleanup;
+		}
+
+		if (unit->property_count == capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			unit->properties = realloc(unit->properties, capacity * sizeof(struct systemd_property));
+		}
+		struct systemd_property *property = &unit->properties[unit->property_count++];
+		property->name = oscap_strdup(property_name);
+		property->values = NULL;
+		property->value_count = 0;
+
+		dbus_message_iter_recurse(&dict_entry, &value_variant);
+
+		// DBUS_TYPE_ARRAY is a special case, each element is one value
+		if (dbus_message_iter_get_arg_type(&value_variant) == DBUS_TYPE_ARRAY) {
+			DBusMessageIter array;
+			dbus_message_iter_recurse(&value_variant, &array);
+
+			do {
+				char *element = oval_dbus_value_to_string(&array);
+				if (element == NULL)
+					continue;
+
+				systemd_property_add_value(property, element);
+			}
+			while (dbus_message_iter_next(&array));
+		}
+		else {
+			systemd_property_add_value(property, oval_dbus_value_to_string(&value_variant));
+		}
+
+		dbus_message_iter_next(&property_iter);
+	}
+
+cleanup:
+	dbus_message_unref(msg);
+}
+
+/*
+ * Load the units which haven't been loaded yet, SYSTEMD_PIPELINE_DEPTH
+ * units at a time: LoadUnit calls of all the units of a batch are sent
+ * first, then GetAll calls of the loaded ones.
+ */
+static void systemd_unit_cache_fetch(struct systemd_unit_cache *cache, struct systemd_unit **units, size_t count)
+{
+	struct systemd_unit *batch[SYSTEMD_PIPELINE_DEPTH];
+	DBusPendingCall *pending[SYSTEMD_PIPELINE_DEPTH];
+	size_t i = 0;
+
+	while (i < count) {
+		size_t n = 0;
+
+		for (; i < count && n < SYSTEMD_PIPELINE_DEPTH; ++i) {
+			if (units[i]->loaded)
+				continue;
+			units[i]->loaded = true;
+			batch[n++] = units[i];
+		}
+		if (n == 0)
+			break;
+
+		for (size_t j = 0; j < n; ++j) {
+			dD("LoadUnit: %s", batch[j]->name);
+			// LoadUnit is similar to GetUnit except it will load the unit file
+			// if it hasn't been loaded yet.
+			pending[j] = systemd_send(cache->conn, "/org/freedesktop/systemd1",
+			                          "org.freedesktop.systemd1.Manager", "LoadUnit", batch[j]->name);
+		}
+		dbus_connection_flush(cache->conn);
+		for (size_t j = 0; j < n; ++j)
+			batch[j]->path = systemd_reply_path(systemd_reply(pending[j]));
+
+		for (size_t j = 0; j < n; ++j) {
+			pending[j] = NULL;
+			if (batch[j]->path != NULL)
+				pending[j] = systemd_send(cache->conn, batch[j]->path,
+				                          "org.freedesktop.DBus.Properties", "GetAll", "org.freedesktop.systemd1.Unit");
+		}
+		dbus_connection_flush(cache->conn);
+		for (size_t j = 0; j < n; ++j)
+			systemd_reply_properties(systemd_reply(pending[j]), batch[j]);
+	}
+}
+
+static const struct systemd_property *systemd_unit_property(const struct systemd_unit *unit, const char *name)
+{
+	for (size_t i = 0; i < unit->property_count; ++i) {
+		if (oscap_streq(unit->properties[i].name, name))
+			return &unit->properties[i];
+	}
+	return NULL;
+}
+
+static const char *g_dependency_properties[] = { "Requires", "Wants", NULL };
+
+/*
+ * Load all the target units reachable from the given units, one level of
+ * the dependency trees at a time.
+ */
+static void systemd_unit_cache_fetch_targets(struct systemd_unit_cache *cache, struct systemd_unit **roots, size_t count)
+{
+	struct systemd_unit **level = malloc((count + 1) * sizeof(struct systemd_unit *));
+	size_t level_count = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (is_unit_name_a_target(roots[i]->name))
+			level[level_count++] = roots[i];
+	}
+
+	while (level_count > 0) {
+		struct systemd_unit **next = NULL;
+		size_t next_count = 0, capacity = 0;
+
+		systemd_unit_cache_fetch(cache, level, level_count);
+
+		for (size_t i = 0; i < level_count; ++i) {
+			for (const char **p = g_dependency_properties; *p != NULL; ++p) {
+				const struct systemd_property *property = systemd_unit_property(level[i], *p);
+				if (property == NULL)
+					continue;
+
+				for (size_t j = 0; j < property->value_count; ++j) {
+					const char *name = property->values[j];
+					if (!is_unit_name_a_target(name))
+						continue;
+
+					struct systemd_unit *dependency = systemd_unit_cache_unit(cache, name);
+					if (dependency->loaded)
+						continue;
+					if (next_count == capacity) {
+						capacity = capacity ? capacity * 2 : 64;
+						next = realloc(next, capacity * sizeof(struct systemd_unit *));
+					}
+					next[next_count++] = dependency;
+				}
+			}
+		}
+
+		free(level);
+		level = next;
+		level_count = next_count;
+	}
+	free(level);
+}
+
+static void systemd_unit_collect_dependencies(struct systemd_unit_cache *cache, const char *name, struct systemd_unit *root, struct oscap_htable *visited_units, size_t *capacity)
+{
+	if (!name || strcmp(name, "(null)") == 0)
+		return;
+
+	// systemctl list-dependencies only recurses into target units
+	if (!is_unit_name_a_target(name))
+		return;
+
+	struct systemd_unit *unit = systemd_unit_cache_unit(cache, name);
+
+	for (const char **p = g_dependency_properties; *p != NULL; ++p) {
+		const struct systemd_property *property = systemd_unit_property(unit, *p);
+		if (property == NULL)
+			continue;
+
+		for (size_t i = 0; i < property->value_count; ++i) {
+			const char *dependency = property->values[i];
+			if (oscap_strcmp(dependency, "") == 0)
+				continue;
+			if (oscap_htable_get(visited_units, dependency) != NULL)
+				continue;
+			oscap_htable_add(visited_units, dependency, (void *) true);
+
+			if (root->dependency_count == *capacity) {
+				*capacity = *capacity ? *capacity * 2 : 32;
+				root->dependencies = realloc(root->dependencies, *capacity * sizeof(char *));
+			}
+			root->dependencies[root->dependency_count++] = strdup(dependency);
+
+			systemd_unit_collect_dependencies(cache, dependency, root, visited_units, capacity);
+		}
+	}
+}
+
+static void systemd_unit_cache_free(struct systemd_unit_cache *cache)
+{
+	if (cache == NULL)
+		return;
+
+	for (size_t i = 0; i < cache->name_count; ++i)
+		free(cache->names[i]);
+	free(cache->names);
+	oscap_htable_free(cache->units, systemd_unit_free);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+}
+
+static void systemd_unit_cache_unref(struct systemd_unit_cache *cache)
+{
+	if (cache != NULL && --cache->refcount == 0)
+		systemd_unit_cache_free(cache);
+}
+
+struct systemd_unit_cache *systemd_unit_cache_get(DBusConnection *conn)
+{
+	struct systemd_unit_cache *cache;
+
+	pthread_mutex_lock(&g_systemd_unit_cache_lock);
+
+	cache = g_systemd_unit_cache;
+	if (cache == NULL || cache->conn != conn) {
+		systemd_unit_cache_unref(g_systemd_unit_cache);
+		g_systemd_unit_cache = cache = calloc(1, sizeof(*cache));
+		cache->conn = conn;
+		cache->units = oscap_htable_new();
+		pthread_mutex_init(&cache->lock, NULL);
+		/* One reference is held by the cache */
+		cache->refcount = 1;
+	}
+	cache->refcount++;
+
+	pthread_mutex_unlock(&g_systemd_unit_cache_lock);
+	return cache;
+}
+
+void systemd_unit_cache_put(struct systemd_unit_cache *cache)
+{
+	pthread_mutex_lock(&g_systemd_unit_cache_lock);
+	systemd_unit_cache_unref(cache);
+	pthread_mutex_unlock(&g_systemd_unit_cache_lock);
+}
+
+void systemd_unit_cache_drop(void)
+{
+	pthread_mutex_lock(&g_systemd_unit_cache_lock);
+	systemd_unit_cache_unref(g_systemd_unit_cache);
+	g_systemd_unit_cache = NULL;
+	pthread_mutex_unlock(&g_systemd_unit_cache_lock);
+}
+
+static int systemd_unit_cache_add_name(const char *unit, void *cbarg)
+{
+	struct systemd_unit_cache *cache = cbarg;
+
+	cache->names = realloc(cache->names, (cache->name_count + 1) * sizeof(char *));
+	cache->names[cache->name_count++] = strdup(unit);
+	return 0;
+}
+
+size_t systemd_unit_cache_list(struct systemd_unit_cache *cache, const char *const **names)
+{
+	pthread_mutex_lock(&cache->lock);
+	if (!cache->listed) {
+		get_all_systemd_units(cache->conn, systemd_unit_cache_add_name, cache);
+		cache->listed = true;
+		dD("Listed %zu systemd unit files.", cache->name_count);
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	*names = (const char *const *)cache->names;
+	return cache->name_count;
+}
+
+void systemd_unit_cache_load(struct systemd_unit_cache *cache, const char *const *names, size_t count, const struct systemd_unit **units)
+{
+	struct systemd_unit **todo = malloc((count + 1) * sizeof(struct systemd_unit *));
+
+	pthread_mutex_lock(&cache->lock);
+	for (size_t i = 0; i < count; ++i)
+		units[i] = todo[i] = systemd_unit_cache_unit(cache, names[i]);
+	systemd_unit_cache_fetch(cache, todo, count);
+	pthread_mutex_unlock(&cache->lock);
+
+	free(todo);
+}
+
+void systemd_unit_cache_load_dependencies(struct systemd_unit_cache *cache, const char *const *names, size_t count)
+{
+	struct systemd_unit **roots = malloc((count + 1) * sizeof(struct systemd_unit *));
+
+	pthread_mutex_lock(&cache->lock);
+	for (size_t i = 0; i < count; ++i)
+		roots[i] = systemd_unit_cache_unit(cache, names[i]);
+	systemd_unit_cache_fetch_targets(cache, roots, count);
+	pthread_mutex_unlock(&cache->lock);
+
+	free(roots);
+}
+
+size_t systemd_unit_cache_dependencies(struct systemd_unit_cache *cache, const char *name, const char *const **dependencies)
+{
+	struct systemd_unit *unit;
+
+	pthread_mutex_lock(&cache->lock);
+
+	unit = systemd_unit_cache_unit(cache, name);
+	if (!unit->closure_done) {
+		if (is_unit_name_a_target(name)) {
+			struct oscap_htable *visited_units = oscap_htable_new();
+			size_t capacity = 0;
+
+			systemd_unit_cache_fetch_targets(cache, &unit, 1);
+			systemd_unit_collect_dependencies(cache, name, unit, visited_units, &capacity);
+			oscap_htable_free(visited_units, NULL);
+		}
+		unit->closure_done = true;
+	}
+
+	pthread_mutex_unlock(&cache->lock);
+
+	*dependencies = (const char *const *)unit->dependencies;
+	return unit->dependency_count;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef OPENSCAP_SYSTEMD_UNIT_CACHE_H
+#define OPENSCAP_SYSTEMD_UNIT_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <dbus/dbus.h>
+
+/*
+ * Cache of the systemd units shared by the systemdunitproperty and
+ * systemdunitdependency probes. The unit files are listed once per scan,
+ * the properties of the units are fetched by pipelined D-Bus calls the
+ * first time they are needed and the dependency closures are computed
+ * once per unit.
+ */
+
+struct systemd_property {
+	char *name;
+	char **values;             /* elements of an array, a single value otherwise */
+	size_t value_count;
+};
+
+struct systemd_unit {
+	char *name;
+	bool loaded;               /* the unit has been loaded */
+	char *path;                /* D-Bus object path, NULL if the unit can't be loaded */
+	struct systemd_property *properties; /* org.freedesktop.systemd1.Unit properties in reply order */
+	size_t property_count;
+	bool closure_done;
+	char **dependencies;       /* Requires and Wants closure, see systemd_unit_cache_dependencies() */
+	size_t dependency_count;
+};
+
+struct systemd_unit_cache;
+
+/*
+ * Get a reference to the cache of the units reachable through the given
+ * connection. The cache is shared until systemd_unit_cache_drop() is called
+ * or a different connection is used.
+ */
+struct systemd_unit_cache *systemd_unit_cache_get(DBusConnection *conn);
+
+/*
+ * Release a reference obtained by systemd_unit_cache_get().
+ */
+void systemd_unit_cache_put(struct systemd_unit_cache *cache);
+
+/*
+ * Drop the shared cache, the next systemd_unit_cache_get() asks systemd
+ * again. Called when the systemd probes are finalized.
+ */
+void systemd_unit_cache_drop(void);
+
+/*
+ * Get the names of the unit files in the order reported by ListUnitFiles,
+ * with '@' removed from the names of the templates. Returns the number of
+ * units, the units listed before an error are kept.
+ */
+size_t systemd_unit_cache_list(struct systemd_unit_cache *cache, const char *const **names);
+
+/*
+ * Load the units with the given names and their properties, if they haven't
+ * been loaded yet. The calls of all the units are sent before waiting for
+ * the replies. The units are stored to units[i], which stay valid until the
+ * reference to the cache is released.
+ */
+void systemd_unit_cache_load(struct systemd_unit_cache *cache, const char *const *names, size_t count, const struct systemd_unit **units);
+
+/*
+ * Load the target units reachable from the units with the given names, so
+ * that the dependencies of all of them are fetched by pipelined calls.
+ */
+void systemd_unit_cache_load_dependencies(struct systemd_unit_cache *cache, const char *const *names, size_t count);
+
+/*
+ * Get the dependencies of a unit the same way `systemctl list-dependencies`
+ * reports them: the Requires and Wants of the unit in depth-first order,
+ * recursing only into target units. Units which aren't targets have no
+ * dependencies. The dependencies are stored to *dependencies, which stay
+ * valid until the reference to the cache is released.
+ */
+size_t systemd_unit_cache_dependencies(struct systemd_unit_cache *cache, const char *name, const char *const **dependencies);
+
+#endif /* OPENSCAP_SYSTEMD_UNIT_CACHE_H */
@@ -29,4 +29,6 @@ int systemdunitdependency_probe_offline_mode_supported(void);
 
 int systemdunitdependency_probe_main(probe_ctx *ctx, void *arg);
 
+void systemdunitdependency_probe_fini(void *arg);
+
 #endif /* OPENSCAP_SYSTEMDUNITDEPENDENCY_PROBE_H */
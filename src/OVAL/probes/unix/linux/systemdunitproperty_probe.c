@@ -31,228 +31,50 @@
 #endif
 
 #include <probe-api.h>
+#include <stdlib.h>
 #include <string.h>
 #include <probe/probe.h>
 
 #include "probe/entcmp.h"
-#include "systemdshared.h"
+#include "common/debug_priv.h"
+#include "oval_dbus.h"
+#include "systemd-unit-cache.h"
 #include "systemdunitproperty_probe.h"
 
-static int get_all_properties_by_unit_path(DBusConnection *conn, const char *unit_path, int(*callback)(const char *name, const char *value, void *arg), void *cbarg)
+static void report_unit_properties(probe_ctx *ctx, const struct systemd_unit *unit, SEXP_t *property_entity)
 {
-	int ret = 1;
-	DBusMessage *msg = NULL;
-	DBusPendingCall *pending = NULL;
+	SEXP_t *se_unit = SEXP_string_new(unit->name, strlen(unit->name));
 
-	msg = dbus_message_new_method_call(
-		"org.freedesktop.systemd1",
-		unit_path,
-		"org.freedesktop.DBus.Properties",
-		"GetAll"
-	);
-	if (msg == NULL) {
-		dD("Failed to create dbus_message via dbus_message_new_method_call!");
-		goto cleanup;
-	}
-
-	DBusMessageIter args, property_iter;
-
-	const char *interface = "org.freedesktop.systemd1.Unit";
-
-	dbus_message_iter_init_append(msg, &args);
-	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &interface)) {
-		dD("Failed to append interface '%s' string parameter to dbus message!", interface);
-		goto cleanup;
-	}
-
-	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
-		dD("Failed to send message via dbus!");
-		goto cleanup;
-	}
-	if (pending == NULL) {
-		dD("Invalid dbus pending call!");
-		goto cleanup;
-	}
-
-	dbus_connection_flush(conn);
-	dbus_message_unref(msg); msg = NULL;
-
-	dbus_pending_call_block(pending);
-	msg = dbus_pending_call_steal_reply(pending);
-	if (msg == NULL) {
-		dD("Failed to steal dbus pending call reply.");
-		goto cleanup;
-	}
-	dbus_pending_call_unref(pending); pending = NULL;
-
-	if (!dbus_message_iter_init(msg, &args)) {
-		dD("Failed to initialize iterator over received dbus message.");
-		goto cleanup;
-	}
-
-	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY && dbus_message_iter_get_element_type(&args) != DBUS_TYPE_DICT_ENTRY) {
-		dD("Expected array of dict_entry argument in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
-		goto cleanup;
-	}
-
-	dbus_message_iter_recurse(&args, &property_iter);
-	do {
-		DBusMessageIter dict_entry, value_variant;
-		dbus_message_iter_recurse(&property_iter, &dict_entry);
-
-		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_STRING) {
-			dD("Expected string as key in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
-			goto cleanup;
-		}
-
-		_DBusBasicValue value;
-		dbus_message_iter_get_basic(&dict_entry, &value);
-		char *property_name = oscap_strdup(value.str);
+	for (size_t i = 0; i < unit->property_count; ++i) {
+		const struct systemd_property *property = &unit->properties[i];
 
-		if (dbus_message_iter_next(&dict_entry) == false) {
-			dW("Expected another field in dict_entry.");
-			free(property_name);
-			goto cleanup;
-		}
-
-		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_VARIANT) {
-			dD("Expected variant as value in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
-			free(property_name);
-			goto cleanup;
-		}
+		if (property->value_count == 0)
+			continue;
 
-		dbus_message_iter_recurse(&dict_entry, &value_variant);
+		SEXP_t *se_property = SEXP_string_new(property->name, strlen(property->name));
 
-		int cbret = 0;
-		const int arg_type = dbus_message_iter_get_arg_type(&value_variant);
-		// DBUS_TYPE_ARRAY is a special case, we report each element as one value entry
-		if (arg_type == DBUS_TYPE_ARRAY) {
-			DBusMessageIter array;
-			dbus_message_iter_recurse(&value_variant, &array);
-
-			do {
-				char *element = oval_dbus_value_to_string(&array);
-				if (element == NULL)
-					continue;
-
-				const int elementcbret = callback(property_name, element, cbarg);
-				if (elementcbret > cbret)
-					cbret = elementcbret;
-
-				free(element);
-			}
-			while (dbus_message_iter_next(&array));
-		}
-		else {
-			char *property_value = oval_dbus_value_to_string(&value_variant);
-			cbret = callback(property_name, property_value, cbarg);
-			free(property_value);
+		if (probe_entobj_cmp(property_entity, se_property) != OVAL_RESULT_TRUE) {
+			SEXP_free(se_property);
+			continue;
 		}
 
-		free(property_name);
-		if (cbret != 0) {
-			goto cleanup;
-		}
-	}
-	while (dbus_message_iter_next(&property_iter));
-
-	dbus_message_unref(msg); msg = NULL;
-	ret = 0;
-
-cleanup:
-	if (pending != NULL)
-		dbus_pending_call_unref(pending);
-
-	if (msg != NULL)
-		dbus_message_unref(msg);
-
-	return ret;
-}
-
-struct unit_callback_vars {
-	DBusConnection *dbus_conn;
-	probe_ctx *ctx;
-	SEXP_t *unit_entity;
-	SEXP_t *property_entity;
-	SEXP_t *se_unit;
-	SEXP_t *se_property;
-	SEXP_t *item;
-};
-
-static int property_callback(const char *property, const char *value, void *cbarg)
-{
-	struct unit_callback_vars *vars = (struct unit_callback_vars *)cbarg;
-
-	if (vars->se_property != NULL) {
-		//
-		// Compare the previously matched entity to the current one
-		// If they are the same, continue to fill the current item
-		// with property values. If not, collect the item and create
-		// a new one for the current property.
-		//
-		if (SEXP_strcmp(vars->se_property, property) == 0) {
-			SEXP_t *se_value = SEXP_string_new(value, strlen(value));
-			probe_item_ent_add(vars->item, "value", NULL, se_value);
+		// Each element of an array property is reported as one value entry
+		SEXP_t *item = probe_item_create(OVAL_LINUX_SYSTEMDUNITPROPERTY, NULL,
+						 "unit", OVAL_DATATYPE_SEXP, se_unit,
+						 "property", OVAL_DATATYPE_SEXP, se_property,
+						 "value", OVAL_DATATYPE_STRING, property->values[0],
+						 NULL);
+		for (size_t j = 1; j < property->value_count; ++j) {
+			SEXP_t *se_value = SEXP_string_new(property->values[j], strlen(property->values[j]));
+			probe_item_ent_add(item, "value", NULL, se_value);
 			SEXP_free(se_value);
-			return 0;
-		} else {
-			probe_item_collect(vars->ctx, vars->item);
-			vars->item = NULL;
-			SEXP_free(vars->se_property);
-			vars->se_property = NULL;
 		}
-	}
 
-	SEXP_t *se_property = SEXP_string_new(property, strlen(property));
-
-	if (probe_entobj_cmp(vars->property_entity, se_property) != OVAL_RESULT_TRUE) {
+		probe_item_collect(ctx, item);
 		SEXP_free(se_property);
-		return 0;
-	}
-
-	vars->se_property = se_property;
-	vars->item = probe_item_create(OVAL_LINUX_SYSTEMDUNITPROPERTY, NULL,
-				       "unit", OVAL_DATATYPE_SEXP, vars->se_unit,
-				       "property", OVAL_DATATYPE_SEXP, vars->se_property,
-				       "value", OVAL_DATATYPE_STRING, value,
-				       NULL);
-	return 0;
-}
-
-static int unit_callback(const char *unit, void *cbarg)
-{
-	struct unit_callback_vars *vars = (struct unit_callback_vars *)cbarg;
-	SEXP_t *se_unit = SEXP_string_new(unit, strlen(unit));
-
-	if (probe_entobj_cmp(vars->unit_entity, se_unit) != OVAL_RESULT_TRUE) {
-		/* Do nothing, continue with the next unit */
-		SEXP_free(se_unit);
-		return 0;
-	}
-
-	vars->se_unit = se_unit;
-	vars->se_property = NULL;
-	vars->item = NULL;
-
-	char *unit_path = get_path_by_unit(vars->dbus_conn, unit);
-
-	if (unit_path == NULL) {
-		return 1;
-	}
-
-	get_all_properties_by_unit_path(vars->dbus_conn, unit_path,
-					property_callback, vars);
-	free(unit_path);
-
-	if (vars->item != NULL) {
-		probe_item_collect(vars->ctx, vars->item);
-		vars->item = NULL;
-		SEXP_free(vars->se_property);
-		vars->se_property = NULL;
 	}
 
 	SEXP_free(se_unit);
-	return 0;
 }
 
 int systemdunitproperty_probe_offline_mode_supported(void)
@@ -291,14 +113,33 @@ int systemdunitproperty_probe_main(probe_ctx *ctx, void *probe_arg)
 	unit_entity = probe_obj_getent(probe_in, "unit", 1);
 	property_entity = probe_obj_getent(probe_in, "property", 1);
 
-	struct unit_callback_vars vars;
+	struct systemd_unit_cache *cache = systemd_unit_cache_get(dbus_conn);
+	const char *const *names;
+	size_t count = systemd_unit_cache_list(cache, &names);
+	const char **matching = malloc((count + 1) * sizeof(char *));
+	size_t matching_count = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		SEXP_t *se_unit = SEXP_string_new(names[i], strlen(names[i]));
 
-	vars.dbus_conn = dbus_conn;
-	vars.ctx = ctx;
-	vars.unit_entity = unit_entity;
-	vars.property_entity = property_entity;
+		if (probe_entobj_cmp(unit_entity, se_unit) == OVAL_RESULT_TRUE)
+			matching[matching_count++] = names[i];
+		SEXP_free(se_unit);
+	}
+
+	const struct systemd_unit **units = malloc((matching_count + 1) * sizeof(struct systemd_unit *));
+	systemd_unit_cache_load(cache, matching, matching_count, units);
+
+	for (size_t i = 0; i < matching_count; ++i) {
+		// Stop at the first unit which can't be loaded
+		if (units[i]->path == NULL)
+			break;
+		report_unit_properties(ctx, units[i], property_entity);
+	}
 
-	get_all_systemd_units(dbus_conn, unit_callback, &vars);
+	free(units);
+	free(matching);
+	systemd_unit_cache_put(cache);
 
 	SEXP_free(unit_entity);
 	SEXP_free(property_entity);
@@ -307,3 +148,8 @@ int systemdunitproperty_probe_main(probe_ctx *ctx, void *probe_arg)
 
 	return 0;
 }
+
+void systemdunitproperty_probe_fini(void *arg)
+{
+	systemd_unit_cache_drop();
+}
@@ -49,14 +49,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
-#include <pwd.h>
-#include <paths.h>
-#if defined(OS_APPLE)
-#include <utmp.h>
-#elif defined(OS_FREEBSD)
+#if defined(OS_FREEBSD)
 #include <utmpx.h>
-#else
-#include <lastlog.h>
 #endif
 
 #include "_seap.h"
@@ -65,6 +59,7 @@
 #include "common/debug_priv.h"
 #include <probe/probe.h>
 #include <probe/option.h>
+#include "account-db.h"
 #include "password_probe.h"
 
 /* Convenience structure for the results being reported */
@@ -121,29 +116,29 @@ static time_t get_last_login(char *username) {
         return t;
 }
 
-static void _freebsd_process_struct_passwd(struct passwd *pw, SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
+static void _freebsd_process_struct_passwd(const struct account_user *pw, SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
 {
 	SEXP_t *un;
 	struct result_info r;
 
-	dI("Have user: %s", pw->pw_name);
-	un = SEXP_string_newf("%s", pw->pw_name);
+	dI("Have user: %s", pw->name);
+	un = SEXP_string_newf("%s", pw->name);
 	if (probe_entobj_cmp(un_ent, un) != OVAL_RESULT_TRUE) {
 		SEXP_free(un);
 		return;
 	}
 
-	r.username = pw->pw_name;
-	r.password = pw->pw_passwd;
-	r.user_id = pw->pw_uid;
-	r.group_id = pw->pw_gid;
-	r.gcos = pw->pw_gecos;
-	r.home_dir = pw->pw_dir;
-	r.login_shell = pw->pw_shell;
+	r.username = pw->name;
+	r.password = pw->password;
+	r.user_id = pw->uid;
+	r.group_id = pw->gid;
+	r.gcos = pw->gecos;
+	r.home_dir = pw->home_dir;
+	r.login_shell = pw->shell;
 	r.last_login = -1;
 
 	if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0) {
-		r.last_login = get_last_login(pw->pw_name);
+		r.last_login = get_last_login(pw->name);
 	}
 
 	report_finding(&r, ctx, over);
@@ -152,13 +147,21 @@ static void _freebsd_process_struct_passwd(struct passwd *pw, SEXP_t *un_ent, pr
 
 static int read_password(SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
 {
-	struct passwd *pw;
-
-	while ((pw = getpwent())) {
-		_freebsd_process_struct_passwd(pw, un_ent, ctx, over);
+	struct account_db *db;
+	const struct account_user **users;
+	int count;
+
+	db = account_db_get(NULL);
+	count = account_db_find_users(db, un_ent, &users);
+	if (count < 0) {
+		account_db_put(db);
+		return 1;
 	}
+	for (int i = 0; i < count; ++i)
+		_freebsd_process_struct_passwd(users[i], un_ent, ctx, over);
+	free(users);
+	account_db_put(db);
 
-	endpwent();
 	return 0;
 }
 
@@ -168,39 +171,29 @@ int password_probe_offline_mode_supported()
 }
 
 #else
-static void _process_struct_passwd(struct passwd *pw, const char *lastlog, SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
+static void _process_struct_passwd(struct account_db *db, const struct account_user *pw, SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
 {
         SEXP_t *un;
         struct result_info r;
 
-        dI("Have user: %s", pw->pw_name);
-        un = SEXP_string_newf("%s", pw->pw_name);
+        dI("Have user: %s", pw->name);
+        un = SEXP_string_newf("%s", pw->name);
         if (probe_entobj_cmp(un_ent, un) != OVAL_RESULT_TRUE) {
                 SEXP_free(un);
                 return;
         }
 
-        r.username = pw->pw_name;
-        r.password = pw->pw_passwd;
-        r.user_id = pw->pw_uid;
-        r.group_id = pw->pw_gid;
-        r.gcos = pw->pw_gecos;
-        r.home_dir = pw->pw_dir;
-        r.login_shell = pw->pw_shell;
+        r.username = pw->name;
+        r.password = pw->password;
+        r.user_id = pw->uid;
+        r.group_id = pw->gid;
+        r.gcos = pw->gecos;
+        r.home_dir = pw->home_dir;
+        r.login_shell = pw->shell;
         r.last_login = -1;
 
-        if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0) {
-                FILE *ll_fp = fopen(lastlog, "r");
-
-                if (ll_fp != NULL) {
-                        struct lastlog ll;
-
-                        if (fseeko(ll_fp, (off_t)pw->pw_uid * sizeof(ll), SEEK_SET) == 0)
-                                if (fread((char *)&ll, sizeof(ll), 1, ll_fp) == 1)
-                                        r.last_login = (int64_t)ll.ll_time;
-                        fclose(ll_fp);
-                }
-        }
+        if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0)
+                r.last_login = account_db_last_login(db, pw);
 
         report_finding(&r, ctx, over);
         SEXP_free(un);
@@ -208,32 +201,28 @@ static void _process_struct_passwd(struct passwd *pw, const char *lastlog, SEXP_
 
 static int read_password(SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
 {
-        struct passwd *pw;
+	struct account_db *db;
+	const struct account_user **users;
+	int count;
 
 	if (ctx->offline_mode & PROBE_OFFLINE_OWN) {
 		const char *root = getenv("OSCAP_PROBE_ROOT");
 		if (root == NULL)
 			return 1;
-		char *passwd_file_path = oscap_path_join(root, "/etc/passwd");
-		char *lastlog_file_path = oscap_path_join(root, _PATH_LASTLOG);
-		FILE *fp = fopen(passwd_file_path, "r");
-		if (fp == NULL) {
-			free(passwd_file_path);
-			free(lastlog_file_path);
-			return 1;
-		}
-		while ((pw = fgetpwent(fp))) {
-			_process_struct_passwd(pw, lastlog_file_path, un_ent, ctx, over);
-		}
-		fclose(fp);
-		free(passwd_file_path);
-		free(lastlog_file_path);
+		db = account_db_get(root);
 	} else {
-		while ((pw = getpwent())) {
-			_process_struct_passwd(pw, _PATH_LASTLOG, un_ent, ctx, over);
-		}
-		endpwent();
+		db = account_db_get(NULL);
+	}
+
+	count = account_db_find_users(db, un_ent, &users);
+	if (count < 0) {
+		account_db_put(db);
+		return 1;
 	}
+	for (int i = 0; i < count; ++i)
+		_process_struct_passwd(db, users[i], un_ent, ctx, over);
+	free(users);
+	account_db_put(db);
 
         return 0;
 }
@@ -270,3 +259,8 @@ int password_probe_main(probe_ctx *ctx, void *arg)
 
         return 0;
 }
+
+void password_probe_fini(void *arg)
+{
+	account_db_drop();
+}
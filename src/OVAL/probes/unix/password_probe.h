@@ -27,5 +27,6 @@
 
 int password_probe_offline_mode_supported(void);
 int password_probe_main(probe_ctx *ctx, void *arg);
+void password_probe_fini(void *arg);
 
 #endif /* OPENSCAP_PASSWORD_PROBE_H */
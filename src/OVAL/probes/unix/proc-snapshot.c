@@ -0,0 +1,613 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_STDIO_EXT_H
+# include <stdio_ext.h>
+#endif
+
+#include "common/debug_priv.h"
+#include "common/oscap_buffer.h"
+#include "common/oscap_parallel.h"
+#include "proc-snapshot.h"
+
+#define CHUNK_SIZE 1024
+
+/* Number of processes read by a job of proc_snapshot_load() */
+#define PROC_SNAPSHOT_JOB_SIZE 64
+
+struct proc_snapshot {
+	char *root;                 /* $OSCAP_PROBE_ROOT, empty if not set */
+	char path[PATH_MAX];        /* <root>/proc */
+	unsigned int refcount;
+	pthread_mutex_t lock;       /* serializes reading of the fields */
+	unsigned int loaded;        /* fields read for all the processes */
+	struct proc_entry *entries;
+	size_t count;
+	unsigned long boot;
+};
+
+static pthread_mutex_t g_proc_snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct proc_snapshot *g_proc_snapshot = NULL;
+
+static void proc_snapshot_read_boot_time(struct proc_snapshot *snapshot)
+{
+	char buf[PATH_MAX];
+	FILE *sf;
+	int line;
+
+	snapshot->boot = 0;
+	if (snprintf(buf, sizeof(buf), "%s/stat", snapshot->path) >= (int) sizeof(buf))
+		return;
+	sf = fopen(buf, "rt");
+	if (sf == NULL)
+		return;
+
+	line = 0;
+#ifdef HAVE_STDIO_EXT_H
+	__fsetlocking(sf, FSETLOCKING_BYCALLER);
+#endif
+	while (fgets(buf, sizeof(buf), sf)) {
+		if (line == 0) {
+			line++;
+			continue;
+		}
+		if (memcmp(buf, "btime", 5) == 0) {
+			sscanf(buf, "btime %lu", &snapshot->boot);
+			break;
+		}
+	}
+	fclose(sf);
+}
+
+static void proc_entry_read_stat(const char *path, struct proc_entry *entry)
+{
+	char buf[PATH_MAX], *tmp;
+	int fd, len, ppid;
+
+	if (snprintf(buf, sizeof(buf), "%s/%d/stat", path, entry->pid) >= (int) sizeof(buf))
+		return;
+	fd = open(buf, O_RDONLY, 0);
+	if (fd < 0)
+		return;
+	len = read(fd, buf, sizeof buf - 1);
+	close(fd);
+	if (len < 40)
+		return;
+	buf[len] = 0;
+	tmp = strrchr(buf, ')');
+	if (tmp == NULL)
+		return;
+	*tmp = 0;
+
+	memset(entry->comm, 0, sizeof(entry->comm));
+	sscanf(buf, "%d (%15c", &ppid, entry->comm);
+	{
+		int tpgid;
+		unsigned flags;
+		unsigned long minflt, cminflt, majflt, cmajflt;
+		long cutime, cstime, cnice, nthreads, itrealvalue;
+
+		sscanf(tmp+2,	"%c %d %d %d %d %d "
+				"%u %lu %lu %lu %lu "
+				"%lu %lu %ld %ld %ld "
+				"%ld %ld %ld %llu",
+			&entry->state, &entry->ppid, &entry->pgrp, &entry->session, &entry->tty_nr, &tpgid,
+			&flags, &minflt, &cminflt, &majflt, &cmajflt,
+			&entry->utime, &entry->stime, &cutime, &cstime, &entry->priority,
+			&cnice, &nthreads, &itrealvalue, &entry->start
+		);
+	}
+	entry->stat_valid = true;
+}
+
+static void proc_entry_read_status(const char *path, struct proc_entry *entry)
+{
+	char buf[PATH_MAX];
+	FILE *sf;
+
+	entry->ruid = -1;
+	entry->euid = -1;
+
+	if (snprintf(buf, sizeof(buf), "%s/%d/status", path, entry->pid) >= (int) sizeof(buf))
+		return;
+	sf = fopen(buf, "rt");
+	if (sf) {
+		int line = 0;
+#ifdef HAVE_STDIO_EXT_H
+		__fsetlocking(sf, FSETLOCKING_BYCALLER);
+#endif
+		while (fgets(buf, sizeof(buf), sf)) {
+			if (line == 0) {
+				line++;
+				continue;
+			}
+			if (memcmp(buf, "Uid:", 4) == 0) {
+				sscanf(buf, "Uid: %d %d", &entry->ruid, &entry->euid);
+				break;
+			}
+		}
+		fclose(sf);
+	}
+}
+
+static void proc_entry_read_loginuid(const char *path, struct proc_entry *entry)
+{
+	char buf[PATH_MAX];
+	FILE *sf;
+
+	entry->loginuid = -1;
+
+	if (snprintf(buf, sizeof(buf), "%s/%d/loginuid", path, entry->pid) >= (int) sizeof(buf))
+		return;
+	sf = fopen(buf, "rt");
+	if (sf) {
+		if (fscanf(sf, "%u", &entry->loginuid) < 1) {
+			dW("fscanf failed from %s", buf);
+		}
+		fclose(sf);
+	}
+}
+
+/*
+ * Read /proc/<pid>/cmdline and format it like ps does: the program and
+ * the arguments are separated by spaces, non-printable characters are
+ * replaced by dots.
+ */
+static void proc_entry_read_cmdline(const char *path, struct proc_entry *entry)
+{
+	char filepath[PATH_MAX];
+	int fd;
+
+	entry->cmdline = NULL;
+
+	if (snprintf(filepath, sizeof(filepath), "%s/%d/cmdline", path, entry->pid) >= (int) sizeof(filepath))
+		return;
+	fd = open(filepath, O_RDONLY, 0);
+	if (fd < 0)
+		return;
+
+	struct oscap_buffer *buffer = oscap_buffer_new();
+	for (;;) {
+		char chunk[CHUNK_SIZE];
+		// Read data, store to buffer
+		ssize_t read_size = read(fd, chunk, CHUNK_SIZE);
+		if (read_size < 0) {
+			close(fd);
+			oscap_buffer_free(buffer);
+			return;
+		}
+		oscap_buffer_append_binary_data(buffer, chunk, read_size);
+
+		// If reach end of file, then end the loop
+		if (CHUNK_SIZE != read_size) {
+			break;
+		}
+	}
+	close(fd);
+
+	int length = oscap_buffer_get_length(buffer);
+	char *buffer_mem = oscap_buffer_get_raw(buffer);
+
+	if (length == 0) { // empty file
+		oscap_buffer_free(buffer);
+		return;
+	}
+
+	// Skip multiple trailing zeros
+	int i = length - 1;
+	while ((i > 0) && (buffer_mem[i] == '\0')) {
+		--i;
+	}
+
+	// Program and args are separated by '\0'
+	// Replace them with spaces ' '
+	while (i >= 0) {
+		char chr = buffer_mem[i];
+		if ((chr == '\0') || (chr == '\n')) {
+			buffer_mem[i] = ' ';
+		} else if (!isprint(chr)) { // "ps" replace non-printable characters with '.' (LC_ALL=C)
+			buffer_mem[i] = '.';
+		}
+		--i;
+	}
+
+	entry->cmdline = oscap_buffer_bequeath(buffer);
+}
+
+/* get exec shield status according to http://people.redhat.com/sgrubb/files/lsexec */
+static void proc_entry_read_exec_shield(const char *path, struct proc_entry *entry)
+{
+	char buf[PATH_MAX];
+	FILE *sf;
+	long unsigned low, high, inode;
+	long long unsigned offset;
+	int dev_min, dev_maj;
+	char perm[3], trim;
+	int read_items;
+
+	entry->exec_shield = -1;
+
+	if (snprintf(buf, sizeof(buf), "%s/%d/maps", path, entry->pid) >= (int) sizeof(buf))
+		return;
+	sf = fopen(buf, "rt");
+	if (sf) {
+		while (fgets(buf, 500, sf)) {
+			read_items = sscanf(
+				buf, "%lx-%lx rw%s %llx %x:%x %lu %c\n",
+				&low, &high, perm, &offset, &dev_min,
+				&dev_maj, &inode, &trim
+			);
+			if (read_items == 7) {
+				if (perm[0] == 'x' && offset != 0) {
+					entry->exec_shield = 0;
+				}
+				else {
+					entry->exec_shield = 1;
+				}
+			}
+		}
+		fclose(sf);
+	}
+}
+
+static void proc_entry_read_environ(const char *path, struct proc_entry *entry)
+{
+	char filepath[PATH_MAX];
+	size_t size = 0, capacity = 0;
+	char *data = NULL;
+	ssize_t s;
+	int fd;
+
+	entry->environment = NULL;
+	entry->environment_len = 0;
+	entry->environment_errno = 0;
+
+	if (snprintf(filepath, sizeof(filepath), "%s/%d/environ", path, entry->pid) >= (int) sizeof(filepath)) {
+		entry->environment_errno = ENAMETOOLONG;
+		return;
+	}
+	if ((fd = open(filepath, O_RDONLY)) == -1) {
+		entry->environment_errno = errno;
+		return;
+	}
+
+	do {
+		if (capacity - size < CHUNK_SIZE) {
+			capacity = capacity ? capacity * 2 : 4 * CHUNK_SIZE;
+			data = realloc(data, capacity + 1);
+		}
+		s = read(fd, data + size, capacity - size);
+		if (s > 0)
+			size += s;
+	} while (s > 0);
+	close(fd);
+
+	/* The last variable doesn't have to be terminated */
+	data[size] = '\0';
+	entry->environment = data;
+	entry->environment_len = size;
+}
+
+static void proc_entry_read_sockets(const char *path, struct proc_entry *entry)
+{
+	char buf[PATH_MAX];
+	struct dirent *ent;
+	size_t capacity = 0;
+	DIR *f;
+
+	entry->sockets = NULL;
+	entry->socket_count = 0;
+
+	// Now lets get the inodes each process has open
+	if (snprintf(buf, sizeof(buf), "%s/%d/fd", path, entry->pid) >= (int) sizeof(buf)) {
+		entry->fd_valid = false;
+		return;
+	}
+	f = opendir(buf);
+	if (f == NULL) {
+		// Process might have ended or we don't have access - ignore it
+		entry->fd_valid = false;
+		return;
+	}
+	entry->fd_valid = true;
+
+	// For each file in the fd dir...
+	while (( ent = readdir(f) )) {
+		char line[256], pathname[PATH_MAX], *s, *e;
+		unsigned long inode;
+		int lnlen;
+
+		if (ent->d_name[0] == '.')
+			continue;
+		if (snprintf(pathname, sizeof(pathname), "%s/%s", buf, ent->d_name) >= (int) sizeof(pathname))
+			continue;
+		lnlen = readlink(pathname, line, sizeof(line) - 1);
+		if (lnlen < 0) {
+			continue;
+		}
+		line[lnlen] = 0;
+
+		// Only look at the socket entries
+		if (memcmp(line, "socket:", 7) == 0) {
+			// Type 1 sockets
+			s = strchr(line+7, '[');
+			if (s == NULL)
+				continue;
+			s++;
+			e = strchr(s, ']');
+			if (e == NULL)
+				continue;
+			*e = 0;
+		} else if (memcmp(line, "[0000]:", 7) == 0) {
+			// Type 2 sockets
+			s = line + 8;
+		} else
+			continue;
+		errno = 0;
+		inode = strtoul(s, NULL, 10);
+		if (errno)
+			continue;
+
+		if (entry->socket_count == capacity) {
+			capacity = capacity ? capacity * 2 : 8;
+			entry->sockets = realloc(entry->sockets, capacity * sizeof(unsigned long));
+		}
+		entry->sockets[entry->socket_count++] = inode;
+	}
+	closedir(f);
+}
+
+static void proc_entry_read(const char *path, struct proc_entry *entry, unsigned int fields)
+{
+	fields &= ~entry->loaded;
+
+	if (fields & PROC_SNAPSHOT_STAT)
+		proc_entry_read_stat(path, entry);
+	if (fields & PROC_SNAPSHOT_STATUS)
+		proc_entry_read_status(path, entry);
+	if (fields & PROC_SNAPSHOT_LOGINUID)
+		proc_entry_read_loginuid(path, entry);
+	if (fields & PROC_SNAPSHOT_CMDLINE)
+		proc_entry_read_cmdline(path, entry);
+	if (fields & PROC_SNAPSHOT_EXEC_SHIELD)
+		proc_entry_read_exec_shield(path, entry);
+	if (fields & PROC_SNAPSHOT_ENVIRON)
+		proc_entry_read_environ(path, entry);
+	if (fields & PROC_SNAPSHOT_SOCKETS)
+		proc_entry_read_sockets(path, entry);
+
+	entry->loaded |= fields;
+}
+
+static void proc_entry_free(struct proc_entry *entry)
+{
+	free(entry->cmdline);
+	free(entry->environment);
+	free(entry->sockets);
+}
+
+static void proc_snapshot_free(struct proc_snapshot *snapshot)
+{
+	if (snapshot == NULL)
+		return;
+
+	for (size_t i = 0; i < snapshot->count; ++i)
+		proc_entry_free(&snapshot->entries[i]);
+	free(snapshot->entries);
+	free(snapshot->root);
+	pthread_mutex_destroy(&snapshot->lock);
+	free(snapshot);
+}
+
+static void proc_snapshot_unref(struct proc_snapshot *snapshot)
+{
+	if (snapshot != NULL && --snapshot->refcount == 0)
+		proc_snapshot_free(snapshot);
+}
+
+static struct proc_snapshot *proc_snapshot_new(const char *root)
+{
+	struct proc_snapshot *snapshot;
+	struct dirent *ent;
+	size_t capacity = 0;
+	DIR *d;
+
+	snapshot = calloc(1, sizeof(struct proc_snapshot));
+	snapshot->root = strdup(root);
+	if (snprintf(snapshot->path, sizeof(snapshot->path), "%s/proc", root) >= (int) sizeof(snapshot->path)) {
+		dD("The path of %s/proc is too long.", root);
+		free(snapshot->root);
+		free(snapshot);
+		return NULL;
+	}
+
+	d = opendir(snapshot->path);
+	if (d == NULL) {
+		dD("Can't read %s: errno=%d, %s.", snapshot->path, errno, strerror(errno));
+		free(snapshot->root);
+		free(snapshot);
+		return NULL;
+	}
+
+	while ((ent = readdir(d))) {
+		// Skip non-process dir entries
+		if (ent->d_name[0] == '\0' || strspn(ent->d_name, "0123456789") != strlen(ent->d_name))
+			continue;
+
+		if (snapshot->count == capacity) {
+			capacity = capacity ? capacity * 2 : 256;
+			snapshot->entries = realloc(snapshot->entries, capacity * sizeof(struct proc_entry));
+		}
+		struct proc_entry *entry = &snapshot->entries[snapshot->count++];
+		memset(entry, 0, sizeof(*entry));
+		entry->pid = atoi(ent->d_name);
+	}
+	closedir(d);
+
+	proc_snapshot_read_boot_time(snapshot);
+	pthread_mutex_init(&snapshot->lock, NULL);
+	dD("Snapshot of %s has %zu processes.", snapshot->path, snapshot->count);
+
+	return snapshot;
+}
+
+struct proc_snapshot *proc_snapshot_get(void)
+{
+	struct proc_snapshot *snapshot;
+	const char *root = getenv("OSCAP_PROBE_ROOT");
+
+	if (root == NULL)
+		root = "";
+
+	pthread_mutex_lock(&g_proc_snapshot_lock);
+
+	snapshot = g_proc_snapshot;
+	if (snapshot == NULL || strcmp(snapshot->root, root) != 0) {
+		proc_snapshot_unref(g_proc_snapshot);
+		g_proc_snapshot = snapshot = proc_snapshot_new(root);
+		/* One reference is held by the cache */
+		if (snapshot != NULL)
+			snapshot->refcount = 1;
+	}
+	if (snapshot != NULL)
+		snapshot->refcount++;
+
+	pthread_mutex_unlock(&g_proc_snapshot_lock);
+	return snapshot;
+}
+
+void proc_snapshot_put(struct proc_snapshot *snapshot)
+{
+	pthread_mutex_lock(&g_proc_snapshot_lock);
+	proc_snapshot_unref(snapshot);
+	pthread_mutex_unlock(&g_proc_snapshot_lock);
+}
+
+void proc_snapshot_drop(void)
+{
+	pthread_mutex_lock(&g_proc_snapshot_lock);
+	proc_snapshot_unref(g_proc_snapshot);
+	g_proc_snapshot = NULL;
+	pthread_mutex_unlock(&g_proc_snapshot_lock);
+}
+
+const char *proc_snapshot_path(struct proc_snapshot *snapshot)
+{
+	return snapshot->path;
+}
+
+size_t proc_snapshot_count(struct proc_snapshot *snapshot)
+{
+	return snapshot->count;
+}
+
+const struct proc_entry *proc_snapshot_nth(struct proc_snapshot *snapshot, size_t n)
+{
+	return n < snapshot->count ? &snapshot->entries[n] : NULL;
+}
+
+unsigned long proc_snapshot_boot_time(struct proc_snapshot *snapshot)
+{
+	return snapshot->boot;
+}
+
+struct proc_snapshot_load_ctx {
+	struct proc_snapshot *snapshot;
+	struct proc_entry **entries;   /* NULL to read all the processes */
+	size_t count;
+	unsigned int fields;
+};
+
+static void proc_snapshot_load_job(size_t index, void *arg)
+{
+	struct proc_snapshot_load_ctx *ctx = arg;
+	size_t first = index * PROC_SNAPSHOT_JOB_SIZE;
+	size_t last = first + PROC_SNAPSHOT_JOB_SIZE;
+
+	if (last > ctx->count)
+		last = ctx->count;
+
+	for (size_t i = first; i < last; ++i) {
+		struct proc_entry *entry = ctx->entries != NULL ? ctx->entries[i] : &ctx->snapshot->entries[i];
+		proc_entry_read(ctx->snapshot->path, entry, ctx->fields);
+	}
+}
+
+static void proc_snapshot_load_run(struct proc_snapshot_load_ctx *ctx)
+{
+	size_t jobs = (ctx->count + PROC_SNAPSHOT_JOB_SIZE - 1) / PROC_SNAPSHOT_JOB_SIZE;
+
+	if (oscap_parallel_run(jobs, proc_snapshot_load_job, ctx) != 0) {
+		for (size_t i = 0; i < jobs; ++i)
+			proc_snapshot_load_job(i, ctx);
+	}
+}
+
+void proc_snapshot_load(struct proc_snapshot *snapshot, unsigned int fields)
+{
+	pthread_mutex_lock(&snapshot->lock);
+
+	fields &= ~snapshot->loaded;
+	if (fields != 0) {
+		struct proc_snapshot_load_ctx ctx = {
+			.snapshot = snapshot,
+			.entries = NULL,
+			.count = snapshot->count,
+			.fields = fields
+		};
+		proc_snapshot_load_run(&ctx);
+		snapshot->loaded |= fields;
+	}
+
+	pthread_mutex_unlock(&snapshot->lock);
+}
+
+void proc_snapshot_load_entries(struct proc_snapshot *snapshot, const struct proc_entry **entries, size_t count, unsigned int fields)
+{
+	pthread_mutex_lock(&snapshot->lock);
+
+	fields &= ~snapshot->loaded;
+	if (fields != 0 && count > 0) {
+		struct proc_snapshot_load_ctx ctx = {
+			.snapshot = snapshot,
+			/* The entries are owned by the snapshot */
+			.entries = (struct proc_entry **) entries,
+			.count = count,
+			.fields = fields
+		};
+		proc_snapshot_load_run(&ctx);
+	}
+
+	pthread_mutex_unlock(&snapshot->lock);
+}
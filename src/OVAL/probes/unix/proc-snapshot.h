@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef OPENSCAP_PROC_SNAPSHOT_H
+#define OPENSCAP_PROC_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Snapshot of the process table below $OSCAP_PROBE_ROOT/proc shared by the
+ * process58, environmentvariable58 and inetlisteningservers probes. The list
+ * of processes is read once per scan, the fields of the processes are read
+ * on demand and kept until the snapshot is dropped, so that all the objects
+ * and probes of a scan see the same processes.
+ */
+
+/* Fields of a process read by proc_snapshot_load() */
+#define PROC_SNAPSHOT_STAT        0x0001 /* /proc/<pid>/stat */
+#define PROC_SNAPSHOT_STATUS      0x0002 /* uids from /proc/<pid>/status */
+#define PROC_SNAPSHOT_LOGINUID    0x0004 /* /proc/<pid>/loginuid */
+#define PROC_SNAPSHOT_CMDLINE     0x0008 /* /proc/<pid>/cmdline */
+#define PROC_SNAPSHOT_EXEC_SHIELD 0x0010 /* exec shield status from /proc/<pid>/maps */
+#define PROC_SNAPSHOT_ENVIRON     0x0020 /* /proc/<pid>/environ */
+#define PROC_SNAPSHOT_SOCKETS     0x0040 /* socket inodes from /proc/<pid>/fd */
+
+struct proc_entry {
+	int pid;
+	unsigned int loaded;        /* PROC_SNAPSHOT_* fields read so far */
+
+	/* PROC_SNAPSHOT_STAT */
+	bool stat_valid;            /* the stat file has been read and parsed */
+	char state;
+	char comm[16];
+	int ppid;
+	int pgrp;
+	int session;
+	int tty_nr;
+	unsigned long utime;
+	unsigned long stime;
+	long priority;
+	unsigned long long start;   /* start time in clock ticks after boot */
+
+	/* PROC_SNAPSHOT_STATUS, -1 if unknown */
+	int ruid;
+	int euid;
+
+	/* PROC_SNAPSHOT_LOGINUID, -1 if unknown */
+	unsigned int loginuid;
+
+	/* PROC_SNAPSHOT_CMDLINE, ps-like command line or NULL if empty */
+	char *cmdline;
+
+	/* PROC_SNAPSHOT_EXEC_SHIELD, -1 not detected, 0 disabled, 1 enabled */
+	int exec_shield;
+
+	/* PROC_SNAPSHOT_ENVIRON, NULL and errno if it can't be read */
+	char *environment;          /* NUL separated variables, NUL terminated */
+	size_t environment_len;
+	int environment_errno;
+
+	/* PROC_SNAPSHOT_SOCKETS */
+	bool fd_valid;              /* the fd directory has been read */
+	unsigned long *sockets;
+	size_t socket_count;
+};
+
+struct proc_snapshot;
+
+/*
+ * Get a reference to the snapshot of the process table. The list of the
+ * processes is read by the first call, the following calls share it until
+ * proc_snapshot_drop() is called. Returns NULL if /proc can't be read.
+ */
+struct proc_snapshot *proc_snapshot_get(void);
+
+/*
+ * Release a reference obtained by proc_snapshot_get().
+ */
+void proc_snapshot_put(struct proc_snapshot *snapshot);
+
+/*
+ * Drop the shared snapshot, the next proc_snapshot_get() reads /proc again.
+ * Called when the probes using the snapshot are finalized.
+ */
+void proc_snapshot_drop(void);
+
+/*
+ * Path of the proc filesystem of the snapshot, including $OSCAP_PROBE_ROOT.
+ */
+const char *proc_snapshot_path(struct proc_snapshot *snapshot);
+
+/*
+ * Get the number of processes in the snapshot.
+ */
+size_t proc_snapshot_count(struct proc_snapshot *snapshot);
+
+/*
+ * Get the n-th process of the snapshot, in /proc directory order.
+ */
+const struct proc_entry *proc_snapshot_nth(struct proc_snapshot *snapshot, size_t n);
+
+/*
+ * Read the fields of all processes in the snapshot, if they haven't been
+ * read yet. The processes are read by a pool of worker threads.
+ */
+void proc_snapshot_load(struct proc_snapshot *snapshot, unsigned int fields);
+
+/*
+ * Read the fields of the given processes of the snapshot, if they haven't
+ * been read yet. Used for the fields which are only needed for some of the
+ * processes.
+ */
+void proc_snapshot_load_entries(struct proc_snapshot *snapshot, const struct proc_entry **entries, size_t count, unsigned int fields);
+
+/*
+ * Get the system boot time in seconds since the epoch, 0 if unknown.
+ */
+unsigned long proc_snapshot_boot_time(struct proc_snapshot *snapshot);
+
+#endif /* OPENSCAP_PROC_SNAPSHOT_H */
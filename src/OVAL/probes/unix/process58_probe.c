@@ -102,11 +102,9 @@ extern char const *_cap_names[];
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
 #include <ctype.h>
-#include "common/oscap_buffer.h"
 #include "process58_probe.h"
 #include "oscap_helpers.h"
-
-#define CHUNK_SIZE 1024
+#include "proc-snapshot.h"
 
 /* Convenience structure for the results being reported */
 struct result_info {
@@ -156,75 +154,6 @@ static void report_finding(struct result_info *res, probe_ctx *ctx)
 
 static unsigned long ticks, boot;
 
-static void get_boot_time(void)
-{
-	char buf[PATH_MAX];
-	FILE *sf;
-	int line;
-
-	boot = 0;
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(buf, sizeof(buf), "%s/proc/stat", prefix ? prefix : "");
-	sf = fopen(buf, "rt");
-	if (sf == NULL)
-		return;
-
-	line = 0;
-	__fsetlocking(sf, FSETLOCKING_BYCALLER);
-	while (fgets(buf, sizeof(buf), sf)) {
-		if (line == 0) {
-			line++;
-			continue;
-		}
-		if (memcmp(buf, "btime", 5) == 0) {
-			sscanf(buf, "btime %lu", &boot);
-			break;
-		}
-	}
-	fclose(sf);
-}
-
-static int get_uids(int pid, struct result_info *r)
-{
-	char buf[PATH_MAX];
-	FILE *sf;
-
-	r->ruid = -1;
-	r->user_id = -1;
-	r->loginuid = -1;
-
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-
-	snprintf(buf, sizeof(buf), "%s/proc/%d/status", prefix ? prefix : "", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		int line = 0;
-		__fsetlocking(sf, FSETLOCKING_BYCALLER);
-		while (fgets(buf, sizeof(buf), sf)) {
-			if (line == 0) {
-				line++;
-				continue;
-			}
-			if (memcmp(buf, "Uid:", 4) == 0) {
-				sscanf(buf, "Uid: %d %d", &r->ruid, &r->user_id);
-				break;
-			}
-		}
-		fclose(sf);
-	}
-
-	snprintf(buf, sizeof(buf), "%s/proc/%d/loginuid", prefix ? prefix : "", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		if (fscanf(sf, "%u", &r->loginuid) < 1) {
-			dW("fscanf failed from %s", buf);
-		}
-		fclose(sf);
-	}
-
-	return 0;
-}
-
 static char *convert_time(unsigned long long t, char *tbuf, int tb_size)
 {
 	unsigned d,h,m,s;
@@ -356,137 +285,132 @@ exit:
 #endif
 }
 
-/* get exec shield status according to http://people.redhat.com/sgrubb/files/lsexec
- * return value: -1 - not detected, 0 - disabled, 1 - enabled */
-static int get_exec_shield_status(int pid) {
-	char buf[PATH_MAX];
-	FILE *sf;
-	long unsigned low, high, inode;
-	long long unsigned offset;
-	int dev_min, dev_maj;
-	char perm[3], trim;
-	int ret = -1, read_items;
-
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(buf, sizeof(buf), "%s/proc/%d/maps", prefix ? prefix : "", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		while (fgets(buf, 500, sf)) {
-			read_items = sscanf(
-				buf, "%lx-%lx rw%s %llx %x:%x %lu %c\n",
-				&low, &high, perm, &offset, &dev_min,
-				&dev_maj, &inode, &trim
-			);
-			if (read_items == 7) {
-				if (perm[0] == 'x' && offset != 0) {
-					ret = 0;
-				}
-				else {
-					ret = 1;
-				}
-			}
-		}
-		fclose(sf);
-	}
-
-	return ret;
-}
-
 /**
- * Parse /proc/%d/cmdline file
- * @param filepath Path to file ~ use preallocated buffer for the path
- * @param buffer output buffer with non-zero size
- * @return ps-like command info or NULL
+ * Make ps-like command of a process, "[%s] <defunct>" for zombies
+ * @param buffer buffer for the zombie command
+ * @return pointer to the command
  */
-static inline bool get_process_cmdline(const char* filepath, struct oscap_buffer* const buffer){
-
-	int fd = open(filepath, O_RDONLY, 0);
+static const char *get_process_command(const struct proc_entry *entry, char *buffer, size_t size)
+{
+	if (entry->state == 'Z') { // zombie
+		snprintf(buffer, size, "[%s] <defunct>", entry->comm);
+		return buffer;
+	}
+	// use full cmdline if there is any
+	return entry->cmdline != NULL ? entry->cmdline : entry->comm;
+}
 
-	if (fd < 0) {
-		return false;
+static void report_process(const struct proc_entry *entry, const char *cmd, int max_cap_id, probe_ctx *ctx)
+{
+	struct result_info r;
+	unsigned long t = entry->utime/ticks + entry->stime/ticks;
+	char tbuf[32], sbuf[32], tty_dev[128], *selinux_domain_label, **posix_capabilities;
+	int tday,tyear;
+	unsigned sched_policy;
+	time_t s_time;
+	struct tm *proc, *now;
+	const char *fmt;
+	int pid = entry->pid;
+
+	// Now get scheduler policy
+	sched_policy = sched_getscheduler(pid);
+	switch (sched_policy) {
+		case SCHED_OTHER:
+			r.scheduling_class = "TS";
+			break;
+		case SCHED_BATCH:
+			r.scheduling_class = "B";
+			break;
+#ifdef SCHED_IDLE
+		case SCHED_IDLE:
+			r.scheduling_class = "#5";
+			break;
+#endif
+		case SCHED_FIFO:
+			r.scheduling_class = "FF";
+			break;
+		case SCHED_RR:
+			r.scheduling_class = "RR";
+			break;
+		default:
+			r.scheduling_class = "?";
+			break;
 	}
 
-	oscap_buffer_clear(buffer);
+	// Calculate the start time
+	s_time = time(NULL);
+	now = localtime(&s_time);
+	tyear = now->tm_year;
+	tday = now->tm_yday;
+	s_time = boot + (entry->start / ticks);
+	proc = localtime(&s_time);
+
+	// Select format based on how long we've been running
+	//
+	// FROM THE SPEC:
+	// "This is the time of day the process started formatted in HH:MM:SS if
+	// the same day the process started or formatted as MMM_DD (Ex.: Feb_5)
+	// if process started the previous day or further in the past."
+	//
+	if (tday != proc->tm_yday || tyear != proc->tm_year)
+		fmt = "%b_%d";
+	else
+		fmt = "%H:%M:%S";
+	strftime(sbuf, sizeof(sbuf), fmt, proc);
 
+	r.command_line = cmd;
+	r.exec_time = convert_time(t, tbuf, sizeof(tbuf));
+	r.pid = pid;
+	r.ppid = entry->ppid;
+	r.priority = entry->priority;
+	r.start_time = sbuf;
 
+	dev_to_tty(tty_dev, sizeof(tty_dev), (dev_t) entry->tty_nr, pid, ABBREV_DEV);
+	r.tty = tty_dev;
 
-	for(;;) {
-		char chunk[CHUNK_SIZE];
-		// Read data, store to buffer
-		ssize_t read_size = read(fd, chunk, CHUNK_SIZE);
-		if (read_size < 0) {
-			close(fd);
-			return false;
-		}
-		oscap_buffer_append_binary_data(buffer, chunk, read_size);
+	r.exec_shield = (entry->exec_shield > 0);
 
-		// If reach end of file, then end the loop
-		if (CHUNK_SIZE != read_size) {
-			break;
-		}
-	}
+	selinux_domain_label = get_selinux_label(pid);
+	r.selinux_domain_label = selinux_domain_label;
 
-	close(fd);
+	posix_capabilities = get_posix_capability(pid, max_cap_id);
+	r.posix_capability = posix_capabilities;
 
-	int length = oscap_buffer_get_length(buffer);
-	char* buffer_mem = oscap_buffer_get_raw(buffer);
+	r.session_id = entry->session;
 
-	if ( length == 0 ) { // empty file
-		return false;
-	} else {
+	r.ruid = entry->ruid;
+	r.user_id = entry->euid;
+	r.loginuid = entry->loginuid;
+	report_finding(&r, ctx);
 
-		// Skip multiple trailing zeros
-		int i = length - 1;
-		while ( (i > 0) && (buffer_mem[i] == '\0') ) {
-			--i;
-		}
+	if (selinux_domain_label != NULL)
+		free(selinux_domain_label);
 
-		// Program and args are separated by '\0'
-		// Replace them with spaces ' '
-		while( i >= 0 ){
-			char chr = buffer_mem[i];
-			if ( ( chr == '\0') || ( chr == '\n' ) ) {
-				buffer_mem[i] = ' ';
-			} else if ( !isprint(chr) ) { // "ps" replace non-printable characters with '.' (LC_ALL=C)
-				buffer_mem[i] = '.';
-			}
-			--i;
-		}
+	if (posix_capabilities != NULL) {
+		char **posix_capabilities_p = posix_capabilities;
+		while (*posix_capabilities_p)
+			free(*posix_capabilities_p++);
+		free(posix_capabilities);
 	}
-	return true;
-}
-
-/**
- * Make "[%s] <defunct>" from cmd string - inplace
- * @param cmd_buffer @see read_process() > cmd_buffer
- * @return pointer to start of string
- */
-static inline char *make_defunc_str(char* const cmd_buffer){
-	static const char DEFUNC_STR[] = "] <defunct>";
-
-	size_t len = strlen(cmd_buffer);
-	memcpy(cmd_buffer + len, DEFUNC_STR, sizeof(DEFUNC_STR));
-	return cmd_buffer;
 }
 
 static int read_process(SEXP_t *cmd_ent, SEXP_t *pid_ent, probe_ctx *ctx)
 {
-	char buf[PATH_MAX];
 	int max_cap_id;
-	DIR *d;
-	struct dirent *ent;
+	struct proc_snapshot *snapshot;
+	const struct proc_entry **matches;
+	size_t count, match_count = 0;
 	oval_schema_version_t oval_version;
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(buf, PATH_MAX, "%s/proc", prefix ? prefix : "");
-	d = opendir(buf);
-	if (d == NULL) {
+	snapshot = proc_snapshot_get();
+	if (snapshot == NULL) {
 		return prefix ? PROBE_ESUCCESS : PROBE_EACCESS;
 	}
 
 	// Get the time tick hertz
 	ticks = (unsigned long)sysconf(_SC_CLK_TCK);
-	get_boot_time();
+	boot = proc_snapshot_boot_time(snapshot);
 
 	oval_version = probe_obj_get_platform_schema_version(probe_ctx_getobject(ctx));
 	if (oval_schema_version_cmp(oval_version, OVAL_SCHEMA_VERSION(5.11)) < 0) {
@@ -495,176 +419,51 @@ static int read_process(SEXP_t *cmd_ent, SEXP_t *pid_ent, probe_ctx *ctx)
 		max_cap_id = OVAL_5_11_MAX_CAP_ID;
 	}
 
-	struct oscap_buffer *cmdline_buffer = oscap_buffer_new();
-	
+	// The command line is needed to match every process
+	proc_snapshot_load(snapshot, PROC_SNAPSHOT_STAT | PROC_SNAPSHOT_CMDLINE);
+	count = proc_snapshot_count(snapshot);
+	matches = malloc((count > 0 ? count : 1) * sizeof(struct proc_entry *));
+
 	char cmd_buffer[1 + 15 + 11 + 1]; // Format:" [ cmd:15 ] <defunc>"
-	cmd_buffer[0] = '[';
 
-	// Scan the directories
+	// Scan the processes
 	bool any_pid_dir_found = false;
-	while (( ent = readdir(d) )) {
-		int fd, len;
-		char *tmp, state, tty_dev[128];
-		int pid, ppid, pgrp, session, tty_nr, tpgid;
-		unsigned flags, sched_policy;
-		unsigned long minflt, cminflt, majflt, cmajflt, uutime, ustime;
-		long cutime, cstime, priority, cnice, nthreads, itrealvalue;
-		unsigned long long start;
+	for (size_t i = 0; i < count; ++i) {
+		const struct proc_entry *entry = proc_snapshot_nth(snapshot, i);
 		SEXP_t *cmd_sexp = NULL, *pid_sexp = NULL;
 
-		// Skip non-process58 dir entries
-		if(*ent->d_name<'0' || *ent->d_name>'9')
-			continue;
-		errno = 0;
-		pid = strtol(ent->d_name, NULL, 10);
-		if (errno || pid == 2) // skip err & kthreads
-			continue;
-
-		// Parse up the stat file for the proc
-		snprintf(buf, PATH_MAX, "%s/proc/%d/stat", prefix ? prefix : "", pid);
-		fd = open(buf, O_RDONLY, 0);
-		if (fd < 0)
-			continue;
-		len = read(fd, buf, sizeof buf - 1);
-		close(fd);
-		if (len < 40)
-			continue;
-		buf[len] = 0;
-		tmp = strrchr(buf, ')');
-		if (tmp)
-			*tmp = 0;
-		else
-			continue;
-		memset(cmd_buffer + 1, 0, sizeof(cmd_buffer)-1); // clear cmd after starting '['
-		sscanf(buf, "%d (%15c", &ppid, cmd_buffer + 1);
-		sscanf(tmp+2,	"%c %d %d %d %d %d "
-				"%u %lu %lu %lu %lu "
-				"%lu %lu %lu %ld %ld "
-				"%ld %ld %ld %llu",
-			&state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
-			&flags, &minflt, &cminflt, &majflt, &cmajflt,
-			&uutime, &ustime, &cutime, &cstime, &priority,
-			&cnice, &nthreads, &itrealvalue, &start
-		);
-
-		// Skip kthreads
-		if (ppid == 2)
+		// Skip kthreads and processes without a stat file
+		if (entry->pid == 2 || !entry->stat_valid || entry->ppid == 2)
 			continue;
 
-		const char* cmd;
-		if (state == 'Z') { // zombie
-			cmd = make_defunc_str(cmd_buffer);
-		} else {
-			snprintf(buf, PATH_MAX, "%s/proc/%d/cmdline", prefix ? prefix : "", pid);
-			if (get_process_cmdline(buf, cmdline_buffer)) {
-				cmd = oscap_buffer_get_raw(cmdline_buffer); // use full cmdline
-			} else {
-				cmd = cmd_buffer + 1;
-			}
-		}
+		const char *cmd = get_process_command(entry, cmd_buffer, sizeof(cmd_buffer));
 
 		any_pid_dir_found = true;
 		cmd_sexp = SEXP_string_newf("%s", cmd);
-		pid_sexp = SEXP_number_newu_32(pid);
+		pid_sexp = SEXP_number_newu_32(entry->pid);
 		if ((cmd_sexp == NULL || probe_entobj_cmp(cmd_ent, cmd_sexp) == OVAL_RESULT_TRUE) &&
 		    (pid_sexp == NULL || probe_entobj_cmp(pid_ent, pid_sexp) == OVAL_RESULT_TRUE)
 		) {
-			struct result_info r;
-			unsigned long t = uutime/ticks + ustime/ticks;
-			char tbuf[32], sbuf[32], *selinux_domain_label, **posix_capabilities;
-			int tday,tyear;
-			time_t s_time;
-			struct tm *proc, *now;
-			const char *fmt;
-
-			// Now get scheduler policy
-			sched_policy = sched_getscheduler(pid);
-			switch (sched_policy) {
-				case SCHED_OTHER:
-					r.scheduling_class = "TS";
-					break;
-				case SCHED_BATCH:
-					r.scheduling_class = "B";
-					break;
-#ifdef SCHED_IDLE
-				case SCHED_IDLE:
-					r.scheduling_class = "#5";
-					break;
-#endif
-				case SCHED_FIFO:
-					r.scheduling_class = "FF";
-					break;
-				case SCHED_RR:
-					r.scheduling_class = "RR";
-					break;
-				default:
-					r.scheduling_class = "?";
-					break;
-			}
-
-			// Calculate the start time
-			s_time = time(NULL);
-			now = localtime(&s_time);
-			tyear = now->tm_year;
-			tday = now->tm_yday;
-			s_time = boot + (start / ticks);
-			proc = localtime(&s_time);
-
-			// Select format based on how long we've been running
-			//
-			// FROM THE SPEC:
-			// "This is the time of day the process started formatted in HH:MM:SS if
-			// the same day the process started or formatted as MMM_DD (Ex.: Feb_5)
-			// if process started the previous day or further in the past."
-			//
-			if (tday != proc->tm_yday || tyear != proc->tm_year)
-				fmt = "%b_%d";
-			else
-				fmt = "%H:%M:%S";
-			strftime(sbuf, sizeof(sbuf), fmt, proc);
-
-			r.command_line = cmd;
-			r.exec_time = convert_time(t, tbuf, sizeof(tbuf));
-			r.pid = pid;
-			r.ppid = ppid;
-			r.priority = priority;
-			r.start_time = sbuf;
-
-			dev_to_tty(tty_dev, sizeof(tty_dev), (dev_t) tty_nr, pid, ABBREV_DEV);
-			r.tty = tty_dev;
-
-			r.exec_shield = (get_exec_shield_status(pid) > 0);
-
-			selinux_domain_label = get_selinux_label(pid);
-			r.selinux_domain_label = selinux_domain_label;
-
-			posix_capabilities = get_posix_capability(pid, max_cap_id);
-			r.posix_capability = posix_capabilities;
-
-			r.session_id = session;
-
-			get_uids(pid, &r);
-			report_finding(&r, ctx);
-
-			if (selinux_domain_label != NULL)
-				free(selinux_domain_label);
-
-			if (posix_capabilities != NULL) {
-				char **posix_capabilities_p = posix_capabilities;
-				while (*posix_capabilities_p)
-					free(*posix_capabilities_p++);
-				free(posix_capabilities);
-			}
+			matches[match_count++] = entry;
 		}
 		SEXP_free(cmd_sexp);
 		SEXP_free(pid_sexp);
 	}
-        closedir(d);
-	oscap_buffer_free(cmdline_buffer);
+
+	// The rest of the fields is only read for the matching processes
+	proc_snapshot_load_entries(snapshot, matches, match_count,
+			PROC_SNAPSHOT_STATUS | PROC_SNAPSHOT_LOGINUID | PROC_SNAPSHOT_EXEC_SHIELD);
+	for (size_t i = 0; i < match_count; ++i) {
+		const char *cmd = get_process_command(matches[i], cmd_buffer, sizeof(cmd_buffer));
+		report_process(matches[i], cmd, max_cap_id, ctx);
+	}
 
 	if (!any_pid_dir_found) {
-		dW("No data about processes could be read from '%s'.", buf);
+		dW("No data about processes could be read from '%s'.", proc_snapshot_path(snapshot));
 	}
+	free(matches);
+	proc_snapshot_put(snapshot);
+
 	// In offline mode, empty /proc might be a normal situation and doesn't
 	// have to mean permissions problems
 	if (prefix)
@@ -858,3 +657,8 @@ int process58_probe_main(probe_ctx *ctx, void *arg)
 	return 0;
 }
 #endif /* __linux */
+
+void process58_probe_fini(void *arg)
+{
+	proc_snapshot_drop();
+}
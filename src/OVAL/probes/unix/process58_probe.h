@@ -29,4 +29,6 @@ int process58_probe_offline_mode_supported(void);
 
 int process58_probe_main(probe_ctx *ctx, void *arg);
 
+void process58_probe_fini(void *arg);
+
 #endif /* OPENSCAP_PROCESS58_PROBE_H */
@@ -59,6 +59,7 @@
 #include "common/debug_priv.h"
 #include <probe/probe.h>
 #include <probe/option.h>
+#include "account-db.h"
 #include "shadow_probe.h"
 
 #ifndef HAVE_SHADOW_H
@@ -177,27 +178,27 @@ static void report_finding(struct result_info *res, probe_ctx *ctx)
         SEXP_free_r(&se_flg_mem);
 }
 
-static void _process_struct_shadow(struct spwd *sp, SEXP_t *un_ent, probe_ctx *ctx)
+static void _process_struct_shadow(const struct account_shadow *sp, SEXP_t *un_ent, probe_ctx *ctx)
 {
         SEXP_t *un;
         struct result_info r;
 
-	dI("Have user: %s", sp->sp_namp);
-	un = SEXP_string_newf("%s", sp->sp_namp);
+	dI("Have user: %s", sp->name);
+	un = SEXP_string_newf("%s", sp->name);
 	if (probe_entobj_cmp(un_ent, un) != OVAL_RESULT_TRUE) {
 		SEXP_free(un);
 		return;
 	}
 
-	r.username = sp->sp_namp;
-	r.password = sp->sp_pwdp;
-	r.chg_lst = sp->sp_lstchg;
-	r.chg_allow = sp->sp_min;
-	r.chg_req = sp->sp_max;
-	r.exp_warn = sp->sp_warn;
-	r.exp_inact = sp->sp_inact;
-	r.exp_date = sp->sp_expire;
-	r.flag = sp->sp_flag;
+	r.username = sp->name;
+	r.password = sp->password;
+	r.chg_lst = sp->last_change;
+	r.chg_allow = sp->min;
+	r.chg_req = sp->max;
+	r.exp_warn = sp->warn;
+	r.exp_inact = sp->inactive;
+	r.exp_date = sp->expire;
+	r.flag = sp->flag;
 
 	report_finding(&r, ctx);
         SEXP_free(un);
@@ -205,27 +206,24 @@ static void _process_struct_shadow(struct spwd *sp, SEXP_t *un_ent, probe_ctx *c
 
 static int read_shadow(SEXP_t *un_ent, probe_ctx *ctx)
 {
-	struct spwd *sp;
-
-	if (ctx->offline_mode & PROBE_OFFLINE_OWN) {
-		const char *root = getenv("OSCAP_PROBE_ROOT");
-		char *shadow_file_path = oscap_path_join(root, "/etc/shadow");
-		FILE *fp = fopen(shadow_file_path, "r");
-		if (fp == NULL) {
-			free(shadow_file_path);
-			return 1;
-		}
-		while ((sp = fgetspent(fp))) {
-			_process_struct_shadow(sp, un_ent, ctx);
-		}
-		fclose(fp);
-		free(shadow_file_path);
-	} else {
-		while ((sp = getspent())) {
-			_process_struct_shadow(sp, un_ent, ctx);
-		}
-		endspent();
+	struct account_db *db;
+	const struct account_shadow **entries;
+	int count;
+
+	if (ctx->offline_mode & PROBE_OFFLINE_OWN)
+		db = account_db_get(getenv("OSCAP_PROBE_ROOT"));
+	else
+		db = account_db_get(NULL);
+
+	count = account_db_find_shadow(db, un_ent, &entries);
+	if (count < 0) {
+		account_db_put(db);
+		return 1;
 	}
+	for (int i = 0; i < count; ++i)
+		_process_struct_shadow(entries[i], un_ent, ctx);
+	free(entries);
+	account_db_put(db);
 
 	return 0;
 }
@@ -253,3 +251,8 @@ int shadow_probe_main(probe_ctx *ctx, void *arg)
 	return 0;
 }
 #endif /* HAVE_SHADOW_H */
+
+void shadow_probe_fini(void *arg)
+{
+	account_db_drop();
+}
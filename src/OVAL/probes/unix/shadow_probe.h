@@ -27,5 +27,6 @@
 
 int shadow_probe_offline_mode_supported(void);
 int shadow_probe_main(probe_ctx *ctx, void *arg);
+void shadow_probe_fini(void *arg);
 
 #endif /* OPENSCAP_SHADOW_PROBE_H */
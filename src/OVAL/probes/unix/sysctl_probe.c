@@ -35,6 +35,11 @@
 #include "probe/entcmp.h"
 #include "sysctl_probe.h"
 
+/* all values of the name are compared with each collected parameter */
+const char * const sysctl_probe_multival_entities[] = {
+	"name", NULL
+};
+
 #if defined(OS_FREEBSD)
 #include <stdio.h>
 #include <stdlib.h>
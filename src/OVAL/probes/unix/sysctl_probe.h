@@ -26,6 +26,7 @@
 #include "probe-api.h"
 
 int sysctl_probe_offline_mode_supported(void);
+extern const char * const sysctl_probe_multival_entities[];
 
 int sysctl_probe_main(probe_ctx *ctx, void *arg);
 
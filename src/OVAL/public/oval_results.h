@@ -146,6 +146,21 @@ OSCAP_API void oval_results_model_set_export_system_characteristics(struct oval_
  * @memberof oval_results_model
  */
 OSCAP_API bool oval_results_model_get_export_system_characteristics(struct oval_results_model *);
+
+/**
+ * Set short-circuit evaluation of criteria. Children of an AND, OR or ONE
+ * criteria are evaluated from the cheapest to collect to the most expensive
+ * one and once the result of the criteria is known, the remaining children
+ * are neither collected nor evaluated and their result is 'not evaluated'.
+ * It's disabled by default.
+ * @memberof oval_results_model
+ */
+OSCAP_API void oval_results_model_set_short_circuit(struct oval_results_model *, bool short_circuit);
+
+/**
+ * @memberof oval_results_model
+ */
+OSCAP_API bool oval_results_model_get_short_circuit(struct oval_results_model *);
 /**
  * Free memory allocated to a specified oval results model.
  * @param the specified oval_results model
@@ -153,6 +153,41 @@ OSCAP_API void oval_session_set_report_export(struct oval_session *session, cons
  */
 OSCAP_API void oval_session_set_xml_reporter(struct oval_session *session, xml_reporter fn);
 
+/**
+ * Set streaming evaluation of OVAL Definitions.
+ *
+ * When enabled, \ref oval_session_load parses the OVAL Definitions file
+ * without building its DOM and keeps only tests, objects, states and
+ * variables. \ref oval_session_evaluate then parses the definitions one by
+ * one in the document order, evaluates them, calls the callback and releases
+ * them, while the collected system characteristics are shared by all of them.
+ * Memory use then depends on the system rather than on the number of
+ * definitions.
+ *
+ * If results or report export is set before \ref oval_session_evaluate is
+ * called, the results of the definitions are kept for the export, but the
+ * definitions are still released after their evaluation. The exported
+ * results then don't include the source definitions.
+ *
+ * @memberof oval_session
+ * @param session an \ref oval_session
+ * @param streaming true value enables the streaming evaluation
+ */
+OSCAP_API void oval_session_set_streaming(struct oval_session *session, bool streaming);
+
+/**
+ * Set short-circuit evaluation of criteria. Children of a criteria are
+ * evaluated from the cheapest to collect to the most expensive one and the
+ * rest is skipped as soon as the result of the criteria is known, eg. when
+ * a child of an AND criteria is false. The skipped criteria and tests are
+ * reported as 'not evaluated' and their objects aren't collected.
+ *
+ * @memberof oval_session
+ * @param session an \ref oval_session
+ * @param short_circuit true value enables the short-circuit evaluation
+ */
+OSCAP_API void oval_session_set_short_circuit(struct oval_session *session, bool short_circuit);
+
 /**
  * Load OVAL Definitions and bind OVAL Variables to it if provided. Validation
  * if performed automatically if you've set it with \ref
@@ -161,3 +161,164 @@ oval_result_t oval_str_cmp_str(char *state_data, oval_datatype_t state_data_type
 	oscap_seterr(OSCAP_EFAMILY_OVAL, "Invalid OVAL data type: %d.", state_data_type);
 	return OVAL_RESULT_ERROR;
 }
+
+void oval_cmp_datum_init(struct oval_cmp_datum *datum, const char *text, oval_datatype_t datatype)
+{
+	memset(datum, 0, sizeof(struct oval_cmp_datum));
+	datum->text = text;
+	datum->datatype = datatype;
+	/* the errors are reported by oval_str_cmp_str() */
+	if (text == NULL)
+		return;
+
+	switch (datatype) {
+	case OVAL_DATATYPE_STRING:
+	case OVAL_DATATYPE_BINARY:
+		datum->parsed = true;
+		break;
+	case OVAL_DATATYPE_INTEGER:
+		datum->parsed = cstr_to_intmax(text, &datum->value.integer);
+		break;
+	case OVAL_DATATYPE_FLOAT:
+		datum->parsed = cstr_to_double(text, &datum->value.number);
+		break;
+	case OVAL_DATATYPE_BOOLEAN:
+		datum->value.boolean = (((strcmp(text, "true")) == 0) || ((strcmp(text, "1")) == 0)) ? 1 : 0;
+		datum->parsed = true;
+		break;
+	case OVAL_DATATYPE_EVR_STRING:
+		oval_evr_parse(&datum->value.evr, text);
+		datum->parsed = true;
+		break;
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+		if (!oval_debian_evr_parse(&datum->value.debian_evr, text)) {
+			oval_debian_evr_clear(&datum->value.debian_evr);
+			break;
+		}
+		datum->parsed = true;
+		break;
+	case OVAL_DATATYPE_VERSION:
+		oval_version_parse(&datum->value.version, text);
+		datum->parsed = true;
+		break;
+	case OVAL_DATATYPE_IPV4ADDR:
+		datum->parsed = (oval_ipaddr_parse(AF_INET, text, &datum->value.ipaddr) == 0);
+		break;
+	case OVAL_DATATYPE_IPV6ADDR:
+		datum->parsed = (oval_ipaddr_parse(AF_INET6, text, &datum->value.ipaddr) == 0);
+		break;
+	default:
+		break;
+	}
+}
+
+void oval_cmp_datum_clear(struct oval_cmp_datum *datum)
+{
+	if (datum->regex != NULL)
+		oscap_pcre_free(datum->regex);
+	datum->regex = NULL;
+	datum->regex_compiled = false;
+	if (datum->parsed) {
+		switch (datum->datatype) {
+		case OVAL_DATATYPE_EVR_STRING:
+			oval_evr_clear(&datum->value.evr);
+			break;
+		case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+			oval_debian_evr_clear(&datum->value.debian_evr);
+			break;
+		case OVAL_DATATYPE_VERSION:
+			oval_version_clear(&datum->value.version);
+			break;
+		default:
+			break;
+		}
+	}
+	datum->parsed = false;
+}
+
+struct oval_cmp_datum *oval_cmp_datum_new(const char *text, oval_datatype_t datatype)
+{
+	struct oval_cmp_datum *datum = malloc(sizeof(struct oval_cmp_datum));
+
+	if (datum != NULL)
+		oval_cmp_datum_init(datum, text, datatype);
+	return datum;
+}
+
+void oval_cmp_datum_free(struct oval_cmp_datum *datum)
+{
+	if (datum == NULL)
+		return;
+	oval_cmp_datum_clear(datum);
+	free(datum);
+}
+
+bool oval_cmp_datatype_is_parsed(oval_datatype_t datatype)
+{
+	switch (datatype) {
+	case OVAL_DATATYPE_INTEGER:
+	case OVAL_DATATYPE_FLOAT:
+	case OVAL_DATATYPE_EVR_STRING:
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+	case OVAL_DATATYPE_VERSION:
+	case OVAL_DATATYPE_IPV4ADDR:
+	case OVAL_DATATYPE_IPV6ADDR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+oval_result_t oval_cmp_datum_cmp(struct oval_cmp_datum *state, const struct oval_cmp_datum *sys, oval_operation_t operation)
+{
+	if (!state->parsed || !sys->parsed || state->datatype != sys->datatype)
+		return oval_str_cmp_str((char *) state->text, state->datatype, sys->text, operation);
+
+	switch (state->datatype) {
+	case OVAL_DATATYPE_STRING:
+		if (operation == OVAL_OPERATION_PATTERN_MATCH) {
+			if (!state->regex_compiled) {
+				char *err;
+				int errofs;
+
+				/* a pattern which can't be compiled is reported by oval_string_cmp() */
+				state->regex = oscap_pcre_compile(state->text, OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+				if (state->regex == NULL)
+					oscap_pcre_err_free(err);
+				state->regex_compiled = true;
+			}
+			if (state->regex != NULL)
+				return oval_string_cmp_regex(state->regex, state->text, sys->text);
+		}
+		return oval_string_cmp(state->text, sys->text, operation);
+	case OVAL_DATATYPE_INTEGER:
+		return oval_int_cmp(state->value.integer, sys->value.integer, operation);
+	case OVAL_DATATYPE_FLOAT:
+		return oval_float_cmp(state->value.number, sys->value.number, operation);
+	case OVAL_DATATYPE_BOOLEAN:
+		return oval_boolean_cmp(state->value.boolean, sys->value.boolean, operation);
+	case OVAL_DATATYPE_EVR_STRING:
+		return oval_evr_cmp(&state->value.evr, &sys->value.evr, operation);
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+		return oval_debian_evr_cmp(&state->value.debian_evr, &sys->value.debian_evr, operation);
+	case OVAL_DATATYPE_VERSION:
+		return oval_version_cmp(&state->value.version, &sys->value.version, operation);
+	case OVAL_DATATYPE_IPV4ADDR:
+		return oval_ipaddr_parsed_cmp(AF_INET, &state->value.ipaddr, &sys->value.ipaddr, operation);
+	case OVAL_DATATYPE_IPV6ADDR:
+		return oval_ipaddr_parsed_cmp(AF_INET6, &state->value.ipaddr, &sys->value.ipaddr, operation);
+	default:
+		return oval_str_cmp_str((char *) state->text, state->datatype, sys->text, operation);
+	}
+}
+
+oval_result_t oval_cmp_datum_cmp_str(struct oval_cmp_datum *state, const char *sys_data, oval_operation_t operation)
+{
+	struct oval_cmp_datum sys;
+	oval_result_t result;
+
+	oval_cmp_datum_init(&sys, sys_data, state->datatype);
+	result = oval_cmp_datum_cmp(state, &sys, operation);
+	oval_cmp_datum_clear(&sys);
+	return result;
+}
@@ -120,10 +120,25 @@ static int istrcmp(const char *st1, const char *st2)
 	return oscap_strcasecmp(st1, st2);
 }
 
-static oval_result_t strregcomp(const char *pattern, const char *test_str)
+oval_result_t oval_string_cmp_regex(oscap_pcre_t *re, const char *pattern, const char *syschar)
 {
 	int ret;
-	oval_result_t result = OVAL_RESULT_ERROR;
+
+	syschar = syschar ? syschar : "";
+	ret = oscap_pcre_exec(re, syschar, strlen(syschar), 0, 0, NULL, 0);
+	if (ret > OSCAP_PCRE_ERR_NOMATCH ) {
+		return OVAL_RESULT_TRUE;
+	} else if (ret == OSCAP_PCRE_ERR_NOMATCH) {
+		return OVAL_RESULT_FALSE;
+	}
+	dE("Unable to match regex pattern '%s' on string '%s', "
+			"oscap_pcre_exec() returned error: %d.\n", pattern, syschar, ret);
+	return OVAL_RESULT_ERROR;
+}
+
+static oval_result_t strregcomp(const char *pattern, const char *test_str)
+{
+	oval_result_t result;
 	oscap_pcre_t *re;
 	char *err;
 	int errofs;
@@ -136,16 +151,7 @@ static oval_result_t strregcomp(const char *pattern, const char *test_str)
 		return OVAL_RESULT_ERROR;
 	}
 
-	ret = oscap_pcre_exec(re, test_str, strlen(test_str), 0, 0, NULL, 0);
-	if (ret > OSCAP_PCRE_ERR_NOMATCH ) {
-		result = OVAL_RESULT_TRUE;
-	} else if (ret == OSCAP_PCRE_ERR_NOMATCH) {
-		result = OVAL_RESULT_FALSE;
-	} else {
-		dE("Unable to match regex pattern '%s' on string '%s', "
-				"oscap_pcre_exec() returned error: %d.\n", pattern, test_str, ret);
-		result = OVAL_RESULT_ERROR;
-	}
+	result = oval_string_cmp_regex(re, pattern, test_str);
 
 	oscap_pcre_free(re);
 	return result;
@@ -24,6 +24,7 @@
 #define OSCAP_OVAL_CMP_BASIC_IMPL_H_
 
 #include "../common/util.h"
+#include "../common/oscap_pcre.h"
 #include "oval_definitions.h"
 #include "oval_types.h"
 
@@ -36,6 +37,12 @@ oval_result_t oval_float_cmp(const double state_val, const double sys_val, oval_
 
 oval_result_t oval_string_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
+/**
+ * Match the data collected from the system against a compiled pattern.
+ * @param pattern the source of the pattern, for the messages
+ */
+oval_result_t oval_string_cmp_regex(oscap_pcre_t *re, const char *pattern, const char *syschar);
+
 oval_result_t oval_binary_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
 
@@ -44,29 +44,236 @@
 #include <rpm/rpmlib.h>
 #endif
 #else
-#ifdef OS_WINDOWS
-#include <malloc.h>
-#elif !defined(OS_FREEBSD)
-#include <alloca.h>
-#endif
-static int rpmvercmp(const char *a, const char *b);
 static int risdigit(int c) {
 	// locale independent
 	return (c >= '0' && c <= '9');
 }
 #endif
 
-static inline int rpmevrcmp(const char *a, const char *b);
 static int compare_values(const char *str1, const char *str2);
 static void parseEVR(char *evr, const char **ep, const char **vp, const char **rp);
 
-oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
+static void evr_split(struct oval_evr *evr, const char *str)
 {
-	if (state == NULL || sys == NULL) {
-		return OVAL_RESULT_ERROR;
+	evr->buffer = oscap_strdup(str);
+	evr->epoch = evr->version = evr->release = NULL;
+	evr->allocated = NULL;
+	parseEVR(evr->buffer, &evr->epoch, &evr->version, &evr->release);
+}
+
+#ifndef HAVE_RPMVERCMP
+/*
+ * The EVR parts are compared segment by segment like rpmvercmp() from
+ * http://rpm.org/api/4.4.2.2/rpmvercmp_8c-source.html compares them. The
+ * parsed EVR strings keep their segments, so that they are found only once.
+ */
+
+/*
+ * Find the next alphabetic or numeric segment of a part of an EVR string.
+ * Returns false at the end of the part, trailing is set when separators
+ * follow the last segment.
+ */
+static bool evr_segment_next(const char **str, struct oval_evr_segment *segment, bool *trailing)
+{
+	const char *s = *str;
+	const char *start;
+
+	while (*s && !isalnum(*s))
+		s++;
+	if (!*s) {
+		*trailing = (s != *str);
+		*str = s;
+		return false;
+	}
+
+	start = s;
+	segment->numeric = isdigit(*s);
+	if (segment->numeric) {
+		while (*s && isdigit(*s))
+			s++;
+	} else {
+		while (*s && isalpha(*s))
+			s++;
+	}
+	segment->text = start;
+	segment->length = s - start;
+	/* throw away any leading zeros - it's a number, right? */
+	while (segment->numeric && segment->length > 0 && *segment->text == '0') {
+		segment->text++;
+		segment->length--;
+	}
+	*str = s;
+	return true;
+}
+
+/* compare alpha and numeric segments of two versions */
+/* return 1: a is newer than b */
+/*        0: a and b are the same version */
+/*       -1: b is newer than a */
+static int evr_segment_cmp(const struct oval_evr_segment *one, const struct oval_evr_segment *two)
+{
+	int rc;
+
+	/* a character which is alphanumeric but neither a letter nor
+	 * a digit in the current locale */
+	if (!one->numeric && one->length == 0)
+		return -1;	/* arbitrary */
+
+	/* numeric segments are always newer than alpha segments */
+	if (one->numeric != two->numeric || (!two->numeric && two->length == 0))
+		return (one->numeric ? 1 : -1);
+
+	/* whichever number has more digits wins */
+	if (one->numeric && one->length != two->length)
+		return (one->length > two->length ? 1 : -1);
+
+	rc = memcmp(one->text, two->text, one->length < two->length ? one->length : two->length);
+	if (rc)
+		return (rc < 0 ? -1 : 1);
+	if (one->length != two->length)
+		return (one->length > two->length ? 1 : -1);
+	return 0;
+}
+
+/*
+ * All the segments compared identically, whichever version still has
+ * characters left over wins, unless both have only separators left.
+ */
+static int evr_rest_cmp(bool more_a, bool trailing_a, bool more_b, bool trailing_b)
+{
+	bool rest_a = more_a || trailing_a;
+	bool rest_b = more_b || trailing_b;
+
+	if (rest_a && rest_b)
+		return more_a - more_b;
+	return rest_a - rest_b;
+}
+
+static int evr_text_cmp(const char *a, const char *b)
+{
+	struct oval_evr_segment one, two;
+	bool more_a, more_b;
+	bool trailing_a = false, trailing_b = false;
+	int rc;
+
+	/* easy comparison to see if versions are identical */
+	if (!strcmp(a, b))
+		return 0;
+
+	for (;;) {
+		more_a = evr_segment_next(&a, &one, &trailing_a);
+		more_b = evr_segment_next(&b, &two, &trailing_b);
+		if (!more_a || !more_b)
+			break;
+		rc = evr_segment_cmp(&one, &two);
+		if (rc)
+			return rc;
+	}
+	return evr_rest_cmp(more_a, trailing_a, more_b, trailing_b);
+}
+
+/*
+ * Split a part of an EVR string to its segments, they are only counted
+ * when the array is NULL.
+ */
+static size_t evr_part_split(struct oval_evr_part *part, const char *text, struct oval_evr_segment *segments)
+{
+	struct oval_evr_segment segment;
+	const char *s = text;
+	size_t count = 0;
+
+	part->text = text;
+	part->segments = segments;
+	part->trailing = false;
+	while (text != NULL && evr_segment_next(&s, &segment, &part->trailing)) {
+		if (segments != NULL)
+			segments[count] = segment;
+		count++;
+		/* the segment which isn't alphabetic nor numeric ends the comparison */
+		if (!segment.numeric && segment.length == 0)
+			break;
+	}
+	part->count = count;
+	return count;
+}
+
+static int evr_part_cmp(const struct oval_evr_part *a, const struct oval_evr_part *b)
+{
+	size_t i;
+	int rc;
+
+	if (a->text == NULL || b->text == NULL)
+		return compare_values(a->text, b->text);
+
+	for (i = 0; i < a->count && i < b->count; i++) {
+		rc = evr_segment_cmp(&a->segments[i], &b->segments[i]);
+		if (rc)
+			return rc;
 	}
-	int result = rpmevrcmp(sys, state);
+	return evr_rest_cmp(i < a->count, a->trailing, i < b->count, b->trailing);
+}
+#endif
+
+void oval_evr_parse(struct oval_evr *evr, const char *str)
+{
+	evr_split(evr, str);
+#ifndef HAVE_RPMVERCMP
+	const char *texts[3] = { evr->epoch, evr->version, evr->release };
+	struct oval_evr_segment *segments;
+	size_t count = 0;
+
+	for (int i = 0; i < 3; i++)
+		count += evr_part_split(&evr->parts[i], texts[i], NULL);
+	segments = evr->allocated = (count > 0) ? malloc(count * sizeof(*segments)) : NULL;
+	for (int i = 0; i < 3; i++)
+		segments += evr_part_split(&evr->parts[i], texts[i], segments);
+#endif
+}
+
+void oval_evr_clear(struct oval_evr *evr)
+{
+	free(evr->buffer);
+	evr->buffer = NULL;
+	free(evr->allocated);
+	evr->allocated = NULL;
+}
+
+static int evrcmp(const struct oval_evr *a, const struct oval_evr *b)
+{
+	/* This mimics rpmevrcmp which is not exported by rpmlib version 4.
+	 * Code inspired by rpm.labelCompare() from rpm4/python/header-py.c
+	 */
+	int result;
+
+	result = compare_values(a->epoch, b->epoch);
+	if (!result) {
+		result = compare_values(a->version, b->version);
+		if (!result)
+			result = compare_values(a->release, b->release);
+	}
+	return result;
+}
 
+/* compare the EVR strings by their segments found by oval_evr_parse() */
+static int evr_parsed_cmp(const struct oval_evr *a, const struct oval_evr *b)
+{
+#ifdef HAVE_RPMVERCMP
+	return evrcmp(a, b);
+#else
+	int result;
+
+	result = evr_part_cmp(&a->parts[0], &b->parts[0]);
+	if (!result) {
+		result = evr_part_cmp(&a->parts[1], &b->parts[1]);
+		if (!result)
+			result = evr_part_cmp(&a->parts[2], &b->parts[2]);
+	}
+	return result;
+#endif
+}
+
+static oval_result_t evr_result(int result, oval_operation_t operation)
+{
 	if (operation == OVAL_OPERATION_EQUALS) {
 		return ((result == 0) ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE);
 	} else if (operation == OVAL_OPERATION_NOT_EQUAL) {
@@ -85,30 +292,24 @@ oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_opera
 	return OVAL_RESULT_ERROR;
 }
 
-static inline int rpmevrcmp(const char *a, const char *b)
+oval_result_t oval_evr_cmp(const struct oval_evr *state, const struct oval_evr *sys, oval_operation_t operation)
 {
-	/* This mimics rpmevrcmp which is not exported by rpmlib version 4.
-	 * Code inspired by rpm.labelCompare() from rpm4/python/header-py.c
-	 */
-	const char *a_epoch, *a_version, *a_release;
-	const char *b_epoch, *b_version, *b_release;
-	char *a_copy, *b_copy;
-	int result;
+	return evr_result(evr_parsed_cmp(sys, state), operation);
+}
 
-	a_copy = oscap_strdup(a);
-	b_copy = oscap_strdup(b);
-	parseEVR(a_copy, &a_epoch, &a_version, &a_release);
-	parseEVR(b_copy, &b_epoch, &b_version, &b_release);
+oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
+{
+	struct oval_evr state_evr, sys_evr;
+	oval_result_t result;
 
-	result = compare_values(a_epoch, b_epoch);
-	if (!result) {
-		result = compare_values(a_version, b_version);
-		if (!result)
-			result = compare_values(a_release, b_release);
+	if (state == NULL || sys == NULL) {
+		return OVAL_RESULT_ERROR;
 	}
-
-	free(a_copy);
-	free(b_copy);
+	evr_split(&state_evr, state);
+	evr_split(&sys_evr, sys);
+	result = evr_result(evrcmp(&sys_evr, &state_evr), operation);
+	oval_evr_clear(&state_evr);
+	oval_evr_clear(&sys_evr);
 	return result;
 }
 
@@ -123,7 +324,11 @@ static int compare_values(const char *str1, const char *str2)
 		return 1;
 	else if (!str1 && str2)
 		return -1;
+#ifdef HAVE_RPMVERCMP
 	return rpmvercmp(str1, str2);
+#else
+	return evr_text_cmp(str1, str2);
+#endif
 }
 
 static void parseEVR(char *evr, const char **ep, const char **vp, const char **rp)
@@ -165,133 +370,6 @@ static void parseEVR(char *evr, const char **ep, const char **vp, const char **r
 	if (rp) *rp = release;
 }
 
-#ifndef HAVE_RPMVERCMP
-/*
- * code from http://rpm.org/api/4.4.2.2/rpmvercmp_8c-source.html
- */
-
-/* compare alpha and numeric segments of two versions */
-/* return 1: a is newer than b */
-/*        0: a and b are the same version */
-/*       -1: b is newer than a */
-static int rpmvercmp(const char *a, const char *b)
-{
-	char oldch1, oldch2;
-	char *str1, *str2;
-	char *one, *two;
-	int rc;
-	int isnum;
-
-	/* easy comparison to see if versions are identical */
-	if (!strcmp(a, b))
-		return 0;
-
-	/* TODO: make new malloca */
-	str1 = alloca(strlen(a) + 1);
-	str2 = alloca(strlen(b) + 1);
-
-	strcpy(str1, a);
-	strcpy(str2, b);
-
-	one = str1;
-	two = str2;
-
-	/* loop through each version segment of str1 and str2 and compare them */
-	while (*one && *two) {
-		while (*one && !isalnum(*one))
-			one++;
-		while (*two && !isalnum(*two))
-			two++;
-
-		/* If we ran to the end of either, we are finished with the loop */
-		if (!(*one && *two))
-			break;
-
-		str1 = one;
-		str2 = two;
-
-		/* grab first completely alpha or completely numeric segment */
-		/* leave one and two pointing to the start of the alpha or numeric */
-		/* segment and walk str1 and str2 to end of segment */
-		if (isdigit(*str1)) {
-			while (*str1 && isdigit(*str1))
-				str1++;
-			while (*str2 && isdigit(*str2))
-				str2++;
-			isnum = 1;
-		} else {
-			while (*str1 && isalpha(*str1))
-				str1++;
-			while (*str2 && isalpha(*str2))
-				str2++;
-			isnum = 0;
-		}
-
-		/* save character at the end of the alpha or numeric segment */
-		/* so that they can be restored after the comparison */
-		oldch1 = *str1;
-		*str1 = '\0';
-		oldch2 = *str2;
-		*str2 = '\0';
-
-		/* this cannot happen, as we previously tested to make sure that */
-		/* the first string has a non-null segment */
-		if (one == str1)
-			return -1;	/* arbitrary */
-
-		/* take care of the case where the two version segments are */
-		/* different types: one numeric, the other alpha (i.e. empty) */
-		/* numeric segments are always newer than alpha segments */
-		/* result_test See patch #60884 (and details) from bugzilla #50977. */
-		if (two == str2)
-			return (isnum ? 1 : -1);
-
-		if (isnum) {
-			/* this used to be done by converting the digit segments */
-			/* to ints using atoi() - it's changed because long  */
-			/* digit segments can overflow an int - this should fix that. */
-
-			/* throw away any leading zeros - it's a number, right? */
-			while (*one == '0')
-				one++;
-			while (*two == '0')
-				two++;
-
-			/* whichever number has more digits wins */
-			if (strlen(one) > strlen(two))
-				return 1;
-			if (strlen(two) > strlen(one))
-				return -1;
-		}
-
-		/* strcmp will return which one is greater - even if the two */
-		/* segments are alpha or if they are numeric.  don't return  */
-		/* if they are equal because there might be more segments to */
-		/* compare */
-		rc = strcmp(one, two);
-		if (rc)
-			return (rc < 1 ? -1 : 1);
-
-		/* restore character that was replaced by null above */
-		*str1 = oldch1;
-		one = str1;
-		*str2 = oldch2;
-		two = str2;
-	}
-	/* this catches the case where all numeric and alpha segments have */
-	/* compared identically but the segment sepparating characters were */
-	/* different */
-	if ((!*one) && (!*two))
-		return 0;
-
-	/* whichever version still has characters left over wins */
-	if (!*one)
-		return -1;
-	else
-		return 1;
-}
-#endif
-
 /*
  * based on code from dpkg: lib/dpkg/version.c
  * Mino changes to use isdigit() and isalpha()
@@ -315,49 +393,113 @@ static int order(int c)
 		return 0;
 }
 
+/*
+ * Find the next segment of a Debian version or revision, the non-digit
+ * characters and the digits following them. Returns false at the end.
+ */
+static bool debian_segment_next(const char **str, struct oval_debian_segment *segment)
+{
+	const char *s = *str;
+
+	if (!*s)
+		return false;
+	segment->text = s;
+	while (*s && !isdigit(*s))
+		s++;
+	segment->length = s - segment->text;
+	while (*s == '0')
+		s++;
+	segment->digits = s;
+	while (isdigit(*s))
+		s++;
+	segment->digits_length = s - segment->digits;
+	*str = s;
+	return true;
+}
+
+/*
+ * based on code from dpkg: lib/dpkg/version.c
+ * Compares one iteration of verrevcmp(), the missing segments are empty.
+ */
+static int debian_segment_cmp(const struct oval_debian_segment *a, const struct oval_debian_segment *b)
+{
+	for (size_t i = 0; i < a->length || i < b->length; i++) {
+		int ac = order((i < a->length) ? a->text[i] : 0);
+		int bc = order((i < b->length) ? b->text[i] : 0);
+
+		if (ac != bc)
+			return ac - bc;
+	}
+	if (a->digits_length > b->digits_length)
+		return 1;
+	if (a->digits_length < b->digits_length)
+		return -1;
+	for (size_t i = 0; i < a->digits_length; i++) {
+		if (a->digits[i] != b->digits[i])
+			return a->digits[i] - b->digits[i];
+	}
+	return 0;
+}
+
+static const struct oval_debian_segment debian_empty_segment = { "", 0, "", 0 };
+
 /*
  * based on code from dpkg: lib/dpkg/version.c
  * Minor changes to use isdigit()
  */
 static int verrevcmp(const char *a, const char *b)
 {
+	struct oval_debian_segment one, two;
+
 	if (a == NULL)
 		a = "";
 	if (b == NULL)
 		b = "";
 
-	while (*a || *b) {
-		int first_diff = 0;
+	for (;;) {
+		bool more_a = debian_segment_next(&a, &one);
+		bool more_b = debian_segment_next(&b, &two);
+		int rc;
 
-		while ((*a && !isdigit(*a)) || (*b && !isdigit(*b))) {
-			int ac = order(*a);
-			int bc = order(*b);
+		if (!more_a && !more_b)
+			return 0;
+		rc = debian_segment_cmp(more_a ? &one : &debian_empty_segment,
+					more_b ? &two : &debian_empty_segment);
+		if (rc)
+			return rc;
+	}
+}
 
-			if (ac != bc)
-				return ac - bc;
+/*
+ * Split a Debian version or revision to its segments, they are only
+ * counted when the array is NULL.
+ */
+static size_t debian_part_split(struct oval_debian_part *part, const char *text, struct oval_debian_segment *segments)
+{
+	struct oval_debian_segment segment;
+	const char *s = (text != NULL) ? text : "";
+	size_t count = 0;
+
+	part->segments = segments;
+	while (debian_segment_next(&s, &segment)) {
+		if (segments != NULL)
+			segments[count] = segment;
+		count++;
+	}
+	part->count = count;
+	return count;
+}
 
-			a++;
-			b++;
-		}
-		while (*a == '0')
-			a++;
-		while (*b == '0')
-			b++;
-		while (isdigit(*a) && isdigit(*b)) {
-			if (!first_diff)
-				first_diff = *a - *b;
-			a++;
-			b++;
-		}
+/* verrevcmp() of the segments found by debian_part_split() */
+static int debian_part_cmp(const struct oval_debian_part *a, const struct oval_debian_part *b)
+{
+	for (size_t i = 0; i < a->count || i < b->count; i++) {
+		int rc = debian_segment_cmp((i < a->count) ? &a->segments[i] : &debian_empty_segment,
+					    (i < b->count) ? &b->segments[i] : &debian_empty_segment);
 
-		if (isdigit(*a))
-			return 1;
-		if (isdigit(*b))
-			return -1;
-		if (first_diff)
-			return first_diff;
+		if (rc)
+			return rc;
 	}
-
 	return 0;
 }
 
@@ -379,7 +521,7 @@ static int verrevcmp(const char *a, const char *b)
  * @retval <0 If a is smaller than b.
  * @retval >0 If a is greater than b.
  */
-static int dpkg_version_compare(struct dpkg_version *a, struct dpkg_version *b)
+static int dpkg_version_compare(const struct dpkg_version *a, const struct dpkg_version *b)
 {
 	int rc;
 
@@ -395,48 +537,63 @@ static int dpkg_version_compare(struct dpkg_version *a, struct dpkg_version *b)
 	return verrevcmp(a->revision, b->revision);
 }
 
-oval_result_t oval_debian_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
+/* dpkg_version_compare() of the segments found by oval_debian_evr_parse() */
+static int debian_evr_parsed_cmp(const struct oval_debian_evr *a, const struct oval_debian_evr *b)
+{
+	int rc;
+
+	if (a->version.epoch > b->version.epoch)
+		return 1;
+	if (a->version.epoch < b->version.epoch)
+		return -1;
+
+	rc = debian_part_cmp(&a->upstream, &b->upstream);
+	if (rc)
+		return rc;
+
+	return debian_part_cmp(&a->revision, &b->revision);
+}
+
+static bool debian_evr_split(struct oval_debian_evr *evr, const char *str)
 {
-	struct dpkg_version a, b;
-	const char *a_epoch, *a_version, *a_release;
-	const char *b_epoch, *b_version, *b_release;
-	char *a_copy, *b_copy;
 	long aux;
 
-	a_copy = oscap_strdup(sys);
-	b_copy = oscap_strdup(state);
-	parseEVR(a_copy, &a_epoch, &a_version, &a_release);
-	parseEVR(b_copy, &b_epoch, &b_version, &b_release);
-
-	if (!a_epoch)
-		a_epoch = "0";
-	if (!b_epoch)
-		b_epoch = "0";
-
-	aux = strtol(a_epoch, NULL, 10);
-	if (aux < INT_MIN || aux > INT_MAX) {
-		free(a_copy);
-		free(b_copy);
-		return OVAL_RESULT_ERROR; // Outside int range
-	}
-	a.epoch = (int) aux;
+	evr_split(&evr->parts, str);
+	evr->allocated = NULL;
+	evr->upstream.count = evr->revision.count = 0;
+	aux = strtol(evr->parts.epoch ? evr->parts.epoch : "0", NULL, 10);
+	if (aux < INT_MIN || aux > INT_MAX)
+		return false; // Outside int range
+	evr->version.epoch = (int) aux;
+	evr->version.version = evr->parts.version;
+	evr->version.revision = evr->parts.release;
+	return true;
+}
 
-	aux = strtol(b_epoch, NULL, 10);
-	if (aux < INT_MIN || aux > INT_MAX) {
-		free(a_copy);
-		free(b_copy);
-		return OVAL_RESULT_ERROR; // Outside int range
-	}
-	b.epoch = (int) aux;
+bool oval_debian_evr_parse(struct oval_debian_evr *evr, const char *str)
+{
+	struct oval_debian_segment *segments;
+	size_t count;
+
+	if (!debian_evr_split(evr, str))
+		return false;
+	count = debian_part_split(&evr->upstream, evr->parts.version, NULL) +
+		debian_part_split(&evr->revision, evr->parts.release, NULL);
+	segments = evr->allocated = (count > 0) ? malloc(count * sizeof(*segments)) : NULL;
+	segments += debian_part_split(&evr->upstream, evr->parts.version, segments);
+	debian_part_split(&evr->revision, evr->parts.release, segments);
+	return true;
+}
 
-	a.version = a_version;
-	a.revision = a_release;
-	b.version = b_version;
-	b.revision = b_release;
-	int result = dpkg_version_compare(&a, &b);
+void oval_debian_evr_clear(struct oval_debian_evr *evr)
+{
+	oval_evr_clear(&evr->parts);
+	free(evr->allocated);
+	evr->allocated = NULL;
+}
 
-	free(a_copy);
-	free(b_copy);
+static oval_result_t debian_evr_result(int result, oval_operation_t operation)
+{
 	switch (operation) {
 	case OVAL_OPERATION_EQUALS:
 		return ((result == 0) ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE);
@@ -457,20 +614,65 @@ oval_result_t oval_debian_evr_string_cmp(const char *state, const char *sys, ova
 	return OVAL_RESULT_ERROR;
 }
 
-oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_operation_t operation)
+oval_result_t oval_debian_evr_cmp(const struct oval_debian_evr *state, const struct oval_debian_evr *sys, oval_operation_t operation)
+{
+	return debian_evr_result(debian_evr_parsed_cmp(sys, state), operation);
+}
+
+oval_result_t oval_debian_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
+{
+	struct oval_debian_evr a, b;
+	oval_result_t result = OVAL_RESULT_ERROR;
+	bool a_valid = debian_evr_split(&a, sys);
+	bool b_valid = debian_evr_split(&b, state);
+
+	if (a_valid && b_valid)
+		result = debian_evr_result(dpkg_version_compare(&a.version, &b.version), operation);
+	oval_debian_evr_clear(&a);
+	oval_debian_evr_clear(&b);
+	return result;
+}
+
+/* move to the next field within the version string (if there is one) */
+static size_t version_next_field(const char *str, size_t idx)
+{
+	if (str[idx])
+		++idx;
+	while ((str[idx]) && (isdigit(str[idx])))
+		++idx;
+	if ((str[idx]) && (!isdigit(str[idx])))
+		++idx;
+	return idx;
+}
+
+void oval_version_parse(struct oval_version *version, const char *str)
+{
+	size_t idx;
+
+	version->count = 0;
+	for (idx = 0; str[idx]; idx = version_next_field(str, idx))
+		version->count++;
+	version->fields = malloc((version->count ? version->count : 1) * sizeof(int));
+	version->count = 0;
+	for (idx = 0; str[idx]; idx = version_next_field(str, idx))
+		version->fields[version->count++] = atoi(&str[idx]);
+}
+
+void oval_version_clear(struct oval_version *version)
+{
+	free(version->fields);
+	version->fields = NULL;
+	version->count = 0;
+}
+
+oval_result_t oval_version_cmp(const struct oval_version *state, const struct oval_version *syschar, oval_operation_t operation)
 {
-	int state_idx = 0;
-	int sys_idx = 0;
-	int result = -1;
-	/* int is_equal = 1; */
-	for (state_idx = 0, sys_idx = 0; (((state[state_idx]) || (syschar[sys_idx])) && (result == -1));) {	// keep going as long as there is data in either the state or sysitem
-		int tmp_state_int, tmp_sys_int;
-		tmp_state_int = atoi(&state[state_idx]);	// look at the current data field (if we're at the end, atoi should return 0)
-		tmp_sys_int = atoi(&syschar[sys_idx]);
-                /* o rly?
-		if (tmp_state_int != tmp_sys_int)
-			is_equal = 0;	// we might need this later (if we don't terminate early)
-                */
+	/* keep going as long as there is data in either the state or sysitem,
+	 * the missing fields are zeros */
+	for (size_t i = 0; i < state->count || i < syschar->count; i++) {
+		int tmp_state_int = i < state->count ? state->fields[i] : 0;
+		int tmp_sys_int = i < syschar->count ? syschar->fields[i] : 0;
+
 		if (operation == OVAL_OPERATION_EQUALS) {
 			if (tmp_state_int != tmp_sys_int)
 				return (OVAL_RESULT_FALSE);
@@ -493,22 +695,6 @@ oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_
 			oscap_seterr(OSCAP_EFAMILY_OVAL, "Invalid type of operation in version comparison: %d.", operation);
 			return OVAL_RESULT_ERROR;
 		}
-
-		if (state[state_idx])
-			++state_idx;
-		/* move to the next field within the version string (if there is one) */
-		while ((state[state_idx]) && (isdigit(state[state_idx])))
-			++state_idx;
-		if ((state[state_idx]) && (!isdigit(state[state_idx])))
-			++state_idx;
-
-		if (syschar[sys_idx])
-			++sys_idx;
-		/* move to the next field within the version string (if there is one) */
-		while ((syschar[sys_idx]) && (isdigit(syschar[sys_idx])))
-			++sys_idx;
-		if ((syschar[sys_idx]) && (!isdigit(syschar[sys_idx])))
-			++sys_idx;
 	}
 
 	// OK, we did not terminate early, and we're out of data, so we now know what to return
@@ -527,5 +713,17 @@ oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_
 	}		// we have already filtered out the invalid ones
 	assert(0);
 	return OVAL_RESULT_ERROR;
+}
 
+oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_operation_t operation)
+{
+	struct oval_version state_version, sys_version;
+	oval_result_t result;
+
+	oval_version_parse(&state_version, state);
+	oval_version_parse(&sys_version, syschar);
+	result = oval_version_cmp(&state_version, &sys_version, operation);
+	oval_version_clear(&state_version);
+	oval_version_clear(&sys_version);
+	return result;
 }
@@ -36,6 +36,89 @@
 #include "oval_types.h"
 
 
+/*
+ * Code copied from lib/dpkg/version.h
+ */
+struct dpkg_version {
+	/** The epoch. It will be zero if no epoch is present. */
+	unsigned int epoch;
+	/** The upstream part of the version. */
+	const char *version;
+	/** The Debian revision part of the version. */
+	const char *revision;
+};
+
+/**
+ * Alphabetic or numeric segment of an EVR string part, as compared by
+ * rpmvercmp(). Numeric segments are kept without their leading zeros.
+ */
+struct oval_evr_segment {
+	const char *text;
+	size_t length;
+	bool numeric;
+};
+
+/**
+ * Epoch, version or release of an EVR string split to its segments.
+ */
+struct oval_evr_part {
+	const char *text;               ///< NULL when the part is missing
+	const struct oval_evr_segment *segments;
+	size_t count;
+	bool trailing;                  ///< separators follow the last segment
+};
+
+/**
+ * EVR string split to the epoch, version and release, to be compared
+ * many times without parsing it again.
+ */
+struct oval_evr {
+	char *buffer;           ///< copy of the string holding the parts
+	const char *epoch;      ///< NULL when the string has no epoch
+	const char *version;
+	const char *release;    ///< NULL when the string has no release
+	struct oval_evr_part parts[3];  ///< segments of the epoch, version and release
+	struct oval_evr_segment *allocated;
+};
+
+/**
+ * Non-digit characters followed by digits in a Debian version or revision,
+ * as compared by verrevcmp(). The digits are kept without leading zeros.
+ */
+struct oval_debian_segment {
+	const char *text;
+	size_t length;
+	const char *digits;
+	size_t digits_length;
+};
+
+/**
+ * Debian version or revision split to its segments.
+ */
+struct oval_debian_part {
+	const struct oval_debian_segment *segments;
+	size_t count;
+};
+
+/**
+ * Debian EVR string with the epoch converted to a number.
+ */
+struct oval_debian_evr {
+	struct oval_evr parts;
+	struct dpkg_version version;
+	struct oval_debian_part upstream;
+	struct oval_debian_part revision;
+	struct oval_debian_segment *allocated;
+};
+
+/**
+ * Version string split to the numeric fields.
+ */
+struct oval_version {
+	int *fields;
+	size_t count;
+};
+
 /**
  * Compare two EVR (Epoch:Version-Release) strings. The format of input types shall
  * conform to EntityStateEVRStringType. Comparisons involving this datatype follow
@@ -47,20 +130,46 @@
  */
 oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation);
 
+/**
+ * Split the EVR string, the result is released by oval_evr_clear().
+ */
+void oval_evr_parse(struct oval_evr *evr, const char *str);
+
+void oval_evr_clear(struct oval_evr *evr);
+
+/**
+ * Compare two parsed EVR strings, see oval_evr_string_cmp().
+ */
+oval_result_t oval_evr_cmp(const struct oval_evr *state, const struct oval_evr *sys, oval_operation_t operation);
+
 oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
+/**
+ * Split the version string, the result is released by oval_version_clear().
+ */
+void oval_version_parse(struct oval_version *version, const char *str);
+
+void oval_version_clear(struct oval_version *version);
+
+/**
+ * Compare two parsed version strings, see oval_versiontype_cmp().
+ */
+oval_result_t oval_version_cmp(const struct oval_version *state, const struct oval_version *syschar, oval_operation_t operation);
+
 oval_result_t oval_debian_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation);
 
-/*
- * Code copied from lib/dpkg/version.h
+/**
+ * Split the Debian EVR string, the result is released by
+ * oval_debian_evr_clear() even when the parsing fails.
+ * @returns false if the epoch is out of range
  */
-struct dpkg_version {
-	/** The epoch. It will be zero if no epoch is present. */
-	unsigned int epoch;
-	/** The upstream part of the version. */
-	const char *version;
-	/** The Debian revision part of the version. */
-	const char *revision;
-};
+bool oval_debian_evr_parse(struct oval_debian_evr *evr, const char *str);
+
+void oval_debian_evr_clear(struct oval_debian_evr *evr);
+
+/**
+ * Compare two parsed Debian EVR strings, see oval_debian_evr_string_cmp().
+ */
+oval_result_t oval_debian_evr_cmp(const struct oval_debian_evr *state, const struct oval_debian_evr *sys, oval_operation_t operation);
 
 #endif
@@ -23,10 +23,14 @@
 #ifndef OSCAP_OVAL_CMP_IMPL_H_
 #define OSCAP_OVAL_CMP_IMPL_H_
 
+#include <stdint.h>
 #include "../common/util.h"
+#include "../common/oscap_pcre.h"
 #include "oval_definitions.h"
 #include "oval_types.h"
 #include "oval_system_characteristics.h"
+#include "oval_cmp_evr_string_impl.h"
+#include "oval_cmp_ip_address_impl.h"
 
 
 /**
@@ -40,5 +44,58 @@
  */
 oval_result_t oval_str_cmp_str(char *state_data, oval_datatype_t state_data_type, const char *sys_data, oval_operation_t operation);
 
+/**
+ * Value parsed according to its data type to be compared many times, eg.
+ * a state entity value, a variable value or an entity of a collected item.
+ * The values which can't be parsed are compared by oval_str_cmp_str() to
+ * report the same errors.
+ */
+struct oval_cmp_datum {
+	const char *text;               ///< the parsed value, not owned
+	oval_datatype_t datatype;
+	bool parsed;                    ///< the typed value below is valid
+	bool regex_compiled;            ///< compilation of the pattern was attempted
+	oscap_pcre_t *regex;            ///< compiled pattern of a pattern match
+	union {
+		intmax_t integer;
+		double number;
+		int boolean;
+		struct oval_evr evr;
+		struct oval_debian_evr debian_evr;
+		struct oval_version version;
+		struct oval_ipaddr ipaddr;
+	} value;
+};
+
+/**
+ * Parse the value for the comparisons.
+ * @param datum the value to initialize, released by oval_cmp_datum_clear()
+ */
+void oval_cmp_datum_init(struct oval_cmp_datum *datum, const char *text, oval_datatype_t datatype);
+
+void oval_cmp_datum_clear(struct oval_cmp_datum *datum);
+
+struct oval_cmp_datum *oval_cmp_datum_new(const char *text, oval_datatype_t datatype);
+
+void oval_cmp_datum_free(struct oval_cmp_datum *datum);
+
+/**
+ * Tell whether a value of the data type is parsed before the comparison,
+ * the values of the other types are compared as they are.
+ */
+bool oval_cmp_datatype_is_parsed(oval_datatype_t datatype);
+
+/**
+ * Compare a parsed state value to a parsed value collected from system,
+ * with the same results as oval_str_cmp_str(). The pattern of a pattern
+ * match is compiled by the first comparison and kept in the state value.
+ */
+oval_result_t oval_cmp_datum_cmp(struct oval_cmp_datum *state, const struct oval_cmp_datum *sys, oval_operation_t operation);
+
+/**
+ * Compare a parsed state value to data collected from system.
+ */
+oval_result_t oval_cmp_datum_cmp_str(struct oval_cmp_datum *state, const char *sys_data, oval_operation_t operation);
+
 
 #endif
@@ -90,16 +90,43 @@ static inline int ipaddr_parse(int af, const char *oval_ip_string, uint32_t *mas
 	return ipv6addr_parse(oval_ip_string, mask_out, ip_out);
 }
 
+int oval_ipaddr_parse(int af, const char *str, struct oval_ipaddr *ip)
+{
+	union {
+		struct in_addr v4;
+		struct in6_addr v6;
+	} addr;
+
+	memset(&addr, 0, sizeof(addr));
+	ip->mask = 0;
+	if (ipaddr_parse(af, str, &ip->mask, &addr))
+		return -1;
+	memcpy(ip->addr, &addr, sizeof(ip->addr));
+	return 0;
+}
+
 oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_operation_t op)
 {
-	oval_result_t result = OVAL_RESULT_ERROR;
-	uint32_t mask1 = 0, mask2 = 0;
-	char addr1[INET6_ADDRSTRLEN];
-	char addr2[INET6_ADDRSTRLEN];
+	struct oval_ipaddr ip1, ip2;
 
-	if (ipaddr_parse(af, s1, &mask1, &addr1) || ipaddr_parse(af, s2, &mask2, &addr2)) {
-		return result;
+	if (oval_ipaddr_parse(af, s1, &ip1) || oval_ipaddr_parse(af, s2, &ip2)) {
+		return OVAL_RESULT_ERROR;
 	}
+	return oval_ipaddr_parsed_cmp(af, &ip1, &ip2, op);
+}
+
+oval_result_t oval_ipaddr_parsed_cmp(int af, const struct oval_ipaddr *ip1, const struct oval_ipaddr *ip2, oval_operation_t op)
+{
+	oval_result_t result = OVAL_RESULT_ERROR;
+	uint32_t mask1 = ip1->mask, mask2 = ip2->mask;
+	union {
+		struct in_addr v4;
+		struct in6_addr v6;
+	} addr1, addr2;
+
+	/* the addresses are masked below */
+	memcpy(&addr1, ip1->addr, sizeof(ip1->addr));
+	memcpy(&addr2, ip2->addr, sizeof(ip2->addr));
 
 	switch (op) {
 	case OVAL_OPERATION_EQUALS:
@@ -31,11 +31,19 @@
 #ifndef OSCAP_OVAL_IP_ADDRESS_IMPL_H_
 #define OSCAP_OVAL_IP_ADDRESS_IMPL_H_
 
+#include <stdint.h>
 #include "common/util.h"
 
 #include "oval_definitions.h"
 #include "oval_types.h"
 
+/**
+ * IP address or address set (CIDR) parsed to be compared many times.
+ */
+struct oval_ipaddr {
+	uint32_t mask;                  ///< netmask (IPv4) or prefix length (IPv6)
+	unsigned char addr[16];         ///< struct in_addr or struct in6_addr
+};
 
 /**
  * Compare two IP address or address sets (CIDR). The format of input string
@@ -49,5 +57,16 @@
  */
 oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_operation_t op);
 
+/**
+ * Parse the IP address or address set for oval_ipaddr_parsed_cmp().
+ * @returns 0 on success
+ */
+int oval_ipaddr_parse(int af, const char *str, struct oval_ipaddr *ip);
+
+/**
+ * Compare two parsed IP addresses or address sets, see oval_ipaddr_cmp().
+ */
+oval_result_t oval_ipaddr_parsed_cmp(int af, const struct oval_ipaddr *ip1, const struct oval_ipaddr *ip2, oval_operation_t op);
+
 
 #endif
@@ -341,26 +341,200 @@ oval_result_t oval_result_criteria_node_negate(struct oval_result_criteria_node
 }
 
 
-static oval_result_t _oval_result_criteria_node_result(struct oval_result_criteria_node *node) {
-	__attribute__nonnull__(node);
+/* Estimated cost of the collection needed to evaluate a criteria node */
+enum {
+	CRITERIA_COST_NONE = 0,		/* the result is known already */
+	CRITERIA_COST_CACHED,		/* the objects have been collected */
+	CRITERIA_COST_PROBE,
+	CRITERIA_COST_FILE_WALK		/* the probe traverses the file system */
+};
+
+static bool _oval_object_walks_file_system(struct oval_object *object)
+{
+	bool walks = false;
+
+	struct oval_behavior_iterator *behaviors = oval_object_get_behaviors(object);
+	while (!walks && oval_behavior_iterator_has_more(behaviors)) {
+		struct oval_behavior *behavior = oval_behavior_iterator_next(behaviors);
+		const char *key = oval_behavior_get_key(behavior);
+		const char *value = oval_behavior_get_value(behavior);
+		if (oscap_streq(key, "recurse_direction") && value != NULL && !oscap_streq(value, "none"))
+			walks = true;
+	}
+	oval_behavior_iterator_free(behaviors);
+
+	struct oval_object_content_iterator *contents = oval_object_get_object_contents(object);
+	while (!walks && oval_object_content_iterator_has_more(contents)) {
+		struct oval_object_content *content = oval_object_content_iterator_next(contents);
+		if (oval_object_content_get_type(content) != OVAL_OBJECTCONTENT_ENTITY)
+			continue;
+		struct oval_entity *entity = oval_object_content_get_entity(content);
+		const char *name = oval_entity_get_name(entity);
+		if ((oscap_streq(name, "path") || oscap_streq(name, "filepath"))
+		    && oval_entity_get_operation(entity) == OVAL_OPERATION_PATTERN_MATCH)
+			walks = true;
+	}
+	oval_object_content_iterator_free(contents);
 
-	oval_result_t result;
+	return walks;
+}
+
+static int _oval_result_criteria_node_cost(struct oval_result_criteria_node *node)
+{
+	if (node->result != OVAL_RESULT_NOT_EVALUATED)
+		return CRITERIA_COST_NONE;
+
+	int cost = CRITERIA_COST_NONE;
 	switch (node->type) {
 	case OVAL_NODETYPE_CRITERIA:{
+			/* all the subnodes might be needed */
 			struct oval_result_criteria_node_iterator *subnodes
 			    = oval_result_criteria_node_get_subnodes(node);
-			oval_operator_t operator = oval_result_criteria_node_get_operator(node);
-			struct oresults node_res;
-			ores_clear(&node_res);
 			while (oval_result_criteria_node_iterator_has_more(subnodes)) {
 				struct oval_result_criteria_node *subnode
 				    = oval_result_criteria_node_iterator_next(subnodes);
-				oval_result_t subres = oval_result_criteria_node_eval(subnode);
-				ores_add_res(&node_res, subres);
+				int subcost = _oval_result_criteria_node_cost(subnode);
+				if (subcost > cost)
+					cost = subcost;
 			}
 			oval_result_criteria_node_iterator_free(subnodes);
-			result = ores_get_result_byopr(&node_res, operator);
+		} break;
+	case OVAL_NODETYPE_CRITERION:{
+			struct oval_result_test *rtest = oval_result_criteria_node_get_test(node);
+			if (oval_result_test_get_result(rtest) != OVAL_RESULT_NOT_EVALUATED)
+				break;
+			struct oval_object *object = oval_test_get_object(oval_result_test_get_test(rtest));
+			if (object == NULL)
+				break;
+			struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(node->sys);
+			struct oval_syschar *syschar = oval_syschar_model_get_syschar(syschar_model, oval_object_get_id(object));
+			if (syschar != NULL && oval_syschar_get_flag(syschar) != SYSCHAR_FLAG_UNKNOWN)
+				cost = CRITERIA_COST_CACHED;
+			else if (_oval_object_walks_file_system(object))
+				cost = CRITERIA_COST_FILE_WALK;
+			else
+				cost = CRITERIA_COST_PROBE;
+		} break;
+	case OVAL_NODETYPE_EXTENDDEF:{
+			struct oval_result_definition *extends = oval_result_criteria_node_get_extends(node);
+			if (oval_result_definition_get_result(extends) != OVAL_RESULT_NOT_EVALUATED)
+				break;
+			struct oval_result_criteria_node *criteria = oval_result_definition_get_criteria(extends);
+			if (criteria != NULL)
+				cost = _oval_result_criteria_node_cost(criteria);
+		} break;
+	default:
+		break;
+	}
+	return cost;
+}
 
+struct oval_result_criteria_subnode {
+	struct oval_result_criteria_node *node;
+	int cost;
+	int index;
+};
+
+static int _oval_result_criteria_subnode_cmp(const void *a, const void *b)
+{
+	const struct oval_result_criteria_subnode *sa = a;
+	const struct oval_result_criteria_subnode *sb = b;
+
+	if (sa->cost != sb->cost)
+		return sa->cost - sb->cost;
+	return sa->index - sb->index;
+}
+
+/* Whether the remaining subnodes can't change the result of the operator */
+static bool _oval_result_criteria_is_decided(oval_operator_t operator, struct oresults *ores)
+{
+	switch (operator) {
+	case OVAL_OPERATOR_AND:
+		return ores->false_cnt > 0;
+	case OVAL_OPERATOR_OR:
+		return ores->true_cnt > 0;
+	case OVAL_OPERATOR_ONE:
+		return ores->true_cnt > 1;
+	default:
+		return false;
+	}
+}
+
+static oval_result_t _oval_result_criteria_evaluate_all(struct oval_result_criteria_node *node)
+{
+	struct oval_result_criteria_node_iterator *subnodes
+	    = oval_result_criteria_node_get_subnodes(node);
+	oval_operator_t operator = oval_result_criteria_node_get_operator(node);
+	struct oresults node_res;
+	ores_clear(&node_res);
+	while (oval_result_criteria_node_iterator_has_more(subnodes)) {
+		struct oval_result_criteria_node *subnode
+		    = oval_result_criteria_node_iterator_next(subnodes);
+		oval_result_t subres = oval_result_criteria_node_eval(subnode);
+		ores_add_res(&node_res, subres);
+	}
+	oval_result_criteria_node_iterator_free(subnodes);
+	return ores_get_result_byopr(&node_res, operator);
+}
+
+/*
+ * Evaluate the subnodes from the cheapest to the most expensive one and stop
+ * once the result of the criteria is known. The subnodes which are skipped
+ * stay 'not evaluated' and the objects of their tests aren't collected.
+ */
+static oval_result_t _oval_result_criteria_short_circuit(struct oval_result_criteria_node *node)
+{
+	oval_operator_t operator = oval_result_criteria_node_get_operator(node);
+	struct oval_result_criteria_node_iterator *subnodes = oval_result_criteria_node_get_subnodes(node);
+	int count = oval_collection_iterator_remaining((struct oval_iterator *) subnodes);
+	struct oval_result_criteria_subnode *order;
+	struct oresults node_res;
+
+	ores_clear(&node_res);
+	if (count == 0) {
+		oval_result_criteria_node_iterator_free(subnodes);
+		return ores_get_result_byopr(&node_res, operator);
+	}
+
+	order = malloc(count * sizeof(struct oval_result_criteria_subnode));
+	if (order == NULL) {
+		oval_result_criteria_node_iterator_free(subnodes);
+		return _oval_result_criteria_evaluate_all(node);
+	}
+
+	int i = 0;
+	while (oval_result_criteria_node_iterator_has_more(subnodes)) {
+		order[i].node = oval_result_criteria_node_iterator_next(subnodes);
+		order[i].cost = _oval_result_criteria_node_cost(order[i].node);
+		order[i].index = i;
+		i++;
+	}
+	oval_result_criteria_node_iterator_free(subnodes);
+	qsort(order, count, sizeof(struct oval_result_criteria_subnode), _oval_result_criteria_subnode_cmp);
+
+	for (i = 0; i < count; i++) {
+		ores_add_res(&node_res, oval_result_criteria_node_eval(order[i].node));
+		if (_oval_result_criteria_is_decided(operator, &node_res)) {
+			dI("Result of the criteria is known, %d criteria not evaluated.", count - i - 1);
+			break;
+		}
+	}
+	free(order);
+
+	return ores_get_result_byopr(&node_res, operator);
+}
+
+static oval_result_t _oval_result_criteria_node_result(struct oval_result_criteria_node *node) {
+	__attribute__nonnull__(node);
+
+	oval_result_t result;
+	switch (node->type) {
+	case OVAL_NODETYPE_CRITERIA:{
+			struct oval_results_model *results_model = oval_result_system_get_results_model(node->sys);
+			if (oval_results_model_get_short_circuit(results_model))
+				result = _oval_result_criteria_short_circuit(node);
+			else
+				result = _oval_result_criteria_evaluate_all(node);
 		} break;
 	case OVAL_NODETYPE_CRITERION:{
 			struct oval_result_test *test = oval_result_criteria_node_get_test(node);
@@ -45,6 +45,7 @@
 #include "adt/oval_smc_impl.h"
 #include "adt/oval_smc_iterator_impl.h"
 #include "adt/oval_string_map_impl.h"
+#include "collectVarRefs_impl.h"
 #include "oval_parser_impl.h"
 
 #include "common/debug_priv.h"
@@ -57,6 +58,7 @@ typedef struct oval_result_system {
 	struct oval_smc *definitions;			///< Map contains lists of oval_result_definition
 	struct oval_smc *tests;				///< Map contains lists of oval_result_test
 	struct oval_syschar_model *syschar_model;
+	struct oval_string_map *state_programs;		///< Map of compiled states by state id
 } oval_result_system_t;
 
 
@@ -116,6 +118,7 @@ struct oval_result_system *oval_result_system_new(struct oval_results_model *mod
 	sys->definitions = oval_smc_new();
 	sys->tests = oval_smc_new();
 	sys->syschar_model = syschar_model;
+	sys->state_programs = oval_string_map_new();
 	sys->model = model;
 
 	oval_results_model_add_system(model, sys);
@@ -146,7 +149,19 @@ void oval_result_system_free(struct oval_result_system *sys)
 	oval_smc_free(sys->definitions, (oscap_destruct_func) oval_result_definition_free);
 	oval_smc_free(sys->tests, (oscap_destruct_func) oval_result_test_free);
 
+	size_t memo_hits = 0, memo_lookups = 0;
+	struct oval_iterator *programs = oval_string_map_values(sys->state_programs);
+	while (oval_collection_iterator_has_more(programs))
+		oval_state_program_get_memo_stats(oval_collection_iterator_next(programs), &memo_hits, &memo_lookups);
+	oval_collection_iterator_free(programs);
+	if (memo_lookups > 0) {
+		dI("Item evaluations reused from other tests sharing the states: %zu of %zu (%.1f%%).",
+		   memo_hits, memo_lookups, 100.0 * memo_hits / memo_lookups);
+	}
+	oval_string_map_free(sys->state_programs, (oscap_destruct_func) oval_state_program_free);
+
 	sys->definitions = NULL;
+	sys->state_programs = NULL;
 	sys->syschar_model = NULL;
 	sys->tests = NULL;
 
@@ -186,6 +201,17 @@ struct oval_result_definition *oval_result_system_get_definition(struct oval_res
 	return oval_smc_get_last(sys->definitions, id);
 }
 
+/**
+ * Drop the result definitions with the given id. The caller has to make sure
+ * that no other result definition extends them.
+ */
+void oval_result_system_remove_definition(struct oval_result_system *sys, const char *id)
+{
+	__attribute__nonnull__(sys);
+
+	oval_smc_remove(sys->definitions, id, (oscap_destruct_func) oval_result_definition_free);
+}
+
 struct oval_result_test *oval_result_system_get_test(struct oval_result_system *sys, char *id) {
 	__attribute__nonnull__(sys);
 
@@ -260,6 +286,20 @@ struct oval_syschar_model *oval_result_system_get_syschar_model(struct oval_resu
 	return sys->syschar_model;
 }
 
+struct oval_state_program *oval_result_system_get_state_program(struct oval_result_system *sys, struct oval_state *state)
+{
+	__attribute__nonnull__(sys);
+
+	const char *state_id = oval_state_get_id(state);
+	struct oval_state_program *program = oval_string_map_get_value(sys->state_programs, state_id);
+	if (program == NULL) {
+		program = oval_state_program_new(state);
+		if (program != NULL)
+			oval_string_map_put(sys->state_programs, state_id, program);
+	}
+	return program;
+}
+
 struct oval_sysinfo *oval_result_system_get_sysinfo(struct oval_result_system *sys) {
 	struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(sys);
 	return (syschar_model)
@@ -341,6 +381,93 @@ int oval_result_system_parse_tag(xmlTextReaderPtr reader, struct oval_parser_con
 	return return_code;
 }
 
+static void _oval_result_system_collect_criteria_tests(struct oval_criteria_node *node, struct oval_string_map *tests,
+						       struct oval_string_map *definitions)
+{
+	struct oval_criteria_node_iterator *subnodes;
+	struct oval_definition *definition;
+	struct oval_test *test;
+
+	if (node == NULL)
+		return;
+
+	switch (oval_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERIA:
+		subnodes = oval_criteria_node_get_subnodes(node);
+		while (oval_criteria_node_iterator_has_more(subnodes))
+			_oval_result_system_collect_criteria_tests(oval_criteria_node_iterator_next(subnodes), tests, definitions);
+		oval_criteria_node_iterator_free(subnodes);
+		break;
+	case OVAL_NODETYPE_CRITERION:
+		test = oval_criteria_node_get_test(node);
+		if (test != NULL)
+			oval_string_map_put(tests, oval_test_get_id(test), test);
+		break;
+	case OVAL_NODETYPE_EXTENDDEF:
+		definition = oval_criteria_node_get_definition(node);
+		if (definition != NULL && oval_string_map_get_value(definitions, oval_definition_get_id(definition)) == NULL) {
+			oval_string_map_put(definitions, oval_definition_get_id(definition), definition);
+			_oval_result_system_collect_criteria_tests(oval_definition_get_criteria(definition), tests, definitions);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Compute the variables referenced by the states of the tests up front,
+ * instead of one by one when the states are compared to the items. Only
+ * the tests whose collected items are going to be compared to the states
+ * are considered, so the variables computed are the same.
+ */
+static void _oval_result_system_compute_variables(struct oval_result_system *sys,
+						  struct oval_definition_model *definition_model)
+{
+	struct oval_string_map *tests, *definitions, *variables;
+	struct oval_definition_iterator *definitions_itr;
+	struct oval_iterator *tests_itr;
+
+	if (oval_results_model_get_probe_session(oval_result_system_get_results_model(sys)) != NULL)
+		return;
+
+	tests = oval_string_map_new();
+	definitions = oval_string_map_new();
+	definitions_itr = oval_definition_model_get_definitions(definition_model);
+	while (oval_definition_iterator_has_more(definitions_itr)) {
+		struct oval_definition *definition = oval_definition_iterator_next(definitions_itr);
+
+		_oval_result_system_collect_criteria_tests(oval_definition_get_criteria(definition), tests, definitions);
+	}
+	oval_definition_iterator_free(definitions_itr);
+
+	variables = oval_string_map_new();
+	tests_itr = oval_string_map_values(tests);
+	while (oval_collection_iterator_has_more(tests_itr)) {
+		struct oval_test *test = oval_collection_iterator_next(tests_itr);
+		struct oval_object *object = oval_test_get_object(test);
+		struct oval_state_iterator *states_itr;
+		struct oval_syschar *syschar;
+
+		if (object == NULL)
+			continue;
+		syschar = oval_syschar_model_get_syschar(sys->syschar_model, oval_object_get_id(object));
+		if (syschar == NULL || !oval_result_test_compares_states(test, syschar))
+			continue;
+
+		states_itr = oval_test_get_states(test);
+		while (oval_state_iterator_has_more(states_itr))
+			oval_ste_collect_var_deps(oval_state_iterator_next(states_itr), variables);
+		oval_state_iterator_free(states_itr);
+	}
+	oval_collection_iterator_free(tests_itr);
+
+	oval_syschar_model_compute_variables(sys->syschar_model, variables);
+	oval_string_map_free0(variables);
+	oval_string_map_free0(definitions);
+	oval_string_map_free0(tests);
+}
+
 int oval_result_system_eval(struct oval_result_system *sys)
 {
 	struct oval_results_model *res_model;
@@ -349,6 +476,7 @@ int oval_result_system_eval(struct oval_result_system *sys)
 
 	res_model = oval_result_system_get_results_model(sys);
 	definition_model = oval_results_model_get_definition_model(res_model);
+	_oval_result_system_compute_variables(sys, definition_model);
 	definitions_itr = oval_definition_model_get_definitions(definition_model);
 
 	while (oval_definition_iterator_has_more(definitions_itr)) {
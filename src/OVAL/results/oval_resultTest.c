@@ -33,6 +33,7 @@
 #include <config.h>
 #endif
 
+#include <stdint.h>
 #include <string.h>
 #include <ctype.h>
 #include "oval_agent_api_impl.h"
@@ -381,7 +382,23 @@ oval_result_t ores_get_result_byopr(struct oresults *ores, oval_operator_t op)
 	return result;
 }
 
-static inline oval_result_t _evaluate_sysent_with_variable(struct oval_syschar_model *syschar_model, struct oval_variable *state_entity_var, const char *sys_data, oval_operation_t state_entity_operation, oval_check_t var_check)
+/*
+ * Compare a parsed value to an item entity, the entity value parsed for the
+ * comparison is kept for the other values and states.
+ */
+static oval_result_t _cmp_sysent(struct oval_cmp_datum *state_datum, struct oval_sysent *item_entity, oval_operation_t operation)
+{
+	struct oval_cmp_datum *sys_datum = oval_sysent_get_cmp_datum(item_entity, state_datum->datatype);
+
+	if (sys_datum == NULL)
+		return oval_cmp_datum_cmp_str(state_datum, oval_sysent_get_value(item_entity), operation);
+	return oval_cmp_datum_cmp(state_datum, sys_datum, operation);
+}
+
+/*
+ * The item entity is NULL when comparing a record field.
+ */
+static inline oval_result_t _evaluate_sysent_with_variable(struct oval_syschar_model *syschar_model, struct oval_variable *state_entity_var, struct oval_sysent *item_entity, const char *sys_data, oval_operation_t state_entity_operation, oval_check_t var_check)
 {
 	oval_syschar_collection_flag_t flag;
 	oval_result_t ent_val_res;
@@ -395,33 +412,37 @@ static inline oval_result_t _evaluate_sysent_with_variable(struct oval_syschar_m
 	case SYSCHAR_FLAG_COMPLETE:
 	case SYSCHAR_FLAG_INCOMPLETE:{
 		struct oresults var_ores;
-		struct oval_value_iterator *val_itr;
+		struct oval_value *var_val;
+		void *pos = NULL;
 
 		ores_clear(&var_ores);
 
-		val_itr = oval_variable_get_values(state_entity_var);
-		while (oval_value_iterator_has_more(val_itr)) {
-			struct oval_value *var_val;
+		while (oval_variable_walk_values(state_entity_var, &pos, &var_val)) {
+			struct oval_cmp_datum *var_val_datum;
 			char *state_entity_val_text = NULL;
 			oval_result_t var_val_res;
 
-			var_val = oval_value_iterator_next(val_itr);
 			state_entity_val_text = oval_value_get_text(var_val);
 			if (state_entity_val_text == NULL) {
 				dE("Found NULL variable value text.");
 				ores_add_res(&var_ores, OVAL_RESULT_ERROR);
 				break;
 			}
-			oval_datatype_t state_entity_val_datatype = oval_value_get_datatype(var_val);
-
-			var_val_res = oval_str_cmp_str(state_entity_val_text, state_entity_val_datatype, sys_data, state_entity_operation);
+			/* the values are parsed once for all the items */
+			if ((var_val_datum = oval_value_get_cmp_datum(var_val)) == NULL) {
+				var_val_res = oval_str_cmp_str(state_entity_val_text, oval_value_get_datatype(var_val),
+						sys_data, state_entity_operation);
+			} else if (item_entity != NULL) {
+				var_val_res = _cmp_sysent(var_val_datum, item_entity, state_entity_operation);
+			} else {
+				var_val_res = oval_cmp_datum_cmp_str(var_val_datum, sys_data, state_entity_operation);
+			}
 			if (var_val_res == OVAL_RESULT_ERROR) {
 				dW("Can't compare variable '%s' value = '%s' with collected item entity = '%s'",
 					oval_variable_get_id(state_entity_var), state_entity_val_text, sys_data);
 			}
 			ores_add_res(&var_ores, var_val_res);
 		}
-		oval_value_iterator_free(val_itr);
 
 		ent_val_res = ores_get_result_bychk(&var_ores, var_check);
 		} break;
@@ -486,7 +507,7 @@ static oval_result_t _evaluate_sysent_record(struct oval_syschar_model *syschar_
 				field_found = true;
 				oval_result_t fields_comparison_result;
 				if (state_rf.var != NULL) {
-					fields_comparison_result = _evaluate_sysent_with_variable(syschar_model, state_rf.var, item_rf.value, state_rf.operation, state_rf.var_check);
+					fields_comparison_result = _evaluate_sysent_with_variable(syschar_model, state_rf.var, NULL, item_rf.value, state_rf.operation, state_rf.var_check);
 				} else {
 					fields_comparison_result = oval_str_cmp_str(state_rf.value, state_rf.data_type, item_rf.value, state_rf.operation);
 				}
@@ -523,7 +544,7 @@ static inline oval_result_t _evaluate_sysent(struct oval_syschar_model *syschar_
 		oval_check_t var_check = oval_state_content_get_var_check(content);
 
 		return _evaluate_sysent_with_variable(syschar_model,
-				state_entity_var, sys_data,
+				state_entity_var, item_entity, sys_data,
 				state_entity_operation, var_check);
 	} else {
 		struct oval_value *state_entity_val;
@@ -554,40 +575,72 @@ static inline oval_result_t _evaluate_sysent(struct oval_syschar_model *syschar_
 	}
 }
 
-static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem, struct oval_state *state)
-{
-	struct oval_state_content_iterator *state_contents_itr;
-	struct oresults ste_ores;
+/*
+ * A state entity resolved for the evaluation of many items. The entities
+ * compared with a literal value have the value parsed in advance, variables
+ * and records are evaluated by _evaluate_sysent().
+ */
+struct oval_state_check {
+	struct oval_state_content *content;
+	struct oval_entity *entity;
+	const char *name;               ///< name of the item entities to compare
+	oval_operation_t operation;
+	oval_check_t entity_check;
+	oval_existence_t check_existence;
+	bool mask;
+	bool prepared;                  ///< compared by the value below
+	struct oval_cmp_datum value;
+};
+
+struct oval_state_program {
+	struct oval_state *state;
 	oval_operator_t operator;
-	oval_result_t result = OVAL_RESULT_ERROR;
+	bool invalid;                   ///< the state can't be evaluated
+	bool instanced;                 ///< the result depends on the variable instance
+	struct oval_string_map *memo;   ///< results of the evaluated items by item id
+	size_t memo_hits;
+	size_t memo_lookups;
+	size_t check_count;
+	struct oval_state_check checks[];
+};
 
-	ores_clear(&ste_ores);
+struct oval_state_program *oval_state_program_new(struct oval_state *state)
+{
+	struct oval_state_content_iterator *state_contents_itr;
+	struct oval_state_program *program;
+	int content_count;
 
 	state_contents_itr = oval_state_get_contents(state);
+	content_count = oval_collection_iterator_remaining((struct oval_iterator *) state_contents_itr);
+	program = calloc(1, sizeof(struct oval_state_program) + content_count * sizeof(struct oval_state_check));
+	if (program == NULL) {
+		oval_state_content_iterator_free(state_contents_itr);
+		return NULL;
+	}
+	program->state = state;
+	program->operator = oval_state_get_operator(state);
+	program->memo = oval_string_map_new();
+
 	while (oval_state_content_iterator_has_more(state_contents_itr)) {
+		struct oval_state_check *check = &program->checks[program->check_count];
 		struct oval_state_content *content;
 		struct oval_entity *state_entity;
 		char *state_entity_name;
-		oval_operation_t state_entity_operation;
-		oval_check_t entity_check;
-		oval_existence_t check_existence;
-		oval_result_t ste_ent_res;
-		struct oval_sysent_iterator *item_entities_itr;
-		struct oresults ent_ores;
-		struct oval_status_counter counter;
-		bool found_matching_item;
 
 		if ((content = oval_state_content_iterator_next(state_contents_itr)) == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL state content");
-			goto fail;
+			program->invalid = true;
+			break;
 		}
 		if ((state_entity = oval_state_content_get_entity(content)) == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity");
-			goto fail;
+			program->invalid = true;
+			break;
 		}
 		if ((state_entity_name = oval_entity_get_name(state_entity)) == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity name");
-			goto fail;
+			program->invalid = true;
+			break;
 		}
 
 		if (oscap_streq(state_entity_name, "line") &&
@@ -605,42 +658,110 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 			}
 		}
 
-		entity_check = oval_state_content_get_ent_check(content);
-		check_existence = oval_state_content_get_check_existence(content);
-		state_entity_operation = oval_entity_get_operation(state_entity);
+		check->content = content;
+		check->entity = state_entity;
+		check->name = state_entity_name;
+		check->entity_check = oval_state_content_get_ent_check(content);
+		check->check_existence = oval_state_content_get_check_existence(content);
+		check->operation = oval_entity_get_operation(state_entity);
+		check->mask = oval_entity_get_mask(state_entity);
+
+		/* literal values are parsed here, anything unusual is left to _evaluate_sysent() */
+		if (oval_entity_get_varref_type(state_entity) == OVAL_ENTITY_VARREF_ATTRIBUTE ||
+		    oval_entity_get_datatype(state_entity) == OVAL_DATATYPE_RECORD) {
+			/* the values of the variables may differ between variable instances */
+			program->instanced = true;
+		} else {
+			struct oval_value *state_entity_val = oval_entity_get_value(state_entity);
+			char *state_entity_val_text = state_entity_val ? oval_value_get_text(state_entity_val) : NULL;
+
+			if (state_entity_val_text != NULL) {
+				oval_cmp_datum_init(&check->value, state_entity_val_text,
+						oval_value_get_datatype(state_entity_val));
+				check->prepared = true;
+			}
+		}
+		++program->check_count;
+	}
+	oval_state_content_iterator_free(state_contents_itr);
+
+	return program;
+}
+
+void oval_state_program_free(struct oval_state_program *program)
+{
+	if (program == NULL)
+		return;
+	for (size_t i = 0; i < program->check_count; i++) {
+		if (program->checks[i].prepared)
+			oval_cmp_datum_clear(&program->checks[i].value);
+	}
+	oval_string_map_free(program->memo, NULL);
+	free(program);
+}
+
+void oval_state_program_get_memo_stats(const struct oval_state_program *program, size_t *hits, size_t *lookups)
+{
+	*hits += program->memo_hits;
+	*lookups += program->memo_lookups;
+}
+
+static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem, struct oval_state_program *program)
+{
+	struct oval_state *state;
+	struct oresults ste_ores;
+	struct oval_status_counter counter;
+	struct oval_sysent *item_entity;
+	void *pos;
+	oval_result_t result = OVAL_RESULT_ERROR;
+
+	if (program == NULL || program->invalid)
+		return OVAL_RESULT_ERROR;
+	state = program->state;
+
+	ores_clear(&ste_ores);
+
+	/* The existence is checked against the statuses of all the entities of the item */
+	oval_status_counter_clear(&counter);
+	pos = NULL;
+	while (oval_sysitem_walk_sysents(cur_sysitem, &pos, &item_entity)) {
+		if (item_entity == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL sysent");
+			return OVAL_RESULT_ERROR;
+		}
+		oval_status_counter_add_status(&counter, oval_sysent_get_status(item_entity));
+	}
+
+	for (size_t i = 0; i < program->check_count; i++) {
+		struct oval_state_check *check = &program->checks[i];
+		oval_result_t ste_ent_res;
+		struct oresults ent_ores;
+		bool found_matching_item;
 
 		ores_clear(&ent_ores);
 		found_matching_item = false;
-		oval_status_counter_clear(&counter);
 
-		item_entities_itr = oval_sysitem_get_sysents(cur_sysitem);
-		while (oval_sysent_iterator_has_more(item_entities_itr)) {
-			struct oval_sysent *item_entity;
+		pos = NULL;
+		while (oval_sysitem_walk_sysents(cur_sysitem, &pos, &item_entity)) {
 			oval_result_t ent_val_res;
-			char *item_entity_name;
-			oval_syschar_status_t item_status;
-
-			item_entity = oval_sysent_iterator_next(item_entities_itr);
-			if (item_entity == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL sysent");
-				oval_sysent_iterator_free(item_entities_itr);
-				goto fail;
-			}
-			item_status = oval_sysent_get_status(item_entity);
-			oval_status_counter_add_status(&counter, item_status);
 
-			item_entity_name = oval_sysent_get_name(item_entity);
-			if (strcmp(item_entity_name, state_entity_name))
+			if (strcmp(oval_sysent_get_name(item_entity), check->name))
 				continue;
 
 			found_matching_item = true;
 
 			/* copy mask attribute from state to item */
-			if (oval_entity_get_mask(state_entity))
+			if (check->mask)
 				oval_sysent_set_mask(item_entity,1);
 
-			ent_val_res = _evaluate_sysent(syschar_model, item_entity, state_entity,
-					state_entity_operation, content);
+			if (!check->prepared) {
+				ent_val_res = _evaluate_sysent(syschar_model, item_entity, check->entity,
+						check->operation, check->content);
+			} else if (oval_sysent_get_status(item_entity) == SYSCHAR_STATUS_DOES_NOT_EXIST) {
+				ent_val_res = OVAL_RESULT_FALSE;
+			} else {
+				ent_val_res = _cmp_sysent(&check->value, item_entity, check->operation);
+			}
 			if (ent_val_res == OVAL_RESULT_TRUE) {
 				dI("Entity '%s'='%s' of item '%s' matches corresponding entity in state '%s'.",
 						oval_sysent_get_name(item_entity),
@@ -653,42 +774,76 @@ static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct
 						oval_sysent_get_value(item_entity),
 						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state));
 			}
-			if (((signed) ent_val_res) == -1) {
-				oval_sysent_iterator_free(item_entities_itr);
-				goto fail;
-			}
+			if (((signed) ent_val_res) == -1)
+				return OVAL_RESULT_ERROR;
 
 			ores_add_res(&ent_ores, ent_val_res);
 		}
-		oval_sysent_iterator_free(item_entities_itr);
 
 		if (!found_matching_item)
 			dW("Entity name '%s' from state (id: '%s') not found in item (id: '%s').",
-			   state_entity_name, oval_state_get_id(state), oval_sysitem_get_id(cur_sysitem));
+			   check->name, oval_state_get_id(state), oval_sysitem_get_id(cur_sysitem));
 
-		oval_result_t cres = oval_status_counter_get_result(&counter, check_existence);
+		oval_result_t cres = oval_status_counter_get_result(&counter, check->check_existence);
 		/* The entity check results are only relevant when the check existence is satisfied */
 		if (cres == OVAL_RESULT_TRUE) {
-			ste_ent_res = ores_get_result_bychk(&ent_ores, entity_check);
+			ste_ent_res = ores_get_result_bychk(&ent_ores, check->entity_check);
 			ores_add_res(&ste_ores, ste_ent_res);
 		} else {
 			ores_add_res(&ste_ores, cres);
 		}
 	}
-	oval_state_content_iterator_free(state_contents_itr);
 
-	operator = oval_state_get_operator(state);
-	result = ores_get_result_byopr(&ste_ores, operator);
+	result = ores_get_result_byopr(&ste_ores, program->operator);
 	dI("Item '%s' compared to state '%s' with result %s.",
 			   oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state),
 			   oval_result_get_text(result));
 
 	return result;
+}
 
- fail:
-	oval_state_content_iterator_free(state_contents_itr);
+/*
+ * Evaluate an item against a compiled state, the result is reused when the
+ * same item is compared to the same state by another test. The variable
+ * instance of the test is a part of the key when the state refers to
+ * variables, see oval_agent.c for the handling of the variable instances.
+ */
+static oval_result_t eval_item_memoised(struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem,
+		struct oval_state_program *program, int variable_instance)
+{
+	const char *item_id;
+	char key[128];
+	void *memoised;
+	oval_result_t result;
+	int len;
+
+	if (program == NULL || program->invalid)
+		return OVAL_RESULT_ERROR;
 
-	return OVAL_RESULT_ERROR;
+	if ((item_id = oval_sysitem_get_id(cur_sysitem)) == NULL)
+		return eval_item(syschar_model, cur_sysitem, program);
+	if (program->instanced)
+		len = snprintf(key, sizeof key, "%s#%d", item_id, variable_instance);
+	else
+		len = snprintf(key, sizeof key, "%s", item_id);
+	if (len < 0 || (size_t) len >= sizeof key)
+		return eval_item(syschar_model, cur_sysitem, program);
+
+	program->memo_lookups++;
+	if ((memoised = oval_string_map_get_value(program->memo, key)) != NULL) {
+		program->memo_hits++;
+		result = (oval_result_t) (uintptr_t) memoised;
+		dI("Item '%s' compared to state '%s' with result %s (reused).",
+				item_id, oval_state_get_id(program->state), oval_result_get_text(result));
+		return result;
+	}
+
+	result = eval_item(syschar_model, cur_sysitem, program);
+	/* errors are reported again by the next evaluation */
+	if (result != OVAL_RESULT_ERROR)
+		oval_string_map_put(program->memo, key, (void *) (uintptr_t) result);
+
+	return result;
 }
 
 #define ITEMMAP (struct oval_string_map    *)args[2]
@@ -711,14 +866,19 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 {
 	struct oval_syschar_model *syschar_model;
 	struct oval_result_item_iterator *ritems_itr;
+	struct oval_state_iterator *ste_itr;
+	struct oval_state_program **programs;
+	size_t program_count = 0, i;
 	struct oresults item_ores;
 	oval_result_t result;
 	oval_check_t ste_check;
 	oval_operator_t ste_opr;
+	int variable_instance;
 
 	ste_check = oval_test_get_check(test);
 	ste_opr = oval_test_get_state_operator(test);
 	syschar_model = oval_result_system_get_syschar_model(SYSTEM);
+	variable_instance = oval_result_test_get_instance(TEST);
 	ores_clear(&item_ores);
 
 	char *state_names = oval_test_get_state_names(test);
@@ -728,13 +888,19 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 		free(state_names);
 	}
 
+	/* the states are compiled once and evaluated for all the items */
+	ste_itr = oval_test_get_states(test);
+	programs = malloc((oval_collection_iterator_remaining((struct oval_iterator *) ste_itr) + 1) * sizeof(struct oval_state_program *));
+	while (oval_state_iterator_has_more(ste_itr))
+		programs[program_count++] = oval_result_system_get_state_program(SYSTEM, oval_state_iterator_next(ste_itr));
+	oval_state_iterator_free(ste_itr);
+
 	ritems_itr = oval_result_test_get_items(TEST);
 	while (oval_result_item_iterator_has_more(ritems_itr)) {
 		struct oval_result_item *ritem;
 		struct oval_sysitem *item;
 		oval_syschar_status_t item_status;
 		struct oresults ste_ores;
-		struct oval_state_iterator *ste_itr;
 		oval_result_t item_res;
 
 		ritem = oval_result_item_iterator_next(ritems_itr);
@@ -759,22 +925,19 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 
 		ores_clear(&ste_ores);
 
-		ste_itr = oval_test_get_states(test);
-		while (oval_state_iterator_has_more(ste_itr)) {
-			struct oval_state *ste;
+		for (i = 0; i < program_count; i++) {
 			oval_result_t ste_res;
 
-			ste = oval_state_iterator_next(ste_itr);
-			ste_res = eval_item(syschar_model, item, ste);
+			ste_res = eval_item_memoised(syschar_model, item, programs[i], variable_instance);
 			ores_add_res(&ste_ores, ste_res);
 		}
-		oval_state_iterator_free(ste_itr);
 
 		item_res = ores_get_result_byopr(&ste_ores, ste_opr);
 		ores_add_res(&item_ores, item_res);
 		oval_result_item_set_result(ritem, item_res);
 	}
 	oval_result_item_iterator_free(ritems_itr);
+	free(programs);
 
 	result = ores_get_result_bychk(&item_ores, ste_check);
 
@@ -844,6 +1007,51 @@ static oval_result_t eval_check_existence(oval_existence_t check_existence, int
 	return result;
 }
 
+bool oval_result_test_compares_states(struct oval_test *test, struct oval_syschar *syschar)
+{
+	struct oval_sysitem_iterator *items_itr;
+	struct oval_state_iterator *ste_itr;
+	oval_existence_t check_existence;
+	int exists_cnt, error_cnt;
+	bool hasstate;
+
+	ste_itr = oval_test_get_states(test);
+	hasstate = oval_state_iterator_has_more(ste_itr);
+	oval_state_iterator_free(ste_itr);
+	if (!hasstate)
+		return false;
+
+	exists_cnt = error_cnt = 0;
+	items_itr = oval_syschar_get_sysitem(syschar);
+	while (oval_sysitem_iterator_has_more(items_itr)) {
+		switch (oval_sysitem_get_status(oval_sysitem_iterator_next(items_itr))) {
+		case SYSCHAR_STATUS_EXISTS:
+			exists_cnt++;
+			break;
+		case SYSCHAR_STATUS_ERROR:
+			error_cnt++;
+			break;
+		default:
+			break;
+		}
+	}
+	oval_sysitem_iterator_free(items_itr);
+
+	/* only the existing items are compared to the states */
+	if (exists_cnt == 0)
+		return false;
+
+	check_existence = oval_test_get_existence(test);
+	switch (oval_syschar_get_flag(syschar)) {
+	case SYSCHAR_FLAG_COMPLETE:
+		return eval_check_existence(check_existence, exists_cnt, error_cnt) == OVAL_RESULT_TRUE;
+	case SYSCHAR_FLAG_INCOMPLETE:
+		return check_existence == OVAL_ANY_EXIST || check_existence == OVAL_AT_LEAST_ONE_EXISTS;
+	default:
+		return false;
+	}
+}
+
 static oval_result_t
 _oval_result_test_evaluate_items(struct oval_test *test, struct oval_syschar *syschar_object, void **args)
 {
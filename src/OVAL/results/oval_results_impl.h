@@ -58,6 +58,12 @@ void oval_result_definition_set_variable_instance_hint(struct oval_result_defini
 struct oval_result_test *make_result_test_from_oval_test(struct oval_result_system *system, struct oval_test *oval_test, int variable_instance);
 
 int oval_result_test_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, void *);
+/**
+ * Check whether the items collected for the test object are compared to the
+ * states of the test, ie. whether evaluating the test computes the variables
+ * referenced by the states.
+ */
+bool oval_result_test_compares_states(struct oval_test *test, struct oval_syschar *syschar);
 xmlNode *oval_result_test_to_dom(struct oval_result_test *, xmlDocPtr, xmlNode *);
 
 
@@ -79,6 +85,23 @@ struct oval_result_definition *oval_result_system_get_new_definition_with_check(
 
 struct oval_result_test *oval_result_system_get_test(struct oval_result_system *, char *);
 
+/**
+ * State compiled once for the evaluation of many items, see eval_item().
+ */
+struct oval_state_program;
+struct oval_state_program *oval_state_program_new(struct oval_state *state);
+void oval_state_program_free(struct oval_state_program *program);
+/**
+ * Add the number of the memoised item evaluations reused by the state and
+ * the number of all its item evaluations to the counters.
+ */
+void oval_state_program_get_memo_stats(const struct oval_state_program *program, size_t *hits, size_t *lookups);
+/**
+ * Get the compiled state, it is compiled the first time and kept until the
+ * result system is freed.
+ */
+struct oval_state_program *oval_result_system_get_state_program(struct oval_result_system *sys, struct oval_state *state);
+
 struct oresults {
 	int true_cnt;
 	int false_cnt;
@@ -106,6 +129,7 @@ const char *oval_result_test_get_id(const struct oval_result_test *test);
 
 
 struct oval_result_definition *oval_result_system_prepare_definition(struct oval_result_system *sys, const char *id);
+void oval_result_system_remove_definition(struct oval_result_system *sys, const char *id);
 
 
 #endif				/* OVAL_RESULTS_IMPL_H_ */
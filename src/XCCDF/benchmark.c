@@ -51,12 +51,13 @@ struct xccdf_backref {
 	char *id;		// id
 };
 
-struct xccdf_benchmark *xccdf_benchmark_import_source(struct oscap_source *source)
+static struct xccdf_benchmark *_xccdf_benchmark_import_source(struct oscap_source *source, bool defer_texts)
 {
 	xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
 
 	while (xmlTextReaderRead(reader) == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) ;
 	struct xccdf_benchmark *benchmark = xccdf_benchmark_new();
+	XITEM(benchmark)->sub.benchmark.defer_texts = defer_texts;
 	const bool parse_result = xccdf_benchmark_parse(XITEM(benchmark), reader);
 	xmlFreeTextReader(reader);
 
@@ -85,6 +86,79 @@ struct xccdf_benchmark *xccdf_benchmark_import_source(struct oscap_source *sourc
 	return benchmark;
 }
 
+struct xccdf_benchmark *xccdf_benchmark_import_source(struct oscap_source *source)
+{
+	return _xccdf_benchmark_import_source(source, false);
+}
+
+struct xccdf_benchmark *xccdf_benchmark_import_source_deferred(struct oscap_source *source)
+{
+	return _xccdf_benchmark_import_source(source, true);
+}
+
+static void _xccdf_textlist_materialize(struct oscap_list *texts)
+{
+	struct oscap_iterator *it = oscap_iterator_new(texts);
+	while (oscap_iterator_has_more(it))
+		oscap_text_materialize(oscap_iterator_next(it));
+	oscap_iterator_free(it);
+}
+
+static void _xccdf_item_materialize_texts(struct xccdf_item *item)
+{
+	_xccdf_textlist_materialize(item->item.description);
+	_xccdf_textlist_materialize(item->item.rationale);
+
+	struct oscap_iterator *it = oscap_iterator_new(item->item.warnings);
+	while (oscap_iterator_has_more(it))
+		oscap_text_materialize(((struct xccdf_warning *) oscap_iterator_next(it))->text);
+	oscap_iterator_free(it);
+
+	if (xccdf_item_get_type(item) != XCCDF_RULE)
+		return;
+
+	it = oscap_iterator_new(item->sub.rule.fixtexts);
+	while (oscap_iterator_has_more(it))
+		oscap_text_materialize(((struct xccdf_fixtext *) oscap_iterator_next(it))->text);
+	oscap_iterator_free(it);
+
+	it = oscap_iterator_new(item->sub.rule.fixes);
+	while (oscap_iterator_has_more(it))
+		xccdf_fix_get_content(oscap_iterator_next(it));
+	oscap_iterator_free(it);
+}
+
+static void _xccdf_htable_materialize_texts(struct oscap_htable *items)
+{
+	struct oscap_htable_iterator *it = oscap_htable_iterator_new(items);
+	while (oscap_htable_iterator_has_more(it))
+		_xccdf_item_materialize_texts(oscap_htable_iterator_next_value(it));
+	oscap_htable_iterator_free(it);
+}
+
+void xccdf_benchmark_materialize_texts(struct xccdf_benchmark *benchmark)
+{
+	struct xccdf_item *bench = XITEM(benchmark);
+	if (!bench->sub.benchmark.defer_texts)
+		return;
+
+	_xccdf_item_materialize_texts(bench);
+	_xccdf_textlist_materialize(bench->sub.benchmark.front_matter);
+	_xccdf_textlist_materialize(bench->sub.benchmark.rear_matter);
+	struct oscap_iterator *it = oscap_iterator_new(bench->sub.benchmark.notices);
+	while (oscap_iterator_has_more(it))
+		oscap_text_materialize(((struct xccdf_notice *) oscap_iterator_next(it))->text);
+	oscap_iterator_free(it);
+
+	_xccdf_htable_materialize_texts(bench->sub.benchmark.items_dict);
+	_xccdf_htable_materialize_texts(bench->sub.benchmark.profiles_dict);
+	it = oscap_iterator_new(bench->sub.benchmark.results);
+	while (oscap_iterator_has_more(it))
+		_xccdf_item_materialize_texts(oscap_iterator_next(it));
+	oscap_iterator_free(it);
+	bench->sub.benchmark.defer_texts = false;
+}
+
 struct xccdf_benchmark *xccdf_benchmark_new(void)
 {
 	struct xccdf_item *bench = xccdf_item_new(XCCDF_BENCHMARK, NULL);
@@ -151,13 +225,13 @@ bool xccdf_benchmark_parse(struct xccdf_item * benchmark, xmlTextReaderPtr reade
 
 		switch (xccdf_element_get(reader)) {
 		case XCCDFE_NOTICE:
-				oscap_list_add(benchmark->sub.benchmark.notices, xccdf_notice_new_parse(reader));
+				oscap_list_add(benchmark->sub.benchmark.notices, xccdf_notice_new_parse(reader, benchmark));
 				break;
 		case XCCDFE_FRONT_MATTER:
-				oscap_list_add(benchmark->sub.benchmark.front_matter, oscap_text_new_parse(XCCDF_TEXT_HTMLSUB, reader));
+				oscap_list_add(benchmark->sub.benchmark.front_matter, xccdf_text_new_parse(benchmark, XCCDF_TEXT_HTMLSUB, reader));
 			break;
 		case XCCDFE_REAR_MATTER:
-				oscap_list_add(benchmark->sub.benchmark.rear_matter, oscap_text_new_parse(XCCDF_TEXT_HTMLSUB, reader));
+				oscap_list_add(benchmark->sub.benchmark.rear_matter, xccdf_text_new_parse(benchmark, XCCDF_TEXT_HTMLSUB, reader));
 			break;
 		case XCCDFE_PLATFORM:
 			xccdf_item_add_applicable_platform(benchmark, reader);
@@ -619,11 +693,11 @@ struct xccdf_notice *xccdf_notice_clone(const struct xccdf_notice * notice)
     return new_notice;
 }
 
-struct xccdf_notice *xccdf_notice_new_parse(xmlTextReaderPtr reader)
+struct xccdf_notice *xccdf_notice_new_parse(xmlTextReaderPtr reader, struct xccdf_item *benchmark)
 {
     struct xccdf_notice *notice = calloc(1, sizeof(struct xccdf_notice));
     notice->id = xccdf_attribute_copy(reader, XCCDFA_ID);
-    notice->text = oscap_text_new_parse(XCCDF_TEXT_NOTICE, reader);
+    notice->text = xccdf_text_new_parse(benchmark, XCCDF_TEXT_NOTICE, reader);
     return notice;
 }
 
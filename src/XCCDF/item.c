@@ -811,10 +811,10 @@ bool xccdf_item_process_element(struct xccdf_item * item, xmlTextReaderPtr reade
         oscap_list_add(item->item.title, oscap_text_new_parse(XCCDF_TEXT_PLAINSUB, reader));
 		return true;
 	case XCCDFE_DESCRIPTION:
-        oscap_list_add(item->item.description, oscap_text_new_parse(XCCDF_TEXT_HTMLSUB, reader));
+        oscap_list_add(item->item.description, xccdf_text_new_parse(item, XCCDF_TEXT_HTMLSUB, reader));
 		return true;
 	case XCCDFE_WARNING:
-        oscap_list_add(item->item.warnings, xccdf_warning_new_parse(reader));
+        oscap_list_add(item->item.warnings, xccdf_warning_new_parse(reader, item));
 		return true;
 	case XCCDFE_REFERENCE:
         oscap_list_add(item->item.references, oscap_reference_new_parse(reader));
@@ -847,7 +847,7 @@ bool xccdf_item_process_element(struct xccdf_item * item, xmlTextReaderPtr reade
 		return true;
     }
 	case XCCDFE_RATIONALE:
-        oscap_list_add(item->item.rationale, oscap_text_new_parse(XCCDF_TEXT_HTMLSUB, reader));
+        oscap_list_add(item->item.rationale, xccdf_text_new_parse(item, XCCDF_TEXT_HTMLSUB, reader));
 		return true;
         case XCCDFE_PLATFORM:
 		xccdf_item_add_applicable_platform(item, reader);
@@ -875,6 +875,14 @@ inline struct xccdf_item* xccdf_item_get_benchmark_internal(struct xccdf_item* i
 	return (xccdf_item_get_type(item) == XCCDF_BENCHMARK ? item : NULL);
 }
 
+struct oscap_text *xccdf_text_new_parse(struct xccdf_item *item, struct oscap_text_traits traits, xmlTextReaderPtr reader)
+{
+	struct xccdf_item *bench = xccdf_item_get_benchmark_internal(item);
+	if (bench != NULL && bench->sub.benchmark.defer_texts)
+		return oscap_text_new_parse_deferred(traits, reader);
+	return oscap_text_new_parse(traits, reader);
+}
+
 #define XCCDF_BENCHGETTER(TYPE) \
 	struct xccdf_benchmark* xccdf_##TYPE##_get_benchmark(const struct xccdf_##TYPE* item) \
 	{ return XBENCHMARK(xccdf_item_get_benchmark_internal(XITEM(item))); }
@@ -1120,11 +1128,11 @@ struct xccdf_warning *xccdf_warning_new(void)
     return w;
 }
 
-struct xccdf_warning *xccdf_warning_new_parse(xmlTextReaderPtr reader)
+struct xccdf_warning *xccdf_warning_new_parse(xmlTextReaderPtr reader, struct xccdf_item *parent)
 {
     struct xccdf_warning *w = xccdf_warning_new();
     w->category = oscap_string_to_enum(XCCDF_WARNING_MAP, xccdf_attribute_get(reader, XCCDFA_CATEGORY));
-    w->text = oscap_text_new_parse(XCCDF_TEXT_HTMLSUB, reader);
+    w->text = xccdf_text_new_parse(parent, XCCDF_TEXT_HTMLSUB, reader);
     return w;
 }
 
@@ -215,6 +215,8 @@ struct xccdf_benchmark_item {
 	struct oscap_list *values;
 	struct oscap_list *content;
 	struct oscap_list *results;
+
+	bool defer_texts;	/* XHTML texts reference the DOM they were parsed from */
 };
 
 struct xccdf_item {
@@ -328,6 +330,7 @@ struct xccdf_fix {
 	xccdf_level_t complexity;
 	char *id;
 	char *content;
+	xmlNode *node;		/* source element of deferred content, NULL once serialized */
 	char *system;
 	char *platform;
 };
@@ -436,6 +439,17 @@ void xccdf_item_print(struct xccdf_item *item, int depth);
 void xccdf_item_dump(struct xccdf_item *item, int depth);
 struct xccdf_item* xccdf_item_get_benchmark_internal(struct xccdf_item* item);
 bool xccdf_benchmark_parse(struct xccdf_item *benchmark, xmlTextReaderPtr reader);
+/**
+ * Import a benchmark whose XHTML texts are serialized lazily on first access.
+ * The caller has to keep the DOM of the source alive as long as the benchmark.
+ */
+struct xccdf_benchmark *xccdf_benchmark_import_source_deferred(struct oscap_source *source);
+/**
+ * Serialize all the deferred texts of a benchmark, so that the DOM it was
+ * imported from can be freed.
+ */
+void xccdf_benchmark_materialize_texts(struct xccdf_benchmark *benchmark);
+struct oscap_text *xccdf_text_new_parse(struct xccdf_item *item, struct oscap_text_traits traits, xmlTextReaderPtr reader);
 void xccdf_benchmark_dump(struct xccdf_benchmark *benchmark);
 int xccdf_benchmark_include_tailored_profiles(struct xccdf_benchmark *benchmark);
 struct oscap_htable_iterator *xccdf_benchmark_get_cluster_items(struct xccdf_benchmark *benchmark, const char *cluster_id);
@@ -472,7 +486,7 @@ struct xccdf_item *xccdf_value_parse(xmlTextReaderPtr reader, struct xccdf_item
 struct xccdf_item *xccdf_value_new_internal(struct xccdf_item *parent, xccdf_value_type_t type);
 void xccdf_value_dump(struct xccdf_item *value, int depth);
 
-struct xccdf_notice *xccdf_notice_new_parse(xmlTextReaderPtr reader);
+struct xccdf_notice *xccdf_notice_new_parse(xmlTextReaderPtr reader, struct xccdf_item *benchmark);
 void xccdf_notice_dump(struct xccdf_notice *notice, int depth);
 
 void xccdf_status_dump(struct xccdf_status *status, int depth);
@@ -495,13 +509,13 @@ bool xccdf_check_inject_content_ref(struct xccdf_check *check, const struct xccd
 void xccdf_check_content_ref_dump(struct xccdf_check_content_ref *ref, int depth);
 struct xccdf_ident *xccdf_ident_parse(xmlTextReaderPtr reader);
 void xccdf_ident_dump(struct xccdf_ident *ident, int depth);
-struct xccdf_fix *xccdf_fix_parse(xmlTextReaderPtr reader);
-struct xccdf_fixtext *xccdf_fixtext_parse(xmlTextReaderPtr reader);
+struct xccdf_fix *xccdf_fix_parse(xmlTextReaderPtr reader, struct xccdf_item *parent);
+struct xccdf_fixtext *xccdf_fixtext_parse(xmlTextReaderPtr reader, struct xccdf_item *parent);
 
 struct xccdf_setvalue *xccdf_setvalue_new_parse(xmlTextReaderPtr reader);
 void xccdf_setvalue_dump(struct xccdf_setvalue *sv, int depth);
 
-struct xccdf_warning *xccdf_warning_new_parse(xmlTextReaderPtr reader);
+struct xccdf_warning *xccdf_warning_new_parse(xmlTextReaderPtr reader, struct xccdf_item *parent);
 
 //private methods for cloning items
 //Will clone the item member of a xccdf_item object
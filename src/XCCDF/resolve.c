@@ -67,17 +67,55 @@ static struct oscap_list *xccdf_benchmark_resolve_dependencies(void *itemptr, vo
 	return ret;
 }
 
+/* Collect items which extend another item, only these need to be resolved */
+static void xccdf_benchmark_collect_extending(struct xccdf_item *item, struct oscap_list *extending)
+{
+	if (xccdf_item_get_extends(item) != NULL)
+		oscap_list_add(extending, item);
+
+	struct xccdf_value_iterator *val_it = NULL;
+	switch (xccdf_item_get_type(item)) {
+		case XCCDF_BENCHMARK: {
+			OSCAP_FOR(xccdf_profile, profile, xccdf_benchmark_get_profiles(xccdf_item_to_benchmark(item)))
+				if (xccdf_profile_get_extends(profile) != NULL)
+					oscap_list_add(extending, profile);
+			val_it = xccdf_benchmark_get_values(xccdf_item_to_benchmark(item));
+			break;
+		}
+		case XCCDF_GROUP:
+			val_it = xccdf_group_get_values(xccdf_item_to_group(item));
+			break;
+		default: break; /* no-op */
+	}
+
+	OSCAP_FOR(xccdf_value, val, val_it)
+		if (xccdf_value_get_extends(val) != NULL)
+			oscap_list_add(extending, val);
+
+	OSCAP_FOR(xccdf_item, child, xccdf_item_get_content(item))
+		xccdf_benchmark_collect_extending(child, extending);
+}
+
 bool xccdf_benchmark_resolve(struct xccdf_benchmark *benchmark)
 {
 	struct oscap_list *resolve_order = NULL, *root_nodes = oscap_list_new();
-	oscap_list_add(root_nodes, benchmark);
 	bool ret = false;
-	
-	if (oscap_tsort(root_nodes, &resolve_order, xccdf_benchmark_resolve_dependencies, NULL, NULL)) {
+
+	/* Items without @extends resolve to themselves. Sorting only the
+	 * extending items pulls in everything they depend on, the rest of
+	 * the benchmark does not need to be visited again. */
+	xccdf_benchmark_collect_extending(XITEM(benchmark), root_nodes);
+
+	if (oscap_list_get_itemcount(root_nodes) == 0) {
+		ret = true;
+	}
+	else if (oscap_tsort(root_nodes, &resolve_order, xccdf_benchmark_resolve_dependencies, NULL, NULL)) {
 		OSCAP_FOR(xccdf_item, item, oscap_iterator_new(resolve_order))
 			xccdf_resolve_item(item, NULL);
 		ret = true;
 	}
+	if (ret)
+		xccdf_benchmark_set_resolved(benchmark, true);
 
 	oscap_list_free(root_nodes, NULL);
 	oscap_list_free(resolve_order, NULL);
@@ -1426,7 +1426,7 @@ static struct xccdf_rule_result *xccdf_rule_result_new_parse(xmlTextReaderPtr re
 			oscap_list_add(rr->instances, xccdf_instance_new_parse(reader));
 			break;
 		case XCCDFE_FIX:
-			oscap_list_add(rr->fixes, xccdf_fix_parse(reader));
+			oscap_list_add(rr->fixes, xccdf_fix_parse(reader, NULL));
 			break;
 		case XCCDFE_CHECK:
 			oscap_list_add(rr->checks, xccdf_check_parse(reader));
@@ -350,10 +350,10 @@ struct xccdf_item *xccdf_rule_parse(xmlTextReaderPtr reader, struct xccdf_item *
 				break;
 			}
 		case XCCDFE_FIX:
-			oscap_list_add(rule->sub.rule.fixes, xccdf_fix_parse(reader));
+			oscap_list_add(rule->sub.rule.fixes, xccdf_fix_parse(reader, rule));
 			break;
 		case XCCDFE_FIXTEXT:
-			oscap_list_add(rule->sub.rule.fixtexts, xccdf_fixtext_parse(reader));
+			oscap_list_add(rule->sub.rule.fixtexts, xccdf_fixtext_parse(reader, rule));
 			break;
 		case XCCDFE_IDENT:
 			oscap_list_add(rule->sub.rule.idents, xccdf_ident_parse(reader));
@@ -786,7 +786,7 @@ struct xccdf_fix *xccdf_fix_clone(const struct xccdf_fix *old_fix)
 	new_fix->complexity = old_fix->complexity;
 
 	new_fix->id = oscap_strdup(old_fix->id);
-	new_fix->content = oscap_strdup(old_fix->content);
+	new_fix->content = oscap_strdup(xccdf_fix_get_content(old_fix));
 	new_fix->system = oscap_strdup(old_fix->system);
 	new_fix->platform = oscap_strdup(old_fix->platform);
 
@@ -795,7 +795,7 @@ struct xccdf_fix *xccdf_fix_clone(const struct xccdf_fix *old_fix)
 
 
 
-struct xccdf_fix *xccdf_fix_parse(xmlTextReaderPtr reader)
+struct xccdf_fix *xccdf_fix_parse(xmlTextReaderPtr reader, struct xccdf_item *parent)
 {
 	struct xccdf_fix *fix = xccdf_fix_new();
 	fix->id = xccdf_attribute_copy(reader, XCCDFA_ID);
@@ -805,7 +805,11 @@ struct xccdf_fix *xccdf_fix_parse(xmlTextReaderPtr reader)
 	fix->strategy   = oscap_string_to_enum(XCCDF_STRATEGY_MAP, xccdf_attribute_get(reader, XCCDFA_STRATEGY));
 	fix->disruption = oscap_string_to_enum(XCCDF_LEVEL_MAP, xccdf_attribute_get(reader, XCCDFA_DISRUPTION));
 	fix->complexity = oscap_string_to_enum(XCCDF_LEVEL_MAP, xccdf_attribute_get(reader, XCCDFA_COMPLEXITY));
-	fix->content    = oscap_get_xml(reader);
+	struct xccdf_item *bench = xccdf_item_get_benchmark_internal(parent);
+	if (bench != NULL && bench->sub.benchmark.defer_texts)
+		fix->node = xmlTextReaderExpand(reader);
+	if (fix->node == NULL)
+		fix->content = oscap_get_xml(reader);
 	return fix;
 }
 
@@ -826,11 +830,11 @@ struct xccdf_fixtext * xccdf_fixtext_clone(const struct xccdf_fixtext * fixtext)
 	return clone;
 }
 
-struct xccdf_fixtext *xccdf_fixtext_parse(xmlTextReaderPtr reader)
+struct xccdf_fixtext *xccdf_fixtext_parse(xmlTextReaderPtr reader, struct xccdf_item *parent)
 {
 	struct xccdf_fixtext *fix = xccdf_fixtext_new();
 	fix->fixref = xccdf_attribute_copy(reader, XCCDFA_FIXREF);
-	fix->text = oscap_text_new_parse(XCCDF_TEXT_HTMLSUB, reader);
+	fix->text = xccdf_text_new_parse(parent, XCCDF_TEXT_HTMLSUB, reader);
 	fix->reboot     = xccdf_attribute_get_bool(reader, XCCDFA_REBOOT);
 	fix->strategy   = oscap_string_to_enum(XCCDF_STRATEGY_MAP, xccdf_attribute_get(reader, XCCDFA_STRATEGY));
 	fix->disruption = oscap_string_to_enum(XCCDF_LEVEL_MAP, xccdf_attribute_get(reader, XCCDFA_DISRUPTION));
@@ -1177,7 +1181,20 @@ OSCAP_ACCESSOR_SIMPLE(xccdf_strategy_t, xccdf_fix, strategy)
 OSCAP_ACCESSOR_SIMPLE(xccdf_level_t, xccdf_fix, disruption)
 OSCAP_ACCESSOR_SIMPLE(xccdf_level_t, xccdf_fix, complexity)
 OSCAP_ACCESSOR_SIMPLE(bool, xccdf_fix, reboot)
-OSCAP_ACCESSOR_STRING(xccdf_fix, content)
+const char *xccdf_fix_get_content(const struct xccdf_fix *fix)
+{
+	struct xccdf_fix *mutable_fix = (struct xccdf_fix *) fix;
+	oscap_get_deferred_xml(&mutable_fix->node, &mutable_fix->content);
+	return fix->content;
+}
+
+bool xccdf_fix_set_content(struct xccdf_fix *fix, const char *content)
+{
+	oscap_get_deferred_xml(&fix->node, &fix->content);
+	free(fix->content);
+	fix->content = oscap_strdup(content);
+	return true;
+}
 OSCAP_ACCESSOR_STRING(xccdf_fix, system)
 OSCAP_ACCESSOR_STRING(xccdf_fix, platform)
 OSCAP_ACCESSOR_STRING(xccdf_fix, id)
@@ -51,6 +51,7 @@
 #include "OVAL/results/oval_results_impl.h"
 #include "source/xslt_priv.h"
 #include "source/signature_priv.h"
+#include "source/validate_priv.h"
 #include "XCCDF/xccdf_impl.h"
 #include "XCCDF_POLICY/public/xccdf_policy.h"
 #include "XCCDF_POLICY/xccdf_policy_priv.h"
@@ -727,6 +728,16 @@ int xccdf_session_load(struct xccdf_session *session)
 	int ret = 0;
 
 	if (session->ds.session) {
+		if (session->xccdf.policy_model != NULL) {
+			/* The benchmark may still reference DOM of the components being freed */
+			if (session->loading_flags & XCCDF_SESSION_LOAD_XCCDF) {
+				xccdf_policy_model_free(session->xccdf.policy_model);
+				session->xccdf.policy_model = NULL;
+			}
+			else {
+				xccdf_benchmark_materialize_texts(xccdf_policy_model_get_benchmark(session->xccdf.policy_model));
+			}
+		}
 		ds_sds_session_reset(session->ds.session);
 	}
 
@@ -761,6 +772,19 @@ static int _reporter(const char *file, int line, const char *msg, void *arg)
 	return 0;
 }
 
+static bool _xccdf_session_owns_xccdf_source(struct xccdf_session *session)
+{
+	if (!xccdf_session_is_sds(session))
+		return false;
+
+	bool owned = false;
+	struct oscap_htable_iterator *it = oscap_htable_iterator_new(ds_sds_session_get_component_sources(session->ds.session));
+	while (!owned && oscap_htable_iterator_has_more(it))
+		owned = (oscap_htable_iterator_next_value(it) == session->xccdf.source);
+	oscap_htable_iterator_free(it);
+	return owned;
+}
+
 static inline int _xccdf_session_load_xccdf_benchmark(struct xccdf_session *session)
 {
 	if (session->xccdf.policy_model != NULL) {
@@ -779,8 +803,12 @@ static inline int _xccdf_session_load_xccdf_benchmark(struct xccdf_session *sess
 		}
 	}
 
-	/* Load XCCDF model and XCCDF Policy model */
-	struct xccdf_benchmark *benchmark = xccdf_benchmark_import_source(session->xccdf.source);
+	/* Load XCCDF model and XCCDF Policy model. The components of a datastream
+	 * stay parsed until the session is freed or reloaded, so rich texts of
+	 * the benchmark can be serialized only when somebody asks for them. */
+	struct xccdf_benchmark *benchmark = _xccdf_session_owns_xccdf_source(session) ?
+		xccdf_benchmark_import_source_deferred(session->xccdf.source) :
+		xccdf_benchmark_import_source(session->xccdf.source);
 	if (benchmark == NULL) {
 		return 1;
 	}
@@ -1188,14 +1216,28 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 	 * or if full validation was explicitly requested.
 	 */
 	if (session->validate && (!xccdf_session_is_sds(session) || session->full_validation)) {
-		for (int idx=0; contents[idx]; idx++) {
-			if (oscap_source_validate(contents[idx]->source, _reporter, NULL) != 0) {
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
-						oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
-						oscap_source_get_schema_version(session->source),
-						contents[idx]->href);
-				return 1;
-			}
+		size_t count = 0;
+		while (contents[count])
+			count++;
+		struct oscap_source **sources = malloc(count * sizeof(struct oscap_source *));
+		if (sources == NULL && count > 0) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for validation of OVAL files.");
+			return 1;
+		}
+		for (size_t idx = 0; idx < count; idx++)
+			sources[idx] = contents[idx]->source;
+		/* OVAL files are independent of each other, validate them in parallel */
+		size_t invalid;
+		int ret = oscap_source_validate_all_priv(sources, count, _reporter, NULL, &invalid);
+		free(sources);
+		if (ret < 0)
+			return 1;
+		if (ret > 0) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
+					oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
+					oscap_source_get_schema_version(session->source),
+					contents[invalid]->href);
+			return 1;
 		}
 	}
 
@@ -160,6 +160,63 @@ char *xccdf_policy_get_readable_item_description(struct xccdf_policy *policy, st
 	return plaintext;
 }
 
+/**
+ * Index set-values and refine-values of the policy profile by value-id,
+ * the *LAST* one in the profile wins. Refine-values are indexed by the
+ * *FIRST* one too, for xccdf_policy_get_value_of_item. The index is rebuilt when the
+ * profile got new values since it was built, eg. through
+ * xccdf_profile_add_setvalue, or when it is forced to.
+ */
+static void xccdf_policy_index_profile_values(struct xccdf_policy *policy, bool force)
+{
+	struct xccdf_profile *profile = xccdf_policy_get_profile(policy);
+	if (profile == NULL)
+		return;
+
+	struct oscap_list *setvalues = XITEM(profile)->sub.profile.setvalues;
+	struct oscap_list *refine_values = XITEM(profile)->sub.profile.refine_values;
+	if (!force && policy->indexed_setvalues == setvalues && policy->indexed_refine_values == refine_values &&
+			policy->indexed_setvalues_generation == oscap_list_get_generation(setvalues) &&
+			policy->indexed_refine_values_generation == oscap_list_get_generation(refine_values))
+		return;
+
+	oscap_htable_free0(policy->setvalues_internal);
+	oscap_htable_free0(policy->refine_values_internal);
+	oscap_htable_free0(policy->first_refine_values_internal);
+	policy->setvalues_internal = oscap_htable_new();
+	policy->refine_values_internal = oscap_htable_new();
+	policy->first_refine_values_internal = oscap_htable_new();
+
+	struct xccdf_setvalue_iterator *s_value_it = xccdf_profile_get_setvalues(profile);
+	while (xccdf_setvalue_iterator_has_more(s_value_it)) {
+		struct xccdf_setvalue *s_value = xccdf_setvalue_iterator_next(s_value_it);
+		const char *id = xccdf_setvalue_get_item(s_value);
+		if (id == NULL)
+			continue;
+		oscap_htable_detach(policy->setvalues_internal, id);
+		oscap_htable_add(policy->setvalues_internal, id, s_value);
+	}
+	xccdf_setvalue_iterator_free(s_value_it);
+
+	struct xccdf_refine_value_iterator *r_value_it = xccdf_profile_get_refine_values(profile);
+	while (xccdf_refine_value_iterator_has_more(r_value_it)) {
+		struct xccdf_refine_value *r_value = xccdf_refine_value_iterator_next(r_value_it);
+		const char *id = xccdf_refine_value_get_item(r_value);
+		if (id == NULL)
+			continue;
+		oscap_htable_detach(policy->refine_values_internal, id);
+		oscap_htable_add(policy->refine_values_internal, id, r_value);
+		/* fails for all but the first refine-value of the value-id */
+		oscap_htable_add(policy->first_refine_values_internal, id, r_value);
+	}
+	xccdf_refine_value_iterator_free(r_value_it);
+
+	policy->indexed_setvalues = setvalues;
+	policy->indexed_refine_values = refine_values;
+	policy->indexed_setvalues_generation = oscap_list_get_generation(setvalues);
+	policy->indexed_refine_values_generation = oscap_list_get_generation(refine_values);
+}
+
 /**
  * Get last setvalue from policy that match specified id
  */
@@ -172,30 +229,14 @@ static struct xccdf_setvalue * xccdf_policy_get_setvalue(struct xccdf_policy * p
     if (id == NULL) return NULL;
     if (policy == NULL) return NULL;
 
-    struct xccdf_setvalue_iterator  * s_value_it;
-    struct xccdf_setvalue           * s_value;
-    struct xccdf_profile            * profile = xccdf_policy_get_profile(policy);;
-
-    /* If profile is NULL we don't have setvalue's
-     * and we return NULL, otherwise we could cause SIGSEG
-     * with accessing NULL structure
-     */
-    if (profile == NULL) return NULL;
-
-    /* We need to return *LAST* setvalue in Profile.
-     * and iterate to the end of setvalue list
-     */
-    struct xccdf_setvalue * final = NULL;
-    s_value_it = xccdf_profile_get_setvalues(profile);
-    while (xccdf_setvalue_iterator_has_more(s_value_it)) {
-        s_value = xccdf_setvalue_iterator_next(s_value_it);
-        if (!strcmp(id, xccdf_setvalue_get_item(s_value))) {
-            final = s_value;
-        }
+    xccdf_policy_index_profile_values(policy, false);
+    struct xccdf_setvalue *s_value = oscap_htable_get(policy->setvalues_internal, id);
+    if (s_value != NULL && oscap_strcmp(xccdf_setvalue_get_item(s_value), id) != 0) {
+        /* The value-id of the set-value was changed after it was indexed */
+        xccdf_policy_index_profile_values(policy, true);
+        s_value = oscap_htable_get(policy->setvalues_internal, id);
     }
-    xccdf_setvalue_iterator_free(s_value_it);
-
-    return final;
+    return s_value;
 }
 
 static struct xccdf_refine_value * xccdf_policy_get_refine_value(struct xccdf_policy * policy, const char * id)
@@ -207,30 +248,32 @@ static struct xccdf_refine_value * xccdf_policy_get_refine_value(struct xccdf_po
     if (id == NULL) return NULL;
     if (policy == NULL) return NULL;
 
-    struct xccdf_refine_value_iterator  * r_value_it;
-    struct xccdf_refine_value           * r_value;
-    struct xccdf_profile            * profile = xccdf_policy_get_profile(policy);;
+    xccdf_policy_index_profile_values(policy, false);
+    struct xccdf_refine_value *r_value = oscap_htable_get(policy->refine_values_internal, id);
+    if (r_value != NULL && oscap_strcmp(xccdf_refine_value_get_item(r_value), id) != 0) {
+        /* The value-id of the refine-value was changed after it was indexed */
+        xccdf_policy_index_profile_values(policy, true);
+        r_value = oscap_htable_get(policy->refine_values_internal, id);
+    }
+    return r_value;
+}
 
-    /* If profile is NULL we don't have setvalue's
-     * and we return NULL, otherwise we could cause SIGSEG
-     * with accessing NULL structure
-     */
-    if (profile == NULL) return NULL;
+/**
+ * Get first refine-value from policy that match specified id
+ */
+static struct xccdf_refine_value * xccdf_policy_get_first_refine_value(struct xccdf_policy * policy, const char * id)
+{
+    if (id == NULL) return NULL;
+    if (policy == NULL) return NULL;
 
-    /* We need to return *LAST* setvalue in Profile.
-     * and iterate to the end of setvalue list
-     */
-    struct xccdf_refine_value * final = NULL;
-    r_value_it = xccdf_profile_get_refine_values(profile);
-    while (xccdf_refine_value_iterator_has_more(r_value_it)) {
-        r_value = xccdf_refine_value_iterator_next(r_value_it);
-        if (!strcmp(id, xccdf_refine_value_get_item(r_value))) {
-            final = r_value;
-        }
+    xccdf_policy_index_profile_values(policy, false);
+    struct xccdf_refine_value *r_value = oscap_htable_get(policy->first_refine_values_internal, id);
+    if (r_value != NULL && oscap_strcmp(xccdf_refine_value_get_item(r_value), id) != 0) {
+        /* The value-id of the refine-value was changed after it was indexed */
+        xccdf_policy_index_profile_values(policy, true);
+        r_value = oscap_htable_get(policy->first_refine_values_internal, id);
     }
-    xccdf_refine_value_iterator_free(r_value_it);
-
-    return final;
+    return r_value;
 }
 
 /**
@@ -1880,6 +1923,9 @@ struct xccdf_policy * xccdf_policy_new(struct xccdf_policy_model * model, struct
 	policy->selected_internal = oscap_htable_new();
 	policy->selected_final = oscap_htable_new();
 	policy->refine_rules_internal = oscap_htable_new();
+	policy->setvalues_internal = oscap_htable_new();
+	policy->refine_values_internal = oscap_htable_new();
+	policy->first_refine_values_internal = oscap_htable_new();
 	policy->model = model;
 
 	benchmark = xccdf_policy_model_get_benchmark(model);
@@ -2188,28 +2234,15 @@ const char *xccdf_policy_get_value_of_item(struct xccdf_policy * policy, struct
 
 	if (profile != NULL) {
 		/* Get set_value for this item */
-		struct xccdf_setvalue *s_value = NULL;
-		struct xccdf_setvalue *last_s_value = NULL;
-		struct xccdf_setvalue_iterator *s_value_it = xccdf_profile_get_setvalues(profile);
-		while (xccdf_setvalue_iterator_has_more(s_value_it)) {
-			s_value = xccdf_setvalue_iterator_next(s_value_it);
-			if (strcmp(xccdf_setvalue_get_item(s_value), xccdf_value_get_id((struct xccdf_value *) item)) == 0)
-				last_s_value = s_value;
-		}
-		xccdf_setvalue_iterator_free(s_value_it);
-		if (last_s_value != NULL)
-			return xccdf_setvalue_get_value(last_s_value);
-
-		/* We don't have set-value in profile, look for refine-value */
-		struct xccdf_refine_value_iterator *r_value_it = xccdf_profile_get_refine_values(profile);
-		while (xccdf_refine_value_iterator_has_more(r_value_it)) {
-			struct xccdf_refine_value *r_value = xccdf_refine_value_iterator_next(r_value_it);
-			if (!strcmp(xccdf_refine_value_get_item(r_value), xccdf_value_get_id((struct xccdf_value *) item))) {
-				selector = xccdf_refine_value_get_selector(r_value);
-				break;
-			}
-		}
-		xccdf_refine_value_iterator_free(r_value_it);
+		const char *value_id = xccdf_value_get_id((struct xccdf_value *) item);
+		struct xccdf_setvalue *s_value = xccdf_policy_get_setvalue(policy, value_id);
+		if (s_value != NULL)
+			return xccdf_setvalue_get_value(s_value);
+
+		/* We don't have set-value in profile, look for the first refine-value */
+		struct xccdf_refine_value *r_value = xccdf_policy_get_first_refine_value(policy, value_id);
+		if (r_value != NULL)
+			selector = xccdf_refine_value_get_selector(r_value);
 	}
 
 	struct xccdf_value_instance *instance = xccdf_value_get_instance_by_selector((struct xccdf_value *) item, selector);
@@ -2278,6 +2311,9 @@ void xccdf_policy_free(struct xccdf_policy * policy) {
 	oscap_htable_free0(policy->selected_internal);
 	oscap_htable_free0(policy->selected_final);
 	oscap_htable_free(policy->refine_rules_internal, (oscap_destruct_func) xccdf_refine_rule_internal_free);
+	oscap_htable_free0(policy->setvalues_internal);
+	oscap_htable_free0(policy->refine_values_internal);
+	oscap_htable_free0(policy->first_refine_values_internal);
         free(policy);
 }
 
@@ -72,6 +72,16 @@ struct xccdf_policy {
 	struct oscap_htable		*selected_final;
 	/* The hash-table contains the latest refine-rule for specified item-id. */
 	struct oscap_htable		*refine_rules_internal;
+	/* The hash-tables contain the latest set-value and refine-value of the profile for specified value-id.
+	 * They are built on first lookup and rebuilt whenever the lists of the profile change. */
+	struct oscap_htable		*setvalues_internal;
+	struct oscap_htable		*refine_values_internal;
+	/* The hash-table contains the first refine-value of the profile for specified value-id. */
+	struct oscap_htable		*first_refine_values_internal;
+	struct oscap_list		*indexed_setvalues;
+	struct oscap_list		*indexed_refine_values;
+	unsigned int			indexed_setvalues_generation;
+	unsigned int			indexed_refine_values_generation;
 };
 
 
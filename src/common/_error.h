@@ -58,4 +58,27 @@ struct oscap_err_t {
 __attribute__((format (printf, 5, 6)))
 void __oscap_seterr(const char *file, uint32_t line, const char *func, oscap_errfamily_t family, const char *fmt, ...);
 
+struct err_queue;
+
+/**
+ * Take over the error queue of the calling thread.
+ * The thread is left with an empty queue. This is used to carry errors
+ * raised in worker threads over to the thread which started them.
+ * @returns the detached queue or NULL if there were no errors
+ */
+struct err_queue *oscap_err_detach_queue(void);
+
+/**
+ * Append all errors of a previously detached queue to the error queue
+ * of the calling thread and dispose the detached queue.
+ * @param queue queue returned by oscap_err_detach_queue, may be NULL
+ */
+void oscap_err_attach_queue(struct err_queue *queue);
+
+/**
+ * Dispose a previously detached queue together with its errors.
+ * @param queue queue returned by oscap_err_detach_queue, may be NULL
+ */
+void oscap_err_free_queue(struct err_queue *queue);
+
 #endif				/* _OSCAP_ERROR_H */
@@ -28,6 +28,9 @@
 #include <config.h>
 #endif
 
+#ifdef OSCAP_THREAD_SAFE
+#include <pthread.h>
+#endif
 #include <string.h>
 #include <fcntl.h>
 #ifdef OS_WINDOWS
@@ -163,6 +166,40 @@ char *oscap_get_xml(xmlTextReaderPtr reader)
 	return (char *)xmlTextReaderReadInnerXml(reader);
 }
 
+#ifdef OSCAP_THREAD_SAFE
+/* Guards serialization of deferred nodes, which may be shared by threads */
+static pthread_mutex_t deferred_xml_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* Same serialization as xmlTextReaderReadInnerXml() */
+static char *_oscap_node_inner_xml(xmlNode *node)
+{
+	xmlBuffer *buff = xmlBufferCreate();
+	for (xmlNode *cur = node->children; cur != NULL; cur = cur->next) {
+		xmlNode *copy = xmlDocCopyNode(cur, node->doc, 1);
+		xmlNodeDump(buff, node->doc, copy, 0, 0);
+		xmlFreeNode(copy);
+	}
+	char *xml = (char *) xmlBufferDetach(buff);
+	xmlBufferFree(buff);
+	return xml;
+}
+
+void oscap_get_deferred_xml(xmlNode **node, char **xml)
+{
+#ifdef OSCAP_THREAD_SAFE
+	pthread_mutex_lock(&deferred_xml_lock);
+#endif
+	/* A NULL node marks materialized content */
+	if (*node != NULL) {
+		*xml = _oscap_node_inner_xml(*node);
+		*node = NULL;
+	}
+#ifdef OSCAP_THREAD_SAFE
+	pthread_mutex_unlock(&deferred_xml_lock);
+#endif
+}
+
 time_t oscap_get_date(const char *date)
 {
 	if (date) {
@@ -53,6 +53,12 @@ const char *oscap_element_string_get(xmlTextReaderPtr reader);
 int oscap_element_depth(xmlTextReaderPtr reader);
 /// get xml content of current element as a string
 char *oscap_get_xml(xmlTextReaderPtr reader);
+/**
+ * Serialize the content of a node kept for later, the same way as
+ * oscap_get_xml() does, into *xml and reset *node. Nothing is done if
+ * *node is NULL already, so it is safe to be called by several threads.
+ */
+void oscap_get_deferred_xml(xmlNode **node, char **xml);
 /// get date from a string
 time_t oscap_get_date(const char *date);
 /// get datetime from a string
@@ -56,6 +56,7 @@ bool oscap_list_add(struct oscap_list * list, void *value)
 	item->next = NULL;
 	item->data = value;
 	++list->itemcount;
+	++list->generation;
 
 	if (list->last == NULL)
 		list->first = list->last = item;
@@ -75,6 +76,7 @@ bool oscap_list_prepend(struct oscap_list * list, void *value)
 	item->next = NULL;
 	item->data = value;
 	++list->itemcount;
+	++list->generation;
 
 	if (list->first == NULL) {
 		list->last = list->first = item;
@@ -108,6 +110,7 @@ bool oscap_list_pop(struct oscap_list *list, oscap_destruct_func destructor)
 	else list->first = NULL;
 
 	--list->itemcount;
+	++list->generation;
 
 	return true;
 }
@@ -135,6 +138,7 @@ bool oscap_list_remove(struct oscap_list *list, void *value, oscap_cmp_func comp
 		free(cur);
 
 		--list->itemcount;
+		++list->generation;
 		return true;
 	}
 
@@ -167,6 +171,7 @@ struct oscap_list *oscap_list_destructive_join(struct oscap_list *list1, struct
 	else list1->last->next = list2->first;
 	if (list2->last != NULL) list1->last = list2->last;
 	list1->itemcount += list2->itemcount;
+	++list1->generation;
 	free(list2);
 	return list1;
 }
@@ -177,6 +182,12 @@ int oscap_list_get_itemcount(struct oscap_list *list)
 	return list->itemcount;
 }
 
+unsigned int oscap_list_get_generation(struct oscap_list *list)
+{
+	__attribute__nonnull__(list);
+	return list->generation;
+}
+
 void oscap_list_free(struct oscap_list *list, oscap_destruct_func destructor)
 {
 	struct oscap_list_item *item, *to_del;
@@ -316,6 +327,7 @@ void *oscap_iterator_detach(struct oscap_iterator *it)
 
 	free(item);
 	--it->list->itemcount;
+	++it->list->generation;
 	return value;
 }
 
@@ -54,6 +54,7 @@ struct oscap_list {
 	struct oscap_list_item *first;
 	struct oscap_list_item *last;
 	size_t itemcount;
+	unsigned int generation;	// Changed by every insertion and removal.
 };
 
 // FIXME: SCE engine uses these
@@ -70,6 +71,7 @@ void oscap_list_free(struct oscap_list *list, oscap_destruct_func destructor);
 void oscap_list_free0(struct oscap_list *list);
 void oscap_list_dump(struct oscap_list *list, oscap_dump_func dumper, int depth);
 int oscap_list_get_itemcount(struct oscap_list *list);
+unsigned int oscap_list_get_generation(struct oscap_list *list);
 bool oscap_list_contains(struct oscap_list *list, void *what, oscap_cmp_func compare);
 struct oscap_list *oscap_list_destructive_join(struct oscap_list *list1, struct oscap_list *list2);
 
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <pthread.h>
+#include <stdlib.h>
+#ifndef OS_WINDOWS
+#include <unistd.h>
+#endif
+
+#include "_error.h"
+#include "debug_priv.h"
+#include "oscap_parallel.h"
+
+struct oscap_parallel_ctx {
+	pthread_mutex_t lock;
+	size_t next;
+	size_t count;
+	oscap_parallel_job_func func;
+	void *arg;
+	struct err_queue **errors;
+};
+
+unsigned int oscap_parallel_max_threads(void)
+{
+	const char *env = getenv("OSCAP_MAX_THREADS");
+	if (env != NULL) {
+		char *endptr = NULL;
+		long value = strtol(env, &endptr, 10);
+		if (endptr != env && *endptr == '\0' && value > 0)
+			return (unsigned int) value;
+		dW("Ignoring invalid value of OSCAP_MAX_THREADS: '%s'", env);
+	}
+#if defined(_SC_NPROCESSORS_ONLN)
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus > 0)
+		return (unsigned int) cpus;
+#endif
+	return 1;
+}
+
+static void *_oscap_parallel_worker(void *arg)
+{
+	struct oscap_parallel_ctx *ctx = (struct oscap_parallel_ctx *) arg;
+
+	for (;;) {
+		pthread_mutex_lock(&ctx->lock);
+		size_t index = ctx->next++;
+		pthread_mutex_unlock(&ctx->lock);
+
+		if (index >= ctx->count)
+			break;
+
+		ctx->func(index, ctx->arg);
+		ctx->errors[index] = oscap_err_detach_queue();
+	}
+	return NULL;
+}
+
+int oscap_parallel_run(size_t count, oscap_parallel_job_func func, void *arg)
+{
+	if (count == 0)
+		return 0;
+
+	size_t threads = oscap_parallel_max_threads();
+	if (threads > count)
+		threads = count;
+
+	struct oscap_parallel_ctx ctx = {
+		.next = 0,
+		.count = count,
+		.func = func,
+		.arg = arg,
+		.errors = calloc(count, sizeof(struct err_queue *))
+	};
+	if (ctx.errors == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for %zu parallel jobs.", count);
+		return -1;
+	}
+	pthread_t *tids = NULL;
+	if (threads > 1) {
+		tids = malloc((threads - 1) * sizeof(pthread_t));
+		if (tids == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for %zu worker threads.", threads - 1);
+			free(ctx.errors);
+			return -1;
+		}
+	}
+	pthread_mutex_init(&ctx.lock, NULL);
+
+	/* Errors raised before the run have to stay in front of the job errors */
+	struct err_queue *previous = oscap_err_detach_queue();
+
+	/* The calling thread is one of the workers */
+	size_t started = 0;
+	for (; started + 1 < threads; ++started) {
+		if (pthread_create(&tids[started], NULL, _oscap_parallel_worker, &ctx) != 0) {
+			dW("Failed to start a worker thread, continuing with %zu threads.", started + 1);
+			break;
+		}
+	}
+	dD("Running %zu jobs in %zu threads.", count, started + 1);
+
+	_oscap_parallel_worker(&ctx);
+	for (size_t i = 0; i < started; ++i)
+		pthread_join(tids[i], NULL);
+
+	oscap_err_attach_queue(previous);
+	for (size_t i = 0; i < count; ++i)
+		oscap_err_attach_queue(ctx.errors[i]);
+
+	pthread_mutex_destroy(&ctx.lock);
+	free(ctx.errors);
+	free(tids);
+	return 0;
+}
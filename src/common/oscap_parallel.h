@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef OSCAP_PARALLEL_H
+#define OSCAP_PARALLEL_H
+
+#include <stddef.h>
+
+/*
+ * Job callback of a parallel run. The index identifies the job, callers
+ * are expected to store the job results into preallocated slots and to
+ * process them in index order once oscap_parallel_run returns.
+ */
+typedef void (*oscap_parallel_job_func)(size_t index, void *arg);
+
+/*
+ * Get the maximal number of worker threads used for a parallel run.
+ * The value can be overridden by the OSCAP_MAX_THREADS environment
+ * variable, otherwise the number of online CPUs is used.
+ */
+unsigned int oscap_parallel_max_threads(void);
+
+/*
+ * Run jobs 0 .. count - 1 in a pool of worker threads and wait until all
+ * of them are finished. Every job starts with an empty error queue, errors
+ * left in it are moved to the error queue of the calling thread in job
+ * order. Jobs are run sequentially in the calling thread if only a single
+ * worker is available.
+ * @return 0 on success, -1 if the run couldn't be set up and no job was run
+ */
+int oscap_parallel_run(size_t count, oscap_parallel_job_func func, void *arg);
+
+#endif
@@ -48,7 +48,29 @@ const struct oscap_text_traits OSCAP_TEXT_TRAITS_PLAIN = { .html = false };
 const struct oscap_text_traits OSCAP_TEXT_TRAITS_HTML  = { .html = true };
 
 
-OSCAP_ACCESSOR_STRING(oscap_text, text)
+void oscap_text_materialize(const struct oscap_text *text)
+{
+	if (!text->deferred)
+		return;
+
+	struct oscap_text *mutable_text = (struct oscap_text *) text;
+	oscap_get_deferred_xml(&mutable_text->node, &mutable_text->text);
+}
+
+const char *oscap_text_get_text(const struct oscap_text *text)
+{
+	oscap_text_materialize(text);
+	return text->text;
+}
+
+bool oscap_text_set_text(struct oscap_text *text, const char *string)
+{
+	oscap_text_materialize(text);
+	free(text->text);
+	text->text = oscap_strdup(string);
+	return true;
+}
+
 OSCAP_ACCESSOR_STRING(oscap_text, lang)
 OSCAP_GENERIC_GETTER(bool, oscap_text, is_html, traits.html)
 OSCAP_GENERIC_GETTER(bool, oscap_text, can_substitute, traits.can_substitute)
@@ -91,6 +113,7 @@ struct oscap_text *oscap_text_new(void)
 
 struct oscap_text * oscap_text_clone(const struct oscap_text * text)
 {
+    oscap_text_materialize(text);
     return oscap_text_new_full(text->traits, text->text, text->lang);   
 }
 
@@ -100,7 +123,7 @@ struct oscap_text *oscap_text_new_html(void)
     return oscap_text_new_full(OSCAP_TEXT_TRAITS_HTML, NULL, NULL);
 }
 
-struct oscap_text *oscap_text_new_parse(struct oscap_text_traits traits, xmlTextReaderPtr reader)
+static struct oscap_text *_oscap_text_new_parse(struct oscap_text_traits traits, xmlTextReaderPtr reader, bool deferred)
 {
     assert(reader != NULL);
 
@@ -120,18 +143,35 @@ struct oscap_text *oscap_text_new_parse(struct oscap_text_traits traits, xmlText
     xmlTextReaderMoveToElement(reader);
 
     // extract content
-    if (text->traits.html || text->traits.can_substitute)
-		text->text = oscap_get_xml(reader);
+    if (text->traits.html || text->traits.can_substitute) {
+		if (deferred) {
+			text->deferred = true;
+			text->node = xmlTextReaderExpand(reader);
+		}
+		if (text->node == NULL)
+			text->text = oscap_get_xml(reader);
+    }
     else text->text = oscap_element_string_copy(reader);
 
     return text;
 }
 
+struct oscap_text *oscap_text_new_parse(struct oscap_text_traits traits, xmlTextReaderPtr reader)
+{
+	return _oscap_text_new_parse(traits, reader, false);
+}
+
+struct oscap_text *oscap_text_new_parse_deferred(struct oscap_text_traits traits, xmlTextReaderPtr reader)
+{
+	return _oscap_text_new_parse(traits, reader, true);
+}
+
 xmlNode *oscap_text_to_dom(struct oscap_text *text, xmlNode *parent, const char *elname)
 {
 	if (!text) return NULL;
 
 	xmlNode *text_node = NULL;
+	oscap_text_materialize(text);
 
 	if (text->traits.html || text->traits.can_substitute) {
 		text_node = oscap_xmlstr_to_dom(parent, elname, text->text);
@@ -158,6 +198,7 @@ bool oscap_text_export(struct oscap_text *text, xmlTextWriter *writer, const cha
 {
 	if (text == NULL || writer == NULL) return false;
 
+	oscap_text_materialize(text);
 	if (elname) xmlTextWriterStartElement(writer, BAD_CAST elname);
 
 	if (text->lang)
@@ -201,6 +242,7 @@ char *oscap_text_get_plaintext(const struct oscap_text *text)
 {
     if (text == NULL) return NULL;
 
+    oscap_text_materialize(text);
     if (!text->traits.html) return oscap_strdup(text->text);
 
 	return _xhtml_to_plaintext(text->text);
@@ -47,6 +47,8 @@ struct oscap_text {
 	char *lang;
 	char *text;
     struct oscap_text_traits traits;
+	bool deferred;      ///< content is serialized from node on first access
+	xmlNode *node;      ///< source element of a deferred text, NULL once materialized
 };
 
 struct oscap_list;
@@ -69,6 +71,19 @@ struct oscap_text *oscap_text_new_full(struct oscap_text_traits traits, const ch
  */
 struct oscap_text *oscap_text_new_parse(struct oscap_text_traits traits, xmlTextReaderPtr reader);
 
+/**
+ * Like oscap_text_new_parse, but XHTML content is not serialized until
+ * it is accessed for the first time. The reader has to walk a DOM tree
+ * which has to outlive the returned text.
+ */
+struct oscap_text *oscap_text_new_parse_deferred(struct oscap_text_traits traits, xmlTextReaderPtr reader);
+
+/**
+ * Serialize the content of a deferred text now, eg. because the DOM it was
+ * parsed from is going to be freed.
+ */
+void oscap_text_materialize(const struct oscap_text *text);
+
 xmlNode *oscap_text_to_dom(struct oscap_text *text, xmlNode *parent, const char *elname);
 bool oscap_text_export(struct oscap_text *text, xmlTextWriter *writer, const char *elname);
 bool oscap_textlist_export(struct oscap_text_iterator *texts, xmlTextWriter *writer, const char *elname);
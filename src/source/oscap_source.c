@@ -75,6 +75,7 @@ struct oscap_source {
 	struct {
 		xmlDoc *doc;                            /// DOM
 	} xml;
+	bool streaming;                                 ///< Prefer reading the file to building the DOM
 };
 
 struct oscap_source *oscap_source_new_from_file(const char *filepath)
@@ -173,6 +174,59 @@ const char *oscap_source_readable_origin(const struct oscap_source *source)
 	return source->origin.filepath;
 }
 
+static void xmlReaderErrorCb(void *user, xmlErrorPtr error)
+{
+	if (error != NULL && error->level >= XML_ERR_ERROR)
+		oscap_setxmlerr(error);
+}
+
+static void xmlReaderQuietErrorCb(void *user, xmlErrorPtr error)
+{
+	/* The caller falls back to the DOM parser which reports the errors */
+}
+
+/**
+ * Create an xmlTextReader parsing the file the source originates from, so
+ * that the content can be read without building its DOM. Returns NULL if the
+ * DOM is already available or the source isn't a plain XML file.
+ */
+static xmlTextReader *_oscap_source_new_file_reader(struct oscap_source *source, void (*error_cb)(void *, xmlErrorPtr))
+{
+	if (source->xml.doc != NULL || source->origin.type != OSCAP_SRC_FROM_USER_XML_FILE)
+		return NULL;
+
+	int fd = open(source->origin.filepath, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+	bool is_bzip = bz2_fd_is_bzip(fd);
+	close(fd);
+	if (is_bzip)
+		return NULL;
+
+	xmlTextReader *reader = xmlReaderForFile(source->origin.filepath, NULL, 0);
+	if (reader != NULL)
+		xmlTextReaderSetStructuredErrorHandler(reader, (xmlStructuredErrorFunc) error_cb, source);
+	return reader;
+}
+
+void oscap_source_set_streaming(struct oscap_source *source, bool streaming)
+{
+	source->streaming = streaming;
+}
+
+bool oscap_source_get_streaming(const struct oscap_source *source)
+{
+	return source->streaming;
+}
+
+xmlTextReader *oscap_source_get_streaming_xmlTextReader(struct oscap_source *source)
+{
+	xmlTextReader *reader = _oscap_source_new_file_reader(source, xmlReaderErrorCb);
+	if (reader == NULL)
+		reader = oscap_source_get_xmlTextReader(source);
+	return reader;
+}
+
 xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 {
 	xmlDoc *doc = oscap_source_get_xmlDoc(source);
@@ -187,8 +241,36 @@ xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 	return reader;
 }
 
+/**
+ * Determine the document type from the root element read directly from the
+ * file, large documents don't need to be parsed into DOM just to find out
+ * what they are. Malformed documents are left to the DOM parser.
+ */
+static void _oscap_source_peek_scap_type(struct oscap_source *source)
+{
+	xmlTextReader *reader = _oscap_source_new_file_reader(source, xmlReaderQuietErrorCb);
+	if (reader == NULL)
+		return;
+	int ret;
+	while ((ret = xmlTextReaderRead(reader)) == 1
+	       && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT);
+	xmlFreeTextReader(reader);
+	if (ret != 1)
+		return;
+
+	/* the root element can be read, so the reader below doesn't fail before it */
+	reader = _oscap_source_new_file_reader(source, xmlReaderQuietErrorCb);
+	if (reader == NULL)
+		return;
+	if (oscap_determine_document_type_reader(reader, &(source->scap_type)) == -1)
+		source->scap_type = OSCAP_DOCUMENT_UNKNOWN;
+	xmlFreeTextReader(reader);
+}
+
 oscap_document_type_t oscap_source_get_scap_type(struct oscap_source *source)
 {
+	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN)
+		_oscap_source_peek_scap_type(source);
 	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN) {
 		xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
 		if (reader == NULL) {
@@ -396,7 +478,11 @@ int oscap_source_validate_schematron(struct oscap_source *source, const char *ou
 const char *oscap_source_get_schema_version(struct oscap_source *source)
 {
 	if (source->origin.version == NULL) {
-		xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
+		/* the version is found at the beginning of the document */
+		xmlTextReader *reader = source->streaming ?
+			_oscap_source_new_file_reader(source, xmlReaderQuietErrorCb) : NULL;
+		if (reader == NULL)
+			reader = oscap_source_get_xmlTextReader(source);
 		if (reader == NULL) {
 			return NULL;
 		}
@@ -67,6 +67,35 @@ struct oscap_source *oscap_source_new_from_xmlDoc(xmlDoc *doc, const char *filep
  */
 xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source);
 
+/**
+ * Set whether the content of this resource is going to be read by
+ * \ref oscap_source_get_streaming_xmlTextReader only. The validation
+ * then reads the file too, instead of building the DOM.
+ * @memberof oscap_source
+ * @param source Resource
+ * @param streaming true to avoid building the DOM
+ */
+void oscap_source_set_streaming(struct oscap_source *source, bool streaming);
+
+/**
+ * Whether the content of this resource is read without building the DOM.
+ * @memberof oscap_source
+ * @param source Resource
+ * @returns true if streaming has been set
+ */
+bool oscap_source_get_streaming(const struct oscap_source *source);
+
+/**
+ * Get an xmlTextReader which parses the file this resource originates from
+ * while reading, without building the DOM. Falls back to \ref
+ * oscap_source_get_xmlTextReader if the DOM is already built or the resource
+ * isn't a plain XML file. The reader needs to be disposed by caller.
+ * @memberof oscap_source
+ * @param source Resource to read the content
+ * @returns xmlTextReader structure to read the content
+ */
+xmlTextReader *oscap_source_get_streaming_xmlTextReader(struct oscap_source *source);
+
 /**
  * Get a DOM representation of this resource. The document ins still owned
  * by oscap_source.
@@ -22,6 +22,7 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
 #include <string.h>
 #ifdef OS_WINDOWS
 #include <io.h>
@@ -34,6 +35,7 @@
 #include "common/_error.h"
 #include "common/debug_priv.h"
 #include "common/list.h"
+#include "common/oscap_parallel.h"
 #include "common/util.h"
 #include "ds_sds_session.h"
 #include "DS/ds_sds_session_priv.h"
@@ -110,6 +112,42 @@ struct oscap_schema_table_entry OSCAP_SCHEMATRON_TABLE[] = {
 	{OSCAP_DOCUMENT_SDS,                    "1.3",          "sds/1.3/source-data-stream-1.3.xsl"}
 };
 
+struct sds_component_validation {
+	struct oscap_source *source;
+	FILE *output;
+	int result;
+};
+
+static void _validate_sds_component_job(size_t index, void *arg)
+{
+	struct sds_component_validation *validation = ((struct sds_component_validation *) arg) + index;
+	struct oscap_source *cs = validation->source;
+
+	/* Components are validated in parallel, each of them writes into its own buffer */
+	validation->output = tmpfile();
+	if (validation->output == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't create temporary file for schematron validation of '%s': %s",
+			oscap_source_readable_origin(cs), strerror(errno));
+		validation->result = -1;
+		return;
+	}
+	validation->result = oscap_source_validate_schematron_priv(cs,
+		oscap_source_get_scap_type(cs),
+		oscap_source_get_schema_version(cs),
+		validation->output);
+}
+
+static void _copy_validation_output(FILE *from, FILE *to)
+{
+	char buffer[4096];
+	size_t size;
+
+	rewind(from);
+	while ((size = fread(buffer, 1, sizeof(buffer), from)) > 0) {
+		fwrite(buffer, 1, size, to);
+	}
+}
+
 static int _validate_sds_components(struct oscap_source *source, FILE *outfile_fd)
 {
 	int ret = 0;
@@ -121,22 +159,47 @@ static int _validate_sds_components(struct oscap_source *source, FILE *outfile_f
 		return -1;
 	}
 	struct oscap_htable *component_sources = ds_sds_session_get_component_sources(session);
+	size_t count = oscap_htable_itemcount(component_sources);
+	struct sds_component_validation *validations = calloc(count, sizeof(struct sds_component_validation));
+	if (validations == NULL && count > 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for schematron validation of '%s'.",
+			oscap_source_readable_origin(source));
+		ds_sds_session_free(session);
+		return -1;
+	}
+	size_t idx = 0;
 	struct oscap_htable_iterator *it = oscap_htable_iterator_new(component_sources);
 	while (oscap_htable_iterator_has_more(it)) {
 		struct oscap_source *cs = oscap_htable_iterator_next_value(it);
-		const char *type = oscap_document_type_to_string(oscap_source_get_scap_type(cs));
-		const char *origin = oscap_source_readable_origin(cs);
+		/* Make sure the lazily computed properties are set before the threads start */
+		oscap_source_get_scap_type(cs);
+		oscap_source_get_schema_version(cs);
+		validations[idx++].source = cs;
+	}
+	oscap_htable_iterator_free(it);
+
+	if (oscap_parallel_run(count, _validate_sds_component_job, validations) != 0) {
+		free(validations);
+		ds_sds_session_free(session);
+		return -1;
+	}
+
+	/* Report in the same order as if the components were validated one after another */
+	for (idx = 0; idx < count; idx++) {
+		struct sds_component_validation *validation = &validations[idx];
+		const char *type = oscap_document_type_to_string(oscap_source_get_scap_type(validation->source));
+		const char *origin = oscap_source_readable_origin(validation->source);
 		fprintf(outfile_fd, "Starting schematron validation of %s component '%s':\n", type, origin);
-		int component_result = oscap_source_validate_schematron_priv(cs,
-			oscap_source_get_scap_type(cs),
-			oscap_source_get_schema_version(cs),
-			outfile_fd);
-		fprintf(outfile_fd, "Schematron validation of %s component '%s': %s\n\n", type, origin, component_result == 0 ? "PASS" : "FAIL");
-		if (component_result != 0) {
-			ret = component_result;
+		if (validation->output != NULL) {
+			_copy_validation_output(validation->output, outfile_fd);
+			fclose(validation->output);
+		}
+		fprintf(outfile_fd, "Schematron validation of %s component '%s': %s\n\n", type, origin, validation->result == 0 ? "PASS" : "FAIL");
+		if (validation->result != 0) {
+			ret = validation->result;
 		}
 	}
-	oscap_htable_iterator_free(it);
+	free(validations);
 	ds_sds_session_free(session);
 	return ret;
 }
@@ -35,13 +35,18 @@
 #include <libxslt/xslt.h>
 #include <libxslt/security.h>
 
+#include <libxml/c14n.h>
+
 #include <xmlsec/xmlsec.h>
 #include <xmlsec/xmltree.h>
 #include <xmlsec/xmldsig.h>
 #include <xmlsec/crypto.h>
 
+#include <openssl/evp.h>
+
 #include "common/_error.h"
 #include "common/debug_priv.h"
+#include "common/oscap_parallel.h"
 #include "oscap_source.h"
 #include "oscap_source_priv.h"
 #include "signature_priv.h"
@@ -111,6 +116,216 @@ static int _mark_sds_id_elements(xmlDocPtr doc)
 	return 0;
 }
 
+/*
+ * Manifest references of a data stream signature point to the components.
+ * They are the bulk of the signed data, so instead of letting xmlsec digest
+ * them one by one we digest them in parallel. Only references which are
+ * simple same-document "#id" URIs with at most one canonicalization
+ * transform are handled here, anything else is left to xmlsec.
+ */
+struct oscap_signature_reference {
+	xmlNodePtr target;     // referenced element
+	int c14n_mode;         // xmlC14NMode of the canonicalization
+	const EVP_MD *md;      // digest algorithm
+	char *digest_value;    // expected digest, base64 without whitespace
+	bool valid;            // computed digest matches
+};
+
+struct oscap_signature_manifests {
+	struct oscap_signature_reference *refs;
+	size_t count;
+};
+
+static const struct {
+	const char *href;
+	int mode;
+} _c14n_algorithms[] = {
+	{ "http://www.w3.org/TR/2001/REC-xml-c14n-20010315", XML_C14N_1_0 },
+	{ "http://www.w3.org/TR/2001/REC-xml-c14n-20010315#WithComments", XML_C14N_1_0 },
+	{ "http://www.w3.org/2006/12/xml-c14n11", XML_C14N_1_1 },
+	{ "http://www.w3.org/2006/12/xml-c14n11#WithComments", XML_C14N_1_1 },
+	{ NULL, 0 }
+};
+
+static const EVP_MD *_digest_algorithm(const char *href)
+{
+	if (!strcmp(href, "http://www.w3.org/2000/09/xmldsig#sha1"))
+		return EVP_sha1();
+	if (!strcmp(href, "http://www.w3.org/2001/04/xmldsig-more#sha224"))
+		return EVP_sha224();
+	if (!strcmp(href, "http://www.w3.org/2001/04/xmlenc#sha256"))
+		return EVP_sha256();
+	if (!strcmp(href, "http://www.w3.org/2001/04/xmldsig-more#sha384"))
+		return EVP_sha384();
+	if (!strcmp(href, "http://www.w3.org/2001/04/xmlenc#sha512"))
+		return EVP_sha512();
+	return NULL;
+}
+
+static char *_strip_whitespace(const char *str)
+{
+	char *ret = malloc(strlen(str) + 1);
+	if (ret == NULL)
+		return NULL;
+	char *out = ret;
+	for (; *str != '\0'; ++str) {
+		if (*str != ' ' && *str != '\t' && *str != '\r' && *str != '\n')
+			*out++ = *str;
+	}
+	*out = '\0';
+	return ret;
+}
+
+static bool _parse_manifest_reference(xmlDocPtr doc, xmlNodePtr ref_node, struct oscap_signature_reference *ref)
+{
+	/* Only bare "#id" URIs, they select the subtree without comments */
+	xmlChar *uri = xmlGetProp(ref_node, xmlSecAttrURI);
+	if (uri == NULL || uri[0] != '#' || strchr((const char *) uri, '(') != NULL) {
+		xmlFree(uri);
+		return false;
+	}
+	xmlAttrPtr id_attr = xmlGetID(doc, uri + 1);
+	xmlFree(uri);
+	if (id_attr == NULL || id_attr->parent == NULL)
+		return false;
+	ref->target = id_attr->parent;
+
+	/* Without transforms the node-set is canonicalized by C14N 1.0 */
+	ref->c14n_mode = XML_C14N_1_0;
+	xmlNodePtr cur = xmlSecGetNextElementNode(ref_node->children);
+	if (cur != NULL && xmlSecCheckNodeName(cur, xmlSecNodeTransforms, xmlSecDSigNs)) {
+		xmlNodePtr transform = xmlSecGetNextElementNode(cur->children);
+		if (transform != NULL) {
+			if (xmlSecGetNextElementNode(transform->next) != NULL)
+				return false;
+			if (!xmlSecCheckNodeName(transform, xmlSecNodeTransform, xmlSecDSigNs) || transform->children != NULL)
+				return false;
+			xmlChar *algorithm = xmlGetProp(transform, xmlSecAttrAlgorithm);
+			if (algorithm == NULL)
+				return false;
+			int i = 0;
+			while (_c14n_algorithms[i].href != NULL && strcmp(_c14n_algorithms[i].href, (const char *) algorithm))
+				i++;
+			xmlFree(algorithm);
+			if (_c14n_algorithms[i].href == NULL)
+				return false;
+			ref->c14n_mode = _c14n_algorithms[i].mode;
+		}
+		cur = xmlSecGetNextElementNode(cur->next);
+	}
+
+	if (cur == NULL || !xmlSecCheckNodeName(cur, xmlSecNodeDigestMethod, xmlSecDSigNs))
+		return false;
+	xmlChar *algorithm = xmlGetProp(cur, xmlSecAttrAlgorithm);
+	ref->md = (algorithm != NULL) ? _digest_algorithm((const char *) algorithm) : NULL;
+	xmlFree(algorithm);
+	if (ref->md == NULL)
+		return false;
+
+	cur = xmlSecGetNextElementNode(cur->next);
+	if (cur == NULL || !xmlSecCheckNodeName(cur, xmlSecNodeDigestValue, xmlSecDSigNs))
+		return false;
+	xmlChar *digest_value = xmlNodeGetContent(cur);
+	if (digest_value == NULL)
+		return false;
+	ref->digest_value = _strip_whitespace((const char *) digest_value);
+	xmlFree(digest_value);
+
+	return xmlSecGetNextElementNode(cur->next) == NULL;
+}
+
+static void _manifests_free(struct oscap_signature_manifests *manifests)
+{
+	for (size_t i = 0; i < manifests->count; ++i)
+		free(manifests->refs[i].digest_value);
+	free(manifests->refs);
+	manifests->refs = NULL;
+	manifests->count = 0;
+}
+
+/*
+ * Collect references of all Manifests in ds:Object elements of the signature.
+ * Returns 1 if we can verify all of them, 0 if any of them can't be verified
+ * by us and -1 on error.
+ */
+static int _collect_manifest_references(xmlDocPtr doc, xmlNodePtr signature, struct oscap_signature_manifests *manifests)
+{
+	for (xmlNodePtr object = xmlSecGetNextElementNode(signature->children); object != NULL;
+			object = xmlSecGetNextElementNode(object->next)) {
+		if (!xmlSecCheckNodeName(object, xmlSecNodeObject, xmlSecDSigNs))
+			continue;
+		for (xmlNodePtr manifest = xmlSecGetNextElementNode(object->children); manifest != NULL;
+				manifest = xmlSecGetNextElementNode(manifest->next)) {
+			if (!xmlSecCheckNodeName(manifest, xmlSecNodeManifest, xmlSecDSigNs))
+				continue;
+			for (xmlNodePtr ref_node = xmlSecGetNextElementNode(manifest->children); ref_node != NULL;
+					ref_node = xmlSecGetNextElementNode(ref_node->next)) {
+				if (!xmlSecCheckNodeName(ref_node, xmlSecNodeReference, xmlSecDSigNs))
+					return 0;
+				struct oscap_signature_reference *refs = realloc(manifests->refs, (manifests->count + 1) * sizeof(struct oscap_signature_reference));
+				if (refs == NULL) {
+					oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for Manifest references");
+					return -1;
+				}
+				manifests->refs = refs;
+				struct oscap_signature_reference *ref = &manifests->refs[manifests->count++];
+				memset(ref, 0, sizeof(*ref));
+				if (!_parse_manifest_reference(doc, ref_node, ref))
+					return 0;
+				if (ref->digest_value == NULL) {
+					oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for Manifest references");
+					return -1;
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+static int _c14n_is_visible(void *user_data, xmlNodePtr node, xmlNodePtr parent)
+{
+	if (node->type == XML_COMMENT_NODE)
+		return 0;
+	xmlNodePtr cur = (node->type == XML_NAMESPACE_DECL || node->type == XML_ATTRIBUTE_NODE) ? parent : node;
+	for (; cur != NULL; cur = cur->parent) {
+		if (cur == (xmlNodePtr) user_data)
+			return 1;
+	}
+	return 0;
+}
+
+static int _digest_write(void *context, const char *buffer, int len)
+{
+	if (EVP_DigestUpdate((EVP_MD_CTX *) context, buffer, len) != 1)
+		return -1;
+	return len;
+}
+
+static void _verify_manifest_reference(size_t index, void *arg)
+{
+	struct oscap_signature_manifests *manifests = (struct oscap_signature_manifests *) arg;
+	struct oscap_signature_reference *ref = &manifests->refs[index];
+
+	EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+	if (md_ctx == NULL || EVP_DigestInit_ex(md_ctx, ref->md, NULL) != 1) {
+		EVP_MD_CTX_free(md_ctx);
+		return;
+	}
+	xmlOutputBufferPtr buf = xmlOutputBufferCreateIO(_digest_write, NULL, md_ctx, NULL);
+	int ret = xmlC14NExecute(ref->target->doc, _c14n_is_visible, ref->target, ref->c14n_mode, NULL, 0, buf);
+	if (xmlOutputBufferClose(buf) < 0)
+		ret = -1;
+
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digest_len = 0;
+	if (ret >= 0 && EVP_DigestFinal_ex(md_ctx, digest, &digest_len) == 1) {
+		char encoded[4 * ((EVP_MAX_MD_SIZE + 2) / 3) + 1];
+		EVP_EncodeBlock((unsigned char *) encoded, digest, digest_len);
+		ref->valid = !strcmp(encoded, ref->digest_value);
+	}
+	EVP_MD_CTX_free(md_ctx);
+}
+
 static int _oscap_signature_validate_doc(xmlDocPtr doc, oscap_document_type_t scap_type, struct oscap_signature_ctx *ctx, bool enforce_signature)
 {
 	int res = -1;
@@ -118,6 +333,8 @@ static int _oscap_signature_validate_doc(xmlDocPtr doc, oscap_document_type_t sc
 	xmlSecDSigCtxPtr dsigCtx = NULL;
 	xmlSecKeysMngrPtr mngr = NULL;
 	xsltSecurityPrefsPtr xsltSecPrefs = NULL;
+	struct oscap_signature_manifests manifests = { NULL, 0 };
+	bool own_manifests = false;
 
 	dI("Validating XML signature.");
 
@@ -176,6 +393,18 @@ static int _oscap_signature_validate_doc(xmlDocPtr doc, oscap_document_type_t sc
 		goto cleanup;
 	}
 
+	int collected = _collect_manifest_references(doc, node, &manifests);
+	if (collected < 0)
+		goto cleanup;
+	own_manifests = (collected == 1);
+	if (own_manifests) {
+		if (oscap_parallel_run(manifests.count, _verify_manifest_reference, &manifests) != 0)
+			goto cleanup;
+	} else {
+		dD("Leaving verification of Manifest references to xmlsec.");
+		_manifests_free(&manifests);
+	}
+
 	/* create and initialize keys manager */
 	mngr = xmlSecKeysMngrCreate();
 	if (mngr == NULL) {
@@ -194,6 +423,9 @@ static int _oscap_signature_validate_doc(xmlDocPtr doc, oscap_document_type_t sc
 		goto cleanup;
 	}
 
+	if (own_manifests)
+		dsigCtx->flags |= XMLSEC_DSIG_FLAGS_IGNORE_MANIFESTS;
+
 	/* Verify signature */
 	if (xmlSecDSigCtxVerify(dsigCtx, node) < 0) {
 		oscap_seterr(OSCAP_EFAMILY_XML, "Signature verification failed");
@@ -227,15 +459,23 @@ static int _oscap_signature_validate_doc(xmlDocPtr doc, oscap_document_type_t sc
 	}
 
 	/* compare good/bad manifests */
-	size = xmlSecPtrListGetSize(&(dsigCtx->manifestReferences));
-	for (int i = good = 0; i < size; i++) {
-		dsigRefCtx = (xmlSecDSigReferenceCtxPtr)xmlSecPtrListGetItem(&(dsigCtx->manifestReferences), i);
-		if (dsigRefCtx == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_XML, "Reference ctx is null");
-			goto cleanup;
+	if (own_manifests) {
+		size = manifests.count;
+		for (int i = good = 0; i < size; i++) {
+			if (manifests.refs[i].valid)
+				good++;
+		}
+	} else {
+		size = xmlSecPtrListGetSize(&(dsigCtx->manifestReferences));
+		for (int i = good = 0; i < size; i++) {
+			dsigRefCtx = (xmlSecDSigReferenceCtxPtr)xmlSecPtrListGetItem(&(dsigCtx->manifestReferences), i);
+			if (dsigRefCtx == NULL) {
+				oscap_seterr(OSCAP_EFAMILY_XML, "Reference ctx is null");
+				goto cleanup;
+			}
+			if (dsigRefCtx->status == xmlSecDSigStatusSucceeded)
+				good++;
 		}
-		if (dsigRefCtx->status == xmlSecDSigStatusSucceeded)
-			good++;
 	}
 	dI("Manifests references (ok/all): %d/%d", good, size);
 	if (good != size) {
@@ -247,6 +487,8 @@ static int _oscap_signature_validate_doc(xmlDocPtr doc, oscap_document_type_t sc
 
 cleanup:
 	/* cleanup */
+	_manifests_free(&manifests);
+
 	if (dsigCtx != NULL)
 		xmlSecDSigCtxDestroy(dsigCtx);
 
@@ -24,6 +24,7 @@
 
 #include <libxml/parser.h>
 #include <libxml/xmlerror.h>
+#include <libxml/xmlreader.h>
 #include <libxml/xmlschemas.h>
 #include <string.h>
 #ifdef OS_WINDOWS
@@ -33,6 +34,7 @@
 #endif
 
 #include "common/_error.h"
+#include "common/oscap_parallel.h"
 #include "common/util.h"
 #include "oscap.h"
 #include "oscap_source.h"
@@ -127,6 +129,26 @@ static inline int oscap_validate_xml(struct oscap_source *source, const char *sc
 
 	xmlSchemaSetValidStructuredErrors(ctxt, oscap_xml_validity_handler, &context);
 
+	if (oscap_source_get_streaming(source)) {
+		/* validate while reading the file, the DOM isn't going to be
+		 * needed, readers walking an existing DOM can't validate though */
+		xmlTextReader *reader = oscap_source_get_streaming_xmlTextReader(source);
+		if (reader != NULL) {
+			xmlTextReaderSetStructuredErrorHandler(reader, (xmlStructuredErrorFunc) oscap_xml_validity_handler, &context);
+			if (xmlTextReaderSchemaValidateCtxt(reader, ctxt, 0) == 0) {
+				int ret;
+				while ((ret = xmlTextReaderRead(reader)) == 1) ;
+				/* errors of malformed documents are reported by the DOM parser below */
+				if (ret == 0) {
+					result = (xmlTextReaderIsValid(reader) == 1) ? 0 : 1;
+					xmlFreeTextReader(reader);
+					goto cleanup;
+				}
+			}
+			xmlFreeTextReader(reader);
+		}
+	}
+
 	doc = oscap_source_get_xmlDoc(source);
 	if (!doc)
 		goto cleanup;
@@ -260,3 +282,83 @@ int oscap_source_validate_priv(struct oscap_source *source, oscap_document_type_
 	oscap_seterr(OSCAP_EFAMILY_OSCAP, "Schema file not found when trying to validate '%s'", oscap_source_readable_origin(source));
 	return -1;
 }
+
+struct validation_message {
+	char *file;
+	int line;
+	char *msg;
+};
+
+struct validation_job {
+	struct oscap_source *source;
+	int result;
+	struct validation_message *messages;
+	size_t messages_count;
+	struct err_queue *errors;
+};
+
+static int _buffer_validation_message(const char *file, int line, const char *msg, void *arg)
+{
+	struct validation_job *job = (struct validation_job *) arg;
+	struct validation_message *messages = realloc(job->messages, (job->messages_count + 1) * sizeof(struct validation_message));
+	if (messages == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for validation message of '%s'.", file);
+		return -1;
+	}
+	job->messages = messages;
+	struct validation_message *message = &job->messages[job->messages_count++];
+	message->file = oscap_strdup(file);
+	message->line = line;
+	message->msg = oscap_strdup(msg);
+	return 0;
+}
+
+static void _validation_job(size_t index, void *arg)
+{
+	struct validation_job *job = ((struct validation_job *) arg) + index;
+	job->result = oscap_source_validate(job->source, _buffer_validation_message, job);
+	/* Keep the errors aside, only files up to the first invalid one report them */
+	job->errors = oscap_err_detach_queue();
+}
+
+int oscap_source_validate_all_priv(struct oscap_source **sources, size_t count, xml_reporter reporter, void *user, size_t *invalid)
+{
+	*invalid = count;
+	if (count == 0)
+		return 0;
+
+	struct validation_job *jobs = calloc(count, sizeof(struct validation_job));
+	if (jobs == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate memory for validation of %zu files.", count);
+		return -1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].source = sources[i];
+	}
+
+	if (oscap_parallel_run(count, _validation_job, jobs) != 0) {
+		free(jobs);
+		return -1;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		for (size_t j = 0; j < jobs[i].messages_count; j++) {
+			struct validation_message *message = &jobs[i].messages[j];
+			if (*invalid == count && reporter != NULL)
+				reporter(message->file, message->line, message->msg, user);
+			free(message->file);
+			free(message->msg);
+		}
+		free(jobs[i].messages);
+		if (*invalid == count) {
+			oscap_err_attach_queue(jobs[i].errors);
+			if (jobs[i].result != 0)
+				*invalid = i;
+		} else {
+			/* Sequential validation would have stopped before this file */
+			oscap_err_free_queue(jobs[i].errors);
+		}
+	}
+	free(jobs);
+	return *invalid < count ? 1 : 0;
+}
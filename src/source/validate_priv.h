@@ -42,4 +42,15 @@ struct oscap_schema_table_entry {
  */
 int oscap_source_validate_priv(struct oscap_source *source, oscap_document_type_t doc_type, const char *version, xml_reporter reporter, void *user);
 
+/**
+ * validate several independent XML files in parallel
+ * Messages are passed to the reporter once all files are validated, in the
+ * order of the files and up to the first file which isn't valid, exactly as
+ * if oscap_source_validate was called on the files one after another.
+ * Errors of the files after the first invalid one are dropped as well.
+ * @param invalid set to the index of the first file which isn't valid; count if all files are valid
+ * @return 0 if all files are valid, 1 if some file isn't valid, -1 on error
+ */
+int oscap_source_validate_all_priv(struct oscap_source **sources, size_t count, xml_reporter reporter, void *user, size_t *invalid);
+
 #endif
@@ -0,0 +1,472 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oval_cmp_evr_string_impl.h"
+
+#ifdef HAVE_RPMVERCMP
+#ifdef RPM418_FOUND
+#include <rpm/rpmver.h>
+#include <rpm/rpmstring.h>
+#else
+#include <rpm/rpmlib.h>
+#endif
+#endif
+
+/*
+ * The comparisons of EVR strings as they were implemented before they were
+ * split to segments, they are the reference of the differential test.
+ */
+
+static int ref_isdigit(int c)
+{
+	return (c >= '0' && c <= '9');
+}
+
+static void ref_parse_evr(char *evr, const char **ep, const char **vp, const char **rp)
+{
+	const char *epoch;
+	const char *version;
+	const char *release;
+	char *s, *se;
+
+	s = evr;
+	while (*s && ref_isdigit(*s)) s++;
+	se = strrchr(s, '-');
+
+	if (*s == ':') {
+		epoch = evr;
+		*s++ = '\0';
+		version = s;
+		if (*epoch == '\0')
+			epoch = "0";
+	} else {
+		epoch = NULL;
+		version = evr;
+	}
+	if (se) {
+		*se++ = '\0';
+		release = se;
+	} else {
+		release = NULL;
+	}
+
+	*ep = epoch;
+	*vp = version;
+	*rp = release;
+}
+
+#ifdef HAVE_RPMVERCMP
+#define ref_rpmvercmp rpmvercmp
+#else
+/* code from http://rpm.org/api/4.4.2.2/rpmvercmp_8c-source.html */
+static int ref_rpmvercmp(const char *a, const char *b)
+{
+	char oldch1, oldch2;
+	char *str1, *str2;
+	char *one, *two;
+	int rc;
+	int isnum;
+
+	if (!strcmp(a, b))
+		return 0;
+
+	str1 = strdup(a);
+	str2 = strdup(b);
+	one = str1;
+	two = str2;
+	rc = 0;
+
+	while (*one && *two) {
+		while (*one && !isalnum(*one))
+			one++;
+		while (*two && !isalnum(*two))
+			two++;
+
+		if (!(*one && *two))
+			break;
+
+		char *end1 = one;
+		char *end2 = two;
+
+		if (isdigit(*end1)) {
+			while (*end1 && isdigit(*end1))
+				end1++;
+			while (*end2 && isdigit(*end2))
+				end2++;
+			isnum = 1;
+		} else {
+			while (*end1 && isalpha(*end1))
+				end1++;
+			while (*end2 && isalpha(*end2))
+				end2++;
+			isnum = 0;
+		}
+
+		oldch1 = *end1;
+		*end1 = '\0';
+		oldch2 = *end2;
+		*end2 = '\0';
+
+		if (one == end1) {
+			rc = -1;
+			goto out;
+		}
+		if (two == end2) {
+			rc = isnum ? 1 : -1;
+			goto out;
+		}
+
+		if (isnum) {
+			while (*one == '0')
+				one++;
+			while (*two == '0')
+				two++;
+			if (strlen(one) > strlen(two)) {
+				rc = 1;
+				goto out;
+			}
+			if (strlen(two) > strlen(one)) {
+				rc = -1;
+				goto out;
+			}
+		}
+
+		rc = strcmp(one, two);
+		if (rc) {
+			rc = rc < 1 ? -1 : 1;
+			goto out;
+		}
+
+		*end1 = oldch1;
+		one = end1;
+		*end2 = oldch2;
+		two = end2;
+	}
+	if ((!*one) && (!*two))
+		rc = 0;
+	else if (!*one)
+		rc = -1;
+	else
+		rc = 1;
+out:
+	free(str1);
+	free(str2);
+	return rc;
+}
+#endif
+
+static int ref_compare_values(const char *str1, const char *str2)
+{
+	if (!str1 && !str2)
+		return 0;
+	else if (str1 && !str2)
+		return 1;
+	else if (!str1 && str2)
+		return -1;
+	return ref_rpmvercmp(str1, str2);
+}
+
+static int ref_evrcmp(const char *a, const char *b)
+{
+	const char *ae, *av, *ar, *be, *bv, *br;
+	char *abuf = strdup(a);
+	char *bbuf = strdup(b);
+	int result;
+
+	ref_parse_evr(abuf, &ae, &av, &ar);
+	ref_parse_evr(bbuf, &be, &bv, &br);
+	result = ref_compare_values(ae, be);
+	if (!result) {
+		result = ref_compare_values(av, bv);
+		if (!result)
+			result = ref_compare_values(ar, br);
+	}
+	free(abuf);
+	free(bbuf);
+	return result;
+}
+
+static int ref_order(int c)
+{
+	if (isdigit(c))
+		return 0;
+	else if (isalpha(c))
+		return c;
+	else if (c == '~')
+		return -1;
+	else if (c)
+		return c + 256;
+	else
+		return 0;
+}
+
+static int ref_verrevcmp(const char *a, const char *b)
+{
+	if (a == NULL)
+		a = "";
+	if (b == NULL)
+		b = "";
+
+	while (*a || *b) {
+		int first_diff = 0;
+
+		while ((*a && !isdigit(*a)) || (*b && !isdigit(*b))) {
+			int ac = ref_order(*a);
+			int bc = ref_order(*b);
+
+			if (ac != bc)
+				return ac - bc;
+
+			a++;
+			b++;
+		}
+		while (*a == '0')
+			a++;
+		while (*b == '0')
+			b++;
+		while (isdigit(*a) && isdigit(*b)) {
+			if (!first_diff)
+				first_diff = *a - *b;
+			a++;
+			b++;
+		}
+
+		if (isdigit(*a))
+			return 1;
+		if (isdigit(*b))
+			return -1;
+		if (first_diff)
+			return first_diff;
+	}
+
+	return 0;
+}
+
+/* returns false when an epoch is out of the int range */
+static bool ref_debian_cmp(const char *a, const char *b, int *result)
+{
+	const char *e[2], *v[2], *r[2];
+	char *buf[2] = { strdup(a), strdup(b) };
+	long epoch[2];
+	bool valid = true;
+
+	for (int i = 0; i < 2; i++) {
+		ref_parse_evr(buf[i], &e[i], &v[i], &r[i]);
+		epoch[i] = strtol(e[i] ? e[i] : "0", NULL, 10);
+		if (epoch[i] < INT_MIN || epoch[i] > INT_MAX)
+			valid = false;
+	}
+	if (valid) {
+		if ((int) epoch[0] != (int) epoch[1])
+			*result = (int) epoch[0] > (int) epoch[1] ? 1 : -1;
+		else if ((*result = ref_verrevcmp(v[0], v[1])) == 0)
+			*result = ref_verrevcmp(r[0], r[1]);
+	}
+	free(buf[0]);
+	free(buf[1]);
+	return valid;
+}
+
+static const oval_operation_t operations[] = {
+	OVAL_OPERATION_EQUALS,
+	OVAL_OPERATION_NOT_EQUAL,
+	OVAL_OPERATION_GREATER_THAN,
+	OVAL_OPERATION_GREATER_THAN_OR_EQUAL,
+	OVAL_OPERATION_LESS_THAN,
+	OVAL_OPERATION_LESS_THAN_OR_EQUAL,
+};
+
+static oval_result_t expected_result(int cmp, oval_operation_t operation)
+{
+	bool result = false;
+
+	switch (operation) {
+	case OVAL_OPERATION_EQUALS:
+		result = (cmp == 0);
+		break;
+	case OVAL_OPERATION_NOT_EQUAL:
+		result = (cmp != 0);
+		break;
+	case OVAL_OPERATION_GREATER_THAN:
+		result = (cmp > 0);
+		break;
+	case OVAL_OPERATION_GREATER_THAN_OR_EQUAL:
+		result = (cmp >= 0);
+		break;
+	case OVAL_OPERATION_LESS_THAN:
+		result = (cmp < 0);
+		break;
+	case OVAL_OPERATION_LESS_THAN_OR_EQUAL:
+		result = (cmp <= 0);
+		break;
+	default:
+		break;
+	}
+	return result ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE;
+}
+
+static uint64_t random_state;
+
+static unsigned int random_next(unsigned int limit)
+{
+	/* xorshift64 */
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (unsigned int) (random_state % limit);
+}
+
+static const char *const pieces[] = {
+	"0", "00", "1", "2", "9", "10", "007", "123456789012345678901234567890",
+	"a", "b", "el", "rc", "beta", "Z", "fc",
+	".", "-", "_", "+", "~", "^", ":", "..", "\xe9",
+};
+#define PIECES (sizeof(pieces) / sizeof(pieces[0]))
+
+static void random_evr(char *buf, size_t size)
+{
+	size_t len = 0;
+	unsigned int count = random_next(8);
+
+	buf[0] = '\0';
+	switch (random_next(4)) {
+	case 0:
+		len = snprintf(buf, size, "%u:", random_next(3));
+		break;
+	case 1:
+		len = snprintf(buf, size, ":");
+		break;
+	default:
+		break;
+	}
+	for (unsigned int i = 0; i < count && len + 32 < size; i++) {
+		const char *piece = pieces[random_next(PIECES)];
+
+		strcpy(buf + len, piece);
+		len += strlen(piece);
+	}
+	if (random_next(2) && len + 40 < size) {
+		buf[len++] = '-';
+		count = random_next(5);
+		for (unsigned int i = 0; i < count; i++) {
+			const char *piece = pieces[random_next(PIECES - 3)];
+
+			strcpy(buf + len, piece);
+			len += strlen(piece);
+		}
+		buf[len] = '\0';
+	}
+}
+
+/* change, insert or remove a character to compare similar strings */
+static void mutate_evr(char *dst, const char *src, size_t size)
+{
+	size_t len = strlen(src);
+	size_t pos = len ? random_next(len + 1) : 0;
+	const char *piece = pieces[random_next(PIECES)];
+
+	snprintf(dst, size, "%s", src);
+	switch (random_next(3)) {
+	case 0:
+		if (pos < len)
+			dst[pos] = piece[0];
+		break;
+	case 1:
+		snprintf(dst + pos, size - pos, "%s%s", piece, src + pos);
+		break;
+	default:
+		if (pos < len)
+			memmove(dst + pos, dst + pos + 1, len - pos);
+		break;
+	}
+}
+
+static bool check_pair(const char *state, const char *sys)
+{
+	struct oval_evr state_evr, sys_evr;
+	struct oval_debian_evr state_debian, sys_debian;
+	int cmp = ref_evrcmp(sys, state);
+	int debian_cmp = 0;
+	bool debian_valid = ref_debian_cmp(sys, state, &debian_cmp);
+	bool state_valid, sys_valid;
+	bool passed = true;
+
+	oval_evr_parse(&state_evr, state);
+	oval_evr_parse(&sys_evr, sys);
+	state_valid = oval_debian_evr_parse(&state_debian, state);
+	sys_valid = oval_debian_evr_parse(&sys_debian, sys);
+	for (size_t i = 0; i < sizeof(operations) / sizeof(operations[0]); i++) {
+		oval_operation_t op = operations[i];
+		oval_result_t expected = expected_result(cmp, op);
+		oval_result_t debian_expected = debian_valid ? expected_result(debian_cmp, op) : OVAL_RESULT_ERROR;
+		oval_result_t results[4];
+
+		results[0] = oval_evr_string_cmp(state, sys, op);
+		results[1] = oval_evr_cmp(&state_evr, &sys_evr, op);
+		results[2] = oval_debian_evr_string_cmp(state, sys, op);
+		results[3] = (state_valid && sys_valid) ?
+			oval_debian_evr_cmp(&state_debian, &sys_debian, op) : OVAL_RESULT_ERROR;
+		if (results[0] != expected || results[1] != expected) {
+			printf("FAIL\tevr_string\t'%s'\t'%s'\toperation %d: %d %d, expected %d\n",
+			       state, sys, op, results[0], results[1], expected);
+			passed = false;
+		}
+		if (results[2] != debian_expected || results[3] != debian_expected) {
+			printf("FAIL\tdebian_evr_string\t'%s'\t'%s'\toperation %d: %d %d, expected %d\n",
+			       state, sys, op, results[2], results[3], debian_expected);
+			passed = false;
+		}
+	}
+	oval_evr_clear(&state_evr);
+	oval_evr_clear(&sys_evr);
+	oval_debian_evr_clear(&state_debian);
+	oval_debian_evr_clear(&sys_debian);
+	return passed;
+}
+
+static const char *const pairs[][2] = {
+	{ "1.0", "1.0" }, { "1.0", "1.0." }, { "1.0.", "1.0_" }, { "1.0", "1.0a" },
+	{ "1.0a", "1.0.a" }, { "1.01", "1.1" }, { "1.0", "1.00" }, { "0:1-1", "1-1" },
+	{ ":1-1", "0:1-1" }, { "1:1.0-1", "1.0-1" }, { "1.0-1", "1.0" }, { "1.0~rc1", "1.0" },
+	{ "1.0~rc1", "1.0~" }, { "a", "1" }, { "", "." }, { "", "" }, { "-", "" },
+	{ "99999999999999999999:1", "1" }, { "2.6.32-754.el6", "2.6.32-71.el6" },
+	{ "1.2.3-4.el8_4.1", "1.2.3-4.el8_4" }, { "\xe9", "a" },
+};
+
+static int fuzz(unsigned long iterations, unsigned long seed)
+{
+	char state[256], sys[256];
+	unsigned long failures = 0;
+
+	for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+		if (!check_pair(pairs[i][0], pairs[i][1]) || !check_pair(pairs[i][1], pairs[i][0]))
+			failures++;
+	}
+
+	random_state = seed * 0x9e3779b97f4a7c15ULL + 1;
+	for (unsigned long i = 0; i < iterations; i++) {
+		random_evr(state, sizeof(state));
+		if (random_next(3))
+			mutate_evr(sys, state, sizeof(sys));
+		else
+			random_evr(sys, sizeof(sys));
+		if (!check_pair(state, sys))
+			failures++;
+	}
+	printf("evr comparison: %lu random pairs with seed %lu, %lu failures\n", iterations, seed, failures);
+	return failures ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	return fuzz(argc >= 2 ? strtoul(argv[1], NULL, 10) : 100000,
+		    argc >= 3 ? strtoul(argv[2], NULL, 10) : 1);
+}
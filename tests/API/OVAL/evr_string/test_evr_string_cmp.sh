@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+
+# Compare random EVR strings by the comparisons split to segments and by
+# the previous implementation. The number of pairs and the seed can be
+# changed, eg.:
+#
+#   EVR_CMP_FUZZ_PAIRS=10000000 EVR_CMP_FUZZ_SEED=7 ctest -R test_evr_string_cmp -V
+
+. $builddir/tests/test_common.sh
+
+# Test cases.
+
+function test_evr_string_cmp_fuzz {
+    ./test_evr_string_cmp ${EVR_CMP_FUZZ_PAIRS:-100000} ${EVR_CMP_FUZZ_SEED:-1}
+}
+
+# Testing.
+
+test_init
+
+if [ -z ${CUSTOM_OSCAP+x} ] ; then
+    test_run "test_evr_string_cmp_fuzz" test_evr_string_cmp_fuzz
+fi
+
+test_exit
@@ -0,0 +1,98 @@
+#!/usr/bin/env bash
+
+# Analyse generated system characteristics with states referring to local
+# variables which pass the values of an object through a chain of
+# functions, check the values computed by the functions and that a
+# concatenation producing too many values is reported as an error.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+items=200
+
+definitions=$(mktemp)
+syschar=$(mktemp)
+result=$(mktemp)
+stderr=$(mktemp)
+
+# the variables pass the items of the first object through the functions,
+# variable 5 counts the values of unique(split(concat(...))) and of
+# arithmetic(regex_capture(concat(...))), variable 6 is the concatenation
+# of every item with every item, the tests compare the only item of the
+# second object
+objref='<object_component object_ref="oval:x:obj:1" item_field="filename"/>'
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2"/>
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <unix:file_test check="at least one" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1"><unix:object object_ref="oval:x:obj:2"/><unix:state state_ref="oval:x:ste:1"/></unix:file_test>
+    <unix:file_test check="at least one" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:2" version="1"><unix:object object_ref="oval:x:obj:2"/><unix:state state_ref="oval:x:ste:2"/></unix:file_test>
+  </tests>
+  <objects>
+    <unix:file_object id="oval:x:obj:1" version="1"><unix:filepath operation="pattern match">^/usr/.*</unix:filepath></unix:file_object>
+    <unix:file_object id="oval:x:obj:2" version="1"><unix:filepath>/etc/f</unix:filepath></unix:file_object>
+  </objects>
+  <states>
+    <unix:file_state id="oval:x:ste:1" version="1"><unix:user_id datatype="int" var_ref="oval:x:var:5"/></unix:file_state>
+    <unix:file_state id="oval:x:ste:2" version="1"><unix:filepath var_ref="oval:x:var:6" var_check="at least one"/></unix:file_state>
+  </states>
+  <variables>
+    <local_variable id="oval:x:var:1" version="1" datatype="string" comment="x"><concat><literal_component>/usr/lib/</literal_component><escape_regex>$objref</escape_regex></concat></local_variable>
+    <local_variable id="oval:x:var:2" version="1" datatype="string" comment="x"><split delimiter="/"><variable_component var_ref="oval:x:var:1"/></split></local_variable>
+    <local_variable id="oval:x:var:3" version="1" datatype="string" comment="x"><unique><variable_component var_ref="oval:x:var:2"/></unique></local_variable>
+    <local_variable id="oval:x:var:4" version="1" datatype="int" comment="x"><arithmetic arithmetic_operation="add"><literal_component datatype="int">1</literal_component><regex_capture pattern="f([0-9]+)\$"><variable_component var_ref="oval:x:var:1"/></regex_capture></arithmetic></local_variable>
+    <local_variable id="oval:x:var:5" version="1" datatype="int" comment="x"><count><variable_component var_ref="oval:x:var:3"/><variable_component var_ref="oval:x:var:4"/></count></local_variable>
+    <local_variable id="oval:x:var:6" version="1" datatype="string" comment="x"><concat>$objref$objref</concat></local_variable>
+  </variables>
+</oval_definitions>
+EOF
+} > $definitions
+
+awk -v count=$items 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<oval_system_characteristics xmlns=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5\" xmlns:oval=\"http://oval.mitre.org/XMLSchema/oval-common-5\" xmlns:unix-sys=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5#unix\">";
+	print "  <generator><oval:schema_version>5.11</oval:schema_version><oval:timestamp>2026-01-01T00:00:00</oval:timestamp></generator>";
+	print "  <system_info><os_name>Linux</os_name><os_version>1</os_version><architecture>x86_64</architecture><primary_host_name>localhost</primary_host_name><interfaces/></system_info>";
+	print "  <collected_objects>";
+	print "    <object id=\"oval:x:obj:1\" version=\"1\" flag=\"complete\">";
+	for (n = 1; n <= count; n++)
+		printf("      <reference item_ref=\"%d\"/>\n", n);
+	print "    </object>";
+	printf("    <object id=\"oval:x:obj:2\" version=\"1\" flag=\"complete\"><reference item_ref=\"%d\"/></object>\n", count + 1);
+	print "  </collected_objects>";
+	print "  <system_data>";
+	for (n = 1; n <= count; n++) {
+		printf("    <unix-sys:file_item id=\"%d\" status=\"exists\"><unix-sys:filepath>/usr/lib/f%d</unix-sys:filepath><unix-sys:path>/usr/lib</unix-sys:path><unix-sys:filename>f%d</unix-sys:filename><unix-sys:type>regular</unix-sys:type></unix-sys:file_item>\n",
+			n, n, n);
+	}
+	printf("    <unix-sys:file_item id=\"%d\" status=\"exists\"><unix-sys:filepath>/etc/f</unix-sys:filepath><unix-sys:path>/etc</unix-sys:path><unix-sys:filename>f</unix-sys:filename><unix-sys:type>regular</unix-sys:type><unix-sys:user_id datatype=\"int\">%d</unix-sys:user_id></unix-sys:file_item>\n",
+		count + 1, 2 * count + 3);
+	print "  </system_data>";
+	print "</oval_system_characteristics>";
+}' > $syschar
+
+# the concatenation of every item with every item exceeds the limit
+OSCAP_FUNCTION_MAX_VALUES=$(( 10 * items )) $OSCAP oval analyse --results $result $definitions $syschar > /dev/null 2> $stderr
+
+tst='/oval_results/results/system/tests/test'
+assert_exists 1 "$tst[@test_id='oval:x:tst:1'][@result='true']"
+assert_exists 1 "$tst[@test_id='oval:x:tst:1']/tested_variable[@variable_id='oval:x:var:5'][text()='$(( 2 * items + 3 ))']"
+assert_exists 1 "$tst[@test_id='oval:x:tst:2'][@result='error']"
+grep -q "The concat function would produce more than $(( 10 * items )) values." $stderr
+
+rm -f $definitions $syschar $result $stderr
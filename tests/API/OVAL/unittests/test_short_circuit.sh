@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+
+# Check that with --short-circuit the criteria which can't change the result
+# of a definition are reported as 'not evaluated' and that their objects
+# aren't collected, even if they come first in the criteria, while the
+# results of the definitions stay the same.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+definitions=$(mktemp)
+file=$(mktemp)
+dir=$(mktemp -d)
+result=$(mktemp)
+stdout_normal=$(mktemp)
+stdout_short=$(mktemp)
+
+echo "present" > $file
+mkdir -p $dir/a/b
+touch $dir/a/b/f
+
+# test 1 is true, test 2 is false, test 3 walks the directory
+cat > $definitions <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:ind="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="vulnerability" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:3"/>
+        <criterion test_ref="oval:x:tst:2"/>
+      </criteria>
+    </definition>
+    <definition class="vulnerability" id="oval:x:def:2" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="OR">
+        <criterion test_ref="oval:x:tst:3"/>
+        <criteria operator="AND">
+          <criterion test_ref="oval:x:tst:1"/>
+          <criterion test_ref="oval:x:tst:2" negate="true"/>
+        </criteria>
+      </criteria>
+    </definition>
+    <definition class="vulnerability" id="oval:x:def:3" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2" negate="true"/>
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <ind:textfilecontent54_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1"><ind:object object_ref="oval:x:obj:1"/></ind:textfilecontent54_test>
+    <ind:textfilecontent54_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:2" version="1"><ind:object object_ref="oval:x:obj:2"/></ind:textfilecontent54_test>
+    <unix:file_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:3" version="1"><unix:object object_ref="oval:x:obj:3"/></unix:file_test>
+  </tests>
+  <objects>
+    <ind:textfilecontent54_object id="oval:x:obj:1" version="1"><ind:filepath>$file</ind:filepath><ind:pattern operation="pattern match">^present$</ind:pattern><ind:instance datatype="int">1</ind:instance></ind:textfilecontent54_object>
+    <ind:textfilecontent54_object id="oval:x:obj:2" version="1"><ind:filepath>$file</ind:filepath><ind:pattern operation="pattern match">^missing$</ind:pattern><ind:instance datatype="int">1</ind:instance></ind:textfilecontent54_object>
+    <unix:file_object id="oval:x:obj:3" version="1"><unix:behaviors recurse_direction="down"/><unix:path>$dir</unix:path><unix:filename>f</unix:filename></unix:file_object>
+  </objects>
+</oval_definitions>
+EOF
+
+$OSCAP oval eval $definitions | grep '^Definition' | sort > $stdout_normal
+$OSCAP oval eval --short-circuit --results $result $definitions | grep '^Definition' | sort > $stdout_short
+diff $stdout_normal $stdout_short
+
+defs='/oval_results/results/system/definitions/definition'
+assert_exists 1 "$defs[@definition_id='oval:x:def:1'][@result='false']"
+assert_exists 1 "$defs[@definition_id='oval:x:def:1']/criteria/criterion[@test_ref='oval:x:tst:3'][@result='not evaluated']"
+assert_exists 1 "$defs[@definition_id='oval:x:def:2'][@result='true']"
+assert_exists 1 "$defs[@definition_id='oval:x:def:2']/criteria/criterion[@test_ref='oval:x:tst:3'][@result='not evaluated']"
+assert_exists 1 "$defs[@definition_id='oval:x:def:3'][@result='true']"
+assert_exists 0 "$defs/criteria//*[@result='not evaluated'][not(@test_ref='oval:x:tst:3')]"
+
+tst='/oval_results/results/system/tests/test'
+assert_exists 1 "$tst[@test_id='oval:x:tst:3'][@result='not evaluated']"
+assert_exists 0 "/oval_results/results/system/oval_system_characteristics/collected_objects/*[@id='oval:x:obj:3']"
+assert_exists 2 "/oval_results/results/system/oval_system_characteristics/collected_objects/*"
+
+rm -rf $definitions $file $dir $result $stdout_normal $stdout_short
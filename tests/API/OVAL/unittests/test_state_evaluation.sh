@@ -0,0 +1,111 @@
+#!/usr/bin/env bash
+
+# Analyse generated system characteristics with many file items against
+# typical file permission states.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+items=1500
+
+definitions=$(mktemp)
+syschar=$(mktemp)
+result=$(mktemp)
+
+cat > $definitions <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2"/>
+        <criterion test_ref="oval:x:tst:3"/>
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <unix:file_test check="all" check_existence="at_least_one_exists" comment="no world writable files" id="oval:x:tst:1" version="1">
+      <unix:object object_ref="oval:x:obj:1"/>
+      <unix:state state_ref="oval:x:ste:1"/>
+    </unix:file_test>
+    <unix:file_test check="none satisfy" check_existence="at_least_one_exists" comment="no setuid files outside of /usr/bin" id="oval:x:tst:2" version="1">
+      <unix:object object_ref="oval:x:obj:1"/>
+      <unix:state state_ref="oval:x:ste:2"/>
+    </unix:file_test>
+    <unix:file_test check="at least one" check_existence="at_least_one_exists" comment="large root owned files" id="oval:x:tst:3" version="1">
+      <unix:object object_ref="oval:x:obj:1"/>
+      <unix:state state_ref="oval:x:ste:3"/>
+    </unix:file_test>
+  </tests>
+  <objects>
+    <unix:file_object id="oval:x:obj:1" version="1">
+      <unix:filepath operation="pattern match">^/usr/.*</unix:filepath>
+    </unix:file_object>
+  </objects>
+  <states>
+    <unix:file_state id="oval:x:ste:1" version="1" operator="AND">
+      <unix:type>regular</unix:type>
+      <unix:user_id datatype="int" operation="less than">1000</unix:user_id>
+      <unix:suid datatype="boolean">false</unix:suid>
+      <unix:sgid datatype="boolean">false</unix:sgid>
+      <unix:sticky datatype="boolean">false</unix:sticky>
+      <unix:uread datatype="boolean">true</unix:uread>
+      <unix:gwrite datatype="boolean">false</unix:gwrite>
+      <unix:owrite datatype="boolean">false</unix:owrite>
+      <unix:oexec datatype="boolean">true</unix:oexec>
+    </unix:file_state>
+    <unix:file_state id="oval:x:ste:2" version="1" operator="AND">
+      <unix:path operation="pattern match">^/usr/(?!bin\$)</unix:path>
+      <unix:suid datatype="boolean">true</unix:suid>
+    </unix:file_state>
+    <unix:file_state id="oval:x:ste:3" version="1" operator="AND">
+      <unix:user_id datatype="int">0</unix:user_id>
+      <unix:size datatype="int" operation="greater than">1048576</unix:size>
+    </unix:file_state>
+  </states>
+</oval_definitions>
+EOF
+
+# every 3rd item is owned by a regular user, every 50th item is setuid and
+# in /usr/bin, every 1000th item is world writable too, the sizes grow up to
+# 2 MiB every 20 items
+awk -v count=$items 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<oval_system_characteristics xmlns=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5\" xmlns:oval=\"http://oval.mitre.org/XMLSchema/oval-common-5\" xmlns:unix-sys=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5#unix\">";
+	print "  <generator><oval:schema_version>5.11</oval:schema_version><oval:timestamp>2026-01-01T00:00:00</oval:timestamp></generator>";
+	print "  <system_info><os_name>Linux</os_name><os_version>1</os_version><architecture>x86_64</architecture><primary_host_name>localhost</primary_host_name><interfaces/></system_info>";
+	print "  <collected_objects>";
+	print "    <object id=\"oval:x:obj:1\" version=\"1\" flag=\"complete\">";
+	for (n = 1; n <= count; n++)
+		printf("      <reference item_ref=\"%d\"/>\n", n);
+	print "    </object>";
+	print "  </collected_objects>";
+	print "  <system_data>";
+	for (n = 1; n <= count; n++) {
+		dir = (n % 10 == 0) ? "/usr/bin" : "/usr/lib";
+		printf("    <unix-sys:file_item id=\"%d\" status=\"exists\"><unix-sys:filepath>%s/f%d</unix-sys:filepath><unix-sys:path>%s</unix-sys:path><unix-sys:filename>f%d</unix-sys:filename><unix-sys:type>regular</unix-sys:type><unix-sys:group_id datatype=\"int\">0</unix-sys:group_id><unix-sys:user_id datatype=\"int\">%d</unix-sys:user_id><unix-sys:a_time datatype=\"int\">1700000000</unix-sys:a_time><unix-sys:c_time datatype=\"int\">1700000000</unix-sys:c_time><unix-sys:m_time datatype=\"int\">1700000000</unix-sys:m_time><unix-sys:size datatype=\"int\">%d</unix-sys:size><unix-sys:suid datatype=\"boolean\">%s</unix-sys:suid><unix-sys:sgid datatype=\"boolean\">false</unix-sys:sgid><unix-sys:sticky datatype=\"boolean\">false</unix-sys:sticky><unix-sys:uread datatype=\"boolean\">true</unix-sys:uread><unix-sys:uwrite datatype=\"boolean\">true</unix-sys:uwrite><unix-sys:uexec datatype=\"boolean\">true</unix-sys:uexec><unix-sys:gread datatype=\"boolean\">true</unix-sys:gread><unix-sys:gwrite datatype=\"boolean\">false</unix-sys:gwrite><unix-sys:gexec datatype=\"boolean\">true</unix-sys:gexec><unix-sys:oread datatype=\"boolean\">true</unix-sys:oread><unix-sys:owrite datatype=\"boolean\">%s</unix-sys:owrite><unix-sys:oexec datatype=\"boolean\">true</unix-sys:oexec><unix-sys:has_extended_acl datatype=\"boolean\">false</unix-sys:has_extended_acl></unix-sys:file_item>\n",
+			n, dir, n, dir, n, n % 3 ? 0 : 1000 + n, (n % 20) * 104857, n % 50 == 0 ? "true" : "false", n % 1000 == 0 ? "true" : "false");
+	}
+	print "  </system_data>";
+	print "</oval_system_characteristics>";
+}' > $syschar
+
+$OSCAP oval analyse --results $result $definitions $syschar > /dev/null
+
+tst='/oval_results/results/system/tests/test'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="false"]'
+# the items owned by a regular user and the setuid ones fail the first state
+assert_exists 1 "$tst[@test_id='oval:x:tst:1'][@result='false']"
+assert_exists $(( items - items / 3 - items / 50 + items / 150 )) "$tst[@test_id='oval:x:tst:1']/tested_item[@result='true']"
+assert_exists 1 "$tst[@test_id='oval:x:tst:2'][@result='true']"
+assert_exists 0 "$tst[@test_id='oval:x:tst:2']/tested_item[@result='true']"
+assert_exists 1 "$tst[@test_id='oval:x:tst:3'][@result='true']"
+
+rm -f $definitions $syschar $result
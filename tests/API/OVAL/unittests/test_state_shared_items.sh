@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+
+# Analyse generated system characteristics with tests sharing states and
+# items, check that the items compared to a state by a test are reused by
+# the other tests.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+items=2000
+
+definitions=$(mktemp)
+syschar=$(mktemp)
+result=$(mktemp)
+log=$(mktemp)
+
+# every state is used by a test of all items and by a test of the even
+# items, the third state refers to a variable
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+	for i in $(seq 6); do
+		echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+	done
+	cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+	for i in $(seq 6); do
+		echo "    <unix:file_test check=\"at least one\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><unix:object object_ref=\"oval:x:obj:$(( (i - 1) % 2 + 1 ))\"/><unix:state state_ref=\"oval:x:ste:$(( (i + 1) / 2 ))\"/></unix:file_test>"
+	done
+	cat <<EOF
+  </tests>
+  <objects>
+    <unix:file_object id="oval:x:obj:1" version="1"><unix:filepath operation="pattern match">^/usr/.*</unix:filepath></unix:file_object>
+    <unix:file_object id="oval:x:obj:2" version="1"><unix:filepath operation="pattern match">^/usr/.*[02468]\$</unix:filepath></unix:file_object>
+  </objects>
+  <states>
+    <unix:file_state id="oval:x:ste:1" version="1"><unix:owrite datatype="boolean">false</unix:owrite></unix:file_state>
+    <unix:file_state id="oval:x:ste:2" version="1"><unix:user_id datatype="int" operation="less than">1000</unix:user_id></unix:file_state>
+    <unix:file_state id="oval:x:ste:3" version="1"><unix:user_id datatype="int" operation="less than" var_ref="oval:x:var:1"/></unix:file_state>
+  </states>
+  <variables>
+    <constant_variable id="oval:x:var:1" version="1" datatype="int" comment="x"><value>1000</value></constant_variable>
+  </variables>
+</oval_definitions>
+EOF
+} > $definitions
+
+# every 3rd item is owned by a regular user, every 1000th item is world writable
+awk -v count=$items 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<oval_system_characteristics xmlns=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5\" xmlns:oval=\"http://oval.mitre.org/XMLSchema/oval-common-5\" xmlns:unix-sys=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5#unix\">";
+	print "  <generator><oval:schema_version>5.11</oval:schema_version><oval:timestamp>2026-01-01T00:00:00</oval:timestamp></generator>";
+	print "  <system_info><os_name>Linux</os_name><os_version>1</os_version><architecture>x86_64</architecture><primary_host_name>localhost</primary_host_name><interfaces/></system_info>";
+	print "  <collected_objects>";
+	print "    <object id=\"oval:x:obj:1\" version=\"1\" flag=\"complete\">";
+	for (n = 1; n <= count; n++)
+		printf("      <reference item_ref=\"%d\"/>\n", n);
+	print "    </object>";
+	print "    <object id=\"oval:x:obj:2\" version=\"1\" flag=\"complete\">";
+	for (n = 2; n <= count; n += 2)
+		printf("      <reference item_ref=\"%d\"/>\n", n);
+	print "    </object>";
+	print "  </collected_objects>";
+	print "  <system_data>";
+	for (n = 1; n <= count; n++) {
+		printf("    <unix-sys:file_item id=\"%d\" status=\"exists\"><unix-sys:filepath>/usr/lib/f%d</unix-sys:filepath><unix-sys:path>/usr/lib</unix-sys:path><unix-sys:filename>f%d</unix-sys:filename><unix-sys:type>regular</unix-sys:type><unix-sys:user_id datatype=\"int\">%d</unix-sys:user_id><unix-sys:owrite datatype=\"boolean\">%s</unix-sys:owrite></unix-sys:file_item>\n",
+			n, n, n, n % 3 ? 0 : 1000 + n, n % 1000 == 0 ? "true" : "false");
+	}
+	print "  </system_data>";
+	print "</oval_system_characteristics>";
+}' > $syschar
+
+$OSCAP --verbose INFO --verbose-log-file $log oval analyse --results $result $definitions $syschar > /dev/null
+
+tst='/oval_results/results/system/tests/test'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+assert_exists $(( items - items / 1000 )) "$tst[@test_id='oval:x:tst:1']/tested_item[@result='true']"
+assert_exists $(( items / 2 - items / 1000 )) "$tst[@test_id='oval:x:tst:2']/tested_item[@result='true']"
+for i in 3 5; do
+	assert_exists $(( items - items / 3 )) "$tst[@test_id='oval:x:tst:$i']/tested_item[@result='true']"
+	assert_exists $(( items / 2 - items / 6 )) "$tst[@test_id='oval:x:tst:$((i + 1))']/tested_item[@result='true']"
+done
+# the even items are compared to each state only once
+grep -q "Item evaluations reused from other tests sharing the states: $(( 3 * (items / 2) )) of $(( 3 * (items + items / 2) )) " $log
+
+rm -f $definitions $syschar $result $log
@@ -0,0 +1,96 @@
+#!/usr/bin/env bash
+
+# Evaluate generated definitions with --stream, check that the results are
+# the same as when the whole document is loaded first, also when the first
+# definition extends the last one. The exported results don't include the
+# source definitions, which are released while streaming.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+definitions_count=2000
+
+definitions=$(mktemp)
+directives=$(mktemp)
+file=$(mktemp)
+stdout_normal=$(mktemp)
+stdout_stream=$(mktemp)
+result_normal=$(mktemp)
+result_stream=$(mktemp)
+
+seq 1 10 > $file
+
+# definition N checks whether the file contains the line N % 20, the tests
+# share 20 objects, the first definition also needs the last one to be true
+awk -v count=$definitions_count -v file=$file 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<oval_definitions xmlns=\"http://oval.mitre.org/XMLSchema/oval-definitions-5\" xmlns:oval=\"http://oval.mitre.org/XMLSchema/oval-common-5\" xmlns:ind=\"http://oval.mitre.org/XMLSchema/oval-definitions-5#independent\">";
+	print "  <generator><oval:schema_version>5.11</oval:schema_version><oval:timestamp>2026-01-01T00:00:00</oval:timestamp></generator>";
+	print "  <definitions>";
+	for (n = 1; n <= count; n++) {
+		printf("    <definition class=\"vulnerability\" id=\"oval:x:def:%d\" version=\"1\"><metadata><title>x</title><description>x</description></metadata><criteria operator=\"AND\">", n);
+		if (n == 1)
+			printf("<extend_definition definition_ref=\"oval:x:def:%d\"/>", count);
+		printf("<criterion test_ref=\"oval:x:tst:%d\"/></criteria></definition>\n", n);
+	}
+	print "  </definitions>";
+	print "  <tests>";
+	for (n = 1; n <= count; n++)
+		printf("    <ind:textfilecontent54_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:%d\" version=\"1\"><ind:object object_ref=\"oval:x:obj:%d\"/></ind:textfilecontent54_test>\n", n, n % 20 + 1);
+	print "  </tests>";
+	print "  <objects>";
+	for (n = 0; n < 20; n++)
+		printf("    <ind:textfilecontent54_object id=\"oval:x:obj:%d\" version=\"1\"><ind:filepath>%s</ind:filepath><ind:pattern operation=\"pattern match\">^%d$</ind:pattern><ind:instance datatype=\"int\">1</ind:instance></ind:textfilecontent54_object>\n", n + 1, file, n);
+	print "  </objects>";
+	print "</oval_definitions>";
+}' > $definitions
+
+$OSCAP oval eval $definitions | grep '^Definition' | sort > $stdout_normal
+
+$OSCAP oval eval --stream $definitions | grep '^Definition' > $stdout_stream
+
+# the definitions are reported in the document order, the extending
+# definition after the extended one
+[ "$(grep -c '^Definition' $stdout_stream)" == "$definitions_count" ]
+[ "$(head -n 1 $stdout_stream)" == "Definition oval:x:def:2: true" ]
+[ "$(tail -n 1 $stdout_stream)" == "Definition oval:x:def:1: false" ]
+sort $stdout_stream | diff $stdout_normal -
+
+cat > $directives <<EOF
+<?xml version="1.0"?>
+<oval_directives xmlns="http://oval.mitre.org/XMLSchema/oval-directives-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:oval-res="http://oval.mitre.org/XMLSchema/oval-results-5">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <directives include_source_definitions="false">
+    <oval-res:definition_true reported="true" content="full"/>
+    <oval-res:definition_false reported="true" content="full"/>
+    <oval-res:definition_unknown reported="true" content="full"/>
+    <oval-res:definition_error reported="true" content="full"/>
+    <oval-res:definition_not_evaluated reported="true" content="full"/>
+    <oval-res:definition_not_applicable reported="true" content="full"/>
+  </directives>
+</oval_directives>
+EOF
+
+# ids of the items differ between runs
+$OSCAP oval eval --directives $directives --results $result_normal $definitions > /dev/null
+$OSCAP oval eval --stream --directives $directives --results $result_stream $definitions > /dev/null
+normalize() {
+	grep -v timestamp $1 | sed -E 's/(item_id|id|item_ref)="[0-9]+"/\1=""/g' | sort
+}
+diff <(normalize $result_normal) <(normalize $result_stream)
+
+$OSCAP oval eval --stream --results $result_stream $definitions > /dev/null
+result=$result_stream
+assert_exists 1 '/oval_results/directives[@include_source_definitions="false"]'
+assert_exists 0 '/oval_results/oval_definitions'
+defs='/oval_results/results/system/definitions/definition'
+assert_exists $definitions_count "$defs"
+assert_exists 1 "$defs[@definition_id='oval:x:def:1'][@result='false']"
+assert_exists 1 "$defs[@definition_id='oval:x:def:10'][@result='true']"
+assert_exists 1 "$defs[@definition_id='oval:x:def:11'][@result='false']"
+
+rm -f $definitions $directives $file $stdout_normal $stdout_stream $result_normal $result_stream
@@ -0,0 +1,99 @@
+#!/usr/bin/env bash
+
+# Analyse generated system characteristics with states referring to local
+# variables which depend on each other and share components, check that
+# the variables are computed level by level of their dependencies and that
+# the shared components are evaluated only once.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+items=100
+
+definitions=$(mktemp)
+syschar=$(mktemp)
+result=$(mktemp)
+log=$(mktemp)
+
+# variable 2 depends on variable 1 and reuses its concatenation, variable 3
+# shares the object reference with them, variable 5 depends on variable 4
+# which depends on variable 3
+objref='<object_component object_ref="oval:x:obj:1" item_field="filename"/>'
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+	for i in $(seq 3); do
+		echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+	done
+	cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+	for i in $(seq 3); do
+		echo "    <unix:file_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><unix:object object_ref=\"oval:x:obj:1\"/><unix:state state_ref=\"oval:x:ste:$i\"/></unix:file_test>"
+	done
+	cat <<EOF
+  </tests>
+  <objects>
+    <unix:file_object id="oval:x:obj:1" version="1"><unix:filepath operation="pattern match">^/usr/.*</unix:filepath></unix:file_object>
+  </objects>
+  <states>
+    <unix:file_state id="oval:x:ste:1" version="1"><unix:filepath var_ref="oval:x:var:1" var_check="at least one"/></unix:file_state>
+    <unix:file_state id="oval:x:ste:2" version="1"><unix:filepath var_ref="oval:x:var:2" var_check="at least one"/></unix:file_state>
+    <unix:file_state id="oval:x:ste:3" version="1"><unix:filepath var_ref="oval:x:var:5" var_check="at least one"/></unix:file_state>
+  </states>
+  <variables>
+    <local_variable id="oval:x:var:1" version="1" datatype="string" comment="x"><concat><literal_component>/usr/lib/</literal_component>$objref</concat></local_variable>
+    <local_variable id="oval:x:var:2" version="1" datatype="string" comment="x"><unique><concat><literal_component>/usr/lib/</literal_component>$objref</concat><variable_component var_ref="oval:x:var:1"/></unique></local_variable>
+    <local_variable id="oval:x:var:3" version="1" datatype="string" comment="x"><regex_capture pattern="^f([0-9]+)\$">$objref</regex_capture></local_variable>
+    <local_variable id="oval:x:var:4" version="1" datatype="string" comment="x"><unique><variable_component var_ref="oval:x:var:3"/></unique></local_variable>
+    <local_variable id="oval:x:var:5" version="1" datatype="string" comment="x"><concat><literal_component>/usr/lib/f</literal_component><variable_component var_ref="oval:x:var:4"/></concat></local_variable>
+  </variables>
+</oval_definitions>
+EOF
+} > $definitions
+
+awk -v count=$items 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<oval_system_characteristics xmlns=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5\" xmlns:oval=\"http://oval.mitre.org/XMLSchema/oval-common-5\" xmlns:unix-sys=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5#unix\">";
+	print "  <generator><oval:schema_version>5.11</oval:schema_version><oval:timestamp>2026-01-01T00:00:00</oval:timestamp></generator>";
+	print "  <system_info><os_name>Linux</os_name><os_version>1</os_version><architecture>x86_64</architecture><primary_host_name>localhost</primary_host_name><interfaces/></system_info>";
+	print "  <collected_objects>";
+	print "    <object id=\"oval:x:obj:1\" version=\"1\" flag=\"complete\">";
+	for (n = 1; n <= count; n++)
+		printf("      <reference item_ref=\"%d\"/>\n", n);
+	print "    </object>";
+	print "  </collected_objects>";
+	print "  <system_data>";
+	for (n = 1; n <= count; n++) {
+		printf("    <unix-sys:file_item id=\"%d\" status=\"exists\"><unix-sys:filepath>/usr/lib/f%d</unix-sys:filepath><unix-sys:path>/usr/lib</unix-sys:path><unix-sys:filename>f%d</unix-sys:filename><unix-sys:type>regular</unix-sys:type></unix-sys:file_item>\n",
+			n, n, n);
+	}
+	print "  </system_data>";
+	print "</oval_system_characteristics>";
+}' > $syschar
+
+$OSCAP --verbose INFO --verbose-log-file $log oval analyse --results $result $definitions $syschar > /dev/null
+
+tst='/oval_results/results/system/tests/test'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+for i in $(seq 3); do
+	assert_exists $items "$tst[@test_id='oval:x:tst:$i']/tested_item[@result='true']"
+done
+grep -q "Computing 5 variables in 3 levels of dependencies." $log
+grep -q "Reusing the values of a component" $log
+
+rm -f $definitions $syschar $result $log
@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+
+# Analyse generated system characteristics with states referring to
+# variables with many values of the evr_string and int data types.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+items=200
+values=10
+
+definitions=$(mktemp)
+syschar=$(mktemp)
+result=$(mktemp)
+
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:linux="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2"/>
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <linux:rpminfo_test check="at least one" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1"><linux:object object_ref="oval:x:obj:1"/><linux:state state_ref="oval:x:ste:1"/></linux:rpminfo_test>
+    <unix:file_test check="at least one" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:2" version="1"><unix:object object_ref="oval:x:obj:2"/><unix:state state_ref="oval:x:ste:2"/></unix:file_test>
+  </tests>
+  <objects>
+    <linux:rpminfo_object id="oval:x:obj:1" version="1"><linux:name operation="pattern match">^p</linux:name></linux:rpminfo_object>
+    <unix:file_object id="oval:x:obj:2" version="1"><unix:filepath operation="pattern match">^/usr/.*</unix:filepath></unix:file_object>
+  </objects>
+  <states>
+    <linux:rpminfo_state id="oval:x:ste:1" version="1"><linux:evr datatype="evr_string" operation="equals" var_ref="oval:x:var:1" var_check="at least one"/></linux:rpminfo_state>
+    <unix:file_state id="oval:x:ste:2" version="1"><unix:user_id datatype="int" operation="equals" var_ref="oval:x:var:2" var_check="at least one"/></unix:file_state>
+  </states>
+  <variables>
+    <constant_variable id="oval:x:var:1" version="1" datatype="evr_string" comment="x">
+EOF
+	for i in $(seq $values); do
+		echo "      <value>1:2.$i-$i.el8</value>"
+	done
+	cat <<EOF
+    </constant_variable>
+    <constant_variable id="oval:x:var:2" version="1" datatype="int" comment="x">
+EOF
+	for i in $(seq $values); do
+		echo "      <value>$i</value>"
+	done
+	cat <<EOF
+    </constant_variable>
+  </variables>
+</oval_definitions>
+EOF
+} > $definitions
+
+# the items with a number matching one of the values modulo twice the
+# number of values are equal to a value
+awk -v count=$items -v values=$values 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<oval_system_characteristics xmlns=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5\" xmlns:oval=\"http://oval.mitre.org/XMLSchema/oval-common-5\" xmlns:linux-sys=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5#linux\" xmlns:unix-sys=\"http://oval.mitre.org/XMLSchema/oval-system-characteristics-5#unix\">";
+	print "  <generator><oval:schema_version>5.11</oval:schema_version><oval:timestamp>2026-01-01T00:00:00</oval:timestamp></generator>";
+	print "  <system_info><os_name>Linux</os_name><os_version>1</os_version><architecture>x86_64</architecture><primary_host_name>localhost</primary_host_name><interfaces/></system_info>";
+	print "  <collected_objects>";
+	for (o = 1; o <= 2; o++) {
+		printf("    <object id=\"oval:x:obj:%d\" version=\"1\" flag=\"complete\">\n", o);
+		for (n = 1; n <= count; n++)
+			printf("      <reference item_ref=\"%d\"/>\n", (o - 1) * count + n);
+		print "    </object>";
+	}
+	print "  </collected_objects>";
+	print "  <system_data>";
+	for (n = 1; n <= count; n++) {
+		v = n % (2 * values);
+		printf("    <linux-sys:rpminfo_item id=\"%d\" status=\"exists\"><linux-sys:name>p%d</linux-sys:name><linux-sys:arch>x86_64</linux-sys:arch><linux-sys:epoch>1</linux-sys:epoch><linux-sys:release>%d.el8</linux-sys:release><linux-sys:version>2.%d</linux-sys:version><linux-sys:evr datatype=\"evr_string\">1:2.%d-%d.el8</linux-sys:evr><linux-sys:signature_keyid>0</linux-sys:signature_keyid></linux-sys:rpminfo_item>\n",
+			n, n, v, v, v, v);
+	}
+	for (n = 1; n <= count; n++) {
+		printf("    <unix-sys:file_item id=\"%d\" status=\"exists\"><unix-sys:filepath>/usr/lib/f%d</unix-sys:filepath><unix-sys:path>/usr/lib</unix-sys:path><unix-sys:filename>f%d</unix-sys:filename><unix-sys:type>regular</unix-sys:type><unix-sys:user_id datatype=\"int\">%d</unix-sys:user_id></unix-sys:file_item>\n",
+			count + n, n, n, n % (2 * values));
+	}
+	print "  </system_data>";
+	print "</oval_system_characteristics>";
+}' > $syschar
+
+$OSCAP oval analyse --results $result $definitions $syschar > /dev/null
+
+# the number of items matching one of the values
+matching=$(( (items / (2 * values)) * values + ( items % (2 * values) < values ? items % (2 * values) : values ) ))
+
+tst='/oval_results/results/system/tests/test'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+assert_exists $matching "$tst[@test_id='oval:x:tst:1']/tested_item[@result='true']"
+assert_exists $matching "$tst[@test_id='oval:x:tst:2']/tested_item[@result='true']"
+
+rm -f $definitions $syschar $result
@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+. $builddir/tests/test_common.sh
+
+set -e
+set -o pipefail
+
+# The content isn't valid, the schema doesn't allow more refine-values of
+# a value in a profile. The first one is used for the substitution.
+name=$(basename $0 .sh)
+fix=$(mktemp -t ${name}.out.XXXXXX)
+
+$OSCAP xccdf generate fix --skip-validation --profile xccdf_moc.elpmaxe.www_profile_1 \
+	--fix-type bash --output $fix $srcdir/${name}.xccdf.xml
+
+grep -q "touch test_file" $fix
+! grep -q "touch delme.txt" $fix
+
+rm $fix
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Build XCCDF policies for all profiles of a benchmark and resolve values
+ * refined by the profiles. Prints a summary line for each profile to stdout:
+ *
+ *   test_xccdf_policy_profiles ssg-rhel8-ds.xml
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <ds_sds_session.h>
+#include <oscap_source.h>
+#include <xccdf_benchmark.h>
+#include <xccdf_policy.h>
+
+#include "oscap_assert.h"
+
+static int _count_profile_values(struct xccdf_policy *policy, struct xccdf_benchmark *benchmark, struct xccdf_profile *profile)
+{
+	int count = 0;
+
+	struct xccdf_setvalue_iterator *s_value_it = xccdf_profile_get_setvalues(profile);
+	while (xccdf_setvalue_iterator_has_more(s_value_it)) {
+		struct xccdf_setvalue *s_value = xccdf_setvalue_iterator_next(s_value_it);
+		struct xccdf_item *value = xccdf_benchmark_get_item(benchmark, xccdf_setvalue_get_item(s_value));
+		if (value != NULL && xccdf_policy_get_value_of_item(policy, value) != NULL)
+			count++;
+	}
+	xccdf_setvalue_iterator_free(s_value_it);
+
+	struct xccdf_refine_value_iterator *r_value_it = xccdf_profile_get_refine_values(profile);
+	while (xccdf_refine_value_iterator_has_more(r_value_it)) {
+		struct xccdf_refine_value *r_value = xccdf_refine_value_iterator_next(r_value_it);
+		struct xccdf_item *value = xccdf_benchmark_get_item(benchmark, xccdf_refine_value_get_item(r_value));
+		if (value != NULL && xccdf_policy_get_value_of_item(policy, value) != NULL)
+			count++;
+	}
+	xccdf_refine_value_iterator_free(r_value_it);
+
+	return count;
+}
+
+/* Set-values added to the profile after the policy was created take effect */
+static void _check_added_setvalue(struct xccdf_policy *policy, struct xccdf_benchmark *benchmark, struct xccdf_profile *profile)
+{
+	struct xccdf_item *value = NULL;
+	struct xccdf_setvalue_iterator *s_value_it = xccdf_profile_get_setvalues(profile);
+	while (value == NULL && xccdf_setvalue_iterator_has_more(s_value_it))
+		value = xccdf_benchmark_get_item(benchmark, xccdf_setvalue_get_item(xccdf_setvalue_iterator_next(s_value_it)));
+	xccdf_setvalue_iterator_free(s_value_it);
+	if (value == NULL)
+		return;
+
+	struct xccdf_setvalue *s_value = xccdf_setvalue_new();
+	xccdf_setvalue_set_item(s_value, xccdf_value_get_id(xccdf_item_to_value(value)));
+	xccdf_setvalue_set_value(s_value, "added-after-policy");
+	xccdf_profile_add_setvalue(profile, s_value);
+	const char *resolved = xccdf_policy_get_value_of_item(policy, value);
+	oscap_assert(resolved != NULL && strcmp(resolved, "added-after-policy") == 0);
+}
+
+int main(int argc, char *argv[])
+{
+	oscap_assert(argc == 2);
+
+	struct oscap_source *source = oscap_source_new_from_file(argv[1]);
+	struct ds_sds_session *session = NULL;
+	struct oscap_source *xccdf_source = source;
+	if (oscap_source_get_scap_type(source) == OSCAP_DOCUMENT_SDS) {
+		session = ds_sds_session_new_from_source(source);
+		oscap_assert(session != NULL);
+		xccdf_source = ds_sds_session_select_checklist(session, NULL, NULL, NULL);
+		oscap_assert(xccdf_source != NULL);
+	}
+
+	struct xccdf_benchmark *benchmark = xccdf_benchmark_import_source(xccdf_source);
+	oscap_assert(benchmark != NULL);
+	struct xccdf_policy_model *model = xccdf_policy_model_new(benchmark);
+	oscap_assert(model != NULL);
+
+	struct xccdf_profile_iterator *profile_it = xccdf_benchmark_get_profiles(benchmark);
+	while (xccdf_profile_iterator_has_more(profile_it)) {
+		struct xccdf_profile *profile = xccdf_profile_iterator_next(profile_it);
+		struct xccdf_policy *policy = xccdf_policy_model_get_policy_by_id(model, xccdf_profile_get_id(profile));
+		oscap_assert(policy != NULL);
+		int selected = xccdf_policy_get_selected_rules_count(policy);
+		int values = _count_profile_values(policy, benchmark, profile);
+		printf("%s selected=%d values=%d\n", xccdf_profile_get_id(profile), selected, values);
+		_check_added_setvalue(policy, benchmark, profile);
+	}
+	xccdf_profile_iterator_free(profile_it);
+
+	xccdf_policy_model_free(model);
+	ds_sds_session_free(session);
+	oscap_source_free(source);
+	return 0;
+}
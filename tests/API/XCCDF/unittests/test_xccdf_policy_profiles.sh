@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+ds=$(mktemp -t ${name}.ds.XXXXXX)
+stdout=$(mktemp -t ${name}.out.XXXXXX)
+echo "Stdout file = $stdout"
+
+bunzip2 -c "${top_srcdir}/tests/memory/ssg-rhel8-ds.xml.bz2" > $ds
+
+./${name} $ds > $stdout
+
+# every profile of the benchmark gets a policy with some rules selected
+profiles=$($OSCAP info --profiles $ds | wc -l)
+[ "$profiles" -gt 0 ]
+[ "$(wc -l < $stdout)" -eq "$profiles" ]
+! grep -q " selected=0 " $stdout
+
+# values refined by the profile resolve through the policy
+grep -q "xccdf_org.ssgproject.content_profile_ospp selected=[0-9]* values=[1-9]" $stdout
+
+rm $ds $stdout
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Load a source data stream in an XCCDF session, reload the session with and
+ * without reloading the XCCDF and check that the rich texts and fixes of the
+ * benchmark, which the session serializes on first access, are the same as
+ * those of the benchmark imported eagerly from the data stream:
+ *
+ *   test_xccdf_session_reload ssg-rhel8-ds.xml
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ds_sds_session.h>
+#include <oscap_source.h>
+#include <oscap_text.h>
+#include <xccdf_benchmark.h>
+#include <xccdf_policy.h>
+#include <xccdf_session.h>
+
+#include "oscap_assert.h"
+
+struct texts_digest {
+	unsigned long count;
+	unsigned long hash;
+};
+
+static void _digest_add(struct texts_digest *digest, const char *text)
+{
+	digest->count++;
+	for (const char *c = text ? text : ""; *c != '\0'; c++)
+		digest->hash = digest->hash * 33 + (unsigned char) *c;
+}
+
+static void _digest_texts(struct texts_digest *digest, struct oscap_text_iterator *texts)
+{
+	while (oscap_text_iterator_has_more(texts))
+		_digest_add(digest, oscap_text_get_text(oscap_text_iterator_next(texts)));
+	oscap_text_iterator_free(texts);
+}
+
+static void _digest_item(struct texts_digest *digest, struct xccdf_item *item)
+{
+	_digest_texts(digest, xccdf_item_get_description(item));
+	_digest_texts(digest, xccdf_item_get_rationale(item));
+
+	switch (xccdf_item_get_type(item)) {
+	case XCCDF_RULE: {
+		struct xccdf_fix_iterator *fixes = xccdf_rule_get_fixes(xccdf_item_to_rule(item));
+		while (xccdf_fix_iterator_has_more(fixes))
+			_digest_add(digest, xccdf_fix_get_content(xccdf_fix_iterator_next(fixes)));
+		xccdf_fix_iterator_free(fixes);
+
+		struct xccdf_fixtext_iterator *fixtexts = xccdf_rule_get_fixtexts(xccdf_item_to_rule(item));
+		while (xccdf_fixtext_iterator_has_more(fixtexts))
+			_digest_add(digest, oscap_text_get_text(xccdf_fixtext_get_text(xccdf_fixtext_iterator_next(fixtexts))));
+		xccdf_fixtext_iterator_free(fixtexts);
+	} break;
+	case XCCDF_GROUP: {
+		struct xccdf_item_iterator *content = xccdf_group_get_content(xccdf_item_to_group(item));
+		while (xccdf_item_iterator_has_more(content))
+			_digest_item(digest, xccdf_item_iterator_next(content));
+		xccdf_item_iterator_free(content);
+	} break;
+	default:
+		break;
+	}
+}
+
+static struct texts_digest _digest_model(struct xccdf_policy_model *model)
+{
+	struct texts_digest digest = { 0, 5381 };
+	oscap_assert(model != NULL);
+	struct xccdf_benchmark *benchmark = xccdf_policy_model_get_benchmark(model);
+
+	_digest_texts(&digest, xccdf_benchmark_get_front_matter(benchmark));
+	_digest_texts(&digest, xccdf_benchmark_get_rear_matter(benchmark));
+	_digest_item(&digest, xccdf_benchmark_to_item(benchmark));
+	struct xccdf_item_iterator *content = xccdf_benchmark_get_content(benchmark);
+	while (xccdf_item_iterator_has_more(content))
+		_digest_item(&digest, xccdf_item_iterator_next(content));
+	xccdf_item_iterator_free(content);
+
+	return digest;
+}
+
+static struct texts_digest _digest_session(struct xccdf_session *session)
+{
+	return _digest_model(xccdf_session_get_policy_model(session));
+}
+
+static struct texts_digest _digest_eager(const char *filename)
+{
+	struct oscap_source *source = oscap_source_new_from_file(filename);
+	struct ds_sds_session *sds_session = ds_sds_session_new_from_source(source);
+	oscap_assert(sds_session != NULL);
+	struct oscap_source *xccdf_source = ds_sds_session_select_checklist(sds_session, NULL, NULL, NULL);
+	oscap_assert(xccdf_source != NULL);
+
+	/* texts are serialized while the benchmark is parsed */
+	struct xccdf_benchmark *benchmark = xccdf_benchmark_import_source(xccdf_source);
+	oscap_assert(benchmark != NULL);
+	struct xccdf_policy_model *model = xccdf_policy_model_new(benchmark);
+	struct texts_digest digest = _digest_model(model);
+
+	xccdf_policy_model_free(model);
+	ds_sds_session_free(sds_session);
+	oscap_source_free(source);
+	return digest;
+}
+
+static struct xccdf_session *_load_session(const char *filename)
+{
+	struct xccdf_session *session = xccdf_session_new(filename);
+	oscap_assert(session != NULL);
+	xccdf_session_set_validation(session, false, false);
+	xccdf_session_set_loading_flags(session, XCCDF_SESSION_LOAD_XCCDF);
+	oscap_assert(xccdf_session_load(session) == 0);
+	return session;
+}
+
+int main(int argc, char *argv[])
+{
+	oscap_assert(argc == 2);
+
+	struct texts_digest expected = _digest_eager(argv[1]);
+	printf("texts=%lu\n", expected.count);
+	oscap_assert(expected.count > 0);
+
+	/* texts read before any reload */
+	struct xccdf_session *session = _load_session(argv[1]);
+	struct texts_digest loaded = _digest_session(session);
+	xccdf_session_free(session);
+	oscap_assert(loaded.count == expected.count && loaded.hash == expected.hash);
+
+	/* the benchmark is kept while the components of the data stream are dropped */
+	session = _load_session(argv[1]);
+	xccdf_session_set_loading_flags(session, XCCDF_SESSION_LOAD_NONE);
+	oscap_assert(xccdf_session_load(session) == 0);
+	struct texts_digest kept = _digest_session(session);
+	xccdf_session_free(session);
+	oscap_assert(kept.count == expected.count && kept.hash == expected.hash);
+
+	/* the benchmark is loaded again */
+	session = _load_session(argv[1]);
+	oscap_assert(xccdf_session_load(session) == 0);
+	struct texts_digest reloaded = _digest_session(session);
+	xccdf_session_free(session);
+	oscap_assert(reloaded.count == expected.count && reloaded.hash == expected.hash);
+
+	return 0;
+}
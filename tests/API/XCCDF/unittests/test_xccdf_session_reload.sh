@@ -0,0 +1,16 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+ds=$(mktemp -t ${name}.ds.XXXXXX)
+
+bunzip2 -c "${top_srcdir}/tests/memory/ssg-rhel8-ds.xml.bz2" > $ds
+
+./${name} $ds
+
+rm $ds
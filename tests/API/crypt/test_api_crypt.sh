@@ -36,8 +36,14 @@ function test_crapi_digest {
             sum=$((md5sum "${TEMPDIR}/${file}" || openssl md5 "${TEMPDIR}/${file}") | sed -n 's|^.*\([0-9a-f]\{32\}\).*$|\1|p')
         elif [[ "$algo" == "sha1" ]] ; then
             sum=$((sha1sum "${TEMPDIR}/${file}" || openssl sha1 "${TEMPDIR}/${file}") | sed -n 's|^.*\([0-9a-f]\{40\}\).*$|\1|p')
+        elif [[ "$algo" == "sha224" ]] ; then
+            sum=$((sha224sum "${TEMPDIR}/${file}" || openssl sha224 "${TEMPDIR}/${file}") | sed -n 's|^.*\([0-9a-f]\{56\}\).*$|\1|p')
         elif [[ "$algo" == "sha256" ]] ; then
             sum=$((sha256sum "${TEMPDIR}/${file}" || openssl sha256 "${TEMPDIR}/${file}") | sed -n 's|^.*\([0-9a-f]\{64\}\).*$|\1|p')
+        elif [[ "$algo" == "sha384" ]] ; then
+            sum=$((sha384sum "${TEMPDIR}/${file}" || openssl sha384 "${TEMPDIR}/${file}") | sed -n 's|^.*\([0-9a-f]\{96\}\).*$|\1|p')
+        elif [[ "$algo" == "sha512" ]] ; then
+            sum=$((sha512sum "${TEMPDIR}/${file}" || openssl sha512 "${TEMPDIR}/${file}") | sed -n 's|^.*\([0-9a-f]\{128\}\).*$|\1|p')
         else
             return 2
         fi
@@ -98,7 +104,10 @@ if [ -z ${CUSTOM_OSCAP+x} ] ; then
     if [[ "$OPENSCAP_ENABLE_SHA1" == "ON" ]] ; then
         test_run "test_crapi_digest_sha1" test_crapi_digest sha1
     fi
+    test_run "test_crapi_digest_sha224" test_crapi_digest sha224
     test_run "test_crapi_digest_sha256" test_crapi_digest sha256
+    test_run "test_crapi_digest_sha384" test_crapi_digest sha384
+    test_run "test_crapi_digest_sha512" test_crapi_digest sha512
     if [[ "$OPENSCAP_ENABLE_MD5" == "ON"  && "$OPENSCAP_ENABLE_SHA1" == "ON" ]] ; then
         test_run "test_crapi_mdigest" test_crapi_mdigest
     fi
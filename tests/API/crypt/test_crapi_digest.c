@@ -88,9 +88,18 @@ int main (int argc, char *argv[])
 #else
 		return 1;
 #endif
+	} else if (!strcmp(algorithm_str, "sha224")) {
+		algorithm = CRAPI_DIGEST_SHA224;
+		dstlen = 28;
 	} else if (!strcmp(algorithm_str, "sha256")) {
 		algorithm = CRAPI_DIGEST_SHA256;
 		dstlen = 32;
+	} else if (!strcmp(algorithm_str, "sha384")) {
+		algorithm = CRAPI_DIGEST_SHA384;
+		dstlen = 48;
+	} else if (!strcmp(algorithm_str, "sha512")) {
+		algorithm = CRAPI_DIGEST_SHA512;
+		dstlen = 64;
 	} else {
 		return 1;
 	}
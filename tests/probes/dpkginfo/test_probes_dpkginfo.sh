@@ -0,0 +1,90 @@
+#!/usr/bin/env bash
+
+# Evaluate one dpkginfo object per package of a generated dpkg status
+# database. Removed packages aren't collected, a package listed twice is
+# reported by its installed entry and the epoch is split from the version.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "dpkginfo" || exit 255
+
+packages=100
+
+root=$(mktemp -d)
+definitions=$(mktemp)
+results=$(mktemp)
+
+# Every tenth package has been removed, every seventh has an epoch and
+# pkg00001 is listed twice, removed first.
+mkdir -p $root/var/lib/dpkg
+awk -v packages=$packages 'BEGIN {
+	printf("Package: pkg00001\nStatus: deinstall ok config-files\nArchitecture: i386\nVersion: 0.1-1\n\n");
+	for (i = 1; i <= packages; i++) {
+		printf("Package: pkg%05d\n", i);
+		printf("Status: %s\n", i % 10 == 0 ? "deinstall ok config-files" : "install ok installed");
+		printf("Priority: optional\nSection: misc\nInstalled-Size: %d\n", i);
+		printf("Maintainer: Nobody <nobody@example.com>\n");
+		printf("Architecture: amd64\n");
+		printf("Version: %s1.%d-%d\n", i % 7 == 0 ? "2:" : "", i, i % 3 + 1);
+		printf("Description: package %d\n a long description\n .\n of the package\n\n", i);
+	}
+}' > $root/var/lib/dpkg/status
+
+{
+cat <<EOF2
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:lin-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux">
+  <generator>
+    <oval:schema_version>5.11.1</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:$((packages + 1))"/>
+EOF2
+for i in $(seq $packages); do
+	echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+done
+cat <<EOF2
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <lin-def:dpkginfo_test check="all" check_existence="any_exist" comment="x" id="oval:x:tst:$((packages + 1))" version="1"><lin-def:object object_ref="oval:x:obj:$((packages + 1))"/></lin-def:dpkginfo_test>
+EOF2
+for i in $(seq $packages); do
+	echo "    <lin-def:dpkginfo_test check=\"all\" check_existence=\"any_exist\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><lin-def:object object_ref=\"oval:x:obj:$i\"/></lin-def:dpkginfo_test>"
+done
+cat <<EOF2
+  </tests>
+  <objects>
+    <lin-def:dpkginfo_object id="oval:x:obj:$((packages + 1))" version="1"><lin-def:name operation="pattern match">^pkg000[0-9][0-9]$</lin-def:name></lin-def:dpkginfo_object>
+EOF2
+for i in $(seq $packages); do
+	printf "    <lin-def:dpkginfo_object id=\"oval:x:obj:$i\" version=\"1\"><lin-def:name>pkg%05d</lin-def:name></lin-def:dpkginfo_object>\n" $i
+done
+cat <<EOF2
+  </objects>
+</oval_definitions>
+EOF2
+} > $definitions
+
+OSCAP_PROBE_ROOT=$root $OSCAP oval eval --results $results $definitions > /dev/null
+
+result=$results
+sc='/oval_results/results/system/oval_system_characteristics/'
+# every installed package is collected once
+assert_exists $((packages - packages / 10)) $sc'system_data/lin-sys:dpkginfo_item'
+assert_exists $((packages / 10)) $sc'collected_objects/object[@flag="does not exist"]'
+# pkg00001..pkg00099 without the removed ones
+assert_exists 90 $sc'collected_objects/object[@id="oval:x:obj:'$((packages + 1))'"]/reference'
+# the installed entry of pkg00001 is reported
+assert_exists 1 $sc'system_data/lin-sys:dpkginfo_item[lin-sys:name="pkg00001"][lin-sys:arch="amd64"][lin-sys:evr="1.1-2"]'
+assert_exists 1 $sc'system_data/lin-sys:dpkginfo_item[lin-sys:name="pkg00007"][lin-sys:epoch="2"][lin-sys:version="1.7"][lin-sys:release="2"]'
+
+rm -rf $root
+rm -f $definitions $results
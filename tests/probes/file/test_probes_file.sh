@@ -120,6 +120,88 @@ function test_probes_file_invalid_utf8 {
 	return $ret_val
 }
 
+function test_probes_file_set {
+
+	probecheck "file" || return 255
+
+	local ret_val=0
+	local files=50
+	local DF=$(mktemp)
+	result=$(mktemp)
+	files_dir=$(mktemp -d)
+
+	for i in $(seq $files); do
+		touch "$files_dir/f$i"
+	done
+
+	# all files, the files with a number ending with 0 and with 0 or 5,
+	# combined by set objects, some of them nested and shared
+	local complement='<set set_operator="COMPLEMENT"><object_reference>oval:x:obj:1</object_reference><object_reference>oval:x:obj:2</object_reference></set>'
+	local intersection='<set set_operator="INTERSECTION"><object_reference>oval:x:obj:2</object_reference><object_reference>oval:x:obj:3</object_reference></set>'
+
+	{
+		cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+		for i in $(seq 10 15); do
+			echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+		done
+		cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+		for i in $(seq 10 15); do
+			echo "    <unix:file_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><unix:object object_ref=\"oval:x:obj:$i\"/></unix:file_test>"
+		done
+		cat <<EOF
+  </tests>
+  <objects>
+    <unix:file_object id="oval:x:obj:1" version="1"><unix:path>$files_dir</unix:path><unix:filename operation="pattern match">^f[0-9]+$</unix:filename></unix:file_object>
+    <unix:file_object id="oval:x:obj:2" version="1"><unix:path>$files_dir</unix:path><unix:filename operation="pattern match">^f[0-9]*0$</unix:filename></unix:file_object>
+    <unix:file_object id="oval:x:obj:3" version="1"><unix:path>$files_dir</unix:path><unix:filename operation="pattern match">^f[0-9]*[05]$</unix:filename></unix:file_object>
+    <unix:file_object id="oval:x:obj:10" version="1">$complement</unix:file_object>
+    <unix:file_object id="oval:x:obj:11" version="1">$intersection</unix:file_object>
+    <unix:file_object id="oval:x:obj:12" version="1"><set><object_reference>oval:x:obj:2</object_reference><object_reference>oval:x:obj:3</object_reference></set></unix:file_object>
+    <unix:file_object id="oval:x:obj:13" version="1"><set>$complement$intersection</set></unix:file_object>
+    <unix:file_object id="oval:x:obj:14" version="1"><set set_operator="INTERSECTION">$complement<set><object_reference>oval:x:obj:3</object_reference></set></set></unix:file_object>
+    <unix:file_object id="oval:x:obj:15" version="1"><set><object_reference>oval:x:obj:1</object_reference><filter action="include">oval:x:ste:1</filter></set></unix:file_object>
+  </objects>
+  <states>
+    <unix:file_state id="oval:x:ste:1" version="1"><unix:filename operation="pattern match">^f[0-9]*5$</unix:filename></unix:file_state>
+  </states>
+</oval_definitions>
+EOF
+	} > $DF
+
+	$OSCAP oval eval --results $result $DF || ret_val=1
+
+	local obj="/oval_results/results/system/oval_system_characteristics/collected_objects/object"
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]' || ret_val=1
+	assert_exists 45 "$obj[@id='oval:x:obj:10']/reference" || ret_val=1
+	assert_exists 5 "$obj[@id='oval:x:obj:11']/reference" || ret_val=1
+	assert_exists 10 "$obj[@id='oval:x:obj:12']/reference" || ret_val=1
+	# each item only once
+	assert_exists 50 "$obj[@id='oval:x:obj:13']/reference" || ret_val=1
+	assert_exists 5 "$obj[@id='oval:x:obj:14']/reference" || ret_val=1
+	assert_exists 5 "$obj[@id='oval:x:obj:15']/reference" || ret_val=1
+
+	rm -f $DF $result
+	rm -rf "$files_dir"
+
+	return $ret_val
+}
+
 # Testing.
 
 test_init
@@ -128,5 +210,6 @@ test_run "test_probes_file with verbose mode" test_probes_file verbose
 test_run "test_probes_file" test_probes_file
 test_run "test_probes_file_filenames" test_probes_file_filenames
 test_run "test_probes_file_invalid_utf8" test_probes_file_invalid_utf8
+test_run "test_probes_file_set" test_probes_file_set
 
 test_exit
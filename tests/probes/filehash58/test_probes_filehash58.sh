@@ -120,6 +120,67 @@ function test_probes_filehash58_chroot_fail {
 	return $ret_val
 }
 
+function test_probes_filehash58_many_files {
+
+    probecheck "filehash58" || return 255
+    require "sha256sum" || return 255
+
+    local ret_val=0
+    local DF=$(mktemp)
+    local RF=$(mktemp)
+    local RF_SINGLE=$(mktemp)
+    local tree=$(mktemp -d)
+
+    for i in $(seq 20); do
+        head -c $((16 * 1024 - 8)) /dev/urandom > $tree/file$i
+        printf "%08d" $i >> $tree/file$i
+    done
+
+    cat > $DF <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:ind="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria><criterion test_ref="oval:x:tst:1"/></criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <ind:filehash58_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1">
+      <ind:object object_ref="oval:x:obj:1"/>
+    </ind:filehash58_test>
+  </tests>
+  <objects>
+    <ind:filehash58_object id="oval:x:obj:1" version="1">
+      <ind:path>$tree</ind:path>
+      <ind:filename operation="pattern match">^file</ind:filename>
+      <ind:hash_type>SHA-256</ind:hash_type>
+    </ind:filehash58_object>
+  </objects>
+</oval_definitions>
+EOF
+
+    $OSCAP oval eval --results $RF $DF > /dev/null || ret_val=1
+
+    # every file has been hashed correctly
+    local items=$(sed -n 's/.*<ind-sys:hash>\([0-9a-f]*\)<.*/\1/p' $RF | sort)
+    local expected=$(cd $tree && sha256sum file* | cut -d' ' -f1 | sort)
+    [ "$items" == "$expected" ] || ret_val=1
+
+    # the order of the collected items doesn't depend on the number of workers
+    OSCAP_MAX_THREADS=1 $OSCAP oval eval --results $RF_SINGLE $DF > /dev/null || ret_val=1
+    diff <(grep -o '<ind-sys:filepath>[^<]*' $RF) <(grep -o '<ind-sys:filepath>[^<]*' $RF_SINGLE) || ret_val=1
+
+    rm -rf $tree
+    rm -f $DF $RF $RF_SINGLE
+
+    return $ret_val
+}
+
 # Testing.
 
 test_init
@@ -134,4 +195,6 @@ test_run "test_probes_filehash58_chroot_fail" test_probes_filehash58_chroot_fail
 
 test_run "test_probes_filehash58_chroot_pass" test_probes_filehash58_chroot_pass
 
+test_run "test_probes_filehash58_many_files" test_probes_filehash58_many_files
+
 test_exit
@@ -0,0 +1,103 @@
+#!/usr/bin/env bash
+
+# Evaluate inetlisteningservers objects against a process holding several
+# listening sockets, all at once and one socket by its port.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "inetlisteningservers" || exit 255
+[ -r /proc/net/tcp ] || exit 255
+
+sockets=10
+objects=5
+
+root=$(mktemp -d)
+ports=$(mktemp)
+definitions=$(mktemp)
+result=$(mktemp)
+
+# the listener holds <sockets> tcp sockets listening on 127.0.0.1
+"$PREFERRED_PYTHON" -c '
+import os, socket, sys, time
+listeners = []
+for i in range(int(sys.argv[1])):
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.bind(("127.0.0.1", 0))
+    s.listen(1)
+    listeners.append(s)
+with open(sys.argv[2] + ".tmp", "w") as f:
+    for s in listeners:
+        f.write("%d\n" % s.getsockname()[1])
+os.rename(sys.argv[2] + ".tmp", sys.argv[2] + ".done")
+time.sleep(600)
+' $sockets "$ports" &
+listener=$!
+trap "kill $listener 2> /dev/null; rm -rf $root; rm -f $ports $ports.done $definitions $result" EXIT
+
+for i in $(seq 100); do
+	[ -f "$ports.done" ] && break
+	sleep 0.1
+done
+[ -f "$ports.done" ]
+mapfile -t port < "$ports.done"
+
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:linux="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+	for i in $(seq $((objects + 1))); do
+		echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+	done
+	cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+	for i in $(seq $((objects + 1))); do
+		echo "    <linux:inetlisteningservers_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><linux:object object_ref=\"oval:x:obj:$i\"/></linux:inetlisteningservers_test>"
+	done
+	cat <<EOF
+  </tests>
+  <objects>
+    <linux:inetlisteningservers_object id="oval:x:obj:1" version="1">
+      <linux:protocol>tcp</linux:protocol>
+      <linux:local_address>127.0.0.1</linux:local_address>
+      <linux:local_port datatype="int" operation="greater than">0</linux:local_port>
+    </linux:inetlisteningservers_object>
+EOF
+	# one listening socket by its port
+	for i in $(seq $objects); do
+		p=${port[$(( (i * 7919) % sockets ))]}
+		echo "    <linux:inetlisteningservers_object id=\"oval:x:obj:$((i + 1))\" version=\"1\"><linux:protocol>tcp</linux:protocol><linux:local_address>127.0.0.1</linux:local_address><linux:local_port datatype=\"int\">$p</linux:local_port></linux:inetlisteningservers_object>"
+	done
+	cat <<EOF
+  </objects>
+</oval_definitions>
+EOF
+} > $definitions
+
+$OSCAP oval eval --results $result $definitions > /dev/null
+
+sc='/oval_results/results/system/oval_system_characteristics'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+assert_exists $sockets "$sc/system_data/lin-sys:inetlisteningserver_item[lin-sys:pid=$listener]"
+p=${port[$((7919 % sockets))]}
+assert_exists 1 "$sc/system_data/lin-sys:inetlisteningserver_item[lin-sys:local_full_address='127.0.0.1:$p'][lin-sys:pid=$listener][lin-sys:user_id=$(id -u)]"
+
+# The sockets of the scanned system can't be read in offline mode, the
+# /proc/net tables always describe the network namespace of the scanner
+OSCAP_PROBE_ROOT="$root" $OSCAP oval eval --results $result $definitions > /dev/null
+assert_exists 1 "$sc/collected_objects/object[@id='oval:x:obj:1'][@flag='not applicable']"
+assert_exists 0 "$sc/system_data/lin-sys:inetlisteningserver_item"
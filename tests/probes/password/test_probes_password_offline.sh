@@ -50,10 +50,103 @@ function test_probes_password {
     return $ret_val
 }
 
+function test_probes_password_shadow_generated {
+
+    probecheck "password" || return 255
+    probecheck "shadow" || return 255
+
+    local users=200
+    local objects=10
+    local DF=$(mktemp)
+    local tmpdir=$(mktemp -t -d "test_password.XXXXXX")
+    result=$(mktemp)
+
+    # the user <n> is "user<n>" with an uid of 1000 + n, "dup" is listed twice
+    mkdir -p "$tmpdir/etc"
+    awk -v count=$users -v etc="$tmpdir/etc" 'BEGIN {
+        for (n = 0; n < count; n++) {
+            printf("user%d:x:%d:%d:User %d:/home/user%d:/bin/bash\n", n, 1000 + n, 100 + n % 10, n, n) > (etc "/passwd");
+            printf("user%d:$6$salt$hash%d:%d:0:99999:7:::\n", n, n, 19000 + n % 1000) > (etc "/shadow");
+        }
+        print "dup:x:10:10::/:/bin/sh" > (etc "/passwd");
+        print "dup:x:11:11::/:/bin/sh" > (etc "/passwd");
+    }'
+
+    {
+        cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+        for i in $(seq $((objects * 2 + 2))); do
+            echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+        done
+        cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+        for i in $(seq $((objects + 2))); do
+            echo "    <unix:password_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><unix:object object_ref=\"oval:x:obj:$i\"/></unix:password_test>"
+        done
+        for i in $(seq $((objects + 3)) $((objects * 2 + 2))); do
+            echo "    <unix:shadow_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><unix:object object_ref=\"oval:x:obj:$i\"/></unix:shadow_test>"
+        done
+        cat <<EOF
+  </tests>
+  <objects>
+EOF
+        # one user by its name, the duplicate user and the users by a pattern
+        for i in $(seq $objects); do
+            n=$(( (i * 7919) % users ))
+            echo "    <unix:password_object id=\"oval:x:obj:$i\" version=\"1\"><unix:username>user$n</unix:username></unix:password_object>"
+        done
+        echo "    <unix:password_object id=\"oval:x:obj:$((objects + 1))\" version=\"1\"><unix:username>dup</unix:username></unix:password_object>"
+        echo "    <unix:password_object id=\"oval:x:obj:$((objects + 2))\" version=\"1\"><unix:username operation=\"pattern match\">^user1[0-9]\$</unix:username></unix:password_object>"
+        for i in $(seq $objects); do
+            n=$(( (i * 7919) % users ))
+            echo "    <unix:shadow_object id=\"oval:x:obj:$((objects + 2 + i))\" version=\"1\"><unix:username>user$n</unix:username></unix:shadow_object>"
+        done
+        cat <<EOF
+  </objects>
+</oval_definitions>
+EOF
+    } > $DF
+
+    set_chroot_offline_test_mode "$tmpdir"
+
+    $OSCAP oval eval --results $result $DF > /dev/null
+
+    unset_chroot_offline_test_mode
+
+    local sc='/oval_results/results/system/oval_system_characteristics'
+    local n=$((7919 % users))
+    assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+    # user1x items of the pattern object may be shared with the single users
+    assert_exists 2 "$sc/system_data/unix-sys:password_item[unix-sys:username='dup']"
+    assert_exists 1 "$sc/system_data/unix-sys:password_item[unix-sys:username='dup'][unix-sys:user_id=11]"
+    assert_exists 10 "$sc/system_data/unix-sys:password_item[starts-with(unix-sys:username, 'user1')][string-length(unix-sys:username)=6]"
+    assert_exists 1 "$sc/system_data/unix-sys:password_item[unix-sys:username='user$n'][unix-sys:user_id=$((1000 + n))][unix-sys:group_id=$((100 + n % 10))][unix-sys:home_dir='/home/user$n'][unix-sys:last_login=-1]"
+    assert_exists 1 "$sc/system_data/unix-sys:shadow_item[unix-sys:username='user$n'][unix-sys:chg_lst=$((19000 + n % 1000))][unix-sys:encrypt_method='SHA-512']"
+    assert_exists $objects "$sc/system_data/unix-sys:shadow_item"
+
+    rm -rf $tmpdir
+    rm -f $DF $result
+}
+
 # Testing.
 
 test_init
 
 test_run "test_probes_password_offline" test_probes_password
+test_run "test_probes_password_shadow_generated" test_probes_password_shadow_generated
 
 test_exit
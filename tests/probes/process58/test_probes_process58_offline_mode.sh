@@ -46,5 +46,110 @@ function test_probes_process58_offline_mode {
     return $ret_val
 }
 
+function test_probes_process58_offline_mode_generated {
+    local processes=50
+    local objects=5
+
+    probecheck "process58" || return 255
+    probecheck "environmentvariable58" || return 255
+
+    local root=$(mktemp -d)
+    local definitions=$(mktemp)
+    local result_single=$(mktemp)
+    result=$(mktemp)
+
+    # pids start at 100, every process runs "/usr/bin/daemon<n> --id <n>" with
+    # a parent of 1 and has two environment variables
+    mkdir -p "$root/proc"
+    printf "cpu  0 0 0 0\nbtime 1700000000\n" > "$root/proc/stat"
+    seq 100 $((processes + 99)) | (cd "$root/proc" && xargs mkdir)
+    awk -v proc="$root/proc" -v count=$processes 'BEGIN {
+        for (n = 0; n < count; n++) {
+            dir = proc "/" (n + 100);
+            printf("%d (daemon%d) S 1 %d %d 0 -1 4194560 100 0 0 0 %d %d 0 0 20 0 1 0 %d 0 0\n",
+                n + 100, n, n + 100, n + 100, n * 10, n * 5, n * 100) > (dir "/stat");
+            close(dir "/stat");
+            printf("Name:\tdaemon%d\nUid:\t%d\t%d\t%d\t%d\n", n, n % 100, n % 50, n % 100, n % 100) > (dir "/status");
+            close(dir "/status");
+            printf("%d", n % 100) > (dir "/loginuid");
+            close(dir "/loginuid");
+            printf("/usr/bin/daemon%d%c--id%c%d%c", n, 0, 0, n, 0) > (dir "/cmdline");
+            close(dir "/cmdline");
+            printf("SERVICE=daemon%d%cINDEX=%d%c", n, 0, n, 0) > (dir "/environ");
+            close(dir "/environ");
+        }
+    }'
+
+    {
+        cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:ind="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+        for i in $(seq $((objects * 2 + 2))); do
+            echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+        done
+        cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+        for i in $(seq $((objects + 1))); do
+            echo "    <unix:process58_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><unix:object object_ref=\"oval:x:obj:$i\"/></unix:process58_test>"
+        done
+        for i in $(seq $((objects + 2)) $((objects * 2 + 2))); do
+            echo "    <ind:environmentvariable58_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><ind:object object_ref=\"oval:x:obj:$i\"/></ind:environmentvariable58_test>"
+        done
+        cat <<EOF
+  </tests>
+  <objects>
+EOF
+        # one process by its command line, then all of them
+        for i in $(seq $objects); do
+            n=$(( (i * 7919) % processes ))
+            echo "    <unix:process58_object id=\"oval:x:obj:$i\" version=\"1\"><unix:command_line>/usr/bin/daemon$n --id $n</unix:command_line><unix:pid datatype=\"int\" operation=\"greater than\">0</unix:pid></unix:process58_object>"
+        done
+        echo "    <unix:process58_object id=\"oval:x:obj:$((objects + 1))\" version=\"1\"><unix:command_line operation=\"pattern match\">^/usr/bin/daemon</unix:command_line><unix:pid datatype=\"int\" operation=\"greater than\">0</unix:pid></unix:process58_object>"
+        # the environment of one process by its pid, then of all of them
+        for i in $(seq $objects); do
+            pid=$(( (i * 7919) % processes + 100 ))
+            echo "    <ind:environmentvariable58_object id=\"oval:x:obj:$((objects + 1 + i))\" version=\"1\"><ind:pid datatype=\"int\">$pid</ind:pid><ind:name operation=\"pattern match\">.*</ind:name></ind:environmentvariable58_object>"
+        done
+        echo "    <ind:environmentvariable58_object id=\"oval:x:obj:$((objects * 2 + 2))\" version=\"1\"><ind:pid datatype=\"int\" operation=\"greater than\">0</ind:pid><ind:name>INDEX</ind:name></ind:environmentvariable58_object>"
+        cat <<EOF
+  </objects>
+</oval_definitions>
+EOF
+    } > $definitions
+
+    OSCAP_PROBE_ROOT="$root" $OSCAP oval eval --results $result $definitions > /dev/null
+
+    local sc='/oval_results/results/system/oval_system_characteristics'
+    assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+    assert_exists $processes "$sc/system_data/unix-sys:process58_item"
+    # the INDEX items of the single processes are shared with the last object
+    assert_exists $((processes + objects)) "$sc/system_data/ind-sys:environmentvariable58_item"
+    local n=$((7919 % processes))
+    assert_exists 1 "$sc/system_data/unix-sys:process58_item[unix-sys:pid=$((n + 100))][unix-sys:command_line='/usr/bin/daemon$n --id $n'][unix-sys:ppid=1][unix-sys:ruid=$((n % 100))][unix-sys:user_id=$((n % 50))][unix-sys:loginuid=$((n % 100))][unix-sys:session_id=$((n + 100))]"
+    assert_exists 1 "$sc/system_data/ind-sys:environmentvariable58_item[ind-sys:pid=$((n + 100))][ind-sys:name='SERVICE'][ind-sys:value='daemon$n']"
+
+    # the order of the collected items doesn't depend on the number of workers
+    OSCAP_PROBE_ROOT="$root" OSCAP_MAX_THREADS=1 $OSCAP oval eval --results $result_single $definitions > /dev/null
+    diff <(grep -o '<unix-sys:pid[^<]*' $result) <(grep -o '<unix-sys:pid[^<]*' $result_single)
+    diff <(grep -o '<ind-sys:pid[^<]*' $result) <(grep -o '<ind-sys:pid[^<]*' $result_single)
+
+    rm -rf $root
+    rm -f $definitions $result $result_single
+}
+
 test_run "Ensure that probe handles \$OSCAP_CHROOT"      test_probes_process58_offline_mode "true"
 test_run "Ensure that probe handles empty \$SCAP_CHROOT" test_probes_process58_offline_mode "false"
+test_run "Ensure that probe handles a generated /proc"   test_probes_process58_offline_mode_generated
@@ -23,8 +23,72 @@ B_NAME=`rpm --qf "%{NAME}\n" -qa | sort | uniq -u | sed -n '2p'`
 
 [ -n "$A_NAME" ] || exit 255
 
+# One object per name of 20 installed packages, every package has to be
+# collected exactly once.
+function test_probes_rpminfo_names {
+    probecheck "rpminfo" || return 255
+
+    local names=$(rpm --qf "%{NAME}\n" -qa | sort -u | head -n 20)
+    local DF=$(mktemp)
+    local RF=$(mktemp)
+    local i
+
+    {
+    cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:lin-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+    i=0
+    for name in $names; do
+        i=$((i + 1))
+        echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+    done
+    cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+    i=0
+    for name in $names; do
+        i=$((i + 1))
+        echo "    <lin-def:rpminfo_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><lin-def:object object_ref=\"oval:x:obj:$i\"/></lin-def:rpminfo_test>"
+    done
+    cat <<EOF
+  </tests>
+  <objects>
+EOF
+    i=0
+    for name in $names; do
+        i=$((i + 1))
+        echo "    <lin-def:rpminfo_object id=\"oval:x:obj:$i\" version=\"1\"><lin-def:name>$name</lin-def:name></lin-def:rpminfo_object>"
+    done
+    cat <<EOF
+  </objects>
+</oval_definitions>
+EOF
+    } > $DF
+
+    $OSCAP oval eval --results $RF $DF > /dev/null
+
+    local expected=$(for name in $names; do rpm -q --qf "%{NAME}\n" $name; done | wc -l)
+    [ "$(grep -c '<lin-sys:rpminfo_item ' $RF)" == "$expected" ]
+    grep -q 'definition_id="oval:x:def:1" result="true"' $RF
+
+    rm -f $DF $RF
+}
+
 test_init
 
 test_run "rpminfo probe test" test_probes_rpminfo $A_NAME $B_NAME
+test_run "rpminfo probe test of installed package names" test_probes_rpminfo_names
 
 test_exit
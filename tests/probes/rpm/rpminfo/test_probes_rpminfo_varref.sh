@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+# Evaluate rpminfo objects whose name references a variable with several
+# values. The names are looked up at once and every package has to be
+# reported once, even when it matches more than one value.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "rpminfo" || exit 255
+require "rpm" || exit 255
+
+names=$(rpm --qf "%{NAME}\n" -qa | sort | uniq -u | grep -E '^[A-Za-z0-9_-]+$' | head -n 3)
+[ $(echo "$names" | wc -l) -eq 3 ] || exit 255
+a=$(echo "$names" | sed -n '1p')
+
+definitions=$(mktemp)
+result=$(mktemp)
+trap "rm -f $definitions $result" EXIT
+
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:lin-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2"/>
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <lin-def:rpminfo_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1"><lin-def:object object_ref="oval:x:obj:1"/></lin-def:rpminfo_test>
+    <lin-def:rpminfo_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:2" version="1"><lin-def:object object_ref="oval:x:obj:2"/></lin-def:rpminfo_test>
+  </tests>
+  <objects>
+    <lin-def:rpminfo_object id="oval:x:obj:1" version="1">
+      <lin-def:name var_ref="oval:x:var:1" var_check="at least one"/>
+    </lin-def:rpminfo_object>
+    <lin-def:rpminfo_object id="oval:x:obj:2" version="1">
+      <lin-def:name operation="pattern match" var_ref="oval:x:var:2" var_check="at least one"/>
+    </lin-def:rpminfo_object>
+  </objects>
+  <variables>
+    <constant_variable id="oval:x:var:1" version="1" datatype="string" comment="three packages, a duplicate and a missing package">
+EOF
+	for name in $names $a; do
+		echo "      <value>$name</value>"
+	done
+	cat <<EOF
+      <value>oscap-missing-package</value>
+    </constant_variable>
+    <constant_variable id="oval:x:var:2" version="1" datatype="string" comment="two patterns matching the same package">
+      <value>^$a\$</value>
+      <value>^($a)\$</value>
+    </constant_variable>
+  </variables>
+</oval_definitions>
+EOF
+} > $definitions
+
+$OSCAP oval eval --results $result $definitions > /dev/null
+
+sc='/oval_results/results/system/oval_system_characteristics'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+for name in $names; do
+	assert_exists 1 "$sc/system_data/lin-sys:rpminfo_item[lin-sys:name='$name']"
+done
+assert_exists 3 "$sc/collected_objects/object[@id='oval:x:obj:1']/reference"
+assert_exists 1 "$sc/collected_objects/object[@id='oval:x:obj:2']/reference"
@@ -0,0 +1,56 @@
+#!/usr/bin/env bash
+
+# Verify all files of a few installed packages with the rpmverify probe.
+# The packages are verified by a pool of workers, the collected items have
+# to be the same as with a single worker.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "rpmverify" || exit 255
+require "rpm" || exit 255
+
+names=$(rpm --qf "%{NAME}\n" -qa | sort -u | head -n 3)
+[ -n "$names" ] || exit 255
+pattern="^($(echo $names | sed 's/[.+]/\\&/g; s/ /|/g'))\$"
+
+definitions=$(mktemp)
+results=$(mktemp)
+results_single=$(mktemp)
+
+cat > $definitions <<EOF2
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:lin-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria><criterion test_ref="oval:x:tst:1"/></criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <lin-def:rpmverify_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1">
+      <lin-def:object object_ref="oval:x:obj:1"/>
+    </lin-def:rpmverify_test>
+  </tests>
+  <objects>
+    <lin-def:rpmverify_object id="oval:x:obj:1" version="1">
+      <lin-def:name operation="pattern match">$pattern</lin-def:name>
+      <lin-def:filepath operation="pattern match">.*</lin-def:filepath>
+    </lin-def:rpmverify_object>
+  </objects>
+</oval_definitions>
+EOF2
+
+$OSCAP oval eval --results $results $definitions > /dev/null
+
+# the collected items don't depend on the number of workers
+OSCAP_MAX_THREADS=1 $OSCAP oval eval --results $results_single $definitions > /dev/null
+diff <(sed -n '/<lin-sys:rpmverify_item/,/<\/lin-sys:rpmverify_item>/p' $results) \
+	<(sed -n '/<lin-sys:rpmverify_item/,/<\/lin-sys:rpmverify_item>/p' $results_single)
+
+rm -f $definitions $results $results_single
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+/*
+ * Mock of the systemd D-Bus service used by the systemd probe tests.
+ *
+ *   test_probes_systemd_mock <bus address> <ready file> <services> <groups> <properties>
+ *
+ * The mock serves ListUnitFiles and LoadUnit of the manager and Get and
+ * GetAll of the units. The units are:
+ *
+ *   service<n>.service     n < services, <properties> extra properties
+ *   getty@.service         listed as a template, loaded as getty.service
+ *   multi-user.target      Requires basic.target, Wants group<k>.target
+ *   group<k>.target        k < groups, Wants service<n>.service for n % groups == k
+ *                          and Requires basic.target
+ *   basic.target           Wants sysinit.target
+ *   sysinit.target         Requires basic.target
+ *
+ * The ready file is created once the service name is owned. The number of
+ * the calls of each method is printed when the bus goes away.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dbus/dbus.h>
+
+#define UNIT_PATH_PREFIX "/org/freedesktop/systemd1/unit/u"
+
+struct mock_unit {
+	char *name;
+	char *file;
+	char **requires;
+	size_t requires_count;
+	char **wants;
+	size_t wants_count;
+};
+
+static struct mock_unit *units;
+static size_t unit_count;
+static int extra_properties;
+
+static unsigned long calls_list, calls_load, calls_get, calls_get_all;
+
+static struct mock_unit *add_unit(const char *name, const char *file)
+{
+	units = realloc(units, (unit_count + 1) * sizeof(struct mock_unit));
+	struct mock_unit *unit = &units[unit_count++];
+	memset(unit, 0, sizeof(*unit));
+	unit->name = strdup(name);
+	unit->file = strdup(file != NULL ? file : name);
+	return unit;
+}
+
+static void add_dependency(char ***list, size_t *count, const char *name)
+{
+	*list = realloc(*list, (*count + 1) * sizeof(char *));
+	(*list)[(*count)++] = strdup(name);
+}
+
+static void create_units(int services, int groups)
+{
+	char name[64];
+
+	for (int n = 0; n < services; ++n) {
+		snprintf(name, sizeof(name), "service%d.service", n);
+		add_unit(name, NULL);
+	}
+	add_unit("getty.service", "getty@.service");
+
+	struct mock_unit *unit = add_unit("multi-user.target", NULL);
+	add_dependency(&unit->requires, &unit->requires_count, "basic.target");
+	for (int k = 0; k < groups; ++k) {
+		snprintf(name, sizeof(name), "group%d.target", k);
+		add_dependency(&unit->wants, &unit->wants_count, name);
+	}
+	for (int k = 0; k < groups; ++k) {
+		snprintf(name, sizeof(name), "group%d.target", k);
+		unit = add_unit(name, NULL);
+		add_dependency(&unit->requires, &unit->requires_count, "basic.target");
+		for (int n = k; n < services; n += groups) {
+			snprintf(name, sizeof(name), "service%d.service", n);
+			add_dependency(&unit->wants, &unit->wants_count, name);
+		}
+	}
+	unit = add_unit("basic.target", NULL);
+	add_dependency(&unit->wants, &unit->wants_count, "sysinit.target");
+	unit = add_unit("sysinit.target", NULL);
+	add_dependency(&unit->requires, &unit->requires_count, "basic.target");
+}
+
+static struct mock_unit *find_unit_by_name(const char *name)
+{
+	for (size_t i = 0; i < unit_count; ++i) {
+		if (strcmp(units[i].name, name) == 0)
+			return &units[i];
+	}
+	return NULL;
+}
+
+static struct mock_unit *find_unit_by_path(const char *path)
+{
+	if (path == NULL || strncmp(path, UNIT_PATH_PREFIX, strlen(UNIT_PATH_PREFIX)) != 0)
+		return NULL;
+
+	size_t i = strtoul(path + strlen(UNIT_PATH_PREFIX), NULL, 10);
+	return i < unit_count ? &units[i] : NULL;
+}
+
+static void append_string_variant(DBusMessageIter *iter, const char *value)
+{
+	DBusMessageIter variant;
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "s", &variant);
+	dbus_message_iter_append_basic(&variant, DBUS_TYPE_STRING, &value);
+	dbus_message_iter_close_container(iter, &variant);
+}
+
+static void append_array_variant(DBusMessageIter *iter, char **values, size_t count)
+{
+	DBusMessageIter variant, array;
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "as", &variant);
+	dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "s", &array);
+	for (size_t i = 0; i < count; ++i)
+		dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &values[i]);
+	dbus_message_iter_close_container(&variant, &array);
+	dbus_message_iter_close_container(iter, &variant);
+}
+
+/* Append the value of a property, returns 0 if the unit has no such property */
+static int append_property(DBusMessageIter *iter, const struct mock_unit *unit, const char *property)
+{
+	char buf[128];
+
+	if (strcmp(property, "Id") == 0) {
+		append_string_variant(iter, unit->name);
+	} else if (strcmp(property, "Description") == 0) {
+		snprintf(buf, sizeof(buf), "Mock unit %s", unit->name);
+		append_string_variant(iter, buf);
+	} else if (strcmp(property, "LoadState") == 0) {
+		append_string_variant(iter, "loaded");
+	} else if (strcmp(property, "ActiveState") == 0) {
+		append_string_variant(iter, "active");
+	} else if (strcmp(property, "Requires") == 0) {
+		append_array_variant(iter, unit->requires, unit->requires_count);
+	} else if (strcmp(property, "Wants") == 0) {
+		append_array_variant(iter, unit->wants, unit->wants_count);
+	} else if (strncmp(property, "Extra", 5) == 0 && atoi(property + 5) < extra_properties) {
+		snprintf(buf, sizeof(buf), "%s of %s", property, unit->name);
+		append_string_variant(iter, buf);
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+static void append_entry(DBusMessageIter *dict, const struct mock_unit *unit, const char *property)
+{
+	DBusMessageIter entry;
+
+	dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &property);
+	append_property(&entry, unit, property);
+	dbus_message_iter_close_container(dict, &entry);
+}
+
+static DBusMessage *handle_get_all(DBusMessage *msg, const struct mock_unit *unit)
+{
+	static const char *properties[] = { "Id", "Description", "LoadState", "ActiveState", "Requires", "Wants", NULL };
+	DBusMessage *reply = dbus_message_new_method_return(msg);
+	DBusMessageIter iter, dict;
+	char name[32];
+
+	dbus_message_iter_init_append(reply, &iter);
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+	for (int i = 0; properties[i] != NULL; ++i)
+		append_entry(&dict, unit, properties[i]);
+	for (int i = 0; i < extra_properties; ++i) {
+		snprintf(name, sizeof(name), "Extra%d", i);
+		append_entry(&dict, unit, name);
+	}
+	dbus_message_iter_close_container(&iter, &dict);
+
+	return reply;
+}
+
+static DBusMessage *handle_message(DBusMessage *msg)
+{
+	const char *arg = NULL, *arg2 = NULL;
+
+	if (dbus_message_is_method_call(msg, "org.freedesktop.systemd1.Manager", "ListUnitFiles")) {
+		DBusMessage *reply = dbus_message_new_method_return(msg);
+		DBusMessageIter iter, array, item;
+		char path[256];
+		const char *state = "enabled", *p = path;
+
+		calls_list++;
+		dbus_message_iter_init_append(reply, &iter);
+		dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(ss)", &array);
+		for (size_t i = 0; i < unit_count; ++i) {
+			snprintf(path, sizeof(path), "/usr/lib/systemd/system/%s", units[i].file);
+			dbus_message_iter_open_container(&array, DBUS_TYPE_STRUCT, NULL, &item);
+			dbus_message_iter_append_basic(&item, DBUS_TYPE_STRING, &p);
+			dbus_message_iter_append_basic(&item, DBUS_TYPE_STRING, &state);
+			dbus_message_iter_close_container(&array, &item);
+		}
+		dbus_message_iter_close_container(&iter, &array);
+		return reply;
+	}
+
+	if (dbus_message_is_method_call(msg, "org.freedesktop.systemd1.Manager", "LoadUnit")) {
+		calls_load++;
+		if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg, DBUS_TYPE_INVALID))
+			return dbus_message_new_error(msg, DBUS_ERROR_INVALID_ARGS, "Expected a unit name");
+
+		struct mock_unit *unit = find_unit_by_name(arg);
+		if (unit == NULL)
+			return dbus_message_new_error(msg, "org.freedesktop.systemd1.NoSuchUnit", arg);
+
+		char path[64];
+		const char *p = path;
+		snprintf(path, sizeof(path), UNIT_PATH_PREFIX "%zu", (size_t)(unit - units));
+		DBusMessage *reply = dbus_message_new_method_return(msg);
+		dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &p, DBUS_TYPE_INVALID);
+		return reply;
+	}
+
+	struct mock_unit *unit = find_unit_by_path(dbus_message_get_path(msg));
+
+	if (unit != NULL && dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES, "GetAll")) {
+		calls_get_all++;
+		return handle_get_all(msg, unit);
+	}
+
+	if (unit != NULL && dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES, "Get")) {
+		calls_get++;
+		if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg, DBUS_TYPE_STRING, &arg2, DBUS_TYPE_INVALID))
+			return dbus_message_new_error(msg, DBUS_ERROR_INVALID_ARGS, "Expected an interface and a property");
+
+		DBusMessage *reply = dbus_message_new_method_return(msg);
+		DBusMessageIter iter;
+		dbus_message_iter_init_append(reply, &iter);
+		if (!append_property(&iter, unit, arg2)) {
+			dbus_message_unref(reply);
+			return dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_PROPERTY, arg2);
+		}
+		return reply;
+	}
+
+	if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_METHOD_CALL)
+		return dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_METHOD, dbus_message_get_member(msg));
+
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	DBusConnection *conn;
+	DBusError err;
+
+	if (argc != 6) {
+		fprintf(stderr, "Usage: %s <bus address> <ready file> <services> <groups> <properties>\n", argv[0]);
+		return 1;
+	}
+
+	create_units(atoi(argv[3]), atoi(argv[4]));
+	extra_properties = atoi(argv[5]);
+
+	dbus_error_init(&err);
+	conn = dbus_connection_open_private(argv[1], &err);
+	if (conn == NULL || !dbus_bus_register(conn, &err)) {
+		fprintf(stderr, "Can't connect to %s: %s\n", argv[1], err.message);
+		return 1;
+	}
+	if (dbus_bus_request_name(conn, "org.freedesktop.systemd1", DBUS_NAME_FLAG_DO_NOT_QUEUE, &err) != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+		fprintf(stderr, "Can't own org.freedesktop.systemd1: %s\n", err.message);
+		return 1;
+	}
+
+	FILE *ready = fopen(argv[2], "w");
+	if (ready != NULL)
+		fclose(ready);
+
+	while (dbus_connection_read_write(conn, -1)) {
+		DBusMessage *msg;
+
+		while ((msg = dbus_connection_pop_message(conn)) != NULL) {
+			DBusMessage *reply = handle_message(msg);
+			if (reply != NULL) {
+				dbus_connection_send(conn, reply, NULL);
+				dbus_message_unref(reply);
+			}
+			dbus_message_unref(msg);
+		}
+	}
+
+	printf("ListUnitFiles=%lu LoadUnit=%lu GetAll=%lu Get=%lu\n", calls_list, calls_load, calls_get_all, calls_get);
+	dbus_connection_close(conn);
+	dbus_connection_unref(conn);
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+#!/usr/bin/env bash
+
+# Evaluate systemdunitproperty and systemdunitdependency objects against a
+# mock of the systemd D-Bus service on a private bus. Each unit has to be
+# fetched from the bus at most once.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "systemdunitproperty" || exit 255
+probecheck "systemdunitdependency" || exit 255
+command -v dbus-daemon > /dev/null || exit 255
+
+mock="$builddir/tests/probes/systemdunitproperty/test_probes_systemd_mock"
+services=50
+groups=5
+properties=20
+objects=5
+
+root=$(mktemp -d)
+definitions=$(mktemp)
+result=$(mktemp)
+stats=$(mktemp)
+
+# a private bus at the location of the system bus below $OSCAP_PROBE_ROOT,
+# it limits the pending replies of a connection the same way the system bus does
+mkdir -p "$root/run/dbus"
+cat > "$root/bus.conf" <<EOF
+<!DOCTYPE busconfig PUBLIC "-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN" "http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd">
+<busconfig>
+  <type>custom</type>
+  <listen>unix:path=$root/run/dbus/system_bus_socket</listen>
+  <auth>EXTERNAL</auth>
+  <policy context="default">
+    <allow send_destination="*" eavesdrop="true"/>
+    <allow eavesdrop="true"/>
+    <allow own="*"/>
+  </policy>
+  <limit name="max_replies_per_connection">128</limit>
+</busconfig>
+EOF
+dbus-daemon --config-file="$root/bus.conf" --nofork --nopidfile &
+bus_pid=$!
+trap 'kill $bus_pid 2> /dev/null || true; rm -rf $root; rm -f $definitions $result $stats' EXIT
+
+for i in $(seq 100); do
+	[ -S "$root/run/dbus/system_bus_socket" ] && break
+	sleep 0.1
+done
+"$mock" "unix:path=$root/run/dbus/system_bus_socket" "$root/ready" $services $groups $properties > $stats &
+mock_pid=$!
+for i in $(seq 100); do
+	[ -f "$root/ready" ] && break
+	sleep 0.1
+done
+[ -f "$root/ready" ]
+
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:linux="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+	for i in $(seq $((objects + 6))); do
+		echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+	done
+	cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+	for i in $(seq $((objects + 2))); do
+		echo "    <linux:systemdunitproperty_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><linux:object object_ref=\"oval:x:obj:$i\"/></linux:systemdunitproperty_test>"
+	done
+	for i in $(seq $((objects + 3)) $((objects + 6))); do
+		echo "    <linux:systemdunitdependency_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><linux:object object_ref=\"oval:x:obj:$i\"/></linux:systemdunitdependency_test>"
+	done
+	cat <<EOF
+  </tests>
+  <objects>
+EOF
+	# one property of a single service, all properties of some services and the template
+	for i in $(seq $objects); do
+		n=$(( (i * 7919) % services ))
+		echo "    <linux:systemdunitproperty_object id=\"oval:x:obj:$i\" version=\"1\"><linux:unit>service$n.service</linux:unit><linux:property>Description</linux:property></linux:systemdunitproperty_object>"
+	done
+	echo "    <linux:systemdunitproperty_object id=\"oval:x:obj:$((objects + 1))\" version=\"1\"><linux:unit operation=\"pattern match\">^service1[0-9]\.service\$</linux:unit><linux:property operation=\"pattern match\">.*</linux:property></linux:systemdunitproperty_object>"
+	echo "    <linux:systemdunitproperty_object id=\"oval:x:obj:$((objects + 2))\" version=\"1\"><linux:unit>getty.service</linux:unit><linux:property>Id</linux:property></linux:systemdunitproperty_object>"
+	# the dependencies of the default target, a group, a service and all targets
+	echo "    <linux:systemdunitdependency_object id=\"oval:x:obj:$((objects + 3))\" version=\"1\"><linux:unit>multi-user.target</linux:unit></linux:systemdunitdependency_object>"
+	echo "    <linux:systemdunitdependency_object id=\"oval:x:obj:$((objects + 4))\" version=\"1\"><linux:unit>group0.target</linux:unit></linux:systemdunitdependency_object>"
+	echo "    <linux:systemdunitdependency_object id=\"oval:x:obj:$((objects + 5))\" version=\"1\"><linux:unit>service0.service</linux:unit></linux:systemdunitdependency_object>"
+	echo "    <linux:systemdunitdependency_object id=\"oval:x:obj:$((objects + 6))\" version=\"1\"><linux:unit operation=\"pattern match\">\.target\$</linux:unit></linux:systemdunitdependency_object>"
+	cat <<EOF
+  </objects>
+</oval_definitions>
+EOF
+} > $definitions
+
+unset DBUS_SYSTEM_BUS_ADDRESS
+export OSCAP_PROBE_ROOT="$root"
+
+$OSCAP oval eval --results $result $definitions > /dev/null
+
+unset OSCAP_PROBE_ROOT
+kill $bus_pid
+wait $mock_pid || true
+
+sc='/oval_results/results/system/oval_system_characteristics'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+n=$((7919 % services))
+assert_exists 1 "$sc/system_data/lin-sys:systemdunitproperty_item[lin-sys:unit='service$n.service'][lin-sys:property='Description'][lin-sys:value='Mock unit service$n.service']"
+assert_exists 1 "$sc/system_data/lin-sys:systemdunitproperty_item[lin-sys:unit='service12.service'][lin-sys:property='Extra$((properties - 1))'][lin-sys:value='Extra$((properties - 1)) of service12.service']"
+# empty arrays aren't reported
+assert_exists 0 "$sc/system_data/lin-sys:systemdunitproperty_item[lin-sys:unit='service12.service'][lin-sys:property='Requires']"
+assert_exists 1 "$sc/system_data/lin-sys:systemdunitproperty_item[lin-sys:unit='getty.service'][lin-sys:value='getty.service']"
+# basic.target, sysinit.target, the groups and all services
+assert_exists $((2 + groups + services)) "$sc/system_data/lin-sys:systemdunitdependency_item[lin-sys:unit='multi-user.target']/lin-sys:dependency"
+assert_exists 1 "$sc/system_data/lin-sys:systemdunitdependency_item[lin-sys:unit='group0.target'][lin-sys:dependency[1]='basic.target'][lin-sys:dependency[2]='sysinit.target'][lin-sys:dependency[3]='service0.service']"
+assert_exists 1 "$sc/system_data/lin-sys:systemdunitdependency_item[lin-sys:unit='service0.service'][not(lin-sys:dependency)]"
+assert_exists 1 "$sc/system_data/lin-sys:systemdunitdependency_item[lin-sys:unit='sysinit.target'][lin-sys:dependency[1]='basic.target'][lin-sys:dependency[2]='sysinit.target']"
+# the unit files are listed once and each unit is fetched at most once
+grep -q "ListUnitFiles=1 " $stats
+awk -v units=$((services + groups + 4)) '{
+	split($2, load, "="); split($3, get_all, "=");
+	if (load[2] > units || get_all[2] > units) exit 1;
+}' $stats
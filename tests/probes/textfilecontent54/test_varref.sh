@@ -0,0 +1,108 @@
+#!/usr/bin/env bash
+
+# Evaluate textfilecontent54 and file objects whose entities reference
+# variables with many values, duplicates and missing files.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "textfilecontent54" || exit 255
+probecheck "file" || exit 255
+
+files=20
+
+dir=$(mktemp -d)
+definitions=$(mktemp)
+result=$(mktemp)
+
+mkdir "$dir/sub"
+for i in $(seq $files); do
+	printf "key%d = %d\nother = x\nsecond%d = y\n" $i $i $i > "$dir/f$i.conf"
+done
+cp "$dir/f1.conf" "$dir/sub/"
+
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:ind="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns:unix="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2"/>
+        <criterion test_ref="oval:x:tst:3"/>
+        <criterion test_ref="oval:x:tst:4" negate="true"/>
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+    <ind:textfilecontent54_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:1" version="1"><ind:object object_ref="oval:x:obj:1"/></ind:textfilecontent54_test>
+    <ind:textfilecontent54_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:2" version="1"><ind:object object_ref="oval:x:obj:2"/></ind:textfilecontent54_test>
+    <unix:file_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:3" version="1"><unix:object object_ref="oval:x:obj:3"/></unix:file_test>
+    <unix:file_test check="all" check_existence="at_least_one_exists" comment="x" id="oval:x:tst:4" version="1"><unix:object object_ref="oval:x:obj:4"/></unix:file_test>
+  </tests>
+  <objects>
+    <ind:textfilecontent54_object id="oval:x:obj:1" version="1">
+      <ind:filepath var_ref="oval:x:var:1" var_check="at least one"/>
+      <ind:pattern operation="pattern match" var_ref="oval:x:var:2" var_check="at least one"/>
+      <ind:instance datatype="int" operation="greater than or equal">1</ind:instance>
+    </ind:textfilecontent54_object>
+    <ind:textfilecontent54_object id="oval:x:obj:2" version="1">
+      <ind:path var_ref="oval:x:var:3" var_check="at least one"/>
+      <ind:filename operation="pattern match">^f1.*\.conf\$</ind:filename>
+      <ind:pattern operation="pattern match">^key(\d+) = (\d+)\$</ind:pattern>
+      <ind:instance datatype="int">1</ind:instance>
+    </ind:textfilecontent54_object>
+    <unix:file_object id="oval:x:obj:3" version="1">
+      <unix:filepath var_ref="oval:x:var:1" var_check="at least one"/>
+    </unix:file_object>
+    <unix:file_object id="oval:x:obj:4" version="1">
+      <unix:filepath var_ref="oval:x:var:1" var_check="all"/>
+    </unix:file_object>
+  </objects>
+  <variables>
+    <constant_variable id="oval:x:var:1" version="1" datatype="string" comment="all files, a duplicate and a missing file">
+EOF
+	for i in $(seq $files); do
+		echo "      <value>$dir/f$i.conf</value>"
+	done
+	cat <<EOF
+      <value>$dir/f1.conf</value>
+      <value>$dir/missing.conf</value>
+    </constant_variable>
+    <constant_variable id="oval:x:var:2" version="1" datatype="string" comment="two patterns and a duplicate">
+      <value>^key(\d+) = (\d+)\$</value>
+      <value>^second(\d+) = (\w)\$</value>
+      <value>^key(\d+) = (\d+)\$</value>
+    </constant_variable>
+    <constant_variable id="oval:x:var:3" version="1" datatype="string" comment="nested directories and a duplicate">
+      <value>$dir</value>
+      <value>$dir/sub</value>
+      <value>$dir</value>
+    </constant_variable>
+  </variables>
+</oval_definitions>
+EOF
+} > $definitions
+
+$OSCAP oval eval --results $result $definitions > /dev/null
+
+sc='/oval_results/results/system/oval_system_characteristics'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+# each file matches both patterns once
+assert_exists $((files * 2)) "$sc/collected_objects/object[@id='oval:x:obj:1']/reference"
+assert_exists 1 "$sc/system_data/ind-sys:textfilecontent_item[ind-sys:filename='f$files.conf'][ind-sys:subexpression[1]='$files'][ind-sys:subexpression[2]='y']"
+# the files in the directory and the copy in the subdirectory, each once
+assert_exists $(( $(ls "$dir" | grep -c '^f1.*\.conf$') + 1 )) "$sc/collected_objects/object[@id='oval:x:obj:2']/reference"
+assert_exists $files "$sc/collected_objects/object[@id='oval:x:obj:3']/reference"
+# a single file can't be equal to all values
+assert_exists 1 "$sc/collected_objects/object[@id='oval:x:obj:4'][@flag='does not exist']"
+
+rm -rf $dir
+rm -f $definitions $result
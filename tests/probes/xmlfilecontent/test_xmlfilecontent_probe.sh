@@ -17,4 +17,81 @@ assert_exists 1 '/oval_results/results/system/definitions/definition[@definition
 assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:5" and @result="true"]'
 assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:6" and @result="true"]'
 assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:7" and @result="true"]'
-rm -f $result
\ No newline at end of file
+rm -f $result
+
+# many objects querying a single generated file
+connectors=200
+objects=5
+
+dir=$(mktemp -d)
+definitions=$(mktemp)
+result=$(mktemp)
+
+# the connector <n> listens on the port 10000 + n, the elements and the
+# attributes are in a namespace which the XPath expressions ignore
+awk -v count=$connectors 'BEGIN {
+	print "<?xml version=\"1.0\"?>";
+	print "<s:Server xmlns:s=\"http://example.com/server\" xmlns:x=\"http://example.com/extra\" port=\"8005\">";
+	print "  <s:Service name=\"Catalina\">";
+	for (n = 0; n < count; n++)
+		printf("    <s:Connector x:port=\"%d\" protocol=\"HTTP/1.1\" secure=\"%s\"><s:Name>connector%d</s:Name></s:Connector>\n",
+			10000 + n, n % 2 ? "true" : "false", n);
+	print "  </s:Service>";
+	print "</s:Server>";
+}' > "$dir/server.xml"
+awk -v count=$connectors 'BEGIN { printf("<a><b>%d</b></a>\n", count); }' > "$dir/other.xml"
+
+{
+	cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:ind="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+  <generator>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2026-01-01T00:00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" id="oval:x:def:1" version="1">
+      <metadata><title>x</title><description>x</description></metadata>
+      <criteria operator="AND">
+EOF
+	for i in $(seq $((objects + 2))); do
+		echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+	done
+	cat <<EOF
+      </criteria>
+    </definition>
+  </definitions>
+  <tests>
+EOF
+	for i in $(seq $((objects + 2))); do
+		echo "    <ind:xmlfilecontent_test check=\"all\" check_existence=\"at_least_one_exists\" comment=\"x\" id=\"oval:x:tst:$i\" version=\"1\"><ind:object object_ref=\"oval:x:obj:$i\"/></ind:xmlfilecontent_test>"
+	done
+	cat <<EOF
+  </tests>
+  <objects>
+EOF
+	# the name of one connector, a count, and the same expression in both files
+	for i in $(seq $objects); do
+		n=$(( (i * 7919) % connectors ))
+		echo "    <ind:xmlfilecontent_object id=\"oval:x:obj:$i\" version=\"1\"><ind:filepath>$dir/server.xml</ind:filepath><ind:xpath>/Server/Service/Connector[@port='$((10000 + n))']/Name/text()</ind:xpath></ind:xmlfilecontent_object>"
+	done
+	echo "    <ind:xmlfilecontent_object id=\"oval:x:obj:$((objects + 1))\" version=\"1\"><ind:filepath>$dir/server.xml</ind:filepath><ind:xpath>count(//Connector[@secure='true'])</ind:xpath></ind:xmlfilecontent_object>"
+	echo "    <ind:xmlfilecontent_object id=\"oval:x:obj:$((objects + 2))\" version=\"1\"><ind:path>$dir</ind:path><ind:filename operation=\"pattern match\">\.xml\$</ind:filename><ind:xpath>//*[@port='8005' or text()='$connectors']/@port|//b/text()</ind:xpath></ind:xmlfilecontent_object>"
+	cat <<EOF
+  </objects>
+</oval_definitions>
+EOF
+} > $definitions
+
+$OSCAP oval eval --results $result $definitions > /dev/null
+
+sc='/oval_results/results/system/oval_system_characteristics'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+n=$((7919 % connectors))
+assert_exists 1 "$sc/system_data/ind-sys:xmlfilecontent_item[ind-sys:filename='server.xml'][ind-sys:value_of='connector$n']"
+assert_exists 1 "$sc/system_data/ind-sys:xmlfilecontent_item[ind-sys:xpath=\"count(//Connector[@secure='true'])\"][ind-sys:value_of=$((connectors / 2))]"
+assert_exists 1 "$sc/system_data/ind-sys:xmlfilecontent_item[ind-sys:filename='server.xml'][ind-sys:value_of='8005']"
+assert_exists 1 "$sc/system_data/ind-sys:xmlfilecontent_item[ind-sys:filename='other.xml'][ind-sys:value_of='$connectors']"
+
+rm -rf $dir
+rm -f $definitions $result
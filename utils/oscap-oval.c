@@ -110,6 +110,8 @@ static struct oscap_module OVAL_EVAL = {
 	"   --report <file>               - Create human readable (HTML) report from OVAL Results.\n"
 	"   --skip-valid                  - Skip validation.\n"
 	"   --skip-validation\n"
+	"   --stream                      - Evaluate definitions one by one while reading them to save memory.\n"
+	"   --short-circuit               - Don't evaluate criteria which can't change the result of the definition.\n"
 	"   --datastream-id <id>          - ID of the data stream in the collection to use.\n"
 	"                                   (only applicable for source data streams)\n"
 	"   --oval-id <id>                - ID of the OVAL component ref in the data stream to use.\n"
@@ -345,6 +347,14 @@ int app_evaluate_oval(const struct oscap_action *action)
 	/* set OVAL Variables */
 	oval_session_set_variables(session, action->f_variables);
 
+	/* set exports before the evaluation, streaming keeps the results for them */
+	oval_session_set_directives(session, action->f_directives);
+	oval_session_set_results_export(session, action->f_results);
+	oval_session_set_report_export(session, action->f_report);
+	oval_session_set_export_system_characteristics(session, !action->without_sys_chars);
+	oval_session_set_streaming(session, action->stream);
+	oval_session_set_short_circuit(session, action->short_circuit);
+
 	oval_session_configure_remote_resources(session, action->remote_resources, action->local_files, download_reporting_callback);
 	/* load all necesary OVAL Definitions and bind OVAL Variables if provided */
 	if ((oval_session_load(session)) != 0)
@@ -363,10 +373,6 @@ int app_evaluate_oval(const struct oscap_action *action)
 
 	printf("Evaluation done.\n");
 
-	oval_session_set_directives(session, action->f_directives);
-	oval_session_set_results_export(session, action->f_results);
-	oval_session_set_report_export(session, action->f_report);
-	oval_session_set_export_system_characteristics(session, !action->without_sys_chars);
 	if (oval_session_export(session) != 0)
 		goto cleanup;
 
@@ -521,6 +527,8 @@ bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 		{ "oval-id",    required_argument, NULL, OVAL_OPT_OVAL_ID},
 		{ "skip-valid",	no_argument, &action->validate, 0 },
 		{ "skip-validation",	no_argument, &action->validate, 0 },
+		{ "stream",	no_argument, &action->stream, 1 },
+		{ "short-circuit",	no_argument, &action->short_circuit, 1 },
 		{ "fetch-remote-resources", no_argument, &action->remote_resources, 1},
 		{ "local-files", required_argument, NULL, OVAL_OPT_LOCAL_FILES},
 		{ 0, 0, 0, 0 }
@@ -167,6 +167,8 @@ struct oscap_action {
 	int progress;
 	int oval_results;
 	int without_sys_chars;
+	int stream;
+	int short_circuit;
 	int thin_results;
 	int remediate;
 	char *sce_template;